@@ -0,0 +1,202 @@
+#include "BenchFixtures.hpp"
+#include "BamTestRecords.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace InterSubMod {
+namespace Bench {
+
+std::string synthetic_reference(size_t length, uint32_t seed) {
+    static const char kBases[] = "ACGT";
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::string ref(length, 'A');
+    for (size_t i = 0; i < length; i++) {
+        ref[i] = kBases[base(rng)];
+    }
+    // Random sequence already has ~6% CG dinucleotides; thin them to ~1%
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (size_t i = 0; i + 1 < length; i++) {
+        if (ref[i] == 'C' && ref[i + 1] == 'G' && u(rng) < 0.83) {
+            ref[i + 1] = 'A';
+        }
+    }
+    return ref;
+}
+
+bam1_t* make_read(const std::string& ref, int32_t ref_offset, int32_t length, uint32_t seed,
+                  int32_t snv_offset, char alt) {
+    std::string seq = ref.substr(ref_offset, length);
+    if (snv_offset >= 0 && snv_offset < length) {
+        seq[snv_offset] = alt;
+    }
+
+    // MM: skip counts over all read Cs, one call per CpG C
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> prob(0, 255);
+    std::string mm = "C+m?";
+    std::vector<uint8_t> ml;
+    int skipped = 0;
+    for (int32_t i = 0; i < length; i++) {
+        if (seq[i] != 'C') continue;
+        if (i + 1 < length && seq[i + 1] == 'G') {
+            mm += "," + std::to_string(skipped);
+            ml.push_back(static_cast<uint8_t>(prob(rng)));
+            skipped = 0;
+        } else {
+            skipped++;
+        }
+    }
+    mm += ";";
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "read_%u", seed);
+    std::vector<char> qual(length, 30);
+    return Testing::make_record(ref_offset, {Testing::op(length, BAM_CMATCH)}, seq, mm, ml, name, qual.data());
+}
+
+std::string synthetic_mm_tag(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> skip(0, 12);
+    std::string mm = "C+h?,0,3;C+m?";
+    for (size_t i = 0; i < count; i++) {
+        mm += "," + std::to_string(skip(rng));
+    }
+    mm += ";";
+    return mm;
+}
+
+MatrixBuilder synthetic_matrix(size_t num_reads, size_t num_cpgs, double coverage, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    MatrixBuilder builder;
+    std::vector<MethylCall> calls;
+    for (size_t r = 0; r < num_reads; r++) {
+        calls.clear();
+        for (size_t c = 0; c < num_cpgs; c++) {
+            if (u(rng) < coverage) {
+                calls.emplace_back(static_cast<int32_t>(10000 + 17 * c), static_cast<float>(u(rng)));
+            }
+        }
+        ReadInfo info{};
+        info.read_id = static_cast<int>(r);
+        info.read_name = "read_" + std::to_string(r);
+        info.align_start = 10000;
+        info.align_end = static_cast<int32_t>(10000 + 17 * num_cpgs);
+        info.mapq = 60;
+        info.is_tumor = true;
+        info.alt_support = (r % 3 == 0) ? AltSupport::ALT : AltSupport::REF;
+        builder.add_read(info, calls);
+    }
+    builder.finalize();
+    return builder;
+}
+
+SomaticSnv synthetic_snv(int32_t pos, char ref_base, char alt_base) {
+    SomaticSnv snv{};
+    snv.snv_id = 0;
+    snv.chr_id = 0;
+    snv.pos = pos;
+    snv.ref_base = ref_base;
+    snv.alt_base = alt_base;
+    snv.qual = 60.0f;
+    snv.is_pass_filter = true;
+    return snv;
+}
+
+static bool file_exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+SyntheticDataset write_dataset(const std::string& dir, int32_t chrom_length, size_t num_reads,
+                               int32_t read_length, size_t num_snvs, uint32_t seed) {
+    SyntheticDataset ds;
+    ds.dir = dir;
+    ds.fasta = dir + "/ref.fa";
+    ds.bam = dir + "/tumor.bam";
+    ds.snv_table = dir + "/snvs.tsv";
+    ds.num_snvs = num_snvs;
+    if (file_exists(ds.bam + ".bai") && file_exists(ds.fasta + ".fai") && file_exists(ds.snv_table)) {
+        return ds;
+    }
+    mkdir(dir.c_str(), 0755);
+
+    const std::string chr = "chrB";
+    const std::string ref = synthetic_reference(chrom_length, seed);
+
+    // FASTA with 60 bp lines and its .fai
+    {
+        std::ofstream fa(ds.fasta);
+        fa << ">" << chr << "\n";
+        for (int32_t i = 0; i < chrom_length; i += 60) {
+            fa << ref.substr(i, 60) << "\n";
+        }
+        std::ofstream fai(ds.fasta + ".fai");
+        fai << chr << "\t" << chrom_length << "\t" << chr.size() + 2 << "\t60\t61\n";
+        if (!fa || !fai) {
+            throw std::runtime_error("Failed to write benchmark FASTA in " + dir);
+        }
+    }
+
+    // Coordinate-sorted BAM: evenly spaced starts with jitter
+    {
+        samFile* out = sam_open(ds.bam.c_str(), "wb");
+        if (!out) {
+            throw std::runtime_error("Failed to write benchmark BAM: " + ds.bam);
+        }
+        std::string text = "@HD\tVN:1.6\tSO:coordinate\n@SQ\tSN:" + chr + "\tLN:" + std::to_string(chrom_length) + "\n";
+        sam_hdr_t* hdr = sam_hdr_parse(text.size(), text.c_str());
+        if (!hdr || sam_hdr_write(out, hdr) < 0) {
+            sam_close(out);
+            throw std::runtime_error("Failed to write benchmark BAM header: " + ds.bam);
+        }
+
+        std::mt19937 rng(seed + 1);
+        const int32_t span = chrom_length - read_length;
+        std::uniform_int_distribution<int32_t> jitter(0, std::max(span / static_cast<int32_t>(num_reads), 1));
+        std::vector<int32_t> starts(num_reads);
+        for (size_t i = 0; i < num_reads; i++) {
+            starts[i] = std::min<int32_t>(static_cast<int32_t>(static_cast<int64_t>(span) * i / num_reads) + jitter(rng), span);
+        }
+        std::sort(starts.begin(), starts.end());
+        for (size_t i = 0; i < num_reads; i++) {
+            bam1_t* b = make_read(ref, starts[i], read_length, seed + 100 + static_cast<uint32_t>(i));
+            int ret = sam_write1(out, hdr, b);
+            bam_destroy1(b);
+            if (ret < 0) {
+                sam_hdr_destroy(hdr);
+                sam_close(out);
+                throw std::runtime_error("Failed to write benchmark BAM record: " + ds.bam);
+            }
+        }
+        sam_hdr_destroy(hdr);
+        if (sam_close(out) < 0 || sam_index_build(ds.bam.c_str(), 0) < 0) {
+            throw std::runtime_error("Failed to finish/index benchmark BAM: " + ds.bam);
+        }
+    }
+
+    // SNVs spread evenly, away from the chromosome ends
+    {
+        std::ofstream tsv(ds.snv_table);
+        tsv << "chr\tpos\tref\talt\n";
+        for (size_t i = 0; i < num_snvs; i++) {
+            int32_t pos = read_length + static_cast<int32_t>(
+                static_cast<int64_t>(chrom_length - 2 * read_length) * i / std::max<size_t>(num_snvs, 1));
+            char ref_base = ref[pos - 1];
+            char alt_base = (ref_base == 'A') ? 'G' : 'A';
+            tsv << chr << "\t" << pos << "\t" << ref_base << "\t" << alt_base << "\n";
+        }
+        if (!tsv) {
+            throw std::runtime_error("Failed to write benchmark SNV table: " + ds.snv_table);
+        }
+    }
+    return ds;
+}
+
+} // namespace Bench
+} // namespace InterSubMod
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <htslib/sam.h>
+#include "core/DataStructs.hpp"
+#include "core/MatrixBuilder.hpp"
+#include "core/SomaticSnv.hpp"
+
+namespace InterSubMod {
+namespace Bench {
+
+/**
+ * @brief Deterministic synthetic inputs for the benchmarks.
+ *
+ * Everything is generated from fixed seeds, so numbers are comparable
+ * between runs and releases without shipping real sequencing data.
+ */
+
+/**
+ * @brief Random ACGT sequence with CpGs at roughly the human genome density (~1%).
+ */
+std::string synthetic_reference(size_t length, uint32_t seed);
+
+/**
+ * @brief A fully aligned long read (one M CIGAR op) copied from ref.
+ *
+ * Every CpG C of the read carries a 5mC call in MM/ML ("C+m?"), base
+ * qualities are 30, and the base at snv_offset (if >= 0) is replaced with
+ * alt so ReadParser sees an ALT-supporting read.
+ *
+ * @param ref_offset 0-based start of the read in ref (= alignment position)
+ */
+bam1_t* make_read(const std::string& ref, int32_t ref_offset, int32_t length, uint32_t seed,
+                  int32_t snv_offset = -1, char alt = 'T');
+
+/**
+ * @brief MM tag with `count` deltas for "C+m?", as written by basecallers.
+ */
+std::string synthetic_mm_tag(size_t count, uint32_t seed);
+
+/**
+ * @brief Finalized matrix of num_reads x ~num_cpgs with ~coverage fraction of cells observed.
+ */
+MatrixBuilder synthetic_matrix(size_t num_reads, size_t num_cpgs, double coverage, uint32_t seed);
+
+/**
+ * @brief An SNV at pos (1-based) on chromosome 0.
+ */
+SomaticSnv synthetic_snv(int32_t pos, char ref_base, char alt_base);
+
+/**
+ * @brief On-disk dataset for end-to-end runs: FASTA + .fai, sorted BAM + .bai, SNV TSV.
+ */
+struct SyntheticDataset {
+    std::string dir;
+    std::string fasta;
+    std::string bam;
+    std::string snv_table;
+    size_t num_snvs = 0;
+};
+
+/**
+ * @brief Writes (or reuses, if already present) a dataset under dir.
+ *
+ * One chromosome "chrB" of chrom_length bp covered by num_reads reads of
+ * read_length bp, and num_snvs SNVs spread evenly along it.
+ *
+ * @throws std::runtime_error if a file cannot be written.
+ */
+SyntheticDataset write_dataset(const std::string& dir, int32_t chrom_length, size_t num_reads,
+                               int32_t read_length, size_t num_snvs, uint32_t seed);
+
+} // namespace Bench
+} // namespace InterSubMod
@@ -0,0 +1,75 @@
+/**
+ * @brief End-to-end throughput: SNV table -> binary region shards.
+ *
+ * Runs RegionProcessor::process_all_regions() on a fixed synthetic dataset
+ * (one 2 Mbp chromosome at ~20x of 10 kbp reads, 400 SNVs) and reports
+ * regions/s of wall time for each thread count. The dataset is written once
+ * under the temp directory and reused by later runs.
+ */
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include "BenchFixtures.hpp"
+#include "core/RegionProcessor.hpp"
+#include "utils/Logger.hpp"
+
+using namespace InterSubMod;
+using namespace InterSubMod::Bench;
+
+namespace {
+
+const SyntheticDataset& dataset() {
+    static const SyntheticDataset ds = write_dataset(
+        (std::filesystem::temp_directory_path() / "ism_bench_dataset_v1").string(),
+        2000000, 4000, 10000, 400, 20240601);
+    return ds;
+}
+
+/// Silences RegionProcessor's console summary for the scope
+struct CoutSilencer {
+    std::ostringstream sink;
+    std::streambuf* saved;
+    CoutSilencer() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~CoutSilencer() { std::cout.rdbuf(saved); }
+};
+
+} // namespace
+
+static void BM_EndToEnd(benchmark::State& state) {
+    const int num_threads = static_cast<int>(state.range(0));
+    const SyntheticDataset& ds = dataset();
+    const std::string output_dir = ds.dir + "/out_t" + std::to_string(num_threads);
+    Utils::Logger::instance().set_log_level(Utils::LogLevel::L_WARNING);
+
+    size_t regions = 0;
+    size_t failed = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove_all(output_dir);
+        state.ResumeTiming();
+
+        CoutSilencer quiet;
+        RegionProcessor processor(ds.bam, "", ds.fasta, output_dir, num_threads, 1000);
+        processor.set_progress_interval(0);
+        processor.load_snvs(ds.snv_table);
+        std::vector<RegionResult> results = processor.process_all_regions();
+        regions += results.size();
+        for (const auto& r : results) {
+            failed += r.success ? 0 : 1;
+        }
+    }
+    std::filesystem::remove_all(output_dir);
+
+    state.counters["regions_per_s"] = benchmark::Counter(static_cast<double>(regions), benchmark::Counter::kIsRate);
+    state.counters["failed"] = static_cast<double>(failed);
+    if (failed > 0) {
+        state.SkipWithError("some regions failed");
+    }
+}
+BENCHMARK(BM_EndToEnd)
+    ->ArgName("threads")
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
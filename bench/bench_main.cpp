@@ -0,0 +1,39 @@
+/**
+ * @brief Benchmark entry point: console table plus a JSON report.
+ *
+ * Unless --benchmark_out is given, results are also written as JSON to
+ * inter_sub_mod_bench.json in the working directory, so every run leaves a
+ * file that can be compared across releases, e.g. with Google Benchmark's
+ * tools/compare.py:
+ *
+ *   compare.py benchmarks old.json new.json
+ */
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    bool has_format = false;
+    for (int i = 1; i < argc; i++) {
+        has_out |= std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+        has_format |= std::strncmp(argv[i], "--benchmark_out_format=", 23) == 0;
+    }
+    std::string out_flag = "--benchmark_out=inter_sub_mod_bench.json";
+    std::string format_flag = "--benchmark_out_format=json";
+    if (!has_out) args.push_back(&out_flag[0]);
+    if (!has_format) args.push_back(&format_flag[0]);
+    args.push_back(nullptr);
+
+    int new_argc = static_cast<int>(args.size()) - 1;
+    benchmark::Initialize(&new_argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(new_argc, args.data())) {
+        return 1;
+    }
+    benchmark::AddCustomContext("suite", "inter_sub_mod");
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
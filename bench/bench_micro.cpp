@@ -0,0 +1,261 @@
+/**
+ * @brief Microbenchmarks of the per-read and per-region hot paths.
+ *
+ * All inputs come from BenchFixtures with fixed seeds; items/s counters are
+ * reads (parsers), cells (finalize), read pairs (distance) or regions (writers).
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include "BenchFixtures.hpp"
+#include "core/DistanceKernels.hpp"
+#include "core/MethylationMatrix.hpp"
+#include "core/MethylationParser.hpp"
+#include "core/ReadParser.hpp"
+#include "io/BinaryRegionFile.hpp"
+#include "io/RegionWriter.hpp"
+
+using namespace InterSubMod;
+using namespace InterSubMod::Bench;
+
+namespace {
+
+constexpr uint32_t kSeed = 20240601;
+
+std::string bench_tmp_dir(const std::string& name) {
+    auto dir = std::filesystem::temp_directory_path() / ("ism_bench_" + name);
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir.string();
+}
+
+/**
+ * @brief Baseline for BM_Distance*: the pre-policy kernel, which branched on
+ * DistanceMetricType once per pair and then ran the same float / double
+ * omp simd reductions as the policies.
+ */
+struct RuntimeDispatchMetric {
+    static inline DistanceMetricType type = DistanceMetricType::L1;
+    static constexpr bool kBinary = false;
+    static constexpr double kMaxDistance = 2.0;
+    static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int common) {
+        if (type == DistanceMetricType::L1) {
+            float sum = 0.0f;
+            #pragma omp simd reduction(+:sum)
+            for (int k = 0; k < m; k++) {
+                sum += wa[k] * wb[k] * std::fabs(a[k] - b[k]);
+            }
+            return static_cast<double>(sum) / common;
+        } else if (type == DistanceMetricType::L2) {
+            float sum = 0.0f;
+            #pragma omp simd reduction(+:sum)
+            for (int k = 0; k < m; k++) {
+                const float d = a[k] - b[k];
+                sum += wa[k] * wb[k] * d * d;
+            }
+            return std::sqrt(static_cast<double>(sum) / common);
+        }
+        double sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+        #pragma omp simd reduction(+:sa, sb, saa, sbb, sab)
+        for (int k = 0; k < m; k++) {
+            const double w = wa[k] * wb[k];
+            const double x = w * a[k];
+            const double y = w * b[k];
+            sa += x;
+            sb += y;
+            saa += x * a[k];
+            sbb += y * b[k];
+            sab += x * b[k];
+        }
+        const double var_a = saa - sa * sa / common;
+        const double var_b = sbb - sb * sb / common;
+        if (var_a <= 1e-12 || var_b <= 1e-12) return std::nan("");
+        return 1.0 - std::clamp((sab - sa * sb / common) / std::sqrt(var_a * var_b), -1.0, 1.0);
+    }
+};
+
+// range(0) reads x range(1) CpGs at 50% coverage, float storage
+MethylationMatrix bench_methylation(size_t num_reads, size_t num_cpgs) {
+    MatrixBuilder builder = synthetic_matrix(num_reads, num_cpgs, 0.5, kSeed);
+    MethylationMatrix methyl;
+    methyl.region_id = 0;
+    methyl.build(builder, 0.8, 0.2, 0);
+    return methyl;
+}
+
+} // namespace
+
+// MM string with range(0) deltas after a leading 5hmC block
+static void BM_ParseMmTag(benchmark::State& state) {
+    const std::string mm = synthetic_mm_tag(state.range(0), kSeed);
+    std::vector<int> deltas;
+    int ml_offset = 0;
+    for (auto _ : state) {
+        bool found = MethylationParser::parse_mm_tag(mm.c_str(), "C+m?", deltas, ml_offset);
+        benchmark::DoNotOptimize(found);
+        benchmark::DoNotOptimize(deltas.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["deltas"] = static_cast<double>(deltas.size());
+}
+BENCHMARK(BM_ParseMmTag)->Arg(64)->Arg(1024)->Arg(8192);
+
+// One read of range(0) bp with its alignment already decoded (as in RegionProcessor)
+static void BM_MethylationParseRead(benchmark::State& state) {
+    const int32_t read_length = static_cast<int32_t>(state.range(0));
+    const std::string ref = synthetic_reference(read_length + 2000, kSeed);
+    bam1_t* b = make_read(ref, 1000, read_length, kSeed);
+    const AlignmentView aln(b);
+    MethylationParser parser;
+    std::vector<MethylCall> calls;
+    for (auto _ : state) {
+        size_t n = parser.parse_read(b, aln, ref, 0, calls);
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["calls"] = static_cast<double>(calls.size());
+    bam_destroy1(b);
+}
+BENCHMARK(BM_MethylationParseRead)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// ReadParser::parse = record fields + HP tag + determine_alt_support at an SNV
+// range(0) bp into the read (block lookup on the decoded alignment)
+static void BM_ReadParserParse(benchmark::State& state) {
+    const int32_t read_length = 20000;
+    const int32_t snv_offset = static_cast<int32_t>(state.range(0));
+    const std::string ref = synthetic_reference(read_length + 2000, kSeed);
+    const char alt = ref[1000 + snv_offset] == 'A' ? 'G' : 'A';
+    bam1_t* b = make_read(ref, 1000, read_length, kSeed, snv_offset, alt);
+    const SomaticSnv snv = synthetic_snv(1000 + snv_offset + 1, ref[1000 + snv_offset], alt);
+    const AlignmentView aln(b);
+    ReadParser parser;
+    for (auto _ : state) {
+        ReadInfo info = parser.parse(b, aln, 0, true, snv, ref, 0);
+        benchmark::DoNotOptimize(info.alt_support);
+    }
+    state.SetItemsProcessed(state.iterations());
+    bam_destroy1(b);
+}
+BENCHMARK(BM_ReadParserParse)->Arg(100)->Arg(10000)->Arg(19000);
+
+// finalize() of range(0) reads x range(1) CpGs at 30% coverage
+static void BM_MatrixFinalize(benchmark::State& state) {
+    const size_t num_reads = state.range(0);
+    const size_t num_cpgs = state.range(1);
+    // Per-read calls are generated once; only add_read + finalize are replayed
+    MatrixBuilder source = synthetic_matrix(num_reads, num_cpgs, 0.3, kSeed);
+    const auto& reads = source.get_reads();
+    const auto& cpgs = source.get_cpg_positions();
+    const MatrixView view = source.get_matrix();
+    std::vector<std::vector<MethylCall>> calls(reads.size());
+    for (size_t r = 0; r < reads.size(); r++) {
+        for (size_t c = 0; c < cpgs.size(); c++) {
+            if (view.at(r, c) != MatrixBuilder::kNoCoverage) {
+                calls[r].emplace_back(cpgs[c], static_cast<float>(view.at(r, c)));
+            }
+        }
+    }
+
+    MatrixBuilder builder;
+    for (auto _ : state) {
+        state.PauseTiming();
+        builder.clear();
+        for (size_t r = 0; r < reads.size(); r++) {
+            builder.add_read(reads.record(r), reads.name(r), calls[r]);
+        }
+        state.ResumeTiming();
+        builder.finalize();
+        benchmark::DoNotOptimize(builder.get_dense().data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_reads * cpgs.size());
+}
+BENCHMARK(BM_MatrixFinalize)->Args({50, 40})->Args({200, 100})->Args({1000, 300});
+
+// One region of range(0) reads x range(1) CpGs per iteration
+static void run_binary_writer(benchmark::State& state, BinaryFormat::MatrixDType dtype, const char* name) {
+    MatrixBuilder builder = synthetic_matrix(state.range(0), state.range(1), 0.3, kSeed);
+    const SomaticSnv snv = synthetic_snv(10000, 'C', 'T');
+    const std::string dir = bench_tmp_dir(name);
+    const std::string path = dir + "/bench.ismr";
+
+    auto writer = std::make_unique<BinaryRegionWriter>(path, dtype);
+    uint64_t bytes = 0;
+    int region_id = 0;
+    for (auto _ : state) {
+        writer->write_region(snv, region_id++, 8000, 12000, builder.get_reads(),
+                             builder.get_cpg_positions(), builder.get_matrix());
+        // Keep the file (and its index) bounded
+        if (region_id % 256 == 0) {
+            state.PauseTiming();
+            bytes += writer->bytes_written();
+            writer.reset();
+            writer = std::make_unique<BinaryRegionWriter>(path, dtype);
+            state.ResumeTiming();
+        }
+    }
+    bytes += writer->bytes_written();
+    writer.reset();
+    std::filesystem::remove_all(dir);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+
+static void BM_WriteBinaryF32(benchmark::State& state) {
+    run_binary_writer(state, BinaryFormat::MatrixDType::FLOAT32, "f32");
+}
+BENCHMARK(BM_WriteBinaryF32)->Args({50, 40})->Args({200, 100});
+
+static void BM_WriteBinaryU8(benchmark::State& state) {
+    run_binary_writer(state, BinaryFormat::MatrixDType::UINT8, "u8");
+}
+BENCHMARK(BM_WriteBinaryU8)->Args({50, 40})->Args({200, 100});
+
+// Legacy per-region directory output (one directory + several text files per region)
+static void BM_WriteCsv(benchmark::State& state) {
+    MatrixBuilder builder = synthetic_matrix(state.range(0), state.range(1), 0.3, kSeed);
+    const SomaticSnv snv = synthetic_snv(10000, 'C', 'T');
+    const std::string dir = bench_tmp_dir("csv");
+    RegionWriter writer(dir);
+    int region_id = 0;
+    for (auto _ : state) {
+        std::string out = writer.write_region(snv, region_id++ % 256, 8000, 12000, builder.get_reads(),
+                                              builder.get_cpg_positions(), builder.get_matrix());
+        benchmark::DoNotOptimize(out.data());
+    }
+    std::filesystem::remove_all(dir);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteCsv)->Args({50, 40})->Args({200, 100});
+
+// range(2): 0 = L1, 1 = L2, 2 = CORR; compare against BM_DistanceRuntimeDispatch with the same args
+static DistanceMetricType bench_metric(int64_t arg) {
+    return arg == 0 ? DistanceMetricType::L1 : arg == 1 ? DistanceMetricType::L2 : DistanceMetricType::CORR;
+}
+
+// Policies resolved once per region (compute_from_methylation())
+static void BM_DistanceTemplated(benchmark::State& state) {
+    const MethylationMatrix methyl = bench_methylation(state.range(0), state.range(1));
+    const DistanceMetricType type = bench_metric(state.range(2));
+    DistanceMatrix dm;
+    for (auto _ : state) {
+        dm.compute_from_methylation(methyl, type, 3, NanDistanceStrategy::MAX_DIST);
+        benchmark::DoNotOptimize(dm.dist_matrix.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * (state.range(0) - 1) / 2);
+}
+BENCHMARK(BM_DistanceTemplated)->ArgsProduct({{200, 1000}, {100}, {0, 1, 2}});
+
+// Same tiling and packing, metric branched on per pair
+static void BM_DistanceRuntimeDispatch(benchmark::State& state) {
+    const MethylationMatrix methyl = bench_methylation(state.range(0), state.range(1));
+    RuntimeDispatchMetric::type = bench_metric(state.range(2));
+    DistanceMatrix dm;
+    for (auto _ : state) {
+        dm.compute<RuntimeDispatchMetric, DistanceKernels::MaxDist>(methyl, 3);
+        benchmark::DoNotOptimize(dm.dist_matrix.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * (state.range(0) - 1) / 2);
+}
+BENCHMARK(BM_DistanceRuntimeDispatch)->ArgsProduct({{200, 1000}, {100}, {0, 1, 2}});
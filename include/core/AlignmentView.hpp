@@ -0,0 +1,80 @@
+#pragma once
+
+#include <htslib/sam.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace InterSubMod {
+
+/**
+ * @brief Per-read alignment geometry, decoded from the CIGAR once.
+ *
+ * Holds the query length (as bam_cigar2qlen), the reference span (as
+ * bam_endpos) and the aligned blocks (M/=/X ops, adjacent ones merged),
+ * so read filtering, ALT/REF calling and methylation mapping share a
+ * single CIGAR pass instead of each walking it again.
+ *
+ * Lookups are binary searches over the blocks; callers that visit query
+ * positions in increasing order (MethylationParser) can walk blocks()
+ * with a forward cursor instead.
+ *
+ * reset() reuses the block buffer, so a long-lived view (one per thread)
+ * decodes reads without allocating in steady state.
+ */
+class AlignmentView {
+public:
+    /**
+     * @brief One gap-free aligned block: query [query_start, query_start + length)
+     *        maps to reference [ref_start, ref_start + length).
+     */
+    struct Block {
+        int32_t query_start;
+        int32_t ref_start;   ///< 0-based
+        int32_t length;
+
+        int32_t query_end() const { return query_start + length; }
+        int32_t ref_end() const { return ref_start + length; }
+    };
+
+    AlignmentView() = default;
+    explicit AlignmentView(const bam1_t* b) { reset(b); }
+
+    /**
+     * @brief Decodes b's CIGAR (single pass); b itself is not retained.
+     */
+    void reset(const bam1_t* b);
+
+    /// Query bases consumed by the CIGAR (M/I/S/=/X), as bam_cigar2qlen()
+    int32_t query_length() const { return query_length_; }
+
+    /// 0-based alignment start (b->core.pos)
+    int32_t ref_start() const { return ref_start_; }
+
+    /// 0-based exclusive alignment end, as bam_endpos() (start + 1 when nothing consumes the reference)
+    int32_t ref_end() const { return ref_end_; }
+
+    /// Aligned blocks in query (and reference) order
+    const std::vector<Block>& blocks() const { return blocks_; }
+
+    /**
+     * @brief Query offset aligned to a reference position.
+     * @param ref_pos 0-based reference position
+     * @return Query offset, or -1 if ref_pos is outside the alignment or in a deletion / reference skip
+     */
+    int32_t query_offset(int32_t ref_pos) const;
+
+    /**
+     * @brief Reference position a query offset is aligned to.
+     * @return 0-based reference position, or -1 for inserted / soft-clipped / out-of-range bases
+     */
+    int32_t ref_position(int32_t query_pos) const;
+
+private:
+    std::vector<Block> blocks_;
+    int32_t query_length_ = 0;
+    int32_t ref_start_ = 0;
+    int32_t ref_end_ = 0;
+};
+
+} // namespace InterSubMod
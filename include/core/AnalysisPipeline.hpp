@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "core/Config.hpp"
+#include "core/RegionProcessor.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief inter_sub_mod 主程式的串流執行器：Config → RegionProcessor → 分析 → 輸出
+ *
+ * 各階段各自有有界佇列並同時進行：
+ * 1. SNV reader thread 串流讀取 VCF（process_snv_stream），每批 super-regions 排入佇列
+ * 2. OpenMP workers（Config::threads）擷取 BAM reads、解析 MM/ML、建構矩陣
+ * 3. 分析 threads（RegionAnalyzer）建構 MethylationMatrix、計算距離並分群，寫入 clusters.tsv
+ * 4. Writer threads（AsyncRegionWriter）寫出矩陣 shards 與 completion journal
+ *
+ * Config::num_clusters = 0 時略過第 3 階段，只輸出矩陣。
+ */
+class AnalysisPipeline {
+public:
+    explicit AnalysisPipeline(const Config& config);
+
+    /**
+     * @brief 執行完整流程並輸出摘要（以及 telemetry，若 Config::telemetry_prefix 非空）
+     *
+     * @return 0 = 全部成功；2 = 部分 regions 失敗（--resume 會重試）
+     * @throws std::runtime_error 無法開啟輸入 / 輸出，或 SNV 讀取中途失敗
+     */
+    int run();
+
+    /**
+     * @brief 最近一次 run() 的每個 region 結果
+     */
+    const std::vector<RegionResult>& results() const { return results_; }
+
+    /**
+     * @brief 依 Config 設定好的 RegionProcessor（run() 前可再調整）
+     */
+    RegionProcessor& processor() { return *processor_; }
+
+private:
+    Config config_;
+    std::unique_ptr<RegionProcessor> processor_;
+    std::vector<RegionResult> results_;
+};
+
+} // namespace InterSubMod
@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 #include <htslib/sam.h>
+#include "core/BamRecordPool.hpp"
 
 namespace InterSubMod {
 
@@ -14,11 +16,23 @@ namespace InterSubMod {
  * in specific genomic regions. Each thread should maintain its own instance
  * to avoid file pointer contention.
  * 
- * Usage:
+ * Usage (streaming, preferred - no per-read allocation):
  *   BamReader reader("sample.bam");
+ *   reader.for_each_read("chr17", 7577000, 7578000, [&](const bam1_t* b) {
+ *       // ... inspect b (only valid during the callback) ...
+ *       return true;  // false stops the iteration
+ *   });
+ *
+ * Usage (owning, when records must outlive the fetch):
  *   auto reads = reader.fetch_reads("chr17", 7577000, 7578000);
  *   // ... process reads ...
- *   for (auto* r : reads) bam_destroy1(r);
+ *   reader.recycle(reads);  // or bam_destroy1() each record
+ *
+ * Repeated queries should use the numeric overloads with a tid from
+ * tid(chr_id, chr) (cached per ChromIndex chr_id): they go straight to
+ * sam_itr_queryi() without formatting or parsing a region string. Together
+ * with the record pool behind fetch_reads(), the only steady-state
+ * allocation left per query is HTSlib's own iterator.
  */
 class BamReader {
 public:
@@ -45,15 +59,126 @@ public:
      * @brief Fetches all reads overlapping the specified region.
      * 
      * @param chr Chromosome name (must match BAM header).
-     * @param start 0-based inclusive start position.
-     * @param end 0-based exclusive end position.
-     * @return Vector of bam1_t pointers. Caller must free with bam_destroy1().
+     * @param start 1-based start position (as in "chr:start-end").
+     * @param end 1-based inclusive end position.
+     * @return Vector of bam1_t pointers from the reader's record pool.
+     *         Caller returns them with recycle() or frees them with bam_destroy1().
      * 
      * @note Returns empty vector if chromosome not found or region invalid.
-     * @note Reads are allocated with bam_dup1(), caller owns the memory.
      */
     std::vector<bam1_t*> fetch_reads(const std::string& chr, int32_t start, int32_t end);
     
+    /**
+     * @brief Fetches only the reads accepted by a predicate.
+     * 
+     * The predicate sees the record in the reader's reusable buffer, so
+     * rejected reads are never copied; accepted ones are copied into
+     * pooled records.
+     * 
+     * @param keep Callable `bool(const bam1_t*)`; true = copy the read.
+     * @return Vector of accepted reads (see fetch_reads()).
+     */
+    template <typename Pred>
+    std::vector<bam1_t*> fetch_reads(const std::string& chr, int32_t start, int32_t end, Pred&& keep) {
+        return fetch_reads(tid(chr), start, end, std::forward<Pred>(keep));
+    }
+    
+    /**
+     * @brief fetch_reads() by target ID (see tid()); tid < 0 gives no reads.
+     */
+    template <typename Pred>
+    std::vector<bam1_t*> fetch_reads(int tid, int32_t start, int32_t end, Pred&& keep) {
+        std::vector<bam1_t*> reads;
+        int64_t ret = for_each_read(tid, start, end, [&](const bam1_t* b) {
+            if (keep(b)) {
+                reads.push_back(records_.copy(b));
+            }
+            return true;
+        });
+        if (ret < 0) {
+            recycle(reads);
+        }
+        return reads;
+    }
+    
+    /**
+     * @brief Streams all reads overlapping the region through a callback.
+     * 
+     * Records are decoded into one bam1_t buffer owned by this reader and
+     * reused for every read, so nothing is allocated per record.
+     * 
+     * @param chr Chromosome name (must match BAM header).
+     * @param start Region start (same convention as fetch_reads()).
+     * @param end Region end (same convention as fetch_reads()).
+     * @param fn Callable `bool(const bam1_t*)`; return false to stop early.
+     *           The pointer is only valid during the call.
+     * @return Number of records visited, 0 if the region is invalid,
+     *         -1 if a read error occurred.
+     */
+    template <typename Fn>
+    int64_t for_each_read(const std::string& chr, int32_t start, int32_t end, Fn&& fn) {
+        return for_each_read(tid(chr), start, end, std::forward<Fn>(fn));
+    }
+    
+    /**
+     * @brief for_each_read() by target ID (see tid()); tid < 0 visits nothing.
+     */
+    template <typename Fn>
+    int64_t for_each_read(int tid, int32_t start, int32_t end, Fn&& fn) {
+        hts_itr_t* iter = query(tid, start, end);
+        if (!iter) {
+            return 0;
+        }
+        
+        int64_t visited = 0;
+        int ret;
+        while ((ret = sam_itr_next(fp_, iter, scratch_)) >= 0) {
+            visited++;
+            if (!fn(static_cast<const bam1_t*>(scratch_))) {
+                ret = -1;  // Stopped by caller, not an error
+                break;
+            }
+        }
+        hts_itr_destroy(iter);
+        
+        // ret < -1 indicates a read error
+        return ret < -1 ? -1 : visited;
+    }
+    
+    /**
+     * @brief Estimates the compressed BAM bytes a query would read, from the index alone.
+     * 
+     * Sums the BGZF virtual-offset chunks the BAI bins and linear index
+     * select for the region (no block is read or decompressed). Chunks
+     * inside a single block are counted by their uncompressed length
+     * divided by a typical compression ratio. A cheap proxy for the
+     * region's fetch and parse cost; tid < 0 or no index gives 0.
+     */
+    uint64_t estimate_bytes(int tid, int32_t start, int32_t end);
+    
+    /**
+     * @brief Target ID of a chromosome in this BAM's header (-1 if absent).
+     */
+    int tid(const std::string& chr) const;
+    
+    /**
+     * @brief tid() cached by ChromIndex chromosome ID.
+     * 
+     * Each chr_id is looked up in the header once per reader; later calls
+     * are a vector load. chr_id < 0 falls back to the name lookup.
+     */
+    int tid(int chr_id, const std::string& chr);
+    
+    /**
+     * @brief Returns records from fetch_reads() to the pool, then clears the vector.
+     */
+    void recycle(std::vector<bam1_t*>& reads) { records_.release(reads); }
+    
+    /**
+     * @brief The pool behind fetch_reads() (reuse / allocation counters).
+     */
+    const BamRecordPool& record_pool() const { return records_; }
+    
     /**
      * @brief Gets the BAM header for chromosome name lookups.
      * @return Pointer to the BAM header (valid until BamReader is destroyed).
@@ -66,6 +191,27 @@ public:
      */
     bool is_open() const { return fp_ != nullptr; }
     
+    /**
+     * @brief Decompresses through a shared HTSlib thread pool.
+     * 
+     * Use instead of the constructor's n_threads (leave it at 1): a file
+     * can only have one pool. The pool must outlive this reader (see HtsThreadPool).
+     * 
+     * @throws std::runtime_error if HTSlib cannot attach the pool.
+     */
+    void set_thread_pool(htsThreadPool* pool);
+    
+    /**
+     * @brief Applies an HTSlib filter expression to every later query.
+     * 
+     * Records failing the expression (e.g. "[NM] < 500 && rlen >= 1000")
+     * are skipped inside sam_itr_next(), before for_each_read() or any
+     * predicate sees them. An empty expression removes the filter.
+     * 
+     * @throws std::runtime_error if HTSlib cannot parse the expression.
+     */
+    void set_filter_expression(const std::string& expr);
+    
     /**
      * @brief Gets the path of the opened BAM file.
      */
@@ -76,6 +222,18 @@ private:
     samFile* fp_;
     bam_hdr_t* hdr_;
     hts_idx_t* idx_;
+    bam1_t* scratch_;  ///< Reusable record buffer for streaming iteration
+    BamRecordPool records_;             ///< Recycled records for fetch_reads()
+    std::vector<int> tid_by_chr_id_;    ///< tid(chr_id, chr) cache; kUnresolvedTid = not looked up yet
+    
+    static constexpr int kUnresolvedTid = -2;
+    
+    /**
+     * @brief Creates a region iterator, or nullptr if not open / tid < 0.
+     * 
+     * start / end follow the "chr:start-end" convention of fetch_reads().
+     */
+    hts_itr_t* query(int tid, int32_t start, int32_t end);
 };
 
 } // namespace InterSubMod
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <htslib/sam.h>
+
+namespace InterSubMod {
+
+/**
+ * @brief Free list of bam1_t records whose data buffers are reused.
+ *
+ * copy() fills a recycled record with bam_copy1(), which only reallocates
+ * when the new read is larger than any read the record held before, so a
+ * reader that fetches similar regions over and over stops allocating once
+ * the pool has warmed up. Records taken from the pool are ordinary bam1_t
+ * and may still be freed with bam_destroy1() instead of release().
+ *
+ * The pool keeps at most max_pooled_bytes of record data (long ONT reads
+ * carry 100+ kB of sequence, quality and MM/ML each); records released
+ * beyond that are destroyed.
+ *
+ * Not thread-safe: one pool per BamReader, i.e. per thread.
+ */
+class BamRecordPool {
+public:
+    static constexpr size_t kDefaultMaxPooledBytes = size_t(64) << 20;
+
+    explicit BamRecordPool(size_t max_pooled_bytes = kDefaultMaxPooledBytes);
+    ~BamRecordPool();
+
+    BamRecordPool(const BamRecordPool&) = delete;
+    BamRecordPool& operator=(const BamRecordPool&) = delete;
+    BamRecordPool(BamRecordPool&& other) noexcept;
+    BamRecordPool& operator=(BamRecordPool&& other) noexcept;
+
+    /**
+     * @brief Deep copy of src in a pooled record (a new one if the pool is empty).
+     * @throws std::bad_alloc if HTSlib cannot allocate the record data.
+     */
+    bam1_t* copy(const bam1_t* src);
+
+    /**
+     * @brief Returns a record to the pool (or destroys it once the pool is full).
+     */
+    void release(bam1_t* b);
+
+    /**
+     * @brief release() for every record, then clears the vector.
+     */
+    void release(std::vector<bam1_t*>& records);
+
+    size_t pooled() const { return free_.size(); }
+    size_t pooled_bytes() const { return pooled_bytes_; }
+
+    /// copy() calls served by a recycled record
+    size_t reuses() const { return reuses_; }
+
+    /// copy() calls that had to create a record
+    size_t allocations() const { return allocations_; }
+
+private:
+    std::vector<bam1_t*> free_;
+    size_t pooled_bytes_ = 0;
+    size_t max_pooled_bytes_;
+    size_t reuses_ = 0;
+    size_t allocations_ = 0;
+
+    void destroy_all();
+};
+
+} // namespace InterSubMod
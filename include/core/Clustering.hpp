@@ -3,6 +3,8 @@
 #include <vector>
 #include <map>
 #include "Types.hpp"
+#include "DataStructs.hpp"
+#include "ReadTable.hpp"
 
 namespace InterSubMod {
 
@@ -45,4 +47,118 @@ public:
     // Placeholder for PhyloNode* phylo_root;
 };
 
+class DistanceMatrix;
+
+/**
+ * @brief One agglomeration step of a dendrogram (SciPy linkage layout).
+ *
+ * Nodes 0..N-1 are reads; the node created by merges[k] has id N+k.
+ */
+struct LinkageStep {
+    int left;       ///< Node id of the first merged cluster
+    int right;      ///< Node id of the second merged cluster
+    double height;  ///< Linkage distance at which they merge
+    int size;       ///< Number of reads in the new cluster
+};
+
+/**
+ * @brief Two-sided Fisher's exact test for 2x2 tables.
+ *
+ * Uses a cached log-factorial table that grows on demand, so repeated tests
+ * within a region cost O(min margin) additions each. Not thread-safe while
+ * growing; use one instance per thread.
+ */
+class FisherExactTest {
+public:
+    explicit FisherExactTest(int initial_n = 1024);
+
+    /**
+     * @brief p-value for the table [[a, b], [c, d]].
+     *
+     * Sums the probabilities of all tables with the same margins that are
+     * no more likely than the observed one. Returns 1.0 for empty tables.
+     */
+    double two_sided(int a, int b, int c, int d);
+
+private:
+    std::vector<double> log_fact_;  ///< log_fact_[n] = log(n!)
+
+    void ensure(int n);
+    double log_hypergeom(int a, int b, int c, int d) const;
+};
+
+/**
+ * @brief Agglomerative hierarchical clustering on a DistanceMatrix.
+ *
+ * Uses the nearest-neighbour-chain algorithm with Lance-Williams updates on
+ * a condensed distance matrix: O(N^2) time and N(N-1)/2 doubles of memory
+ * (average, complete and Ward linkage are all reducible, so the chain
+ * yields the same dendrogram as the naive O(N^3) method).
+ *
+ * NaN distances (NanDistanceStrategy::SKIP) are treated as the largest
+ * finite distance in the matrix.
+ *
+ * Usage:
+ *   HierarchicalClustering hc(LinkageMethod::AVERAGE);
+ *   hc.fit(dist);
+ *   ClusteringResult res = hc.summarize(dist, hc.cut_k(2), reads);
+ */
+class HierarchicalClustering {
+public:
+    explicit HierarchicalClustering(LinkageMethod method = LinkageMethod::AVERAGE);
+
+    /**
+     * @brief Builds the dendrogram.
+     * @return N-1 merges ordered by non-decreasing height.
+     */
+    const std::vector<LinkageStep>& fit(const DistanceMatrix& dist);
+
+    const std::vector<LinkageStep>& linkage() const { return merges_; }
+    int num_leaves() const { return num_leaves_; }
+
+    /**
+     * @brief Cuts the tree into (at most) k clusters.
+     * @return labels[i] in 1..k, numbered by first appearance.
+     */
+    std::vector<int> cut_k(int k) const;
+
+    /**
+     * @brief Cuts the tree at a height: clusters merge while height <= threshold.
+     * @return labels[i] in 1..K, numbered by first appearance.
+     */
+    std::vector<int> cut_height(double threshold) const;
+
+    /**
+     * @brief Per-read silhouette coefficients, computed in parallel over rows.
+     *
+     * s(i) = (b - a) / max(a, b) with a = mean distance to its own cluster
+     * and b = lowest mean distance to another cluster; 0 for singletons or
+     * when only one cluster exists. NaN distances are ignored.
+     */
+    static std::vector<double> silhouette(const DistanceMatrix& dist, const std::vector<int>& labels);
+
+    /**
+     * @brief Assembles a ClusteringResult: labels, silhouettes and per-cluster stats.
+     *
+     * Each cluster is tested against all other reads with Fisher's exact test
+     * on HP1/HP2 (HP=0 excluded) and ALT/REF (UNKNOWN excluded).
+     *
+     * @param reads Read metadata aligned with the distance matrix rows.
+     */
+    ClusteringResult summarize(const DistanceMatrix& dist, const std::vector<int>& labels,
+                               const ReadTable& reads);
+
+    /// Same as above for a plain ReadInfo list (copied into a ReadTable)
+    ClusteringResult summarize(const DistanceMatrix& dist, const std::vector<int>& labels,
+                               const std::vector<ReadInfo>& reads);
+
+private:
+    LinkageMethod method_;
+    int num_leaves_ = 0;
+    std::vector<LinkageStep> merges_;
+    FisherExactTest fisher_;
+
+    std::vector<int> labels_after(int num_merges) const;
+};
+
 } // namespace InterSubMod
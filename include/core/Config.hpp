@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -21,12 +22,20 @@ struct Config {
     std::string somatic_vcf_path;     ///< Path to Somatic VCF (Required)
     std::string output_dir = "output";///< Output directory for results
     std::string pmd_bed_path;         ///< Path to PMD annotation BED (Optional)
+    OutputFormat output_format = OutputFormat::BINARY; ///< Region output format (CSV is opt-in)
+    bool quantize_matrix = false;     ///< Keep region matrices as uint8 (255 = no coverage) in memory and in binary output
+    std::string snv_regions;          ///< Only SNVs in these ranges, e.g. "chr1:1-50M,chr2" (Optional)
+    std::string shard;                ///< Only shard "i/N" of the genome, balanced by read depth (Optional)
+    bool resume = false;              ///< Skip regions already completed in output_dir's journal
+    int work_units = 0;               ///< inter_sub_mod_mpi: genome shards handed out by rank 0 (0 = 4 per worker rank)
+    std::string telemetry_prefix;     ///< Write <prefix>.tsv / <prefix>.json stage telemetry (Optional)
 
     // Global Parameters
     int window_size_bp = 1000;        ///< Analysis window size around somatic SNV (±bp)
     int min_mapq = 20;                ///< Minimum Mapping Quality to consider a read
     int min_read_length = 1000;       ///< Minimum Read Length (bp)
     int min_base_quality = 20;        ///< Minimum Base Quality for SNV/CpG sites
+    std::string read_filter_expression; ///< Extra HTSlib filter expression on BAM records (Optional)
     
     double binary_methyl_high = 0.8;  ///< Threshold for methylated (1) call
     double binary_methyl_low = 0.2;   ///< Threshold for unmethylated (0) call
@@ -36,9 +45,21 @@ struct Config {
     
     NanDistanceStrategy nan_distance_strategy = NanDistanceStrategy::MAX_DIST; ///< Strategy for missing distances
     DistanceMetricType distance_metric = DistanceMetricType::NHD;              ///< Distance metric to use
+    LinkageMethod linkage_method = LinkageMethod::AVERAGE;                     ///< Hierarchical clustering linkage
+    int num_clusters = 2;             ///< Clusters per region (dendrogram cut); 0 = write matrices only
     
     bool pmd_gating = true;           ///< Whether to exclude CpG sites in PMDs
+    bool cache_reference = false;     ///< Decode each chromosome once into a shared in-memory cache
+    int methyl_cache_mb = 0;          ///< Per-thread cache of parsed per-read methylation calls (MB, 0 = off)
+    int max_reads_per_region = 0;     ///< Depth cap: stratified deterministic downsampling above this (0 = off)
+    uint64_t sample_seed = 0;         ///< Seed of the downsampling hash
+    bool cost_schedule = false;       ///< Estimate region costs from the BAI and schedule heaviest first
+    int prefetch_depth = 0;           ///< Super-regions each worker fetches ahead of the one it computes (0 = off)
+    bool numa = false;                ///< Pin workers per NUMA node and replicate read-only data per node
     int threads = 16;                  ///< Number of threads for parallel processing
+    int hts_threads = 0;               ///< Shared BGZF decompression threads for all BAM readers (0 = inline)
+    double progress_interval_s = 10.0; ///< Seconds between progress lines (0 = off)
+    bool verbose = false;              ///< Log per-region start/completion lines (debug level)
 
     /**
      * @brief Validates configuration logic and file formats.
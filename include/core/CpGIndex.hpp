@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/DataStructs.hpp"
+#include "core/IntervalIndex.hpp"
+
+namespace InterSubMod {
+
+class FastaReader;
+
+/**
+ * @brief On-disk genome-wide CpG index (.cpgi, version 1).
+ *
+ * Written once per reference by the build_cpg_index tool, then mmapped.
+ * Every CpG (a 'C' followed by 'G' on the + strand) gets a stable global
+ * cpg_id: chromosomes are numbered in FASTA order and sites in position
+ * order, so cpg_id = ChromEntry::first_cpg_id + index within the chromosome.
+ * Little-endian, arrays 64-byte aligned.
+ *
+ * ```
+ * [FileHeader 64B]
+ * [ChromEntry x num_chroms]     64B each, FASTA order
+ * [names blob]                  chromosome names, no '\0'
+ * per chromosome (64B aligned):
+ *    int32 positions[num_sites] 1-based position of the C, ascending
+ *    uint8 flags[num_sites]     CpGFlag bits
+ * ```
+ */
+namespace CpGIndexFormat {
+
+constexpr char kMagic[8] = {'I', 'S', 'M', 'C', 'P', 'G', '0', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlign = 64;
+
+/**
+ * @brief Annotation bits stored per site.
+ */
+enum CpGFlag : uint8_t {
+    CPG_IN_PMD = 1 << 0,
+    CPG_REPRESSIVE = 1 << 1,
+    CPG_ACCESSIBLE = 1 << 2
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       ///< sizeof(FileHeader)
+    uint32_t num_chroms;
+    uint32_t annotations;       ///< OR of the CpGFlag bits that were annotated
+    uint64_t num_sites;
+    uint64_t chrom_table_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint8_t reserved[8];
+};
+
+struct ChromEntry {
+    int64_t length;             ///< Chromosome length (bp)
+    uint64_t first_cpg_id;
+    uint64_t num_sites;
+    uint64_t positions_offset;
+    uint64_t flags_offset;
+    uint32_t name_offset;       ///< Relative to the names blob
+    uint32_t name_len;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(ChromEntry) == 64, "ChromEntry layout");
+
+} // namespace CpGIndexFormat
+
+/**
+ * @brief Builds a .cpgi file from a reference FASTA.
+ *
+ * Usage:
+ *   CpGIndexBuilder builder("hg38.fa");
+ *   builder.set_annotation(CpGIndexFormat::CPG_IN_PMD, &pmd_intervals);
+ *   builder.write("hg38.cpgi", 8);
+ */
+class CpGIndexBuilder {
+public:
+    explicit CpGIndexBuilder(const std::string& fasta_path);
+
+    /**
+     * @brief Marks sites inside the given intervals with a flag bit.
+     * @param intervals Must outlive write(); nullptr removes the annotation.
+     */
+    void set_annotation(CpGIndexFormat::CpGFlag flag, const IntervalIndex* intervals);
+
+    /**
+     * @brief Scans every chromosome and writes the index.
+     *
+     * Chromosomes are decoded and scanned in parallel (OpenMP), then written
+     * in FASTA order; peak memory is about num_threads chromosomes.
+     *
+     * @return Number of CpG sites written.
+     * @throws std::runtime_error on FASTA or I/O errors.
+     */
+    uint64_t write(const std::string& out_path, int num_threads = 1);
+
+private:
+    struct ChromSites {
+        int64_t length = 0;
+        std::vector<int32_t> positions;
+        std::vector<uint8_t> flags;
+    };
+
+    std::string fasta_path_;
+    std::vector<std::pair<CpGIndexFormat::CpGFlag, const IntervalIndex*>> annotations_;
+
+    void scan_chromosome(FastaReader& fasta, const std::string& name, ChromSites& out) const;
+};
+
+/**
+ * @brief CpG sites of one chromosome range (zero-copy view into the index).
+ */
+struct CpGRange {
+    int chr_id = -1;
+    uint64_t first_cpg_id = 0;           ///< cpg_id of positions[0]
+    const int32_t* positions = nullptr;  ///< 1-based, ascending
+    const uint8_t* flags = nullptr;
+    size_t count = 0;
+
+    int64_t cpg_id(size_t i) const { return static_cast<int64_t>(first_cpg_id + i); }
+};
+
+/**
+ * @brief Read-only, mmapped view of a .cpgi file.
+ *
+ * Range lookups are a binary search over the chromosome's position array.
+ * All methods are const and safe to share across threads.
+ */
+class CpGIndex {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened or is not a .cpgi file.
+     */
+    explicit CpGIndex(const std::string& path);
+    ~CpGIndex();
+
+    CpGIndex(const CpGIndex&) = delete;
+    CpGIndex& operator=(const CpGIndex&) = delete;
+
+    size_t num_chroms() const { return chroms_.size(); }
+    uint64_t num_sites() const { return header_->num_sites; }
+    uint32_t annotations() const { return header_->annotations; }
+
+    /**
+     * @brief Chromosome id (FASTA order), or -1 if unknown.
+     */
+    int chr_id(const std::string& chr) const;
+    const std::string& chr_name(int chr_id) const { return names_[chr_id]; }
+    const CpGIndexFormat::ChromEntry& chrom(int chr_id) const { return chroms_[chr_id]; }
+
+    /**
+     * @brief Sites with start <= pos <= end (1-based, inclusive).
+     * @return Empty range (count = 0) if none or the chromosome is unknown.
+     */
+    CpGRange range(const std::string& chr, int32_t start, int32_t end) const;
+
+    /**
+     * @brief Global id of the CpG at a 1-based position, or -1.
+     */
+    int64_t cpg_id(const std::string& chr, int32_t pos) const;
+
+    /**
+     * @brief Maps ascending 1-based positions to global ids (-1 if not a CpG).
+     *
+     * One binary search for the first position, then a linear merge; meant
+     * for per-region column lists such as MatrixBuilder::get_cpg_positions().
+     */
+    void lookup_ids(const std::string& chr, const std::vector<int32_t>& positions,
+                    std::vector<int64_t>& ids) const;
+
+    /**
+     * @brief Materializes a range as CpGSite records.
+     */
+    std::vector<CpGSite> sites(const std::string& chr, int32_t start, int32_t end) const;
+
+private:
+    std::string path_;
+    const uint8_t* data_;
+    size_t size_;
+    const CpGIndexFormat::FileHeader* header_;
+    std::vector<CpGIndexFormat::ChromEntry> chroms_;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, int> ids_;
+
+    const int32_t* positions(int chr_id) const {
+        return reinterpret_cast<const int32_t*>(data_ + chroms_[chr_id].positions_offset);
+    }
+};
+
+} // namespace InterSubMod
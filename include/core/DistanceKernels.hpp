@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+#include "core/DistanceMatrix.hpp"
+#include "core/MethylationMatrix.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Compile-time distance kernels behind DistanceMatrix.
+ *
+ * A kernel is DistanceMatrix::compute<Metric, NanPolicy>(): the metric and
+ * the NaN strategy are template parameters, so the per-pair code is one
+ * inlined function with no branch on DistanceMetricType or
+ * NanDistanceStrategy; compute_from_methylation() picks the instantiation
+ * once per region.
+ *
+ * A metric policy is a struct with either
+ * - binary input (bitsets of binary_matrix):
+ *   @code
+ *   static constexpr bool kBinary = true;
+ *   static constexpr double kMaxDistance = 1.0;
+ *   // common = sites covered by both, diff = discordant, inter = both methylated
+ *   static double from_counts(int common, int diff, int inter);
+ *   @endcode
+ * - or probability input (masked float rows, missing = value 0, mask 0):
+ *   @code
+ *   static constexpr bool kBinary = false;
+ *   static constexpr double kMaxDistance = 1.0;
+ *   // m = padded row length, common = sites covered by both (>= min_cov)
+ *   static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int common);
+ *   @endcode
+ * A NaN result is replaced by the NaN policy's fallback. Custom metrics are
+ * just another policy passed to compute<>(); tiling, threading and the
+ * coverage check are shared.
+ */
+namespace DistanceKernels {
+
+constexpr size_t kTileBytes = 16 * 1024;      ///< Per-tile working set (two tiles ~ L1d)
+constexpr int64_t kParallelPairs = 64 * 64;   ///< Below this, stay on the calling thread
+constexpr int kFloatAlign = 16;               ///< Row stride in floats (64 bytes)
+
+/**
+ * @brief Per-read bitsets: bit k of meth = methylated, bit k of cov = has a value.
+ */
+struct BitRows {
+    size_t words = 0;
+    std::vector<uint64_t> meth;
+    std::vector<uint64_t> cov;
+
+    const uint64_t* meth_row(int r) const { return meth.data() + r * words; }
+    const uint64_t* cov_row(int r) const { return cov.data() + r * words; }
+};
+
+/**
+ * @brief Row-major float copy of the probabilities: missing values are 0 with mask 0.
+ */
+struct FloatRows {
+    size_t stride = 0;
+    std::vector<float> val;
+    std::vector<float> mask;
+
+    const float* val_row(int r) const { return val.data() + r * stride; }
+    const float* mask_row(int r) const { return mask.data() + r * stride; }
+};
+
+/**
+ * @brief Packs binary_matrix (-1 = missing) into methylated/covered bitsets.
+ */
+BitRows pack_binary(const Eigen::MatrixXi& bin);
+
+/**
+ * @brief Packs raw_matrix, or quant_matrix when quantized, into padded float rows;
+ *        cov_bits receives the covered-site bitsets (meth left empty).
+ */
+FloatRows pack_probabilities(const MethylationMatrix& methyl_mat, BitRows& cov_bits);
+
+inline int common_sites(const BitRows& bits, int i, int j) {
+    const uint64_t* a = bits.cov_row(i);
+    const uint64_t* b = bits.cov_row(j);
+    int count = 0;
+    for (size_t w = 0; w < bits.words; w++) {
+        count += __builtin_popcountll(a[w] & b[w]);
+    }
+    return count;
+}
+
+inline int tile_rows(size_t bytes_per_row) {
+    size_t rows = kTileBytes / std::max<size_t>(bytes_per_row, 1);
+    return static_cast<int>(std::clamp<size_t>(rows, 4, 256));
+}
+
+/**
+ * @brief Calls fn(i, j) for every i < j, tiled so that both row blocks stay
+ * cache-resident, with tile pairs of the upper triangle spread over threads.
+ */
+template <typename PairFn>
+void for_each_pair_tiled(int n, int tile, PairFn&& fn) {
+    const int num_tiles = (n + tile - 1) / tile;
+    std::vector<std::pair<int, int>> tile_pairs;
+    tile_pairs.reserve(static_cast<size_t>(num_tiles) * (num_tiles + 1) / 2);
+    for (int ti = 0; ti < num_tiles; ti++) {
+        for (int tj = ti; tj < num_tiles; tj++) {
+            tile_pairs.emplace_back(ti, tj);
+        }
+    }
+
+    const bool parallel = static_cast<int64_t>(n) * n > kParallelPairs;
+    const int num_pairs = tile_pairs.size();
+
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int t = 0; t < num_pairs; t++) {
+        const int i_begin = tile_pairs[t].first * tile;
+        const int i_end = std::min(i_begin + tile, n);
+        const int j_begin = tile_pairs[t].second * tile;
+        const int j_end = std::min(j_begin + tile, n);
+
+        for (int i = i_begin; i < i_end; i++) {
+            for (int j = std::max(j_begin, i + 1); j < j_end; j++) {
+                fn(i, j);
+            }
+        }
+    }
+}
+
+// --- Metric policies ---
+
+/// Fraction of discordant binary calls
+struct Nhd {
+    static constexpr bool kBinary = true;
+    static constexpr double kMaxDistance = 1.0;
+    static double from_counts(int common, int diff, int /*inter*/) {
+        return static_cast<double>(diff) / common;
+    }
+};
+
+/// 1 - |meth_a ∩ meth_b| / |meth_a ∪ meth_b| over common sites
+struct Jaccard {
+    static constexpr bool kBinary = true;
+    static constexpr double kMaxDistance = 1.0;
+    static double from_counts(int /*common*/, int diff, int inter) {
+        // |A ∪ B| = |A ∩ B| + |A xor B|
+        const int uni = inter + diff;
+        return uni == 0 ? 0.0 : 1.0 - static_cast<double>(inter) / uni;
+    }
+};
+
+/// Mean absolute difference
+struct L1 {
+    static constexpr bool kBinary = false;
+    static constexpr double kMaxDistance = 1.0;
+    static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int common) {
+        float sum = 0.0f;
+        #pragma omp simd reduction(+:sum)
+        for (int k = 0; k < m; k++) {
+            sum += wa[k] * wb[k] * std::fabs(a[k] - b[k]);
+        }
+        return static_cast<double>(sum) / common;
+    }
+};
+
+/// Root mean squared difference
+struct L2 {
+    static constexpr bool kBinary = false;
+    static constexpr double kMaxDistance = 1.0;
+    static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int common) {
+        float sum = 0.0f;
+        #pragma omp simd reduction(+:sum)
+        for (int k = 0; k < m; k++) {
+            const float d = a[k] - b[k];
+            sum += wa[k] * wb[k] * d * d;
+        }
+        return std::sqrt(static_cast<double>(sum) / common);
+    }
+};
+
+/// 1 - Pearson correlation; undefined (NaN) for a constant read
+struct Corr {
+    static constexpr bool kBinary = false;
+    static constexpr double kMaxDistance = 2.0;
+    static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int common) {
+        double sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+        #pragma omp simd reduction(+:sa, sb, saa, sbb, sab)
+        for (int k = 0; k < m; k++) {
+            const double w = wa[k] * wb[k];
+            const double x = w * a[k];
+            const double y = w * b[k];
+            sa += x;
+            sb += y;
+            saa += x * a[k];
+            sbb += y * b[k];
+            sab += x * b[k];
+        }
+        const double cov = sab - sa * sb / common;
+        const double var_a = saa - sa * sa / common;
+        const double var_b = sbb - sb * sb / common;
+        if (var_a <= 1e-12 || var_b <= 1e-12) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const double r = cov / std::sqrt(var_a * var_b);
+        return 1.0 - std::clamp(r, -1.0, 1.0);
+    }
+};
+
+// --- NaN policies: value of pairs with too little overlap or an undefined metric ---
+
+/// NanDistanceStrategy::MAX_DIST
+struct MaxDist {
+    template <typename Metric>
+    static constexpr double fallback() { return Metric::kMaxDistance; }
+};
+
+/// NanDistanceStrategy::SKIP
+struct Skip {
+    template <typename Metric>
+    static constexpr double fallback() { return std::numeric_limits<double>::quiet_NaN(); }
+};
+
+} // namespace DistanceKernels
+
+template <typename Metric, typename NanPolicy>
+void DistanceMatrix::compute(const MethylationMatrix& methyl_mat, int min_cov) {
+    namespace K = DistanceKernels;
+    region_id = methyl_mat.region_id;
+    read_ids = methyl_mat.read_ids;
+    min_common_coverage = min_cov;
+
+    const int n = Metric::kBinary              ? methyl_mat.binary_matrix.rows()
+                  : methyl_mat.is_quantized() ? methyl_mat.quant_matrix.rows()
+                                              : methyl_mat.raw_matrix.rows();
+    dist_matrix.setZero(n, n);
+    if (n < 2) {
+        return;
+    }
+
+    constexpr double fallback = NanPolicy::template fallback<Metric>();
+    const int required = std::max(min_cov, 1);
+    auto store = [&](int i, int j, double d) {
+        if (std::isnan(d)) d = fallback;
+        dist_matrix(i, j) = d;
+        dist_matrix(j, i) = d;
+    };
+
+    if constexpr (Metric::kBinary) {
+        // popcount over packed methylated/covered bitsets
+        const K::BitRows bits = K::pack_binary(methyl_mat.binary_matrix);
+        const size_t words = bits.words;
+        K::for_each_pair_tiled(n, K::tile_rows(words * 2 * sizeof(uint64_t)), [&](int i, int j) {
+            const uint64_t* ma = bits.meth_row(i);
+            const uint64_t* mb = bits.meth_row(j);
+            const uint64_t* ca = bits.cov_row(i);
+            const uint64_t* cb = bits.cov_row(j);
+
+            int common = 0;
+            int diff = 0;
+            int inter = 0;
+            for (size_t w = 0; w < words; w++) {
+                const uint64_t both = ca[w] & cb[w];
+                common += __builtin_popcountll(both);
+                diff += __builtin_popcountll((ma[w] ^ mb[w]) & both);
+                inter += __builtin_popcountll(ma[w] & mb[w] & both);
+            }
+            store(i, j, common < required ? fallback : Metric::from_counts(common, diff, inter));
+        });
+    } else {
+        // Masked float rows, SIMD reductions over sites
+        K::BitRows cov_bits;
+        const K::FloatRows rows = K::pack_probabilities(methyl_mat, cov_bits);
+        const int m = rows.stride;
+        K::for_each_pair_tiled(n, K::tile_rows(rows.stride * 2 * sizeof(float)), [&](int i, int j) {
+            const int common = K::common_sites(cov_bits, i, j);
+            if (common < required) {
+                store(i, j, fallback);
+                return;
+            }
+            store(i, j, Metric::from_rows(rows.val_row(i), rows.val_row(j), rows.mask_row(i), rows.mask_row(j),
+                                          m, common));
+        });
+    }
+}
+
+} // namespace InterSubMod
@@ -21,12 +21,46 @@ public:
     /**
      * @brief Computes pairwise distances from a MethylationMatrix.
      * 
+     * Metrics are evaluated over the CpG sites covered by both reads:
+     * - NHD: fraction of discordant binary calls (binary_matrix, -1 = missing).
+     * - JACCARD: 1 - |meth_a ∩ meth_b| / |meth_a ∪ meth_b| on binary_matrix
+     *   (0 when neither read is methylated at any common site).
+     * - L1: mean absolute difference of raw_matrix (NaN = missing).
+     * - L2: root mean squared difference of raw_matrix.
+     * - CORR: 1 - Pearson correlation of raw_matrix values.
+     * 
+     * Pairs with fewer than min_cov common sites (or, for CORR, a constant
+     * read) get the metric's maximum (1.0; 2.0 for CORR) under MAX_DIST, or
+     * NaN under SKIP. The diagonal is 0.
+     * 
+     * Binary metrics use per-read methylated/covered bitsets, so each pair is
+     * popcount((a_meth ^ b_meth) & a_cov & b_cov) over 64-site words. Raw
+     * metrics use masked, padded float rows with SIMD reductions. The upper
+     * triangle is processed in cache-sized row tiles, spread over OpenMP
+     * threads for larger regions.
+     * 
+     * A quantized matrix (raw_matrix empty, quant_matrix filled) is decoded
+     * into the float rows during that packing step.
+     * 
+     * The enums are resolved once here into a compute<Metric, NanPolicy>()
+     * instantiation, so the per-pair code does not branch on them.
+     * 
      * @param methyl_mat The input methylation data.
      * @param type Distance metric (e.g., NHD).
      * @param min_cov Minimum common CpG sites required to calculate a valid distance.
      * @param nan_strategy Strategy to handle pairs with insufficient overlap (e.g., MAX_DIST).
      */
     void compute_from_methylation(const class MethylationMatrix& methyl_mat, DistanceMetricType type, int min_cov, NanDistanceStrategy nan_strategy);
+
+    /**
+     * @brief Same as compute_from_methylation() with the metric and NaN strategy
+     * fixed at compile time (policies in core/DistanceKernels.hpp, which also
+     * defines this template; include it to use custom metric policies).
+     * 
+     * metric_type is left unchanged.
+     */
+    template <typename Metric, typename NanPolicy>
+    void compute(const class MethylationMatrix& methyl_mat, int min_cov);
 };
 
 } // namespace InterSubMod
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include "core/Config.hpp"
+#include "io/ShardMerger.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief 多節點執行（inter_sub_mod_mpi，只在找到 MPI 時建置）
+ *
+ * 基因組依 tumor BAM 的 read depth 切成 Config::work_units 個連續、工作量相近的分片
+ * （ShardPlanner，即 --shard k/N），由 rank 0 動態分配給 worker ranks：
+ * - 一開始每個 worker 分到一段連續的分片，依序處理，相鄰分片的 BGZF blocks 與
+ *   reference 較可能仍在同一節點的 page cache 中
+ * - 自己那段做完的 worker 從剩餘最多的一段尾端取走分片，最後少數分片不會讓其他節點閒置
+ * 每個分片在 worker 上是一次一般的 AnalysisPipeline 執行（OpenMP workers、cost / locality
+ * 排程、prefetch 等設定照舊），輸出以 "part_kkk_of_NNN" 命名的 shards、clusters 與 journal，
+ * 因此所有 ranks 可寫入同一個共享輸出目錄；--resume 以相同的 work_units 重跑即可接續。
+ * 所有分片完成後 rank 0 以 ShardMerger 寫出 merged.index.tsv / merged.clusters.tsv /
+ * merged.summary.json。
+ *
+ * 只有一個 rank 時由 rank 0 自己依序處理所有分片。
+ */
+class DistributedRunner {
+public:
+    /**
+     * @param config 每個分片共用的設定（snv_regions / shard 須為空）
+     * @param rank MPI_COMM_WORLD 中的 rank
+     * @param size MPI_COMM_WORLD 的 ranks 數
+     */
+    DistributedRunner(const Config& config, int rank, int size);
+
+    /**
+     * @brief 執行（所有 ranks 都要呼叫；須在 MPI_Init 之後）
+     *
+     * @return rank 0：所有分片中最差的狀態（0 = 全部成功；2 = 部分 regions 失敗；
+     *         1 = 有分片無法執行或合併失敗）；其他 ranks：自己處理的分片中最差的狀態
+     */
+    int run();
+
+    /**
+     * @brief 分片數（Config::work_units，0 時為每個 worker rank 4 個）
+     */
+    int num_units() const { return num_units_; }
+
+    /**
+     * @brief 最近一次 run() 的合併統計（僅 rank 0）
+     */
+    const MergeStats& merge_stats() const { return merge_stats_; }
+
+private:
+    Config config_;
+    int rank_;
+    int size_;
+    int num_units_;
+    MergeStats merge_stats_;
+
+    /**
+     * @brief 以一般的 AnalysisPipeline 處理第 unit 個分片（1-based）
+     * @return AnalysisPipeline::run() 的狀態；無法執行時為 1
+     */
+    int process_unit(int unit);
+
+    /**
+     * @brief Rank 0：分配分片直到所有 workers 收到停止訊息
+     */
+    int coordinate();
+
+    /**
+     * @brief Worker rank：要求並處理分片直到收到停止訊息
+     */
+    int work();
+
+    /**
+     * @brief Rank 0：合併所有分片的輸出
+     */
+    int merge();
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <htslib/hts.h>
+#include <htslib/thread_pool.h>
+
+namespace InterSubMod {
+
+/**
+ * @brief Process-wide HTSlib thread pool for BGZF decompression.
+ *
+ * hts_set_threads() gives every file its own private pool, so N per-thread
+ * readers with k threads each would start N * k threads. Instead one pool
+ * is created here and attached to every BamReader with
+ * BamReader::set_thread_pool(); its threads decompress blocks for whichever
+ * reader is currently reading. A worker stuck on one very deep region
+ * (e.g. an amplified locus) then has its BGZF blocks inflated by otherwise
+ * idle pool threads instead of inline.
+ *
+ * The pool is sized independently of the OpenMP compute threads.
+ *
+ * Lifetime: must outlive every reader it is attached to (ThreadResourcePool
+ * holds it by shared_ptr and destroys its readers first).
+ */
+class HtsThreadPool {
+public:
+    /**
+     * @param num_threads Decompression threads (> 0).
+     * @param queue_size Jobs queued per attached file (0 = HTSlib's default, 2 * num_threads).
+     * @throws std::runtime_error if num_threads <= 0 or HTSlib cannot start the pool.
+     */
+    explicit HtsThreadPool(int num_threads, int queue_size = 0);
+
+    ~HtsThreadPool();
+
+    HtsThreadPool(const HtsThreadPool&) = delete;
+    HtsThreadPool& operator=(const HtsThreadPool&) = delete;
+
+    /**
+     * @brief The handle passed to hts_set_thread_pool().
+     */
+    htsThreadPool* get() { return &pool_; }
+
+    /**
+     * @brief Number of threads in the pool.
+     */
+    int size() const { return num_threads_; }
+
+private:
+    htsThreadPool pool_;
+    int num_threads_;
+};
+
+} // namespace InterSubMod
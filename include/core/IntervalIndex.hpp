@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace InterSubMod {
+
+/**
+ * @brief Sorted, non-overlapping intervals of one chromosome.
+ *
+ * Coordinates are 0-based, half-open [start, end), as in BED. Overlapping
+ * and touching input intervals are merged, so a point query is a single
+ * binary search over the starts.
+ */
+class ChromIntervals {
+public:
+    /**
+     * @brief Returns true if 0-based position pos lies in an interval.
+     */
+    bool contains(int64_t pos) const;
+
+    /**
+     * @brief Returns true if [start, end) overlaps any interval.
+     */
+    bool overlaps(int64_t start, int64_t end) const;
+
+    /**
+     * @brief Index of the first interval whose end is > pos (size() if none).
+     *
+     * Lets callers walking sorted positions keep a cursor and advance it
+     * instead of searching for every position.
+     */
+    size_t first_ending_after(int64_t pos) const;
+
+    size_t size() const { return starts_.size(); }
+    int64_t start(size_t i) const { return starts_[i]; }
+    int64_t end(size_t i) const { return ends_[i]; }
+
+    /**
+     * @brief Total bases covered.
+     */
+    int64_t covered_bp() const;
+
+private:
+    friend class IntervalIndex;
+    std::vector<int64_t> starts_;
+    std::vector<int64_t> ends_;
+};
+
+/**
+ * @brief Per-chromosome interval index loaded from a BED file.
+ *
+ * Used for PMD and other region annotations. Built once, then read-only:
+ * all const methods are safe to call from many threads concurrently.
+ *
+ * Usage:
+ *   IntervalIndex pmd = IntervalIndex::load_bed("pmd.bed");
+ *   if (pmd.contains("chr17", 7577120)) { ... }
+ */
+class IntervalIndex {
+public:
+    IntervalIndex() = default;
+
+    /**
+     * @brief Loads a BED file (only the first three columns are used).
+     *
+     * Blank lines and lines starting with '#', "track" or "browser" are
+     * skipped. Intervals with end <= start are ignored.
+     *
+     * @throws std::runtime_error if the file cannot be opened or a data
+     *         line cannot be parsed.
+     */
+    static IntervalIndex load_bed(const std::string& bed_path);
+
+    /**
+     * @brief Adds one interval; call finalize() after the last add.
+     */
+    void add(const std::string& chr, int64_t start, int64_t end);
+
+    /**
+     * @brief Sorts and merges the intervals of every chromosome.
+     */
+    void finalize();
+
+    /**
+     * @brief Intervals of a chromosome, or nullptr if it has none.
+     */
+    const ChromIntervals* chrom(const std::string& chr) const;
+
+    bool contains(const std::string& chr, int64_t pos) const {
+        const ChromIntervals* c = chrom(chr);
+        return c && c->contains(pos);
+    }
+
+    bool empty() const { return chroms_.empty(); }
+
+    /**
+     * @brief Total number of (merged) intervals.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Total bases covered over all chromosomes.
+     */
+    int64_t covered_bp() const;
+
+private:
+    std::unordered_map<std::string, ChromIntervals> chroms_;
+};
+
+} // namespace InterSubMod
@@ -1,95 +1,268 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include <cstdint>
+#include <cstddef>
+#include <memory_resource>
 #include "core/DataStructs.hpp"
 #include "core/MethylationParser.hpp"
+#include "core/MethylQuant.hpp"
+#include "core/ReadTable.hpp"
 
 namespace InterSubMod {
 
+/**
+ * @brief 矩陣數值的儲存型別
+ *
+ * FLOAT32：機率以 float 儲存，-1.0 = no coverage。
+ * UINT8：機率以 Quant::encode 量化（ML tag 本身即為 8-bit），255 = no coverage；
+ * 記憶體為 float 的 1/4，需要浮點數值時才經由 Quant::decode 查表還原。
+ */
+enum class MatrixStorage : uint8_t {
+    FLOAT32 = 0,
+    UINT8 = 1
+};
+
+/**
+ * @brief 稀疏 Read × CpG 矩陣（CSR 格式）
+ *
+ * 第 r 列（read）的資料位於 [row_ptr[r], row_ptr[r+1])，
+ * col_idx 為 CpG column index（每列內遞增），values 為甲基化機率。
+ * UINT8 模式下 values 為空，改用 quant_values。
+ */
+struct CsrMatrix {
+    int num_rows = 0;
+    int num_cols = 0;
+    std::vector<int32_t> row_ptr;       ///< 長度 num_rows + 1
+    std::vector<int32_t> col_idx;       ///< 長度 nnz
+    std::vector<float> values;          ///< 長度 nnz（FLOAT32）
+    std::vector<uint8_t> quant_values;  ///< 長度 nnz（UINT8）
+
+    size_t nnz() const { return col_idx.size(); }
+};
+
+/**
+ * @brief 連續 row-major 矩陣的唯讀 view
+ *
+ * 提供與原本 `std::vector<std::vector<double>>` 相同的存取方式：
+ * `m.size()`、`m[r].size()`、`m[r][c]`（-1.0 = no coverage），
+ * 以及 range-for 逐列走訪。不擁有資料，生命週期跟隨 MatrixBuilder。
+ *
+ * 底層可為 float 或 uint8（quantized()）；`m[r][c]` / `at()` 一律回傳機率，
+ * uint8 時經由查表還原。data() 只在 float 時有效，quant_data() 只在 uint8 時有效。
+ */
+class MatrixView {
+public:
+    /**
+     * @brief 單一 row 的 view
+     */
+    class RowView {
+    public:
+        RowView(const float* data, size_t cols) : data_(data), quant_(nullptr), cols_(cols) {}
+        RowView(const uint8_t* quant, size_t cols) : data_(nullptr), quant_(quant), cols_(cols) {}
+        size_t size() const { return cols_; }
+        bool empty() const { return cols_ == 0; }
+        double operator[](size_t c) const { return quant_ ? Quant::decode(quant_[c]) : data_[c]; }
+        const float* data() const { return data_; }
+        const uint8_t* quant_data() const { return quant_; }
+    private:
+        const float* data_;
+        const uint8_t* quant_;
+        size_t cols_;
+    };
+
+    /**
+     * @brief 逐列走訪用的 iterator
+     */
+    class RowIterator {
+    public:
+        RowIterator(const MatrixView* view, size_t row) : view_(view), row_(row) {}
+        RowView operator*() const { return (*view_)[row_]; }
+        RowIterator& operator++() { ++row_; return *this; }
+        bool operator!=(const RowIterator& other) const { return row_ != other.row_; }
+    private:
+        const MatrixView* view_;
+        size_t row_;
+    };
+
+    MatrixView() : data_(nullptr), quant_(nullptr), rows_(0), cols_(0) {}
+    MatrixView(const float* data, size_t rows, size_t cols) : data_(data), quant_(nullptr), rows_(rows), cols_(cols) {}
+    MatrixView(const uint8_t* quant, size_t rows, size_t cols) : data_(nullptr), quant_(quant), rows_(rows), cols_(cols) {}
+
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    bool quantized() const { return quant_ != nullptr; }
+    const float* data() const { return data_; }
+    const uint8_t* quant_data() const { return quant_; }
+
+    /// 底層 buffer 與其大小（bytes），供 checksum / 原樣寫出
+    const void* bytes() const { return quant_ ? static_cast<const void*>(quant_) : static_cast<const void*>(data_); }
+    size_t byte_size() const { return rows_ * cols_ * (quant_ ? sizeof(uint8_t) : sizeof(float)); }
+
+    RowView operator[](size_t r) const {
+        return quant_ ? RowView(quant_ + r * cols_, cols_) : RowView(data_ + r * cols_, cols_);
+    }
+    double at(size_t r, size_t c) const {
+        return quant_ ? Quant::decode(quant_[r * cols_ + c]) : data_[r * cols_ + c];
+    }
+
+    RowIterator begin() const { return RowIterator(this, 0); }
+    RowIterator end() const { return RowIterator(this, rows_); }
+
+private:
+    const float* data_;
+    const uint8_t* quant_;
+    size_t rows_;
+    size_t cols_;
+};
+
 /**
  * @brief 建構並管理 Read × CpG 甲基化矩陣
- * 
+ *
  * 此類別負責：
  * 1. 收集所有 reads 的甲基化資訊
  * 2. 建立唯一的 CpG 位點列表（排序後）
- * 3. 建構稀疏矩陣（使用 NaN 表示無數據）
+ * 3. 建構稀疏矩陣（CSR）與稠密矩陣（使用 -1 表示無數據）
  * 4. 提供矩陣存取與查詢介面
- * 
+ *
  * 矩陣維度：
  * - Rows: reads (按讀取順序)
  * - Cols: unique CpG sites (按基因組座標排序)
- * 
+ *
  * 數值含義：
  * - [0.0, 1.0]: 甲基化機率
  * - -1.0: 此 read 未覆蓋此 CpG 位點（使用 -1 代表 NaN）
- * 
- * Note: 使用 vector<vector<double>> 而非 Eigen 以避免依賴
+ * （UINT8 儲存時為 0-254 與 255，見 MatrixStorage）
+ *
+ * 實作：所有 calls 以 (row, pos, prob) 依序 append 到單一 vector，
+ * finalize() 時位置只排序/去重一次，所有輸出都是連續陣列，
+ * 不使用 node-based container（避免每個 call 一次 cache miss、每列一次配置）。
  */
 class MatrixBuilder {
 public:
+    /// 稠密矩陣中「未覆蓋」的 sentinel
+    static constexpr float kNoCoverage = -1.0f;
+
     MatrixBuilder() = default;
-    
+
+    /**
+     * @brief 暫存資料（add_read() 收集的 calls、finalize() 的排序 buffer）改由 scratch 配置
+     *
+     * 通常傳入 thread 的 Utils::Arena（每個 region 前 reset）；finalize() 結束時
+     * 暫存即全部釋放，因此 finalize 後的 builder 可以 move 給其他 thread。
+     * 輸出資料（reads、CpG 座標、CSR、稠密矩陣）仍使用一般配置。
+     */
+    explicit MatrixBuilder(std::pmr::memory_resource* scratch) : entries_(scratch) {}
+
+    /**
+     * @brief 設定矩陣儲存型別（預設 FLOAT32），於下一次 finalize() 生效
+     *
+     * UINT8 時 CSR 與稠密矩陣皆以 uint8 儲存（255 = no coverage），get_dense() 為空，
+     * 改用 get_quantized()；get_matrix() 的 view 仍以機率存取。clear() 不會重設此設定。
+     */
+    void set_storage(MatrixStorage storage) { storage_ = storage; }
+    MatrixStorage storage() const { return storage_; }
+
     /**
      * @brief 添加一個 read 的甲基化資訊
-     * 
+     *
      * @param read_info Read 的基本資訊（用於記錄 read metadata）
-     * @param methyl_calls 該 read 的所有甲基化 calls
+     * @param methyl_calls 該 read 的所有甲基化 calls（同一位置重複時以最後一筆為準）
      * @return read_id (矩陣中的 row index)
      */
     int add_read(const ReadInfo& read_info, const std::vector<MethylCall>& methyl_calls);
-    
+
+    /**
+     * @brief 同上，但 read metadata 以 ReadRecord + 名稱傳入（名稱直接存入 ReadTable 的 pool，不建立 std::string）
+     */
+    int add_read(const ReadRecord& record, std::string_view read_name, const std::vector<MethylCall>& methyl_calls);
+
     /**
      * @brief 完成資料收集，建構最終矩陣
-     * 
+     *
      * 此方法會：
-     * 1. 排序所有唯一的 CpG 位點
-     * 2. 分配矩陣空間（rows × cols）
-     * 3. 填充甲基化數值
-     * 4. 設定未覆蓋的位置為 NaN
+     * 1. 排序並去重所有 CpG 位點
+     * 2. 建立 CSR 稀疏矩陣
+     * 3. 分配連續的 row-major 稠密矩陣並填入數值
+     * 4. 未覆蓋的位置設為 -1
      */
     void finalize();
-    
+
+    /**
+     * @brief 取得最終的甲基化矩陣（只讀 view）
+     * @return 矩陣 view (rows=reads, cols=CpGs)，-1.0 = no coverage
+     */
+    MatrixView get_matrix() const {
+        if (storage_ == MatrixStorage::UINT8) {
+            return MatrixView(dense_quant_.data(), reads_.size(), cpg_positions_.size());
+        }
+        return MatrixView(dense_.data(), reads_.size(), cpg_positions_.size());
+    }
+
+    /**
+     * @brief 取得連續 row-major 稠密矩陣（rows × cols，-1 = no coverage；FLOAT32 模式）
+     */
+    const std::vector<float>& get_dense() const { return dense_; }
+
+    /**
+     * @brief 取得量化的 row-major 稠密矩陣（rows × cols，255 = no coverage；UINT8 模式）
+     */
+    const std::vector<uint8_t>& get_quantized() const { return dense_quant_; }
+
     /**
-     * @brief 取得最終的甲基化矩陣（只讀）
-     * @return 矩陣 reference (rows=reads, cols=CpGs)
+     * @brief 取得 CSR 稀疏矩陣
      */
-    const std::vector<std::vector<double>>& get_matrix() const { return matrix_; }
-    
+    const CsrMatrix& get_csr() const { return csr_; }
+
     /**
-     * @brief 取得所有 Read 資訊（按 row order）
+     * @brief 取得所有 Read 資訊（按 row order，struct-of-arrays，名稱在共用 pool 中）
      */
-    const std::vector<ReadInfo>& get_reads() const { return reads_; }
-    
+    const ReadTable& get_reads() const { return reads_; }
+
     /**
      * @brief 取得所有 CpG 位點座標（按 column order，已排序）
      */
     const std::vector<int32_t>& get_cpg_positions() const { return cpg_positions_; }
-    
+
     /**
      * @brief 取得矩陣維度資訊
      */
     int num_reads() const { return reads_.size(); }
     int num_cpgs() const { return cpg_positions_.size(); }
-    
+
     /**
-     * @brief 清空所有資料（用於處理下一個 region）
+     * @brief 輸出資料（reads 與 read names、CpG 座標、CSR、稠密矩陣）目前佔用的 bytes
+     */
+    size_t memory_bytes() const;
+
+    /**
+     * @brief 清空所有資料（用於處理下一個 region，保留已配置的容量）
      */
     void clear();
-    
+
 private:
-    std::vector<ReadInfo> reads_;  ///< Read metadata (row indices)
-    
-    // 暫存：read_id -> (cpg_pos -> probability)
-    std::map<int, std::map<int32_t, float>> read_methyl_map_;
-    
+    /// 暫存的單一 call
+    struct Entry {
+        int32_t row;
+        int32_t pos;
+        float prob;
+    };
+
+    ReadTable reads_;  ///< Read metadata (row indices)
+
+    // 暫存：依加入順序排列的 (row, pos, prob)；配置自建構時的 scratch resource
+    std::pmr::vector<Entry> entries_;
+
     // 最終資料
-    std::vector<int32_t> cpg_positions_;        ///< Sorted unique CpG positions (column indices)
-    std::vector<std::vector<double>> matrix_;  ///< Final matrix (rows × cols), -1.0 = no coverage
-    
+    std::vector<int32_t> cpg_positions_;  ///< Sorted unique CpG positions (column indices)
+    CsrMatrix csr_;                       ///< Sparse form
+    std::vector<float> dense_;            ///< Row-major rows × cols, -1.0 = no coverage (FLOAT32)
+    std::vector<uint8_t> dense_quant_;    ///< Row-major rows × cols, 255 = no coverage (UINT8)
+
+    MatrixStorage storage_ = MatrixStorage::FLOAT32;
     bool finalized_ = false;
 };
 
 } // namespace InterSubMod
-
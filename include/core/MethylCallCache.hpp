@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <htslib/sam.h>
+#include "core/MethylationParser.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Hit/miss counters of a MethylCallCache.
+ */
+struct MethylCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;      ///< Reads parsed (not cached, or cached over a span not covering the window)
+    uint64_t evictions = 0;
+
+    MethylCacheStats& operator+=(const MethylCacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        return *this;
+    }
+
+    double hit_rate() const {
+        uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / total : 0.0;
+    }
+};
+
+/**
+ * @brief Byte-bounded LRU cache of per-read methylation calls.
+ *
+ * With ±1-2 kb windows and 30-100 kb ONT reads, one read overlaps many
+ * neighbouring SNV windows, and without a cache its MM/ML tags are parsed
+ * again for each of them. Here a read is parsed once over the widest
+ * reference span available (the whole chromosome with a ReferenceCache,
+ * otherwise the super-region's union window) and its sorted call list is
+ * kept. Each window then takes its calls with a binary search (slice()).
+ *
+ * An entry is keyed by (source BAM, tid, pos, read name) and remembers the
+ * span it was parsed over. A request for a window outside that span is a
+ * miss and re-parses the read. Calls only depend on the read, the
+ * reference and the chromosome's excluded intervals, so entries stay
+ * valid across regions.
+ *
+ * Not thread-safe: one cache per worker thread (contiguous batches of
+ * super-regions go to the same thread, so that is where the reuse is).
+ */
+class MethylCallCache {
+public:
+    /**
+     * @param max_bytes Memory budget for cached calls and names (0 = disabled).
+     */
+    explicit MethylCallCache(size_t max_bytes = 0) : max_bytes_(max_bytes) {}
+
+    MethylCallCache(const MethylCallCache&) = delete;
+    MethylCallCache& operator=(const MethylCallCache&) = delete;
+    MethylCallCache(MethylCallCache&&) = default;
+    MethylCallCache& operator=(MethylCallCache&&) = default;
+
+    /**
+     * @brief Changes the budget (0 = disabled); drops entries as needed.
+     */
+    void set_capacity(size_t max_bytes);
+
+    bool enabled() const { return max_bytes_ > 0; }
+
+    /**
+     * @brief The calls of @p b, parsed over a span covering [lo, hi).
+     *
+     * On a miss, `parse(calls)` must fill calls (sorted by ref_pos) for the
+     * whole span [span_lo, span_hi), which must contain [lo, hi).
+     * Positions use the 0-based convention of MethylationParser's
+     * ref_start_pos, and a call at ref_pos covers position ref_pos - 1.
+     *
+     * @return Reference valid until the next calls_for() or set_capacity().
+     */
+    template <typename Parse>
+    const std::vector<MethylCall>& calls_for(const bam1_t* b, bool is_tumor, int32_t lo, int32_t hi,
+                                             int32_t span_lo, int32_t span_hi, Parse&& parse) {
+        Entry* e = find(b, is_tumor);
+        if (e && e->span_lo <= lo && hi <= e->span_hi) {
+            stats_.hits++;
+            return e->calls;
+        }
+        stats_.misses++;
+        e = prepare(e, b, is_tumor, span_lo, span_hi);
+        parse(e->calls);
+        account(*e);
+        return e->calls;
+    }
+
+    /**
+     * @brief Copies the calls covering positions [lo, hi) into out (cleared first).
+     */
+    static void slice(const std::vector<MethylCall>& calls, int32_t lo, int32_t hi, std::vector<MethylCall>& out);
+
+    size_t size() const { return map_.size(); }
+    size_t bytes() const { return bytes_; }
+    const MethylCacheStats& stats() const { return stats_; }
+
+private:
+    struct Key {
+        uint64_t name_hash;
+        int32_t tid;
+        int32_t pos;
+        bool is_tumor;
+
+        bool operator==(const Key& o) const {
+            return name_hash == o.name_hash && tid == o.tid && pos == o.pos && is_tumor == o.is_tumor;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return k.name_hash ^ (static_cast<uint64_t>(static_cast<uint32_t>(k.pos)) * 0x9E3779B97F4A7C15ull) ^
+                   (static_cast<uint64_t>(static_cast<uint32_t>(k.tid)) << 1) ^ k.is_tumor;
+        }
+    };
+    struct Entry {
+        Key key;
+        std::string name;         ///< Guards against name-hash collisions
+        int32_t span_lo = 0;
+        int32_t span_hi = 0;
+        std::vector<MethylCall> calls;
+        size_t bytes = 0;         ///< Charged against bytes_
+    };
+
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    std::list<Entry> lru_;        ///< Front = most recently used
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> map_;
+    MethylCacheStats stats_;
+
+    static Key make_key(const bam1_t* b, bool is_tumor);
+
+    /// Finds b's entry and marks it most recently used (nullptr if absent)
+    Entry* find(const bam1_t* b, bool is_tumor);
+
+    /// Entry to parse b into: @p existing (stale span) or a new / recycled one
+    Entry* prepare(Entry* existing, const bam1_t* b, bool is_tumor, int32_t span_lo, int32_t span_hi);
+
+    /// Charges an entry's memory and evicts least recently used entries over budget
+    void account(Entry& e);
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+
+namespace InterSubMod {
+namespace Quant {
+
+/**
+ * @brief 8-bit methylation probabilities (the resolution of the ML tag).
+ *
+ * A probability p is stored as round(p * 255) clamped to 254; 255 is the
+ * "no coverage" sentinel. ML values therefore round-trip exactly except
+ * ML = 255, which is stored as 254. Decoding goes through a 256-entry
+ * table, so consumers that need a float pay one load per cell.
+ */
+
+/// Quantized value meaning "this read does not cover this CpG"
+constexpr uint8_t kNoCoverage = 255;
+
+/// Probability -> uint8 (negative / no coverage -> 255)
+inline uint8_t encode(float p) {
+    if (p < 0.0f) {
+        return kNoCoverage;
+    }
+    int q = static_cast<int>(p * 255.0f + 0.5f);
+    return static_cast<uint8_t>(q > 254 ? 254 : q);
+}
+
+/// Decoding table: q / 255 for q < 255, -1.0 for the sentinel
+struct ProbabilityTable {
+    float value[256];
+
+    constexpr ProbabilityTable() : value() {
+        for (int q = 0; q < 255; q++) {
+            value[q] = q / 255.0f;
+        }
+        value[kNoCoverage] = -1.0f;
+    }
+
+    constexpr float operator[](uint8_t q) const { return value[q]; }
+};
+
+inline constexpr ProbabilityTable kProbability{};
+
+/// uint8 -> probability (255 -> -1.0)
+inline float decode(uint8_t q) {
+    return kProbability[q];
+}
+
+/**
+ * @brief Binary-call thresholds translated to the uint8 scale.
+ *
+ * call(q) equals what comparing decode(q) against the double thresholds
+ * gives (>= high -> 1, <= low -> 0, otherwise or missing -> -1), but uses
+ * two integer compares per cell.
+ */
+struct BinaryThresholds {
+    int min_methylated = 255;    ///< Smallest q with decode(q) >= high (255 = none)
+    int max_unmethylated = -1;   ///< Largest q with decode(q) <= low (-1 = none)
+
+    BinaryThresholds() = default;
+    BinaryThresholds(double high, double low) {
+        for (int q = 254; q >= 0 && kProbability.value[q] >= high; q--) {
+            min_methylated = q;
+        }
+        for (int q = 0; q <= 254 && kProbability.value[q] <= low; q++) {
+            max_unmethylated = q;
+        }
+    }
+
+    int call(uint8_t q) const {
+        if (q == kNoCoverage) return -1;
+        if (q >= min_methylated) return 1;
+        if (q <= max_unmethylated) return 0;
+        return -1;
+    }
+};
+
+} // namespace Quant
+} // namespace InterSubMod
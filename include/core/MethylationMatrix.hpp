@@ -3,6 +3,8 @@
 #include <vector>
 #include <Eigen/Dense>
 #include "DataStructs.hpp"
+#include "MatrixBuilder.hpp"
+#include "Config.hpp"
 
 namespace InterSubMod {
 
@@ -17,20 +19,63 @@ public:
     int region_id;
     std::vector<int> read_ids; ///< Maps row index to global Read ID
     std::vector<int> cpg_ids;  ///< Maps column index to global CpG ID
+    std::vector<int32_t> cpg_positions; ///< Genomic position of each column (filled by build())
     
+    /// uint8 storage: probabilities as Quant::encode values, 255 for missing
+    using QuantMatrix = Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic>;
+
     Eigen::MatrixXd raw_matrix;     ///< Raw methylation probabilities (0.0 - 1.0), NaN for missing
     Eigen::MatrixXi binary_matrix;  ///< Binary methylation status: 1 (meth), 0 (unmeth), -1 (missing)
+    QuantMatrix quant_matrix;       ///< Quantized probabilities; used instead of raw_matrix when that is empty
     
     int num_reads() const { return read_ids.size(); }
     int num_sites() const { return cpg_ids.size(); }
+
+    /// True when probabilities are held only in quant_matrix
+    bool is_quantized() const { return raw_matrix.size() == 0 && quant_matrix.size() > 0; }
+
+    /**
+     * @brief Probability of one cell from whichever storage is filled (NaN for missing).
+     */
+    double probability(int r, int c) const;
+
+    /**
+     * @brief Fills quant_matrix and binary_matrix from a finalized MatrixBuilder view.
+     *
+     * Float views are quantized, uint8 views copied. binary_matrix is derived
+     * on the uint8 scale (Quant::BinaryThresholds): p >= high -> 1,
+     * p <= low -> 0, anything in between or missing -> -1. raw_matrix is
+     * left empty; float metrics decode quant_matrix on the fly.
+     *
+     * @param high Config::binary_methyl_high
+     * @param low Config::binary_methyl_low
+     */
+    void set_quantized(const MatrixView& view, double high, double low);
     
     /**
-     * @brief Builds the matrix from a set of reads and CpG sites.
+     * @brief Builds the matrix from a finalized MatrixBuilder in one fused pass.
+     * 
+     * Per-column coverage is counted from the CSR column indices, columns
+     * with fewer than min_site_coverage reads are dropped, and each CSR
+     * value is then written once into both the probability matrix and
+     * binary_matrix (>= high -> 1, <= low -> 0, else -1). Both are Eigen's
+     * column-major layout, so a site's reads are contiguous for the distance
+     * kernels. No dense intermediate is read.
      * 
-     * Iterates through reads, maps their MM/ML tags to the provided CpG sites,
-     * and fills the raw and binary matrices.
+     * A UINT8 builder fills quant_matrix (raw_matrix stays empty); a FLOAT32
+     * builder fills raw_matrix. All reads are kept, so rows stay aligned with
+     * builder.get_reads().
+     * 
+     * read_ids become the builder's read IDs, cpg_ids the builder column index
+     * of each kept column, and cpg_positions its genomic position. region_id is
+     * left to the caller.
      */
-    void build(const std::vector<ReadInfo>& reads, const std::vector<CpGSite>& sites);
+    void build(const MatrixBuilder& builder, double methyl_high, double methyl_low, int min_site_coverage);
+
+    /// Same as above with thresholds and min_site_coverage taken from the Config
+    void build(const MatrixBuilder& builder, const Config& config) {
+        build(builder, config.binary_methyl_high, config.binary_methyl_low, config.min_site_coverage);
+    }
 };
 
 } // namespace InterSubMod
@@ -2,11 +2,16 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <htslib/sam.h>
+#include "core/AlignmentView.hpp"
 
 namespace InterSubMod {
 
+class CpGBitmap;
+class ChromIntervals;
+
 /**
  * @brief Represents a single methylation call at a genomic position.
  */
@@ -35,7 +40,17 @@ struct MethylCall {
  *   - Each value corresponds to a modification in MM
  *   - Probability = ML[i] / 255.0
  * 
- * Thread-safe: This class is stateless and can be used from multiple threads.
+ * Performance: parse_read() makes a single pass over the MM string
+ * (strtol-style, no std::string copies), locates the read's 'C' bases with
+ * a SIMD scan of the packed 4-bit sequence (Utils::find_bases), and maps
+ * only the modified ones to the reference with a forward-only cursor over
+ * the read's AlignmentView blocks, without materialising a per-base
+ * seq->ref map. Output goes into a
+ * caller-supplied buffer; together with the parser's internal delta
+ * buffer this makes steady-state parsing allocation-free.
+ * 
+ * Thread-safety: instances hold reusable scratch buffers, so each thread
+ * should own its own MethylationParser.
  */
 class MethylationParser {
 public:
@@ -51,40 +66,96 @@ public:
      *       1. Are in CpG context (verified against ref_seq)
      *       2. Map to valid reference positions (not in insertions)
      *       3. Have matching MM/ML array lengths
+     *       4. Are outside the excluded intervals, if set
      */
     std::vector<MethylCall> parse_read(
         const bam1_t* b,
-        const std::string& ref_seq,
+        std::string_view ref_seq,
         int32_t ref_start_pos
     );
-
-private:
+    
     /**
-     * @brief Parses MM tag and extracts delta-encoded skip counts.
+     * @brief Allocation-free variant of parse_read().
      * 
-     * Searches for the specified modification code (e.g., "C+m?") and
-     * extracts the comma-separated skip counts that follow it.
+     * Same semantics and results as the returning overload, but writes into
+     * @p calls (cleared first) so its capacity is reused across reads.
+     * 
+     * @param cpg_sites Optional precomputed CpG bitmap of the chromosome
+     *        (0-based positions, from ReferenceCache). When given, the CpG
+     *        check is a bit test instead of comparing ref_seq characters;
+     *        ref_seq must then be a slice of the same cached chromosome.
+     * @return Number of calls written.
+     */
+    size_t parse_read(
+        const bam1_t* b,
+        std::string_view ref_seq,
+        int32_t ref_start_pos,
+        std::vector<MethylCall>& calls,
+        const CpGBitmap* cpg_sites = nullptr
+    );
+    
+    /**
+     * @brief parse_read() for a read whose alignment is already decoded.
      * 
-     * @param mm_str MM tag string (e.g., "C+m?,3,5,0,2;").
-     * @param mod_code Modification code to search for (default "C+m?" for 5mC).
-     * @return Vector of delta skip counts, empty if mod_code not found.
+     * Modified bases are mapped to the reference through @p aln's aligned
+     * blocks, so the CIGAR is not read again.
      * 
-     * @note Delta encoding means: skip_count[i] is the number of unmodified
-     *       bases of the target type (e.g., 'C') between modifications.
+     * @param aln View of b (AlignmentView::reset(b) or ReadParser::should_keep(b, aln)).
      */
-    std::vector<int> parse_mm_tag(const char* mm_str, const std::string& mod_code = "C+m?");
+    size_t parse_read(
+        const bam1_t* b,
+        const AlignmentView& aln,
+        std::string_view ref_seq,
+        int32_t ref_start_pos,
+        std::vector<MethylCall>& calls,
+        const CpGBitmap* cpg_sites = nullptr
+    );
+
+    /**
+     * @brief Drops CpG calls inside these intervals (e.g. PMDs) while parsing.
+     * 
+     * Checked with a forward-only cursor per read, so gating costs one
+     * binary search per read plus a linear walk. The intervals must belong
+     * to the chromosome of the reads being parsed and outlive the calls;
+     * pass nullptr to disable.
+     */
+    void set_excluded_intervals(const ChromIntervals* intervals) { excluded_ = intervals; }
     
     /**
-     * @brief Builds a mapping from read sequence index to reference position.
+     * @brief Number of CpG calls dropped by set_excluded_intervals() so far.
+     */
+    size_t excluded_calls() const { return excluded_calls_; }
+    
+    /**
+     * @brief Parses MM tag and extracts delta-encoded skip counts.
      * 
-     * Traverses the CIGAR string to determine which read bases align to
-     * which reference positions. Insertions map to -1 (not in reference).
+     * Searches for the first occurrence of the modification code (e.g.
+     * "C+m?") and extracts the comma-separated skip counts that follow it,
+     * up to the next ';'. Works directly on the tag buffer in one pass.
      * 
-     * @param b BAM record.
-     * @return Vector where seq_to_ref[i] = reference position for seq[i],
-     *         or -1 if seq[i] is an insertion.
+     * @param mm_str MM tag string (e.g., "C+h?,1,0;C+m?,3,5,0,2;").
+     * @param mod_code Modification code to search for ("C+m?" for 5mC).
+     * @param deltas Output skip counts (cleared first); empty if mod_code not found.
+     * @param ml_offset Output index of the first ML value belonging to mod_code
+     *        (number of deltas listed before it).
+     * @return true if mod_code was found.
+     * 
+     * @note Delta encoding means: skip_count[i] is the number of unmodified
+     *       bases of the target type (e.g., 'C') between modifications.
      */
-    std::vector<int32_t> build_seq_to_ref_map(const bam1_t* b);
+    static bool parse_mm_tag(
+        const char* mm_str,
+        const char* mod_code,
+        std::vector<int>& deltas,
+        int& ml_offset
+    );
+
+private:
+    std::vector<int> deltas_;           ///< Reusable delta buffer
+    std::vector<int32_t> c_positions_;  ///< Reusable read positions of 'C' bases
+    AlignmentView aln_;                 ///< Decoded alignment for the overloads without a view
+    const ChromIntervals* excluded_ = nullptr;
+    size_t excluded_calls_ = 0;
     
     /**
      * @brief Checks if a position in the reference sequence is a CpG site.
@@ -95,8 +166,7 @@ private:
      * @param offset 0-based offset within ref_seq.
      * @return true if position is a CpG dinucleotide.
      */
-    bool is_cpg_site(const std::string& ref_seq, size_t offset);
+    bool is_cpg_site(std::string_view ref_seq, size_t offset);
 };
 
 } // namespace InterSubMod
-
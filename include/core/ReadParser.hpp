@@ -1,7 +1,12 @@
 #pragma once
 
 #include <htslib/sam.h>
+#include <cstdint>
+#include <string_view>
+#include "core/AlignmentView.hpp"
+#include "core/Config.hpp"
 #include "core/DataStructs.hpp"
+#include "core/ReadTable.hpp"
 #include "core/SomaticSnv.hpp"
 
 namespace InterSubMod {
@@ -14,6 +19,39 @@ struct ReadFilterConfig {
     int min_read_length = 1000;  ///< Minimum read length in bp
     int min_base_quality = 20;   ///< Minimum base quality for SNV support
     bool require_mm_ml = true;   ///< Require MM and ML tags
+
+    /**
+     * @brief Takes min_mapq, min_read_length and min_base_quality from a Config.
+     */
+    static ReadFilterConfig from_config(const Config& config);
+};
+
+/**
+ * @brief Per-stage counts of ReadParser::should_keep().
+ *
+ * Stages run in order (FLAG, MAPQ, length, MM/ML tags) and a read is
+ * counted at the first stage that rejects it, so
+ * seen = failed_flag + failed_mapq + failed_length + failed_tags + kept.
+ * Reads dropped by an HTSlib filter expression never reach should_keep()
+ * and are not counted.
+ */
+struct ReadFilterStats {
+    uint64_t seen = 0;
+    uint64_t failed_flag = 0;    ///< Secondary, supplementary, duplicate or unmapped
+    uint64_t failed_mapq = 0;
+    uint64_t failed_length = 0;
+    uint64_t failed_tags = 0;    ///< Missing MM or ML
+    uint64_t kept = 0;
+
+    ReadFilterStats& operator+=(const ReadFilterStats& other) {
+        seen += other.seen;
+        failed_flag += other.failed_flag;
+        failed_mapq += other.failed_mapq;
+        failed_length += other.failed_length;
+        failed_tags += other.failed_tags;
+        kept += other.kept;
+        return *this;
+    }
 };
 
 /**
@@ -43,10 +81,23 @@ public:
      * - Length: requires >= min_read_length
      * - Tags: requires MM and ML if configured
      * 
+     * FLAG and MAPQ only read the fixed-size core, so most rejected reads
+     * cost two compares; the CIGAR and aux data are touched only after them.
+     * 
      * @param b BAM record to check.
+     * @param stats If non-null, the stage that decided the read is counted.
      * @return true if read should be kept, false if filtered out.
      */
-    bool should_keep(const bam1_t* b) const;
+    bool should_keep(const bam1_t* b, ReadFilterStats* stats = nullptr) const;
+    
+    /**
+     * @brief should_keep() that also decodes the read's alignment into @p aln.
+     * 
+     * The CIGAR is decoded only for reads passing the FLAG and MAPQ checks;
+     * for kept reads @p aln is then valid for parse() and
+     * MethylationParser::parse_read() without another CIGAR pass.
+     */
+    bool should_keep(const bam1_t* b, AlignmentView& aln, ReadFilterStats* stats = nullptr) const;
     
     /**
      * @brief Parses a BAM record into a ReadInfo structure.
@@ -66,7 +117,41 @@ public:
         int read_id,
         bool is_tumor,
         const SomaticSnv& anchor_snv,
-        const std::string& ref_seq,
+        std::string_view ref_seq,
+        int32_t ref_start_pos
+    ) const;
+    
+    /**
+     * @brief parse() without the read name: fills only the fixed-size fields.
+     * 
+     * Used on the hot path together with MatrixBuilder::add_read(record,
+     * bam_get_qname(b), ...), which stores the name in the matrix's name pool.
+     * HP tags outside [-128, 127] are reported as 0 (unknown).
+     * 
+     * @param aln View of b (AlignmentView::reset(b) or should_keep(b, aln)).
+     */
+    ReadRecord parse_record(
+        const bam1_t* b,
+        const AlignmentView& aln,
+        int read_id,
+        bool is_tumor,
+        const SomaticSnv& anchor_snv,
+        std::string_view ref_seq,
+        int32_t ref_start_pos
+    ) const;
+    
+    /**
+     * @brief parse() for a read whose alignment is already decoded.
+     * 
+     * @param aln View of b (AlignmentView::reset(b) or should_keep(b, aln)).
+     */
+    ReadInfo parse(
+        const bam1_t* b,
+        const AlignmentView& aln,
+        int read_id,
+        bool is_tumor,
+        const SomaticSnv& anchor_snv,
+        std::string_view ref_seq,
         int32_t ref_start_pos
     ) const;
     
@@ -78,20 +163,31 @@ public:
 private:
     ReadFilterConfig config_;
     
+    /**
+     * @brief FLAG and MAPQ checks of should_keep() (no CIGAR access).
+     */
+    bool passes_flag_and_mapq(const bam1_t* b, ReadFilterStats* stats) const;
+    
+    /**
+     * @brief MM/ML presence check of should_keep().
+     */
+    bool has_required_tags(const bam1_t* b, ReadFilterStats* stats) const;
+    
     /**
      * @brief Determines if a read supports ALT, REF, or is UNKNOWN at SNV position.
      * 
      * This requires:
      * 1. Read must cover the SNV position
      * 2. Base quality at SNV >= min_base_quality
-     * 3. CIGAR traversal to find the read offset corresponding to SNV
+     * 3. The SNV is in an aligned block (binary search over aln's blocks)
      * 
      * @return AltSupport::ALT, REF, or UNKNOWN.
      */
     AltSupport determine_alt_support(
         const bam1_t* b,
+        const AlignmentView& aln,
         const SomaticSnv& snv,
-        const std::string& ref_seq,
+        std::string_view ref_seq,
         int32_t ref_start_pos
     ) const;
 };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/MethylationParser.hpp"
+#include "core/ReadTable.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Deterministic, stratified read downsampling for one region at a time.
+ *
+ * Each read gets a key derived from a fixed 64-bit hash of its name and a
+ * seed, and within each stratum (source BAM x HP tag x ALT/REF support)
+ * the reads with the smallest keys are kept. This is bottom-k (hash-seeded
+ * reservoir) sampling: it is uniform within each stratum, independent of
+ * fetch order, and selects the same reads on every run and in every
+ * overlapping window.
+ *
+ * offer() is called in the fetch loop after ReadParser::parse_record()
+ * and before the methylation parse. A read whose key cannot make its
+ * stratum's reservoir is rejected right away, so its MM/ML tags are never
+ * parsed. Reads taken into a reservoir get a calls buffer to fill; only
+ * O(k log(n / k)) of them are expected to be parsed. emit() then gives
+ * every stratum a share of max_reads proportional to its size (largest
+ * remainder, at least one read for every non-empty stratum) and hands over
+ * the reads in fetch order.
+ *
+ * Not thread-safe: one sampler per worker thread, reused across regions
+ * (slot buffers keep their capacity).
+ */
+class ReadSampler {
+public:
+    /// Source (tumor / normal) x HP (unknown / 1 / 2) x AltSupport (ALT / REF / UNKNOWN)
+    static constexpr size_t kNumStrata = 2 * 3 * 3;
+
+    /**
+     * @param max_reads Reads kept per region (0 = sampling disabled).
+     * @param seed Mixed into every key; another seed draws another sample.
+     */
+    explicit ReadSampler(int max_reads = 0, uint64_t seed = 0) { configure(max_reads, seed); }
+
+    void configure(int max_reads, uint64_t seed);
+
+    bool enabled() const { return max_reads_ > 0; }
+    int max_reads() const { return max_reads_; }
+
+    /**
+     * @brief Starts a new region (drops all reads, keeps the buffers).
+     */
+    void reset();
+
+    /**
+     * @brief Offers a read of the current region.
+     *
+     * @return Buffer for the read's methylation calls if it enters its
+     *         stratum's reservoir (fill it before the next offer()), or
+     *         nullptr if the read is dropped.
+     */
+    std::vector<MethylCall>* offer(const ReadRecord& record, std::string_view name);
+
+    /**
+     * @brief Hands the selected reads to fn in fetch order.
+     *
+     * fn is called as fn(const ReadRecord&, std::string_view name,
+     * const std::vector<MethylCall>& calls). Call once per region, after
+     * the last offer().
+     *
+     * @return Number of reads emitted.
+     */
+    template <typename Fn>
+    size_t emit(Fn&& fn) {
+        select();
+        for (int slot : selected_) {
+            const Slot& s = slots_[slot];
+            fn(s.record, std::string_view(s.name), s.calls);
+        }
+        return selected_.size();
+    }
+
+    /// Reads offered since reset()
+    size_t seen() const { return seen_; }
+
+    /// Reads offered since reset() per stratum (see stratum_of())
+    const std::array<uint32_t, kNumStrata>& stratum_sizes() const { return stratum_size_; }
+
+    /// Stratum index of a read
+    static size_t stratum_of(const ReadRecord& record);
+
+    /// Sampling key: 64-bit FNV-1a of the name, mixed with the seed
+    static uint64_t key_of(std::string_view name, uint64_t seed);
+
+private:
+    struct Slot {
+        uint64_t key = 0;
+        uint32_t arrival = 0;     ///< Offer index (restores fetch order)
+        ReadRecord record;
+        std::string name;
+        std::vector<MethylCall> calls;
+    };
+
+    int max_reads_ = 0;
+    uint64_t seed_ = 0;
+    size_t seen_ = 0;
+    std::vector<Slot> slots_;
+    std::vector<int> free_slots_;
+    size_t used_slots_ = 0;                                 ///< slots_[0, used_slots_) have been handed out
+    std::array<std::vector<int>, kNumStrata> reservoir_;    ///< Max-heap of slots by (key, arrival)
+    std::array<uint32_t, kNumStrata> stratum_size_{};
+    std::vector<int> selected_;
+
+    bool before(int a, int b) const {
+        const Slot& x = slots_[a];
+        const Slot& y = slots_[b];
+        return x.key != y.key ? x.key < y.key : x.arrival < y.arrival;
+    }
+
+    int take_slot();
+
+    /// Fills selected_ with the emitted slots, in arrival order
+    void select();
+};
+
+} // namespace InterSubMod
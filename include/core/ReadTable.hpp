@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/DataStructs.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief The fixed-size fields of one read (ReadInfo without the name).
+ *
+ * Produced by ReadParser::parse_record() so the hot path never builds a
+ * std::string per read; the name goes straight into a ReadTable's pool.
+ */
+struct ReadRecord {
+    int32_t read_id = 0;      ///< Unique internal read ID
+    int32_t chr_id = 0;       ///< Chromosome ID
+    int32_t align_start = 0;  ///< Alignment start position (0-based)
+    int32_t align_end = 0;    ///< Alignment end position (0-based, exclusive)
+    uint8_t mapq = 0;         ///< Mapping Quality
+    int8_t hp_tag = 0;        ///< Haplotype tag (HP): 0=Unknown, 1=H1, 2=H2
+    AltSupport alt_support = AltSupport::UNKNOWN;
+    bool is_tumor = true;     ///< True if from Tumor BAM
+};
+
+/**
+ * @brief Struct-of-arrays table of reads with pooled names.
+ *
+ * Each field is its own packed column (int32 coordinates, 8-bit MAPQ /
+ * HP / ALT support / source), and all read names live back to back in one
+ * character pool addressed by offset. A read costs 24 bytes plus its name
+ * instead of a ReadInfo and a heap-allocated std::string, and per-field
+ * loops (e.g. the HP/ALT counts in HierarchicalClustering::summarize) run
+ * over contiguous bytes.
+ *
+ * Names are only materialised as std::string by get(); writers read them
+ * as string_views into the pool.
+ */
+class ReadTable {
+public:
+    /**
+     * @brief Appends a read; HP tags outside [-128, 127] are stored as 0 (unknown).
+     * @return Row index of the new read.
+     */
+    int append(const ReadRecord& record, std::string_view name);
+
+    /**
+     * @brief Appends a ReadInfo (name copied into the pool, MAPQ clamped to 0-255).
+     */
+    int append(const ReadInfo& info);
+
+    size_t size() const { return read_id_.size(); }
+    bool empty() const { return read_id_.empty(); }
+
+    /**
+     * @brief Removes all reads (keeps the allocated capacity).
+     */
+    void clear();
+
+    /**
+     * @brief Reserves room for num_reads reads and name_bytes characters of names.
+     */
+    void reserve(size_t num_reads, size_t name_bytes = 0);
+
+    // Per-row access
+    int32_t read_id(size_t row) const { return read_id_[row]; }
+    int32_t chr_id(size_t row) const { return chr_id_[row]; }
+    int32_t align_start(size_t row) const { return align_start_[row]; }
+    int32_t align_end(size_t row) const { return align_end_[row]; }
+    int mapq(size_t row) const { return mapq_[row]; }
+    int hp_tag(size_t row) const { return hp_tag_[row]; }
+    AltSupport alt_support(size_t row) const { return static_cast<AltSupport>(alt_support_[row]); }
+    bool is_tumor(size_t row) const { return is_tumor_[row] != 0; }
+
+    /// Name of a read, pointing into the pool (valid until the table is modified)
+    std::string_view name(size_t row) const {
+        return std::string_view(names_.data() + name_offset_[row], name_offset_[row + 1] - name_offset_[row]);
+    }
+
+    ReadRecord record(size_t row) const;
+
+    /**
+     * @brief Materialises a row as ReadInfo (allocates the name string).
+     */
+    ReadInfo get(size_t row) const;
+
+    // Whole columns for vectorizable loops
+    const std::vector<int8_t>& hp_tags() const { return hp_tag_; }
+    const std::vector<uint8_t>& alt_supports() const { return alt_support_; }  ///< AltSupport values
+    const std::vector<uint8_t>& tumor_flags() const { return is_tumor_; }     ///< 1 = tumor, 0 = normal
+
+    /// Total characters in the name pool
+    size_t name_bytes() const { return names_.size(); }
+
+    /// Reads from the normal BAM
+    size_t count_normal() const;
+
+    /// Bytes currently allocated by the columns and the name pool
+    size_t memory_bytes() const;
+
+private:
+    std::vector<int32_t> read_id_;
+    std::vector<int32_t> chr_id_;
+    std::vector<int32_t> align_start_;
+    std::vector<int32_t> align_end_;
+    std::vector<uint8_t> mapq_;
+    std::vector<int8_t> hp_tag_;
+    std::vector<uint8_t> alt_support_;
+    std::vector<uint8_t> is_tumor_;
+    std::vector<uint32_t> name_offset_{0};  ///< size() + 1 entries; name i is [offset[i], offset[i + 1])
+    std::string names_;
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "core/Types.hpp"
+#include "core/Config.hpp"
+#include "core/Clustering.hpp"
+#include "io/AsyncRegionWriter.hpp"
+#include "utils/BoundedQueue.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief 分析階段（矩陣 → 距離 → 分群）的參數
+ */
+struct AnalysisOptions {
+    DistanceMetricType metric = DistanceMetricType::NHD;
+    NanDistanceStrategy nan_strategy = NanDistanceStrategy::MAX_DIST;
+    LinkageMethod linkage = LinkageMethod::AVERAGE;
+    int num_clusters = 2;          ///< Dendrogram 切成幾群
+    int min_site_coverage = 5;     ///< CpG column 至少需要的 reads 數
+    int min_common_coverage = 3;   ///< 計算 read pair 距離所需的共同 CpG 數
+    double methyl_high = 0.8;
+    double methyl_low = 0.2;
+    int num_threads = 1;           ///< 分析 threads 數
+    size_t queue_capacity = 64;    ///< 等待分析的 regions 上限
+
+    /**
+     * @brief 由 Config 取出分析參數；分析 threads 為 Config::threads 的 1/4（至少 1）
+     */
+    static AnalysisOptions from_config(const Config& config);
+};
+
+/**
+ * @brief RegionAnalyzer 的統計資料
+ */
+struct AnalyzerStats {
+    uint64_t regions_analyzed = 0;   ///< 完成分群的 regions
+    uint64_t regions_skipped = 0;    ///< Reads 或 CpG sites 太少、未分群（矩陣仍寫出）
+    uint64_t clusters = 0;           ///< clusters.tsv 的資料列數
+    double analyze_ms = 0.0;         ///< 分析 threads 的總耗時
+    int num_threads = 0;
+    Utils::QueueStats queue;
+};
+
+/**
+ * @brief 介於 compute workers 與 AsyncRegionWriter 之間的分析階段
+ *
+ * Workers 以 submit() 交出 finalize 後的 region，分析 threads 從自己的有界佇列
+ * 取出，依序執行 MethylationMatrix::build → DistanceMatrix → HierarchicalClustering
+ * → summarize，把每群一列放入 RegionOutput::cluster_rows，再把 region 轉交給 writer；
+ * writer 只為成功寫出的 regions 附加資料列，且在記錄 journal 前落盤（見 AsyncRegionWriter）。
+ * 因此 BAM 擷取/解析、分群與寫檔三個階段各有佇列並同時進行；任一佇列滿時上游會等待。
+ *
+ * 分析 threads 內的 OpenMP 平行區段固定為 1 個 thread（與 compute workers 搶核心沒有好處）。
+ * 分析失敗的 region 不會轉交 writer（不寫出也不記入 journal，resume 時重做）。
+ *
+ * Thread-safety: submit() 可由多個 threads 同時呼叫；close() 必須在所有 submit() 結束後，
+ * 且在 downstream writer 的 close() 之前呼叫。
+ */
+class RegionAnalyzer {
+public:
+    /**
+     * @param options 分析參數
+     * @param downstream 分析完成後接手的 writer（生命週期需長於 analyzer）
+     * @param clusters_path clusters TSV 路徑（覆寫；由 downstream writer 開啟並寫入）
+     * @throws std::runtime_error 無法建立 clusters TSV 時
+     */
+    RegionAnalyzer(const AnalysisOptions& options, AsyncRegionWriter& downstream, const std::string& clusters_path);
+
+    /**
+     * @brief 解構時自動 close()
+     */
+    ~RegionAnalyzer();
+
+    RegionAnalyzer(const RegionAnalyzer&) = delete;
+    RegionAnalyzer& operator=(const RegionAnalyzer&) = delete;
+
+    /**
+     * @brief 交出一個 region；佇列滿時阻塞
+     * @return false 若 analyzer 已關閉
+     */
+    bool submit(RegionOutput&& output);
+
+    /**
+     * @brief 分析完佇列中剩餘的 regions（全部轉交 writer 後）並 join threads
+     */
+    void close();
+
+    /**
+     * @brief 分析或轉交失敗的 regions（region_id, 錯誤訊息），close() 後完整
+     */
+    std::vector<std::pair<int, std::string>> errors() const;
+
+    AnalyzerStats stats() const;
+
+    /**
+     * @brief 對單一 region 分群（供 analysis threads 與測試使用）
+     *
+     * @param hc 呼叫端的 HierarchicalClustering（重複使用 Fisher test 的 cache）
+     * @param result 輸出；region_id 為 output.region_id
+     * @return false 若 reads < 2 或沒有 CpG column 通過 min_site_coverage（不分群）
+     */
+    static bool analyze(const RegionOutput& output, const AnalysisOptions& options,
+                        HierarchicalClustering& hc, ClusteringResult& result);
+
+    /// clusters TSV 的欄位名稱（tab 分隔，無換行）
+    static const char* tsv_header();
+
+private:
+    AnalysisOptions options_;
+    AsyncRegionWriter& downstream_;
+    bool closed_;
+
+    Utils::BoundedQueue<RegionOutput> queue_;
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mutex_;  ///< 保護 errors_ 與 stats_
+    std::vector<std::pair<int, std::string>> errors_;
+    AnalyzerStats stats_;
+
+    void analysis_loop();
+};
+
+} // namespace InterSubMod
@@ -1,15 +1,34 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "core/SomaticSnv.hpp"
+#include "core/SnvSource.hpp"
 #include "core/BamReader.hpp"
 #include "utils/FastaReader.hpp"
 #include "core/ReadParser.hpp"
 #include "core/MethylationParser.hpp"
+#include "core/MethylCallCache.hpp"
+#include "core/ReadSampler.hpp"
 #include "core/MatrixBuilder.hpp"
+#include "utils/Arena.hpp"
+#include "core/RegionScheduler.hpp"
+#include "core/ThreadResourcePool.hpp"
 #include "io/RegionWriter.hpp"
+#include "io/BinaryRegionFile.hpp"
+#include "io/AsyncRegionWriter.hpp"
+#include "core/RegionAnalyzer.hpp"
+#include "io/CompletionJournal.hpp"
+#include "core/IntervalIndex.hpp"
+#include "core/ShardPlan.hpp"
+#include "utils/BoundedQueue.hpp"
+#include "utils/StageTimer.hpp"
+#include "utils/ProgressReporter.hpp"
+#include "utils/NumaTopology.hpp"
 
 namespace InterSubMod {
 
@@ -19,15 +38,64 @@ namespace InterSubMod {
 struct RegionResult {
     int region_id;
     int snv_id;
-    int num_reads;
+    int num_reads;          ///< Tumor + normal reads in the matrix
+    int num_normal_reads;   ///< Reads from the normal BAM (is_tumor = false)
+    int num_reads_dropped;  ///< Reads left out by depth-capped downsampling (set_max_reads_per_region())
+    double est_bytes;       ///< Cost model：super-region 的估計 BAM 壓縮 bytes 依成員數分攤（0 = 未估計）
     int num_cpgs;
     double elapsed_ms;
-    double peak_memory_mb;
+    double peak_memory_mb;  ///< Region 用量（MB）：arena 暫存 + 輸出矩陣（精確值），加上分攤的擷取配置量（jemalloc；未啟用時為 0）
+    Utils::StageTimes stages; ///< 各階段耗時（super-region 共用的擷取依成員數平均分攤）
     bool success;
+    bool resumed;           ///< 已在先前的執行完成（journal 記錄為 OK），本次未重新處理
     std::string error_message;
     
-    RegionResult() : region_id(-1), snv_id(-1), num_reads(0), num_cpgs(0),
-                     elapsed_ms(0.0), peak_memory_mb(0.0), success(false) {}
+    RegionResult() : region_id(-1), snv_id(-1), num_reads(0), num_normal_reads(0), num_reads_dropped(0), est_bytes(0.0), num_cpgs(0),
+                     elapsed_ms(0.0), peak_memory_mb(0.0), success(false), resumed(false) {}
+};
+
+/**
+ * @brief 一個 super-region 擷取後的 reads 與參考序列（擷取與計算分開時的交接單位）
+ * 
+ * Records 來自擷取它的 slot 的 readers，用完以 recycle 交還同一個 slot。
+ */
+struct FetchedSuperRegion {
+    std::vector<bam1_t*> tumor_reads;     ///< 空的：tumor reads 於計算時直接串流（單一成員）
+    std::vector<bam1_t*> normal_reads;
+    std::string ref_owned;                ///< Prefetch 時 ref_union 的副本（FastaReader buffer 會被下一次擷取覆寫）
+    std::string_view ref_union;
+    std::string_view cache_ref;           ///< Methyl-call cache 的解析範圍（未啟用時為空）
+    int32_t cache_ref_start = 0;
+    const CpGBitmap* cpg_sites = nullptr;
+    AlignmentView alignment;              ///< 擷取時 should_keep() 的解碼結果
+    ReadFilterStats tumor_filter;         ///< 擷取時的過濾統計（計算時併入 RegionWorkspace）
+    ReadFilterStats normal_filter;
+    Utils::StageTimes fetch_times;
+    double fetch_ms = 0.0;
+    uint64_t alloc_bytes = 0;             ///< 擷取 thread 的配置量（jemalloc；未啟用時為 0）
+    std::string error;                    ///< 非空 = 擷取失敗，所有成員記為失敗
+};
+
+/**
+ * @brief 每個 thread 重複使用的 parser 與暫存 buffer
+ * 
+ * 跨 regions 保留容量，使 steady-state 的 per-read 解析不需配置記憶體。
+ */
+struct RegionWorkspace {
+    ReadParser read_parser;
+    MethylationParser methyl_parser;
+    std::vector<MethylCall> calls;  ///< parse_read() 的輸出 buffer
+    AlignmentView alignment;        ///< 目前 read 的 CIGAR 解碼結果（過濾、ALT 判定、甲基化共用）
+    Utils::Arena arena;             ///< 每個 region 開始時 reset 的暫存配置區（MatrixBuilder scratch）
+    Utils::StageTimes stage_totals; ///< 此 thread 處理過的 regions 的各階段耗時總和
+    size_t regions = 0;             ///< 此 thread 處理過的 regions 數
+    MethylCallCache methyl_cache;   ///< 跨 regions 共用的 per-read calls（set_methyl_cache() 啟用）
+    ReadSampler sampler;            ///< 深度上限的分層抽樣（set_max_reads_per_region() 啟用）
+    ReadFilterStats tumor_filter;   ///< 此 thread 的 tumor reads 過濾統計
+    ReadFilterStats normal_filter;  ///< 此 thread 的 normal reads 過濾統計（normal task 結束後併入）
+    FetchedSuperRegion fetched;     ///< 未 prefetch 時重複使用的擷取 buffer
+    size_t prefetched = 0;          ///< 經由 prefetch 處理的 super-regions 數
+    double prefetch_wait_ms = 0.0;  ///< 等待 prefetch 完成的時間（I/O 未被計算蓋過的部分）
 };
 
 /**
@@ -37,13 +105,18 @@ struct RegionResult {
  * 1. 載入 SNV table
  * 2. 為每個 SNV 定義 region（如 ±2000bp）
  * 3. 使用 OpenMP 平行處理多個 regions
- * 4. 管理 thread-local 資源（BamReader, FastaReader）
- * 5. 收集並報告每個 region 的處理結果
+ * 4. 管理 thread-local 資源（BamReader, FastaReader），每個 thread 只開檔一次
+ * 5. 若提供 normal BAM，tumor 與 normal reads 同時擷取（normal 以 OpenMP task 執行），
+ *    共用同一段參考序列，合併到同一個 MatrixBuilder（ReadInfo::is_tumor 區分來源）
+ * 6. 收集並報告每個 region 的處理結果
  * 
  * Thread-safety:
- * - 每個 thread 維護自己的 BAM/FASTA readers
- * - MatrixBuilder 與 RegionWriter 在 critical section 中使用
- * - 結果收集使用 mutex 保護
+ * - 每個 thread 透過 ThreadResourcePool 持有自己的 BAM/FASTA readers，
+ *   並在該 thread 處理的所有 regions 之間重複使用
+ * - 每個 thread 使用自己的 MatrixBuilder，finalize 後 move 給 AsyncRegionWriter，
+ *   由專用 writer threads 序列化與寫檔（binary 時每個 writer thread 一個 shard），
+ *   worker 不必等待 I/O；佇列滿時 worker 會被阻塞（backpressure）
+ * - 結果收集使用 mutex 保護；進度回報只用 atomic counters（ProgressReporter），workers 不進入 critical section
  */
 class RegionProcessor {
 public:
@@ -67,11 +140,19 @@ public:
     );
     
     /**
-     * @brief 載入 SNV table（TSV 格式）
+     * @brief 收尾 process_single_region() 尚未關閉的輸出（見 finish_single_regions()）
+     */
+    ~RegionProcessor();
+    
+    /**
+     * @brief 載入 SNV table（VCF/BCF 或 TSV，經由 SnvSource）
      * 
-     * 格式：chr  pos  ref  alt  qual
+     * VCF（.vcf / .vcf.gz / .bcf）：僅保留 FILTER=PASS 的 biallelic SNV，somatic_conf = FORMAT/AF
+     * TSV 格式：chr  pos  ref  alt  qual
      * 範例：chr17  7578000  C  T  100.0
      * 
+     * chr_id 由 processor 的 ChromIndex 依染色體名稱配發。
+     * 
      * @param snv_table_path SNV table 檔案路徑
      * @return 成功載入的 SNV 數量
      */
@@ -80,30 +161,309 @@ public:
     /**
      * @brief 處理所有 SNVs（平行化）
      * 
+     * SNVs 先依 (chr, pos) 排序，重疊或相鄰（間距 <= merge_gap）的窗口合併為
+     * super-region，每個 super-region 只向 BAM 擷取一次，再分配給各成員 SNV。
+     * 同一染色體上連續的 super-regions 組成 batch 交給同一個 thread，
+     * 以保持 BGZF block cache 的局部性。
+     * 
      * @param max_snvs 最多處理幾個 SNVs（0 = 全部）
      * @return 處理結果的 vector
      */
     std::vector<RegionResult> process_all_regions(int max_snvs = 0);
     
     /**
-     * @brief 處理單個 region（由 OpenMP worker thread 呼叫）
+     * @brief 邊讀取 SNV 檔邊處理（不需先呼叫 load_snvs()）
+     * 
+     * 一個 reader thread 以 SnvSource 串流讀檔，依檔案順序即時合併 super-regions
+     * （規則同 RegionScheduler::try_extend），每約 32 個 SNVs 組成一個 chunk 經由
+     * bounded queue 交給 OpenMP workers，因此第一批 regions 在 VCF 仍在讀取時就開始處理；
+     * 佇列滿時 reader 會等待。輸入需依 (chr, pos) 排序才能完整合併（VCF 通常如此），
+     * 未排序的輸入結果仍正確，只是合併較少。結束後 get_snvs() 為讀到的所有 SNVs。
+     * 
+     * @param snv_path VCF/BCF 或 TSV 路徑
+     * @param max_snvs 最多處理幾個 SNVs（0 = 全部）
+     * @return 處理結果（以 region_id 即檔案中的順序索引）
+     * @throws std::runtime_error 無法開啟檔案，或讀取中途失敗（已處理的 regions 仍會寫出）
+     */
+    std::vector<RegionResult> process_snv_stream(const std::string& snv_path, int max_snvs = 0);
+    
+    /**
+     * @brief 處理單個 region 並交給輸出
+     * 
+     * 第一次呼叫時開啟 journal 與輸出（resume 或先前已有輸出時選用新的 shard 檔名，
+     * 不覆寫既有 shards），之後的呼叫沿用同一組 writer，直到 finish_single_regions()、
+     * 下一次 process_all_regions() / process_snv_stream() 或解構時才關閉。
+     * 可由多個 threads 呼叫，但彼此以 mutex 序列化；大量 regions 請用 process_all_regions()。
      * 
-     * @param snv SNV 資訊
-     * @param region_id Region ID
-     * @return RegionResult
+     * @param snv SNV 資訊（chr_id 須屬於本 processor 的 chromosome 編號，例如 get_snvs() 的元素）
+     * @param region_id Region ID（輸出與 journal 使用的編號）
+     * @return RegionResult；寫出失敗要到 finish_single_regions() 才會回報
      */
     RegionResult process_single_region(const SomaticSnv& snv, int region_id);
     
+    /**
+     * @brief 關閉 process_single_region() 開啟的輸出，並把計算或寫出失敗的 regions 記錄到 journal
+     * @return 成功寫出的 region 數（沒有開啟的輸出時為 0）
+     */
+    size_t finish_single_regions();
+    
     /**
      * @brief 取得載入的 SNVs 列表
      */
     const std::vector<SomaticSnv>& get_snvs() const { return snvs_; }
     
     /**
-     * @brief 輸出處理摘要報告
+     * @brief SomaticSnv::chr_id 與染色體名稱的對照
+     */
+    const ChromIndex& chrom_index() const { return chrom_index_; }
+    
+    /**
+     * @brief 設定合併窗口的最大間距（bp）
+     * 
+     * 兩個 SNV 窗口相距不超過 merge_gap 時也會合併為同一個 super-region（預設 0：僅合併重疊窗口）
+     */
+    void set_merge_gap(int32_t merge_gap) { merge_gap_ = merge_gap; }
+    
+    /**
+     * @brief 設定 region 輸出格式
+     * 
+     * BINARY（預設）：每個 writer thread 一個 append-only shard
+     * （output_dir/regions.shard_NNN.ismr），process_all_regions() 結束時寫入 index；
+     * CSV：舊的每 region 一個目錄的文字輸出，僅供除錯。
+     * 
+     * @param dtype Binary 模式的矩陣型別（float32 或 uint8 量化）；uint8 時 region 矩陣
+     *              在記憶體中即以 MatrixStorage::UINT8 建構
+     */
+    void set_output_format(OutputFormat format,
+                           BinaryFormat::MatrixDType dtype = BinaryFormat::MatrixDType::FLOAT32) {
+        output_format_ = format;
+        output_dtype_ = dtype;
+    }
+    
+    /**
+     * @brief 啟用 / 停用染色體層級的 reference cache
+     * 
+     * 啟用後每條染色體只解壓與轉大寫一次，所有 threads 共用（唯讀），
+     * region 的參考序列為指向 cache 的 string_view，CpG 判定改為 bitmap 查詢。
+     * 代價是每條用到的染色體約 1.1 byte/bp 的常駐記憶體。
+     */
+    void set_reference_cache(bool enabled);
+    
+    /**
+     * @brief 建立所有 BAM readers（tumor 與 normal、所有 threads）共用的 BGZF 解壓 thread pool
+     * 
+     * Pool 大小與 OpenMP compute threads 分開設定；每個 reader 不再各自開 private pool，
+     * 單一很深的 region（例如 amplified loci）的解壓可以分給閒置的核心，
+     * 而不是讓一個 worker 自己 inline 解壓。只能設定一次，且須在處理開始前呼叫。
+     * 
+     * @param num_threads 解壓 threads 數（<= 0 = 不使用，由各 worker 自行解壓）
+     * @throws std::runtime_error 無法建立 pool 時
+     */
+    void set_decompression_threads(int num_threads);
+    
+    /**
+     * @brief 啟用每個 thread 的 methyl-call cache（MethylCallCache）
+     * 
+     * 長 reads 會跨越許多相鄰 SNV 窗口；啟用後每條 read 的 MM/ML 只解析一次
+     * （reference cache 模式下涵蓋整條染色體，否則涵蓋 super-region 的 union 窗口），
+     * 各窗口以二分搜尋取出自己的 calls。命中率列於摘要與 telemetry。
+     * 
+     * @param bytes_per_thread 每個 thread 的記憶體上限（0 = 停用，預設）
+     */
+    void set_methyl_cache(size_t bytes_per_thread);
+    
+    /**
+     * @brief 所有 threads 的 methyl-call cache 統計總和
+     */
+    MethylCacheStats methyl_cache_stats() const;
+    
+    /**
+     * @brief 每個 region 最多保留的 reads 數（深度上限的 deterministic 抽樣）
+     * 
+     * 高深度或 amplified loci 的單一 region 可能有上萬條 reads，而距離矩陣與分群是
+     * O(n²)。超過上限時以 ReadSampler 依 (tumor/normal × HP × ALT/REF) 分層、按比例抽樣
+     * （每個非空 stratum 至少保留 1 條），所以少數的 ALT reads 或 normal reads 不會被整批捨棄。
+     * 抽樣依 read name 的 hash 決定：同一 seed 每次執行、每個重疊窗口都選到相同的 reads。
+     * 未被選中的 reads 不會解析 MM/ML。丟棄數記在 RegionResult::num_reads_dropped。
+     * 
+     * @param max_reads 每個 region 的 reads 上限（0 = 不抽樣，預設）
+     * @param seed 抽樣 seed（換 seed 即換一組樣本）
+     */
+    void set_max_reads_per_region(int max_reads, uint64_t seed = 0);
+    
+    /**
+     * @brief 設定 read 過濾條件（所有 threads 的 ReadParser；預設為 ReadFilterConfig{}）
+     * 
+     * 過濾在 BAM iterator 的迴圈中、bam_dup1() 之前進行：FLAG / MAPQ 只讀 record
+     * core，通過後才解碼 CIGAR（長度）與查 MM/ML tags。各階段的剔除數見 read_filter_stats()。
+     */
+    void set_read_filter(const ReadFilterConfig& filter);
+    
+    /**
+     * @brief 額外的 HTSlib filter expression（空字串 = 無），套用到所有 BAM readers
+     * 
+     * 不符合的 records 在 sam_itr_next() 內即被略過，不會進入 should_keep()，
+     * 也不計入 read_filter_stats()。
+     * 
+     * @throws std::runtime_error HTSlib 無法解析 expression 時
+     */
+    void set_read_filter_expression(const std::string& expr) { resource_pool_.set_read_filter_expression(expr); }
+    
+    /**
+     * @brief 所有 threads 的 read 過濾統計總和
+     * @param tumor true = tumor BAM，false = normal BAM
+     */
+    ReadFilterStats read_filter_stats(bool tumor) const;
+    
+    /**
+     * @brief 設定 PMD gating（nullptr = 停用）
+     * 
+     * PMD 內的 CpG calls 在 MethylationParser 的解析迴圈中即被丟棄，
+     * 不會進入 MatrixBuilder。Interval index 由所有 threads 唯讀共用。
+     * 
+     * @param pmd 由 IntervalIndex::load_bed(pmd_bed_path) 載入的 PMD intervals
+     */
+    void set_pmd_intervals(std::shared_ptr<const IntervalIndex> pmd) {
+        pmd_index_ = std::move(pmd);
+        pmd_replicas_.clear();
+    }
+    
+    /**
+     * @brief 只處理落在指定範圍內的 SNVs（load_snvs() / process_snv_stream() 之前呼叫）
+     * 
+     * 有 .tbi/.csi 的 VCF 直接 seek 到各範圍，不掃描整個檔案。
+     * 設定後輸出改為 shard-stable 命名：binary shard 檔名加上 output_tag
+     * （regions.<tag>.shard_NNN.ismr），CSV 子目錄以 SNV 座標命名，
+     * 多個節點的分片輸出可放在同一目錄而不衝突。
+     * 
+     * @param ranges 1-based inclusive 範圍（空 = 不選取任何 SNV）
+     * @param output_tag 檔名標記；空字串時由範圍產生（region_selection_tag）
+     */
+    void set_snv_regions(const std::vector<GenomicRange>& ranges, const std::string& output_tag = "");
+    
+    /**
+     * @brief 只處理 N 個分片中的第 i 個（1-based）
+     * 
+     * 依 tumor BAM index 的每條染色體 mapped reads 數量把基因組切成 N 段
+     * 連續、估計工作量相近的範圍（ShardPlanner），再交給 set_snv_regions()，
+     * output_tag 為 "part_iii_of_NNN"。每個位置恰屬於一個分片。
+     * 
+     * @throws std::runtime_error 無法讀取 tumor BAM index 時
+     */
+    void set_shard(const ShardSpec& shard);
+    
+    /**
+     * @brief 設定進度列的輸出間隔（秒，<= 0 = 不輸出，預設 10）
+     * 
+     * Workers 只更新 atomic counters，由一個 reporter thread 定期印出
+     * 完成數、regions/s、ETA 與失敗數。每個 region 的開始/完成訊息改為
+     * Utils::Logger 的 debug 訊息（set_log_level(L_DEBUG) 時才輸出；release build
+     * 預設不編入 debug 訊息，需以 -DISM_LOG_MIN_LEVEL=0 建置）。
+     */
+    void set_progress_interval(double seconds) { progress_interval_s_ = seconds; }
+    
+    /**
+     * @brief 依估計成本排程，減少最後少數 regions 拖長 wall-clock 的情形
+     * 
+     * 處理前先以 BAI 的 bins / linear index 估計每個 super-region 要讀的壓縮 bytes
+     * （BamReader::estimate_bytes()，只查 index，不讀 BGZF blocks），tumor 與 normal 相加。
+     * - process_all_regions()：改用 RegionScheduler::build_cost_batches()，依成本切 batches
+     *   並由重到輕處理（longest-first），很重的 super-region 自成一個 batch
+     * - process_snv_stream()：reader thread 估計每個 super-region；遠重於目前平均者
+     *   單獨成為一個 chunk，不讓同一 chunk 的其他 regions 排在它後面
+     * 
+     * 估計值記在 RegionResult::est_bytes；摘要與 telemetry 列出估計與實際耗時的相關係數，
+     * 用來檢查模型。預設關閉（原本的排程）。
+     */
+    void set_cost_scheduling(bool enabled) { cost_scheduling_ = enabled; }
+    
+    /**
+     * @brief 每個 worker 提前擷取的 super-regions 數（0 = 不 prefetch，預設）
+     * 
+     * 啟用後每個 worker 在處理一個 batch（process_all_regions()）或 chunk（process_snv_stream()）時
+     * 另開一個 I/O thread，依排程順序先擷取接下來 depth 個 super-regions 的 reads 與參考序列，
+     * 與本 thread 的 MM/ML 解析、矩陣建構重疊；BAM 位於網路儲存時 CPU 不必等待擷取。
+     * 記憶體最多多出 depth 個 super-regions 的 records。單一成員的 region 也改為先擷取
+     * （不再於計算時串流），因為 readers 整段期間由 I/O thread 獨占。
+     */
+    void set_prefetch_depth(int depth) { prefetch_depth_ = std::max(depth, 0); }
+    
+    /**
+     * @brief 多 socket 伺服器的 NUMA 配置（預設關閉）
+     * 
+     * 每次 process_*() 開始時偵測 NUMA 拓撲（Utils::NumaTopology），並：
+     * - 把 OpenMP thread t 固定在第 t * nodes / threads 個 node 的 CPUs 上；
+     *   若已設定 OMP_PLACES / OMP_PROC_BIND 則不改動，改以各 thread 目前所在的 node 為準
+     *   （prefetch 的 I/O thread 繼承其 worker 的 affinity）
+     * - reference cache 與 PMD intervals 每個 node 各一份，由該 node 的 thread 建立
+     *   （first touch 使記憶體落在本地 node，不再全由 main thread 配置在同一個 socket）
+     * - process_all_regions()：以 RegionScheduler::partition_by_node() 將整條染色體分配給各 node，
+     *   threads 先處理自己 node 的 batches，做完再接手其他 node 剩下的
+     * 
+     * 單一 node 的機器上只做偵測，行為與關閉時相同。
+     */
+    void set_numa(bool enabled) { numa_ = enabled; }
+    
+    /**
+     * @brief 從上次中斷的執行接續（第一次 process_*() 之前呼叫）
+     * 
+     * 每次執行都會把寫出完成的 regions 記錄在 output_dir/completed[.tag].journal
+     * （CompletionJournal：每批 fsync，且在對應的 shard fsync 之後）。
+     * resume 時讀回 journal，已記錄為 OK 的 SNVs 不再處理（RegionResult::resumed），
+     * 失敗或未完成的 regions 重新處理；新的 binary shards 與 clusters 表（CSV 模式亦同）檔名加上 ".resumeNN"，
+     * 不覆寫先前執行的輸出。未設定時 journal、shards 與 clusters 表從頭覆寫。
+     */
+    void set_resume(bool resume) { resume_ = resume; }
+    
+    /**
+     * @brief 設定非同步輸出的 writer thread 數與佇列容量
+     * 
+     * @param num_writer_threads Writer threads（binary 時 = shard 數，預設 1）
+     * @param queue_capacity 等待寫出的 regions 上限；佇列滿時 workers 會等待（預設 64）
+     */
+    void set_writer_options(int num_writer_threads, size_t queue_capacity) {
+        writer_threads_ = num_writer_threads;
+        writer_queue_capacity_ = queue_capacity;
+    }
+    
+    /**
+     * @brief 啟用分析階段：每個 region 的矩陣先經 RegionAnalyzer 分群，再交給 writer
+     * 
+     * 分群結果寫入 output_dir/clusters[.tag].tsv（tag 規則同 binary shards）。
+     * 分析 threads 有自己的有界佇列，與 compute workers、writer threads 同時進行。
+     * 未呼叫時只輸出矩陣。
+     */
+    void set_analysis(const AnalysisOptions& options) {
+        analysis_enabled_ = true;
+        analysis_options_ = options;
+    }
+    
+    /**
+     * @brief 輸出處理摘要報告（包含 reader 重複使用與 writer 佇列統計）
      */
     void print_summary(const std::vector<RegionResult>& results) const;
     
+    /**
+     * @brief 寫出 telemetry：<path_prefix>.tsv（每個 region 一行，含各階段耗時與配置量）
+     *        與 <path_prefix>.json（各階段總和、每個 thread 的分項、writer 與佇列統計）
+     * 
+     * JSON 的 "io_ms"（bam_fetch + ref_fetch + writer threads）與 "cpu_ms"
+     * （filter + parse + finalize）用來判斷執行是 I/O-bound 還是 CPU-bound。
+     * 
+     * @throws std::runtime_error 無法寫檔時
+     */
+    void write_telemetry(const std::vector<RegionResult>& results, const std::string& path_prefix) const;
+    
+    /**
+     * @brief 所有 threads 的各階段耗時總和（不含 writer threads，見 AsyncWriterStats::write_ms）
+     */
+    Utils::StageTimes stage_totals() const;
+    
+    /**
+     * @brief 取得 thread-local reader pool 的開檔統計
+     */
+    ThreadResourceStats get_resource_stats() const { return resource_pool_.stats(); }
+    
 private:
     std::string tumor_bam_path_;
     std::string normal_bam_path_;
@@ -111,11 +471,207 @@ private:
     std::string output_dir_;
     int num_threads_;
     int32_t window_size_;
+    int32_t merge_gap_;
+    OutputFormat output_format_;
+    BinaryFormat::MatrixDType output_dtype_;
     
     std::vector<SomaticSnv> snvs_;
     std::vector<std::string> chr_names_;  // Store chromosome names for each SNV
+    ChromIndex chrom_index_;              // chr name -> SomaticSnv::chr_id
+    
+    // SNV 範圍選取（set_snv_regions / set_shard）
+    bool has_snv_selection_ = false;
+    std::vector<GenomicRange> snv_ranges_;
+    std::string output_tag_;              ///< 非空時使用 shard-stable 的輸出命名
+    
+    /**
+     * @brief 開啟 SNV 來源並套用範圍選取；chr_id 先依 reference FASTA 順序配發，
+     *        使不同分片（不同 SNV 子集）的 chr_id 一致
+     */
+    std::unique_ptr<SnvSource> open_snv_source(const std::string& path);
     
-    // Thread-local 資源會在 process_single_region 中建立
+    /**
+     * @brief process_snv_stream() 中 reader 交給 workers 的工作單位
+     */
+    struct SnvChunk {
+        std::vector<SomaticSnv> snvs;            ///< snv_id = 全域 region_id
+        std::vector<SuperRegion> super_regions;  ///< members 為 snvs 的索引
+    };
+    
+    /**
+     * @brief 擷取 super-region 的 reads 與參考序列一次，並分配給所有成員 SNV
+     * 
+     * @param sr Super-region（members 為 snvs / results 的索引）
+     * @param snvs 成員 SNVs 所在的陣列；輸出的 region_id 為 SomaticSnv::snv_id
+     * @param results 結果陣列（與 snvs 同索引，各成員寫入自己的欄位）
+     */
+    void process_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs,
+                              std::vector<RegionResult>& results);
+    
+    /**
+     * @brief 依序處理 count 個 super-regions（一個 batch 或 chunk，維持排程的 locality 順序）
+     * 
+     * set_prefetch_depth() > 0 時另開一個 I/O thread 使用此 slot 的 readers，
+     * 最多提前 prefetch_depth_ 個 super-regions 擷取 reads 與參考序列，
+     * 本 thread 同時解析與建構前一個；否則逐一 process_super_region()。
+     */
+    void process_super_regions(const SuperRegion* srs, size_t count, const std::vector<SomaticSnv>& snvs,
+                               std::vector<RegionResult>& results);
+    
+    /**
+     * @brief 擷取一個 super-region（之後交給 compute_super_region()）
+     * 
+     * @param slot 使用哪個 slot 的 readers（呼叫端須獨占）
+     * @param stream_tumor true = 不擷取 tumor reads（計算時再串流）
+     * @param own_reference true = 把參考序列複製到 f.ref_owned（非 reference cache 模式）
+     */
+    void fetch_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs, int slot,
+                            bool stream_tumor, bool own_reference, FetchedSuperRegion& f);
+    
+    /**
+     * @brief 把已擷取的 super-region 分配給所有成員 SNV
+     * 
+     * @param streaming true = tumor reads 由本 thread 的 slot 直接串流（f.tumor_reads 為空）
+     */
+    void compute_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs,
+                              std::vector<RegionResult>& results, FetchedSuperRegion& f, bool streaming);
+    
+    /**
+     * @brief 把 f 的 records 交還 slot 的 readers
+     */
+    void recycle_fetched(int slot, FetchedSuperRegion& f);
+    
+    /**
+     * @brief 處理單一成員 SNV
+     * 
+     * @param chr_name SNV 所在染色體（shard-stable 輸出命名用）
+     * @param for_each_kept_read 以 (region_start, region_end, handler) 呼叫，
+     *        對每個通過 should_keep() 且與成員窗口重疊的 read 呼叫 handler(b, aln, is_tumor)
+     *        （aln 為該 read 已解碼的 AlignmentView）
+     *        （來源可以是 super-region 已擷取的 reads，或直接串流自 BAM；
+     *        tumor reads 先於 normal reads）
+     * @param ws 此 thread 的 parser 與暫存 buffer
+     * @param ref_union Super-region 的參考序列
+     * @param union_start ref_union 的起始座標
+     * @param cpg_sites 染色體的 CpG bitmap（reference cache 模式），否則 nullptr
+     * @param cache_ref methyl-call cache 解析整條 read 用的參考序列（整條染色體或 ref_union）
+     * @param cache_ref_start cache_ref 的起始座標
+     */
+    template <typename ForEachRead>
+    RegionResult process_member(
+        const SomaticSnv& snv,
+        const std::string& chr_name,
+        int region_id,
+        ForEachRead&& for_each_kept_read,
+        RegionWorkspace& ws,
+        std::string_view ref_union,
+        int32_t union_start,
+        const CpGBitmap* cpg_sites,
+        std::string_view cache_ref,
+        int32_t cache_ref_start
+    );
+    
+    // Thread-local readers（每個 OpenMP thread 一個 slot，lazy 開檔）
+    ThreadResourcePool resource_pool_;
+    
+    // Thread-local parsers / buffers（與 resource_pool_ 的 slot 一一對應）
+    std::vector<RegionWorkspace> workspaces_;
+    
+    // PMD intervals（唯讀共用，nullptr = 不 gating）
+    std::shared_ptr<const IntervalIndex> pmd_index_;
+    
+    // 非同步輸出（每次 process_all_regions() 建立一次）
+    std::unique_ptr<AsyncRegionWriter> writer_;
+    int writer_threads_;
+    size_t writer_queue_capacity_;
+    AsyncWriterStats writer_stats_;  ///< 最近一次 close_output() 的統計
+    
+    // 分析階段（set_analysis() 啟用時與 writer_ 一起建立，位於 workers 與 writer_ 之間）
+    bool analysis_enabled_ = false;
+    AnalysisOptions analysis_options_;
+    std::unique_ptr<RegionAnalyzer> analyzer_;
+    AnalyzerStats analyzer_stats_;   ///< 最近一次 close_output() 的統計
+    
+    // Prefetch（set_prefetch_depth()）
+    int prefetch_depth_ = 0;
+    
+    // NUMA 配置（set_numa()；bind_numa() 第一次呼叫時偵測拓撲）
+    bool numa_ = false;
+    bool numa_pin_ = false;                ///< 由本程式固定 threads（未設定 OMP_PLACES / OMP_PROC_BIND）
+    std::unique_ptr<Utils::NumaTopology> numa_topology_;
+    std::vector<std::shared_ptr<const IntervalIndex>> pmd_replicas_;  ///< 每個 node 一份 pmd_index_ 的副本（空 = 尚未建立）
+    bool reference_cache_enabled_ = false;
+    
+    /**
+     * @brief 偵測拓撲、固定 workers 並建立各 node 的副本（numa_ 關閉時為 no-op）
+     */
+    void bind_numa();
+    
+    /**
+     * @brief 把目前的 thread 固定到 slot 所屬的 node（已固定則只比較一次 thread_local）
+     */
+    void pin_worker(int slot) const;
+    
+    /**
+     * @brief slot 所屬 node 的 PMD intervals（沒有副本時為 pmd_index_）
+     */
+    const IntervalIndex* pmd_for(int slot) const;
+    
+    /**
+     * @brief NUMA 拓撲的節點數（未啟用時為 1）
+     */
+    int numa_nodes() const { return numa_topology_ ? numa_topology_->num_nodes() : 1; }
+    
+    // 成本排程（set_cost_scheduling()）
+    bool cost_scheduling_ = false;
+    double cost_estimate_ms_ = 0.0;  ///< 最近一次執行的估計耗時
+    
+    /**
+     * @brief 一個 super-region 的估計壓縮 bytes（tumor + normal，見 BamReader::estimate_bytes()）
+     */
+    static uint64_t estimate_cost(const SuperRegion& sr, int chr_id, BamReader& tumor, BamReader* normal);
+    
+    // 進度回報（每次 process_*() 建立一次；process_single_region() 不回報）
+    double progress_interval_s_ = 10.0;
+    std::unique_ptr<Utils::ProgressReporter> progress_;
+    
+    // Checkpoint / resume（第一次 open_journal() 時開啟，之後的執行共用）
+    bool resume_ = false;
+    std::unique_ptr<CompletionJournal> journal_;
+    
+    /**
+     * @brief 開啟 completion journal（已開啟則為 no-op）
+     */
+    void open_journal();
+    
+    /**
+     * @brief SNV 是否已由先前的執行完成；是則把 result 標記為 resumed
+     */
+    bool already_completed(const SomaticSnv& snv, const std::string& chr_name, RegionResult& result) const;
+    
+    /**
+     * @brief 把處理或寫出失敗的 regions 記錄到 journal（resume 時重試）
+     */
+    void journal_failures(const std::vector<RegionResult>& results);
+    
+    // process_single_region() 的輸出（第一次呼叫時開啟，finish_single_regions() 關閉）
+    std::mutex single_mutex_;
+    bool single_output_open_ = false;
+    std::vector<RegionResult> single_results_;          ///< 以 region_id 索引，供 close_output()
+    std::unordered_map<int, std::string> single_keys_;  ///< region_id -> journal key
+    int outputs_opened_ = 0;                            ///< open_output() 的次數；第二次起不覆寫既有 shards
+    
+    /**
+     * @brief 建立 writer threads 與輸出 shards（resume 或本 processor 已輸出過時選用尚未存在的 shard 檔名），
+     *        啟用分析時再建立 analysis threads
+     */
+    void open_output();
+    
+    /**
+     * @brief 依序關閉分析階段與 writer，把分析或寫出失敗的 regions 標記為失敗
+     * @return 成功寫出的 region 總數
+     */
+    size_t close_output(std::vector<RegionResult>& results);
 };
 
 } // namespace InterSubMod
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "core/SomaticSnv.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief A group of SNV windows that are fetched from the BAM only once.
+ *
+ * Neighbouring SNVs whose ±window_size windows overlap (or lie within
+ * merge_gap bp of each other) are coalesced into a single super-region.
+ * The union window is fetched once and its reads are fanned out to the
+ * member SNVs.
+ */
+struct SuperRegion {
+    std::string chr_name;      ///< Chromosome name shared by all members
+    int32_t fetch_start;       ///< Union window start (same convention as member windows)
+    int32_t fetch_end;         ///< Union window end
+    std::vector<int> members;  ///< Region IDs (indices into the SNV list), sorted by position
+    uint64_t est_bytes = 0;    ///< Estimated compressed BAM bytes of the union window (0 = not estimated)
+};
+
+/**
+ * @brief A chromosome-contiguous run of super-regions handed to one worker.
+ *
+ * Super-regions [first, last) are adjacent on the same chromosome, so the
+ * worker's BGZF block cache stays warm between consecutive fetches.
+ */
+struct WorkBatch {
+    size_t first;        ///< Index of the first super-region
+    size_t last;         ///< One past the last super-region
+    int num_regions;     ///< Total member SNVs in the batch
+    uint64_t est_bytes = 0;  ///< Sum of the super-regions' est_bytes
+};
+
+/**
+ * @brief Locality-aware planner for per-SNV region processing.
+ *
+ * Sorts SNVs by (chromosome, position), merges overlapping or nearby
+ * windows into super-regions and groups them into chromosome-contiguous
+ * work batches. Chromosomes keep the order in which they first appear in
+ * the input.
+ */
+class RegionScheduler {
+public:
+    /**
+     * @param window_size Half window size around each SNV (±bp).
+     * @param merge_gap Windows closer than this many bp are merged as well.
+     * @param max_span Upper bound on a super-region's length (bp), so that
+     *        long SNV chains (e.g. kataegis) do not pin too many reads in memory.
+     */
+    explicit RegionScheduler(int32_t window_size, int32_t merge_gap = 0, int32_t max_span = 200000);
+
+    /**
+     * @brief Computes the window of a single SNV (start clamped to 1).
+     */
+    void window_of(const SomaticSnv& snv, int32_t& start, int32_t& end) const;
+
+    /**
+     * @brief Builds super-regions from the first @p count SNVs.
+     *
+     * @param snvs SNV list (region ID = index in this list).
+     * @param chr_names Chromosome name for each SNV.
+     * @param count Number of SNVs to schedule (prefix of the list).
+     * @return Super-regions in (chromosome, position) order.
+     */
+    std::vector<SuperRegion> build_super_regions(
+        const std::vector<SomaticSnv>& snvs,
+        const std::vector<std::string>& chr_names,
+        int count
+    ) const;
+
+    /**
+     * @brief Groups super-regions into chromosome-contiguous batches.
+     *
+     * Batches are sized so that there are roughly 4 batches per thread,
+     * which keeps dynamic scheduling balanced without breaking locality.
+     */
+    std::vector<WorkBatch> build_batches(const std::vector<SuperRegion>& super_regions, int num_threads) const;
+
+    /**
+     * @brief Cost-weighted batches, heaviest first.
+     *
+     * Like build_batches(), but batches are cut at about 1/4 per thread of
+     * the total SuperRegion::est_bytes instead of a region count, so a
+     * super-region heavier than that becomes a batch on its own. Batches
+     * are returned in decreasing est_bytes order (longest processing time
+     * first): the dynamic loop starts the stragglers first and fills in
+     * behind them with the light batches. Batches stay chromosome-contiguous.
+     */
+    std::vector<WorkBatch> build_cost_batches(const std::vector<SuperRegion>& super_regions, int num_threads) const;
+
+    /**
+     * @brief Splits batches between NUMA nodes by whole chromosomes.
+     *
+     * Chromosomes are weighted by the est_bytes of their batches (or by
+     * num_regions when nothing was estimated) and assigned heaviest first
+     * to the currently lightest node, so each chromosome's reads and
+     * reference are only touched by one node's workers.
+     *
+     * @return For each node, indices into @p batches in their original order.
+     */
+    static std::vector<std::vector<size_t>> partition_by_node(
+        const std::vector<SuperRegion>& super_regions,
+        const std::vector<WorkBatch>& batches,
+        int num_nodes
+    );
+
+    /**
+     * @brief Adds an SNV to @p cur if its window can be fetched together with it.
+     *
+     * The merge rule shared by build_super_regions() and incremental
+     * (streaming) planners: same chromosome, window start not before the
+     * union's start, within merge_gap of its end and the result within max_span.
+     *
+     * @return true if the SNV was added (fetch_end extended as needed).
+     */
+    bool try_extend(SuperRegion& cur, const SomaticSnv& snv, const std::string& chr_name, int region_id) const;
+
+private:
+    int32_t window_size_;
+    int32_t merge_gap_;
+    int32_t max_span_;
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace InterSubMod {
+
+/**
+ * @brief A genomic range, 1-based and inclusive (samtools region convention).
+ */
+struct GenomicRange {
+    std::string chr;
+    int64_t start = 1;
+    int64_t end = INT64_MAX;  ///< INT64_MAX = to the end of the chromosome
+
+    bool contains(const std::string& c, int64_t pos) const {
+        return c == chr && pos >= start && pos <= end;
+    }
+
+    /**
+     * @brief "chr", or "chr:start-end" when bounded (parseable by htslib).
+     */
+    std::string to_string() const;
+};
+
+/**
+ * @brief Parses a comma-separated region list.
+ *
+ * Each item is "chr", "chr:start" or "chr:start-end"; numbers may use ','
+ * separators and k/M/G suffixes ("chr1:1-50M"). The result is sorted by
+ * (first appearance of the chromosome, start) with overlapping or touching
+ * ranges merged, so every position is selected at most once.
+ *
+ * @throws std::runtime_error on malformed input.
+ */
+std::vector<GenomicRange> parse_region_list(const std::string& spec);
+
+/**
+ * @brief Merges overlapping/touching ranges (same ordering as parse_region_list()).
+ */
+std::vector<GenomicRange> normalize_ranges(std::vector<GenomicRange> ranges);
+
+/**
+ * @brief One shard of a run split over N nodes: shard index of count (1-based).
+ */
+struct ShardSpec {
+    int index = 0;   ///< 1..count; 0 = not sharded
+    int count = 0;
+
+    bool enabled() const { return count > 0; }
+
+    /**
+     * @brief Parses "i/N" with 1 <= i <= N.
+     * @throws std::runtime_error on malformed input.
+     */
+    static ShardSpec parse(const std::string& spec);
+
+    /**
+     * @brief File-name-safe tag, e.g. "part_003_of_016".
+     */
+    std::string tag() const;
+};
+
+/**
+ * @brief Estimated work of one contig.
+ */
+struct ContigWeight {
+    std::string name;
+    int64_t length = 0;
+    double weight = 0.0;   ///< e.g. mapped reads; spread uniformly along the contig
+};
+
+/**
+ * @brief Splits the genome into contiguous shards of roughly equal weight.
+ *
+ * Contigs are laid end to end in the given order and the total weight is
+ * cut into N equal parts; a cut inside a contig maps to a position
+ * proportionally. Every base of every contig belongs to exactly one shard,
+ * so SNV-to-shard assignment (by position) is a partition and does not
+ * depend on where the SNVs are.
+ */
+class ShardPlanner {
+public:
+    /**
+     * @brief Ranges covered by one shard.
+     * @return Empty if the shard covers no bases (more shards than weight).
+     */
+    static std::vector<GenomicRange> plan(const std::vector<ContigWeight>& contigs, const ShardSpec& shard);
+
+    /**
+     * @brief Per-contig mapped read counts from a BAM index (.bai/.csi).
+     *
+     * Falls back to contig length as the weight when the index carries no
+     * read counts.
+     *
+     * @throws std::runtime_error if the BAM or its index cannot be opened.
+     */
+    static std::vector<ContigWeight> weights_from_bam(const std::string& bam_path);
+};
+
+/**
+ * @brief File-name-safe tag for a region selection ("chr1_1-50000000", or a hash if long).
+ */
+std::string region_selection_tag(const std::vector<GenomicRange>& ranges);
+
+} // namespace InterSubMod
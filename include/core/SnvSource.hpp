@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <htslib/vcf.h>
+#include <htslib/tbx.h>
+#include "core/SomaticSnv.hpp"
+#include "core/IntervalIndex.hpp"
+#include "core/ShardPlan.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Counters for one pass over an SNV source.
+ */
+struct SnvSourceStats {
+    size_t records = 0;   ///< Data records seen (VCF records or TSV lines)
+    size_t loaded = 0;    ///< Records returned by next()
+    size_t skipped = 0;   ///< Filtered (non-PASS, not a biallelic SNV) or malformed records
+    size_t outside = 0;   ///< Records scanned but outside the selected regions
+    bool indexed = false; ///< Regions were read by seeking through a .tbi/.csi index
+};
+
+/**
+ * @brief Streaming reader for somatic SNVs from a VCF/BCF or a TSV table.
+ *
+ * Records are produced one at a time, so callers can start scheduling
+ * regions before the whole file has been read. This is the single SNV
+ * ingestion path shared by SomaticSnvTable::load_from_vcf() and
+ * RegionProcessor.
+ *
+ * VCF/BCF (.vcf, .vcf.gz, .bcf): only FILTER=PASS biallelic SNVs are kept.
+ * Records are unpacked with BCF_UN_STR | BCF_UN_FLT only; FORMAT is
+ * unpacked (for AF of the first sample -> somatic_conf) only for records
+ * that pass, and INFO is never unpacked.
+ *
+ * TSV (anything else): `chr  pos  ref  alt  [qual]`, an optional header
+ * line, '#' comments.
+ *
+ * set_regions() restricts the output to genomic ranges. A bgzipped VCF with
+ * a .tbi/.csi (or a BCF with a .csi) is read by seeking to each range, so a
+ * shard only decompresses the blocks it needs; TSV files and unindexed VCFs
+ * fall back to a filtered full scan.
+ *
+ * chr_id comes from the given ChromIndex (VCF header contigs are registered
+ * first, in header order); snv_id counts returned records from 0.
+ *
+ * Usage:
+ *   ChromIndex chroms;
+ *   SnvSource source("somatic.vcf.gz", chroms);
+ *   SomaticSnv snv;
+ *   std::string chr;
+ *   while (source.next(snv, chr)) { ... }
+ *
+ * Not thread-safe; one reader thread per source.
+ */
+class SnvSource {
+public:
+    enum class Format { AUTO, VCF, TSV };
+
+    /**
+     * @param format AUTO picks VCF from the file extension, TSV otherwise.
+     * @throws std::runtime_error if the file (or VCF header) cannot be read.
+     */
+    SnvSource(const std::string& path, ChromIndex& chrom_index, Format format = Format::AUTO);
+    ~SnvSource();
+
+    SnvSource(const SnvSource&) = delete;
+    SnvSource& operator=(const SnvSource&) = delete;
+
+    /**
+     * @brief Reads the next kept SNV.
+     * @return false at end of input.
+     * @throws std::runtime_error on a VCF read error.
+     */
+    bool next(SomaticSnv& snv, std::string& chr_name);
+
+    /**
+     * @brief Keeps only SNVs inside the given ranges; call before the first next().
+     *
+     * Ranges are normalized (sorted per chromosome, merged), so each SNV is
+     * returned at most once. An empty list selects everything.
+     */
+    void set_regions(const std::vector<GenomicRange>& ranges);
+
+    Format format() const { return format_; }
+    const SnvSourceStats& stats() const { return stats_; }
+
+    /**
+     * @brief True if the path looks like a VCF/BCF file.
+     */
+    static bool is_vcf_path(const std::string& path);
+
+private:
+    std::string path_;
+    ChromIndex& chrom_index_;
+    Format format_;
+    SnvSourceStats stats_;
+
+    // VCF
+    htsFile* vcf_;
+    bcf_hdr_t* hdr_;
+    bcf1_t* rec_;
+    float* af_buf_;
+    int af_cap_;
+
+    // Region selection
+    std::vector<GenomicRange> ranges_;
+    IntervalIndex range_filter_;   ///< Linear-scan filter (0-based half-open)
+    tbx_t* tbx_;                   ///< Tabix index (bgzipped VCF)
+    hts_idx_t* bcf_idx_;           ///< CSI index (BCF)
+    hts_itr_t* itr_;
+    size_t next_range_;
+    kstring_t line_buf_;
+
+    // TSV
+    std::ifstream tsv_;
+    bool first_line_;
+    std::string line_;
+
+    bool next_vcf(SomaticSnv& snv, std::string& chr_name);
+    int read_vcf_record();
+    bool selected(const std::string& chr_name, int64_t pos) const;
+    bool next_tsv(SomaticSnv& snv, std::string& chr_name);
+};
+
+} // namespace InterSubMod
@@ -29,6 +29,11 @@ public:
      * @brief Gets the chromosome name for a given ID.
      */
     std::string get_name(int chr_id) const;
+    
+    /**
+     * @brief Number of registered chromosomes.
+     */
+    size_t size() const { return id_to_name_.size(); }
 
 private:
     std::map<std::string, int> name_to_id_;
@@ -78,7 +83,8 @@ public:
     
     /**
      * @brief Loads somatic variants from a VCF file.
-     * Parses the VCF using htslib and populates the table.
+     * Streams the VCF through SnvSource (FILTER=PASS biallelic SNVs) and populates the table.
+     * To overlap loading with processing, use SnvSource directly instead.
      */
     bool load_from_vcf(const std::string& vcf_path, ChromIndex& chrom_index);
 
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "core/BamReader.hpp"
+#include "core/HtsThreadPool.hpp"
+#include "utils/FastaReader.hpp"
+#include "utils/ReferenceCache.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Open/reuse counters for one kind of reader.
+ */
+struct ReaderUsageStats {
+    size_t opens = 0;         ///< Number of times the reader was actually opened
+    size_t acquisitions = 0;  ///< Number of times a region asked for the reader
+
+    /// Opens that would have happened with one reader per region.
+    size_t avoided() const { return acquisitions > opens ? acquisitions - opens : 0; }
+};
+
+/**
+ * @brief Aggregated pool statistics across all thread slots.
+ */
+struct ThreadResourceStats {
+    ReaderUsageStats tumor_bam;
+    ReaderUsageStats normal_bam;
+    ReaderUsageStats fasta;
+    size_t records_reused = 0;     ///< fetch_reads() copies into recycled records (all BAM readers)
+    size_t records_allocated = 0;  ///< fetch_reads() copies that created a record
+
+    size_t total_avoided() const {
+        return tumor_bam.avoided() + normal_bam.avoided() + fasta.avoided();
+    }
+};
+
+/**
+ * @brief Persistent per-thread pool of BAM/FASTA readers.
+ *
+ * Opening a reader costs sam_open + sam_hdr_read + sam_index_load (BAM)
+ * or fai_load (FASTA). Instead of paying that for every region, each
+ * OpenMP thread owns one slot and its readers are opened lazily on first
+ * use, then reused for every region the thread handles.
+ *
+ * Thread-safety:
+ * - A slot must only be accessed by the thread that owns it
+ *   (slot index = omp_get_thread_num()).
+ * - Statistics are per-slot and aggregated by stats(), which must be
+ *   called outside of the parallel region.
+ *
+ * Usage:
+ *   ThreadResourcePool pool(tumor, normal, ref, omp_get_max_threads());
+ *   #pragma omp parallel
+ *   {
+ *       BamReader& bam = pool.tumor_bam(omp_get_thread_num());
+ *       ...
+ *   }
+ */
+class ThreadResourcePool {
+public:
+    /**
+     * @brief Constructs an empty pool; no file is opened until first use.
+     *
+     * @param tumor_bam_path Tumor BAM path (required).
+     * @param normal_bam_path Normal BAM path (empty = no normal BAM).
+     * @param ref_fasta_path Reference FASTA path (required).
+     * @param num_slots Number of thread slots (usually the OpenMP thread count).
+     */
+    ThreadResourcePool(
+        const std::string& tumor_bam_path,
+        const std::string& normal_bam_path,
+        const std::string& ref_fasta_path,
+        int num_slots
+    );
+
+    ThreadResourcePool(const ThreadResourcePool&) = delete;
+    ThreadResourcePool& operator=(const ThreadResourcePool&) = delete;
+
+    /**
+     * @brief Gets the tumor BAM reader of a slot, opening it on first use.
+     * @throws std::runtime_error if the BAM cannot be opened.
+     */
+    BamReader& tumor_bam(int slot);
+
+    /**
+     * @brief Gets the normal BAM reader of a slot, opening it on first use.
+     * @return nullptr if no normal BAM was configured.
+     * @throws std::runtime_error if the BAM cannot be opened.
+     */
+    BamReader* normal_bam(int slot);
+
+    /**
+     * @brief Gets the FASTA reader of a slot, opening it on first use.
+     * @throws std::runtime_error if the FASTA cannot be loaded.
+     */
+    FastaReader& fasta(int slot);
+
+    /**
+     * @brief Shares a chromosome cache with every slot's FastaReader.
+     *
+     * Must be called before the parallel region; readers opened later (and
+     * already-open ones) use the cache for fetch_view() and cpg_bitmap().
+     */
+    void set_reference_cache(std::shared_ptr<ReferenceCache> cache);
+
+    /**
+     * @brief One chromosome cache per NUMA node; a slot's FastaReader uses the
+     *        cache of the slot's node (see set_slot_node()).
+     *
+     * Same rules as set_reference_cache(); an empty vector disables caching.
+     * Nodes beyond the last cache use the last one.
+     */
+    void set_reference_caches(std::vector<std::shared_ptr<ReferenceCache>> caches);
+
+    /**
+     * @brief Assigns a slot to a NUMA node (default 0).
+     *
+     * May be called by the slot's owning thread inside a parallel region.
+     */
+    void set_slot_node(int slot, int node);
+
+    /**
+     * @brief NUMA node of a slot.
+     */
+    int slot_node(int slot) const { return slots_.at(slot).node; }
+
+    /**
+     * @brief Shares one BGZF decompression pool between every slot's tumor and normal BAM readers.
+     *
+     * Must be called before the parallel region, at most once; applies to
+     * readers opened later and to already-open ones. Without it reads are
+     * decompressed inline by the calling thread.
+     *
+     * @throws std::runtime_error if a pool is already set or an open reader cannot attach it.
+     */
+    void set_decompression_pool(std::shared_ptr<HtsThreadPool> pool);
+
+    /**
+     * @brief The shared decompression pool, or nullptr if disabled.
+     */
+    const std::shared_ptr<HtsThreadPool>& decompression_pool() const { return decompression_pool_; }
+
+    /**
+     * @brief HTSlib filter expression for every slot's tumor and normal BAM readers.
+     *
+     * Must be called before the parallel region; applies to readers opened
+     * later and to already-open ones (see BamReader::set_filter_expression()).
+     *
+     * @throws std::runtime_error if an open reader rejects the expression.
+     */
+    void set_read_filter_expression(const std::string& expr);
+
+    /**
+     * @brief The shared chromosome cache, or nullptr if disabled.
+     */
+    std::shared_ptr<ReferenceCache> reference_cache() const {
+        return reference_caches_.empty() ? nullptr : reference_caches_.front();
+    }
+
+    /**
+     * @brief All chromosome caches (one per NUMA node, or a single shared one).
+     */
+    const std::vector<std::shared_ptr<ReferenceCache>>& reference_caches() const { return reference_caches_; }
+
+    /**
+     * @brief Returns true if a normal BAM path was configured.
+     */
+    bool has_normal() const { return !normal_bam_path_.empty(); }
+
+    /**
+     * @brief Number of thread slots.
+     */
+    int num_slots() const { return static_cast<int>(slots_.size()); }
+
+    /**
+     * @brief Aggregates open/reuse counters over all slots.
+     */
+    ThreadResourceStats stats() const;
+
+private:
+    /// One slot per thread; aligned to avoid false sharing of the counters.
+    struct alignas(64) Slot {
+        std::unique_ptr<BamReader> tumor_bam;
+        std::unique_ptr<BamReader> normal_bam;
+        std::unique_ptr<FastaReader> fasta;
+        ThreadResourceStats stats;
+        int node = 0;  ///< NUMA node; selects the reference cache
+    };
+
+    std::string tumor_bam_path_;
+    std::string normal_bam_path_;
+    std::string ref_fasta_path_;
+    std::string read_filter_expression_;
+    std::shared_ptr<HtsThreadPool> decompression_pool_;  ///< Declared before slots_: outlives the readers
+    std::vector<std::shared_ptr<ReferenceCache>> reference_caches_;
+    std::vector<Slot> slots_;
+
+    Slot& slot_at(int slot);
+    const std::shared_ptr<ReferenceCache>& cache_for(const Slot& s) const;
+};
+
+} // namespace InterSubMod
@@ -18,6 +18,17 @@ enum class NanDistanceStrategy {
     SKIP
 };
 
+enum class LinkageMethod {
+    AVERAGE,   ///< UPGMA
+    COMPLETE,
+    WARD
+};
+
+enum class OutputFormat {
+    BINARY,    ///< Append-only .ismr shards (default)
+    CSV        ///< Per-region directory of TSV/CSV files (debug)
+};
+
 enum class AltSupport {
     ALT,
     REF,
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "core/SomaticSnv.hpp"
+#include "core/MatrixBuilder.hpp"
+#include "core/Types.hpp"
+#include "io/BinaryRegionFile.hpp"
+#include "io/CompletionJournal.hpp"
+#include "utils/BoundedQueue.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief 一個已完成、等待寫出的 region（MatrixBuilder 以 move 交給 writer）
+ */
+struct RegionOutput {
+    SomaticSnv snv;
+    int region_id = -1;
+    int32_t region_start = 0;
+    int32_t region_end = 0;
+    MatrixBuilder matrix;
+    double elapsed_ms = 0.0;
+    double peak_memory_mb = 0.0;
+    std::string name;        ///< CSV 子目錄名（空 = region_%04d）
+    std::string chr_name;    ///< SNV 所在染色體（clusters.tsv 用）
+    std::string journal_key; ///< CompletionJournal::region_key()（未啟用 journal 時為空）
+    std::string cluster_rows; ///< 分析階段產生的 clusters.tsv 資料列（region 寫出成功後才附加）
+};
+
+/**
+ * @brief AsyncRegionWriter 的統計資料
+ */
+struct AsyncWriterStats {
+    uint64_t regions_written = 0;
+    uint64_t batches = 0;            ///< pop_batch() 次數（每批 flush 一次）
+    double write_ms = 0.0;           ///< Writer threads 花在序列化/寫檔的總時間
+    int num_writer_threads = 0;
+    Utils::QueueStats queue;
+};
+
+/**
+ * @brief 將 region 輸出從 compute workers 移到專用 writer threads
+ *
+ * Workers 呼叫 submit() 把 finalize 後的 MatrixBuilder 放入有界佇列後立即返回；
+ * writer threads 以 batch 取出、序列化並在每批結束時 flush。
+ * 佇列滿時 submit() 會阻塞（backpressure），因此待寫出的矩陣數量有上限。
+ *
+ * Binary 模式下每個 writer thread 寫自己的 shard
+ * （output_dir/regions[.file_tag].shard_NNN.ismr）；CSV 模式每個 region 一個目錄。
+ * 分散在多個節點執行時，各節點以不同 file_tag 區分，輸出可直接合併到同一目錄。
+ *
+ * 設定 CompletionJournal 後，binary shard 在每批結束時改為 fsync，之後才把該批
+ * 成功寫出的 regions 記錄為 OK，因此 journal 永遠不會領先已落盤的資料。
+ * CSV 模式則在每個 region 寫完後 fsync 其檔案與目錄（RegionWriter::sync_region()）。
+ * open_clusters_file() 的資料列同樣只附加成功寫出的 regions，並在記錄 journal 前 fsync。
+ *
+ * Thread-safety: submit() 可由多個 threads 同時呼叫；close() 只能呼叫一次
+ * （之後的呼叫為 no-op），且必須在所有 submit() 結束後。
+ */
+class AsyncRegionWriter {
+public:
+    /**
+     * @param output_dir 輸出根目錄
+     * @param format 輸出格式
+     * @param dtype Binary 模式的矩陣型別
+     * @param num_writer_threads Writer thread 數量（= binary shard 數量）
+     * @param queue_capacity 佇列最多容納的 regions 數
+     * @param batch_size 每次 flush 前最多寫出的 regions 數
+     * @param file_tag 加在 shard 檔名中的標記（如 "part_003_of_016"），空字串 = 不加
+     * @throws std::runtime_error 無法建立輸出檔時
+     */
+    AsyncRegionWriter(const std::string& output_dir,
+                      OutputFormat format,
+                      BinaryFormat::MatrixDType dtype = BinaryFormat::MatrixDType::FLOAT32,
+                      int num_writer_threads = 1,
+                      size_t queue_capacity = 64,
+                      size_t batch_size = 16,
+                      const std::string& file_tag = "");
+
+    /**
+     * @brief 解構時自動 close()
+     */
+    ~AsyncRegionWriter();
+
+    AsyncRegionWriter(const AsyncRegionWriter&) = delete;
+    AsyncRegionWriter& operator=(const AsyncRegionWriter&) = delete;
+
+    /**
+     * @brief 交出一個 region；佇列滿時阻塞直到 writer 騰出空間
+     * @return false 若 writer 已關閉（region 未被寫出）
+     */
+    bool submit(RegionOutput&& output);
+
+    /**
+     * @brief 記錄完成的 regions 到 journal（nullptr = 停用）；必須在第一次 submit() 前呼叫
+     */
+    void set_journal(CompletionJournal* journal) { journal_ = journal; }
+
+    /**
+     * @brief 建立 clusters TSV（覆寫）並寫入 header；必須在第一次 submit() 前呼叫
+     *
+     * 每批寫出後，把該批成功寫出之 regions 的 RegionOutput::cluster_rows 附加到檔案
+     * （有 journal 時 fsync），之後才記錄 journal，因此 journal 中 OK 的 region 其資料列
+     * 一定已落盤；寫出失敗的 region 不留下資料列。
+     *
+     * @throws std::runtime_error 無法建立檔案時
+     */
+    void open_clusters_file(const std::string& path, const std::string& header);
+
+    /**
+     * @brief 寫完佇列中剩餘的 regions、join writer threads 並關閉所有 shards
+     */
+    void close();
+
+    /**
+     * @brief 寫出失敗的 regions（region_id, 錯誤訊息），close() 後完整
+     */
+    std::vector<std::pair<int, std::string>> errors() const;
+
+    AsyncWriterStats stats() const;
+
+private:
+    std::string output_dir_;
+    OutputFormat format_;
+    BinaryFormat::MatrixDType dtype_;
+    size_t batch_size_;
+    bool closed_;
+    CompletionJournal* journal_;
+
+    Utils::BoundedQueue<RegionOutput> queue_;
+    std::vector<std::unique_ptr<BinaryRegionWriter>> shards_;  ///< 每個 writer thread 一個
+    std::vector<std::thread> threads_;
+
+    std::mutex clusters_mutex_;       ///< 保護 clusters_fp_（writer threads 共用）
+    FILE* clusters_fp_ = nullptr;
+    std::string clusters_path_;
+
+    mutable std::mutex mutex_;  ///< 保護 errors_ 與 stats_
+    std::vector<std::pair<int, std::string>> errors_;
+    AsyncWriterStats stats_;
+
+    void writer_loop(int index);
+    JournalEntry write_one(int index, const RegionOutput& output);
+    void append_cluster_rows(const std::string& rows);
+};
+
+} // namespace InterSubMod
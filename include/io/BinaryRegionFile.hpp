@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/DataStructs.hpp"
+#include "core/SomaticSnv.hpp"
+#include "core/MatrixBuilder.hpp"
+#include "core/MethylQuant.hpp"
+#include "core/ReadTable.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief 二進位 region 輸出格式（.ismr，version 1）
+ *
+ * 取代每個 region 一個目錄、四個文字檔的輸出方式：所有 regions 依序 append 到
+ * 同一個檔案（或每個 worker 一個 shard），結尾附上 region index，可直接 mmap。
+ * 所有整數/浮點數皆為 little-endian，所有陣列起點對齊 64 bytes，
+ * 因此可用 `numpy.frombuffer(mm, dtype, count, offset)` 零拷貝讀取。
+ *
+ * ```
+ * [FileHeader 64B]
+ * [Block 0] [Block 1] ...                    每個 block 起點對齊 64B
+ *    BlockPrelude 64B  ("ISMBLK01", block_size)
+ *    RegionIndexEntry 128B（與 index 內容相同，用於未正常關閉時的 recovery）
+ *    int32   cpg_positions[num_cpgs]         1-based，已排序
+ *    PackedRead reads[num_reads]             32B/read
+ *    char    names[names_size]               read names（不含 '\0'）
+ *    float32 matrix[num_reads * num_cpgs]    row-major，-1.0 = no coverage
+ *      或 uint8 matrix[...]                  round(p*255) clamp 到 254，255 = no coverage
+ * [RegionIndexEntry × num_regions]
+ * [FileTrailer 32B]                          ("ISMIDX01", index_offset, num_regions)
+ * ```
+ *
+ * 對應的 Python reader：scripts/read_binary_regions.py
+ */
+namespace BinaryFormat {
+
+constexpr char kFileMagic[8] = {'I', 'S', 'M', 'R', 'E', 'G', '0', '1'};
+constexpr char kBlockMagic[8] = {'I', 'S', 'M', 'B', 'L', 'K', '0', '1'};
+constexpr char kIndexMagic[8] = {'I', 'S', 'M', 'I', 'D', 'X', '0', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlign = 64;
+
+/// uint8 矩陣中「未覆蓋」的 sentinel（與 Quant::kNoCoverage 相同）
+constexpr uint8_t kQuantNoCoverage = Quant::kNoCoverage;
+
+enum class MatrixDType : uint8_t {
+    FLOAT32 = 0,
+    UINT8 = 1
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;    ///< sizeof(FileHeader)
+    uint64_t index_offset;   ///< 0 = 檔案尚未正常關閉（需掃描 blocks）
+    uint64_t num_regions;
+    uint8_t reserved[32];
+};
+
+struct BlockPrelude {
+    char magic[8];
+    uint64_t block_size;     ///< 含 prelude 與 padding 的 block 總長度
+    uint8_t reserved[48];
+};
+
+/**
+ * @brief 單一 region 的 index 項目（所有 offset 皆為檔案內絕對位置）
+ */
+struct RegionIndexEntry {
+    int32_t region_id;
+    int32_t snv_id;
+    int32_t chr_id;
+    int32_t snv_pos;         ///< 1-based
+    int32_t region_start;    ///< 1-based
+    int32_t region_end;      ///< 1-based
+    int32_t num_reads;
+    int32_t num_cpgs;
+    char ref_base;
+    char alt_base;
+    uint8_t dtype;           ///< MatrixDType
+    uint8_t reserved0;
+    float snv_qual;
+    float elapsed_ms;
+    float peak_memory_mb;
+    uint64_t block_offset;
+    uint64_t block_size;
+    uint64_t cpg_offset;
+    uint64_t reads_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t matrix_offset;
+    uint64_t matrix_size;    ///< bytes
+    uint8_t reserved[16];
+};
+
+/**
+ * @brief 固定長度的 read metadata（name 存在 names blob 中）
+ */
+struct PackedRead {
+    int32_t read_id;
+    int32_t chr_id;
+    int32_t align_start;     ///< 0-based
+    int32_t align_end;       ///< 0-based
+    uint32_t name_offset;    ///< 相對於 names blob 起點
+    uint16_t name_len;
+    uint8_t mapq;            ///< clamp 到 255
+    int8_t hp_tag;           ///< 0 = unknown, 1 = H1, 2 = H2
+    int8_t alt_support;      ///< 0 = ALT, 1 = REF, 2 = UNKNOWN
+    uint8_t is_tumor;
+    uint8_t reserved[6];
+};
+
+struct FileTrailer {
+    char magic[8];
+    uint64_t index_offset;
+    uint64_t num_regions;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(BlockPrelude) == 64, "BlockPrelude layout");
+static_assert(sizeof(RegionIndexEntry) == 128, "RegionIndexEntry layout");
+static_assert(sizeof(PackedRead) == 32, "PackedRead layout");
+static_assert(sizeof(FileTrailer) == 32, "FileTrailer layout");
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Binary region format assumes a little-endian host");
+#endif
+
+/**
+ * @brief 將機率量化為 uint8（-1 / no coverage -> 255），見 Quant::encode
+ */
+inline uint8_t quantize(float p) {
+    return Quant::encode(p);
+}
+
+/**
+ * @brief uint8 還原為機率（255 -> -1.0），見 Quant::decode
+ */
+inline float dequantize(uint8_t q) {
+    return Quant::decode(q);
+}
+
+} // namespace BinaryFormat
+
+/**
+ * @brief Append-only 二進位 region writer
+ *
+ * 每個 region 組成一個 block 後以單次 fwrite 寫出；close() 時寫入 index 與 trailer
+ * 並回填 FileHeader.index_offset。
+ *
+ * Thread-safety: 非 thread-safe；平行寫出時每個 thread 使用自己的 shard。
+ */
+class BinaryRegionWriter {
+public:
+    /**
+     * @brief 建立（覆寫）輸出檔
+     * @throws std::runtime_error 無法開檔時
+     */
+    explicit BinaryRegionWriter(const std::string& path,
+                                BinaryFormat::MatrixDType dtype = BinaryFormat::MatrixDType::FLOAT32);
+
+    /**
+     * @brief 解構時自動 close()
+     */
+    ~BinaryRegionWriter();
+
+    BinaryRegionWriter(const BinaryRegionWriter&) = delete;
+    BinaryRegionWriter& operator=(const BinaryRegionWriter&) = delete;
+
+    /**
+     * @brief Append 一個 region（參數與 RegionWriter::write_region 相同）
+     * @return 整個 block 的 FNV-1a checksum（記錄於 CompletionJournal）
+     * @throws std::runtime_error 寫入失敗時
+     */
+    uint64_t write_region(
+        const SomaticSnv& snv,
+        int region_id,
+        int32_t region_start,
+        int32_t region_end,
+        const ReadTable& reads,
+        const std::vector<int32_t>& cpg_positions,
+        const MatrixView& matrix,
+        double elapsed_ms = 0.0,
+        double peak_memory_mb = 0.0
+    );
+
+    /**
+     * @brief 將已寫出的 blocks 推送到 OS（不寫 index）
+     * @throws std::runtime_error 失敗時
+     */
+    void flush();
+
+    /**
+     * @brief flush() 後再 fsync，確保已寫出的 blocks 落盤
+     * @throws std::runtime_error 失敗時
+     */
+    void sync();
+
+    /**
+     * @brief 寫入 index 與 trailer 並關檔（可重複呼叫）
+     */
+    void close();
+
+    size_t num_regions() const { return index_.size(); }
+    uint64_t bytes_written() const { return offset_; }  ///< 下一個 block 的 offset
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    BinaryFormat::MatrixDType dtype_;
+    FILE* fp_;
+    uint64_t offset_;                                  ///< 目前檔案長度
+    std::vector<BinaryFormat::RegionIndexEntry> index_;
+    std::vector<char> block_;                          ///< 重複使用的 block 暫存
+
+    void write_bytes(const void* data, size_t size);
+};
+
+/**
+ * @brief 以 mmap 讀取 .ismr 檔案的唯讀 reader
+ *
+ * 所有回傳的指標都指向 mapping 本身（零拷貝），生命週期跟隨 reader。
+ * 若檔案沒有 trailer（writer 未正常關閉），會掃描 blocks 重建 index。
+ */
+class BinaryRegionReader {
+public:
+    /**
+     * @throws std::runtime_error 無法開檔、mmap 失敗或格式不符時
+     */
+    explicit BinaryRegionReader(const std::string& path);
+    ~BinaryRegionReader();
+
+    BinaryRegionReader(const BinaryRegionReader&) = delete;
+    BinaryRegionReader& operator=(const BinaryRegionReader&) = delete;
+
+    size_t num_regions() const { return index_.size(); }
+    const BinaryFormat::RegionIndexEntry& entry(size_t i) const { return index_[i]; }
+
+    /**
+     * @brief 依 region_id 查詢
+     * @return nullptr 若不存在
+     */
+    const BinaryFormat::RegionIndexEntry* find(int region_id) const;
+
+    const int32_t* cpg_positions(const BinaryFormat::RegionIndexEntry& e) const;
+    const BinaryFormat::PackedRead* reads(const BinaryFormat::RegionIndexEntry& e) const;
+    std::string_view read_name(const BinaryFormat::RegionIndexEntry& e, int row) const;
+
+    /**
+     * @brief float32 矩陣（dtype 不是 FLOAT32 時回傳 nullptr）
+     */
+    const float* matrix_f32(const BinaryFormat::RegionIndexEntry& e) const;
+
+    /**
+     * @brief uint8 矩陣（dtype 不是 UINT8 時回傳 nullptr）
+     */
+    const uint8_t* matrix_u8(const BinaryFormat::RegionIndexEntry& e) const;
+
+    /**
+     * @brief 讀取單一數值（兩種 dtype 皆可），-1.0 = no coverage
+     */
+    float value(const BinaryFormat::RegionIndexEntry& e, int row, int col) const;
+
+    /**
+     * @brief index 是否由掃描 blocks 重建（檔案未正常關閉）
+     */
+    bool recovered() const { return recovered_; }
+
+private:
+    std::string path_;
+    const uint8_t* data_;
+    size_t size_;
+    std::vector<BinaryFormat::RegionIndexEntry> index_;
+    bool recovered_;
+
+    void scan_blocks();
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/SomaticSnv.hpp"
+#include "utils/Hash.hpp"
+
+namespace InterSubMod {
+
+/**
+ * @brief Journal 的一筆紀錄
+ */
+struct JournalEntry {
+    std::string key;          ///< region_key()：以 SNV 座標識別，與 region_id 無關
+    int region_id = -1;
+    bool success = false;
+    uint64_t checksum = 0;    ///< 輸出內容的 Utils::fnv1a64（binary：整個 block；CSV：CpG 位置 + 矩陣）
+    std::string detail;       ///< 成功：輸出位置（"檔名@offset" 或 CSV 目錄）；失敗：錯誤訊息
+};
+
+/**
+ * @brief 已完成 regions 的 append-only journal，用於中斷後續跑
+ *
+ * 每行一筆紀錄（tab 分隔，detail 中的 tab/換行會被替換為空白）：
+ * ```
+ * OK    <key>  <region_id>  <checksum hex>  <檔名@offset | 目錄>
+ * FAIL  <key>  <region_id>  0               <錯誤訊息>
+ * ```
+ * append() 一次寫入一批紀錄並 fsync，呼叫端應在對應的輸出資料 fsync 之後才記錄，
+ * 因此 journal 中標記 OK 的 region 一定已經在磁碟上。開啟時讀回既有紀錄，
+ * 同一 key 以最後一筆為準；被中斷的最後一行（沒有換行）會被忽略並截掉。
+ *
+ * Thread-safety: append() 與查詢可由多個 threads 同時呼叫。
+ */
+class CompletionJournal {
+public:
+    /**
+     * @param path Journal 檔案路徑
+     * @param resume true：讀回既有紀錄並接續 append；false：清空重來
+     * @throws std::runtime_error 無法開啟或寫入時
+     */
+    CompletionJournal(const std::string& path, bool resume);
+    ~CompletionJournal();
+
+    CompletionJournal(const CompletionJournal&) = delete;
+    CompletionJournal& operator=(const CompletionJournal&) = delete;
+
+    /**
+     * @brief 寫入一批紀錄並 fsync（空的 batch 為 no-op）
+     * @throws std::runtime_error 寫入或 fsync 失敗時
+     */
+    void append(const std::vector<JournalEntry>& entries);
+
+    /**
+     * @brief key 的最後一筆紀錄是否為 OK
+     */
+    bool is_completed(const std::string& key) const;
+
+    size_t num_completed() const;
+    size_t num_failed() const;
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief Region 的穩定識別字串 "chr:pos:ref:alt"
+     */
+    static std::string region_key(const std::string& chr_name, const SomaticSnv& snv);
+
+private:
+    std::string path_;
+    int fd_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, bool> status_;  ///< key -> 最後一筆是否 OK
+
+    void load();
+};
+
+} // namespace InterSubMod
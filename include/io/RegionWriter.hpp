@@ -4,6 +4,8 @@
 #include <vector>
 #include "core/DataStructs.hpp"
 #include "core/SomaticSnv.hpp"
+#include "core/MatrixBuilder.hpp"
+#include "core/ReadTable.hpp"
 
 namespace InterSubMod {
 
@@ -22,6 +24,9 @@ namespace InterSubMod {
  *   region_0001/
  *     ...
  * ```
+ * 
+ * 以 --regions / --shard 分片執行時，子目錄改以 SNV 座標命名
+ * （如 region_chr17_7578000_C_T），各節點的輸出可合併而不衝突。
  */
 class RegionWriter {
 public:
@@ -43,19 +48,33 @@ public:
      * @param matrix 甲基化矩陣（rows=reads, cols=CpGs，-1.0=no coverage）
      * @param elapsed_ms 處理此 region 的時間（毫秒）
      * @param peak_memory_mb 處理此 region 的峰值記憶體（MB）
+     * @param dir_name 子目錄名稱（空字串 = region_%04d，以 region_id 命名）
+     * @return region 子目錄的完整路徑
      */
-    void write_region(
+    std::string write_region(
         const SomaticSnv& snv,
         int region_id,
         int32_t region_start,
         int32_t region_end,
-        const std::vector<ReadInfo>& reads,
+        const ReadTable& reads,
         const std::vector<int32_t>& cpg_positions,
-        const std::vector<std::vector<double>>& matrix,
+        const MatrixView& matrix,
         double elapsed_ms = 0.0,
-        double peak_memory_mb = 0.0
+        double peak_memory_mb = 0.0,
+        const std::string& dir_name = ""
     );
     
+    /**
+     * @brief 將 write_region() 寫出的檔案、region 子目錄與輸出根目錄 fsync 到磁碟
+     * 
+     * CompletionJournal 只能在資料落盤後記錄 OK；有 journal 時由 AsyncRegionWriter 在
+     * 每個 region 寫完後呼叫。
+     * 
+     * @param region_dir write_region() 回傳的子目錄路徑
+     * @throws std::runtime_error 任一檔案或目錄無法開啟或 fsync 時
+     */
+    void sync_region(const std::string& region_dir) const;
+    
 private:
     std::string output_dir_;
     
@@ -63,7 +82,7 @@ private:
      * @brief 建立 region 子目錄
      * @return region 子目錄的完整路徑
      */
-    std::string create_region_dir(int region_id);
+    std::string create_region_dir(int region_id, const std::string& dir_name);
     
     /**
      * @brief 寫出 metadata.txt
@@ -88,7 +107,7 @@ private:
      */
     void write_reads(
         const std::string& region_dir,
-        const std::vector<ReadInfo>& reads
+        const ReadTable& reads
     );
     
     /**
@@ -111,7 +130,7 @@ private:
      */
     void write_matrix_csv(
         const std::string& region_dir,
-        const std::vector<std::vector<double>>& matrix,
+        const MatrixView& matrix,
         const std::vector<int32_t>& cpg_positions
     );
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace InterSubMod {
+
+/**
+ * @brief ShardMerger::merge() 的統計
+ */
+struct MergeStats {
+    size_t shard_files = 0;       ///< 讀入的 .ismr shards
+    size_t recovered_files = 0;   ///< 沒有 trailer（未正常關閉）、由掃描 blocks 重建 index 的 shards
+    size_t regions = 0;           ///< 合併後的 regions（去除重複後）
+    size_t duplicates = 0;        ///< 同一 SNV 出現在多個 shards（resume 重寫）而被略過的 blocks
+    size_t failed = 0;            ///< Journals 中最後一筆為 FAIL 且沒有輸出的 regions
+    size_t cluster_files = 0;
+    size_t cluster_rows = 0;
+    size_t cluster_duplicates = 0; ///< 同一 region 在其他 clusters 檔已有資料列而被略過的列（含截斷的列）
+    uint64_t reads = 0;           ///< 所有 regions 的 reads 總和
+    uint64_t cpgs = 0;            ///< 所有 regions 的 CpG 欄位總和
+};
+
+/**
+ * @brief 把分片執行（--shard、inter_sub_mod_mpi）在同一輸出目錄留下的輸出合併為一份
+ *
+ * 讀取 output_dir 中所有 regions*.ismr、clusters*.tsv 與 completed*.journal
+ * （已合併的 merged.* 除外），寫出：
+ * - merged.index.tsv：每個 region 一行，依 (chr_id, pos, ref, alt) 排序並重新編號 region_id，
+ *   指向所在 shard 檔（相對於 output_dir）與 block offset，可直接以 BinaryRegionReader 讀取
+ * - merged.clusters.tsv：各分片的 clusters 合併，region_id 改為 merged index 的編號
+ *   （沒有對應矩陣的列為 -1）
+ * - merged.summary.json：上述 MergeStats 與每個 shard 的 region 數
+ *
+ * 分片各自的 region_id 只在分片內唯一，因此合併時以 SNV 座標識別 region；
+ * 同一 SNV 出現多次時保留檔名排序最前者。Clusters 列同理：同一 region 只採用一個
+ * clusters 檔的列（列數最多者，同數取檔名排序最前者），欄位數與 header 不符的截斷列略過。
+ * Shards 本身不會被改寫或複製。
+ */
+class ShardMerger {
+public:
+    /**
+     * @param output_dir 分片輸出所在目錄（合併結果也寫在這裡）
+     * @param chr_names chr_id -> 染色體名稱（reference FASTA 順序，與分片配發的 chr_id 一致）
+     */
+    ShardMerger(const std::string& output_dir, std::vector<std::string> chr_names);
+
+    /**
+     * @brief 合併並寫出 merged.*
+     * @throws std::runtime_error 無法讀取 shard 或寫出結果時
+     */
+    MergeStats merge();
+
+    /**
+     * @brief 合併 index 的欄位名稱（merged.index.tsv 的第一行）
+     */
+    static const char* index_header();
+
+private:
+    std::string output_dir_;
+    std::vector<std::string> chr_names_;
+
+    std::string chr_name(int32_t chr_id) const;
+};
+
+} // namespace InterSubMod
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief Monotonic bump allocator for per-region scratch, usable through std::pmr.
+ *
+ * Allocation bumps a pointer inside the current chunk; deallocation is a
+ * no-op. reset() rewinds to the start but keeps the memory, so a thread
+ * that resets its arena between regions stops allocating from the system
+ * once the arena has grown to its largest region:
+ *
+ *   Arena arena;
+ *   for (...) {
+ *       arena.reset();
+ *       std::pmr::vector<int> scratch(&arena);  // no malloc in steady state
+ *   }
+ *
+ * When a region needed more than one chunk, reset() replaces them with a
+ * single chunk of the combined size, so later regions fit contiguously.
+ *
+ * Thread-safety: none; one arena per thread. Containers using it must not
+ * outlive the next reset() (nor be handed to another thread).
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param initial_bytes Size of the first chunk, allocated on first use
+     */
+    explicit Arena(size_t initial_bytes = 1 << 20);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Makes all memory reusable; everything allocated before is invalid afterwards.
+     */
+    void reset();
+
+    /// Bytes handed out since the last reset() (exact, excluding alignment padding)
+    size_t bytes_allocated() const { return allocated_; }
+
+    /// Total size of the chunks currently held
+    size_t capacity() const;
+
+    /// Chunks requested from the system so far (stops growing in steady state)
+    size_t system_allocations() const { return system_allocations_; }
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t initial_bytes_;
+    size_t current_ = 0;             ///< Chunk being bumped
+    size_t offset_ = 0;              ///< Next free byte in chunks_[current_]
+    size_t allocated_ = 0;
+    size_t system_allocations_ = 0;
+
+    void add_chunk(size_t min_bytes);
+    void release_chunks();
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -3,6 +3,7 @@
 #include "core/Config.hpp"
 #include "vendor/CLI11.hpp"
 #include <iostream>
+#include <map>
 
 namespace InterSubMod {
 namespace Utils {
@@ -45,12 +46,92 @@ public:
             
         app.add_option("-o,--output-dir", config.output_dir, "Output Directory (Default: output)");
 
+        std::map<std::string, OutputFormat> format_map{{"binary", OutputFormat::BINARY}, {"csv", OutputFormat::CSV}};
+        app.add_option("--output-format", config.output_format, "Region output format: binary or csv (Default: binary)")
+            ->transform(CLI::CheckedTransformer(format_map, CLI::ignore_case));
+        app.add_flag("--quantize-matrix", config.quantize_matrix,
+                     "Store methylation matrices as uint8 (ML resolution, 1/4 of float32) in memory and in binary output");
+
+        // SNV selection (cluster runs)
+        app.add_option("--regions", config.snv_regions,
+                       "Only SNVs in these ranges, e.g. chr1:1-50M,chr2 (uses the VCF .tbi/.csi index)");
+        app.add_option("--shard", config.shard,
+                       "Only shard i/N (1-based) of the genome, balanced by tumor BAM read depth")
+            ->excludes("--regions");
+        app.add_option("--work-units", config.work_units,
+                       "inter_sub_mod_mpi only: shards rank 0 hands out to worker ranks (Default: 0 = 4 per worker)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_flag("--resume", config.resume,
+                     "Skip regions recorded as completed in the output directory's journal and retry the rest");
+        app.add_option("--telemetry", config.telemetry_prefix,
+                       "Write per-region stage timings to PREFIX.tsv and a run summary to PREFIX.json");
+
         // Parameters
         app.add_option("-w,--window-size", config.window_size_bp, "Window size in bp (Default: 1000)")
             ->check(CLI::PositiveNumber);
             
         app.add_option("-j,--threads", config.threads, "Number of threads (Default: 1)")
             ->check(CLI::PositiveNumber);
+        app.add_option("--hts-threads", config.hts_threads,
+                       "BGZF decompression threads shared by all BAM readers, on top of --threads (Default: 0 = inline)")
+            ->check(CLI::NonNegativeNumber);
+
+        // Read filters
+        app.add_option("--min-mapq", config.min_mapq, "Minimum mapping quality (Default: 20)")
+            ->check(CLI::Range(0, 255));
+        app.add_option("--min-read-length", config.min_read_length, "Minimum read length in bp (Default: 1000)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_option("--min-base-quality", config.min_base_quality,
+                       "Minimum base quality at the SNV for ALT/REF support (Default: 20)")
+            ->check(CLI::Range(0, 93));
+        app.add_option("--read-filter", config.read_filter_expression,
+                       "Extra HTSlib filter expression applied while reading the BAMs, e.g. '[NM] < 500'");
+
+        app.add_option("--pmd-bed", config.pmd_bed_path, "PMD annotation BED; CpGs inside are dropped")
+            ->check(CLI::ExistingFile);
+        app.add_flag("--no-pmd-gating{false}", config.pmd_gating, "Keep CpGs inside PMDs even with --pmd-bed");
+
+        app.add_option("--progress-interval", config.progress_interval_s,
+                       "Seconds between progress lines, 0 disables (Default: 10)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_flag("--verbose", config.verbose, "Log a line for every region (debug level; release builds need -DISM_LOG_MIN_LEVEL=0)");
+
+        app.add_flag("--cache-reference", config.cache_reference,
+                     "Cache whole chromosomes in memory (~1.1 byte/bp per chromosome used)");
+        app.add_option("--methyl-cache-mb", config.methyl_cache_mb,
+                       "Per-thread cache of parsed read methylation calls, reused by overlapping windows (MB, Default: 0 = off)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_option("--max-reads-per-region", config.max_reads_per_region,
+                       "Downsample deeper regions to this many reads, stratified by HP and ALT/REF (Default: 0 = no cap)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_option("--sample-seed", config.sample_seed, "Seed of the deterministic downsampling (Default: 0)");
+        app.add_flag("--cost-schedule", config.cost_schedule,
+                     "Estimate region costs from the BAM index and process the heaviest first");
+        app.add_option("--prefetch", config.prefetch_depth,
+                       "Super-regions each worker fetches ahead on an I/O thread while it computes (Default: 0 = off)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_flag("--numa", config.numa,
+                     "Pin workers per NUMA node (unless OMP_PLACES/OMP_PROC_BIND is set), keep node-local "
+                     "reference/PMD copies and split chromosomes between nodes");
+
+        // Distance / clustering
+        std::map<std::string, DistanceMetricType> metric_map{
+            {"nhd", DistanceMetricType::NHD}, {"l1", DistanceMetricType::L1}, {"l2", DistanceMetricType::L2},
+            {"corr", DistanceMetricType::CORR}, {"jaccard", DistanceMetricType::JACCARD}};
+        app.add_option("--metric", config.distance_metric, "Read distance: nhd, l1, l2, corr or jaccard (Default: nhd)")
+            ->transform(CLI::CheckedTransformer(metric_map, CLI::ignore_case));
+        std::map<std::string, LinkageMethod> linkage_map{
+            {"average", LinkageMethod::AVERAGE}, {"complete", LinkageMethod::COMPLETE}, {"ward", LinkageMethod::WARD}};
+        app.add_option("--linkage", config.linkage_method, "Linkage: average, complete or ward (Default: average)")
+            ->transform(CLI::CheckedTransformer(linkage_map, CLI::ignore_case));
+        app.add_option("--clusters", config.num_clusters,
+                       "Clusters per region written to clusters.tsv, 0 skips clustering (Default: 2)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_option("--min-site-coverage", config.min_site_coverage, "Reads required to keep a CpG column (Default: 5)")
+            ->check(CLI::NonNegativeNumber);
+        app.add_option("--min-common-coverage", config.min_common_coverage,
+                       "Common CpGs required for a read-pair distance (Default: 3)")
+            ->check(CLI::NonNegativeNumber);
 
         // Methylation Thresholds (custom check)
         app.add_option("--methyl-high", config.binary_methyl_high, "Binary methylation high threshold")
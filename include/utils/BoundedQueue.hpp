@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief Counters describing how a BoundedQueue was used.
+ */
+struct QueueStats {
+    uint64_t pushed = 0;          ///< Items accepted
+    uint64_t popped = 0;          ///< Items handed to consumers
+    uint64_t push_stalls = 0;     ///< Pushes that had to wait for space (backpressure)
+    double push_stall_ms = 0.0;   ///< Total time producers spent waiting
+    size_t max_depth = 0;         ///< Highest number of queued items observed
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Blocking, bounded multi-producer queue.
+ *
+ * push() blocks while the queue is full, which throttles producers to the
+ * consumers' pace and bounds the memory held by queued items. After close(),
+ * pushes are rejected and consumers drain the remaining items before pop()
+ * returns false.
+ *
+ * Usage:
+ *   BoundedQueue<Job> q(64);
+ *   // producers: q.push(std::move(job));
+ *   // consumer:  std::vector<Job> batch; while (q.pop_batch(batch, 16)) { ... }
+ *   q.close();
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Enqueues an item, waiting for space if the queue is full.
+     * @return false if the queue was closed (the item is not consumed).
+     */
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.size() >= capacity_ && !closed_) {
+            auto t0 = std::chrono::steady_clock::now();
+            not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+            stats_.push_stalls++;
+            stats_.push_stall_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+        if (closed_) {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        stats_.pushed++;
+        if (items_.size() > stats_.max_depth) {
+            stats_.max_depth = items_.size();
+        }
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Dequeues one item, waiting until one is available.
+     * @return false once the queue is closed and empty.
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        stats_.popped++;
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Waits for at least one item, then takes up to max_items.
+     * @param batch Output (cleared first).
+     * @return false once the queue is closed and empty.
+     */
+    bool pop_batch(std::vector<T>& batch, size_t max_items) {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        while (!items_.empty() && batch.size() < max_items) {
+            batch.push_back(std::move(items_.front()));
+            items_.pop_front();
+        }
+        stats_.popped += batch.size();
+        lock.unlock();
+        not_full_.notify_all();
+        return true;
+    }
+
+    /**
+     * @brief Rejects further pushes and wakes all waiting threads.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    QueueStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        QueueStats s = stats_;
+        s.capacity = capacity_;
+        return s;
+    }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    QueueStats stats_;
+};
+
+} // namespace Utils
+} // namespace InterSubMod
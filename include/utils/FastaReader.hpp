@@ -1,10 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <htslib/faidx.h>
 
 namespace InterSubMod {
 
+class ReferenceCache;
+class CpGBitmap;
+
 /**
  * @brief RAII wrapper for FASTA file reading with HTSlib.
  * 
@@ -14,9 +20,16 @@ namespace InterSubMod {
  * Thread-safety: faidx operations are generally thread-safe for read operations,
  * but each thread should ideally have its own FastaReader instance.
  * 
+ * Cache mode: after set_cache(), fetch_view() returns views into a shared
+ * ReferenceCache (each chromosome decoded and uppercased once per process)
+ * and cpg_bitmap() exposes its precomputed CpG bitmap.
+ * 
  * Usage:
  *   FastaReader fasta("hg38.fa");
  *   std::string seq = fasta.fetch_sequence("chr17", 7577000, 7579000);
+ * 
+ *   fasta.set_cache(std::make_shared<ReferenceCache>("hg38.fa"));
+ *   std::string_view view = fasta.fetch_view("chr17", 7577000, 7579000);
  */
 class FastaReader {
 public:
@@ -51,6 +64,28 @@ public:
      */
     std::string fetch_sequence(const std::string& chr, int32_t start, int32_t end);
     
+    /**
+     * @brief Zero-copy variant of fetch_sequence().
+     * 
+     * In cache mode the view points into the shared ReferenceCache and stays
+     * valid for the cache's lifetime. Otherwise it points into an internal
+     * buffer that is overwritten by the next fetch_view() call.
+     * 
+     * @return Uppercase sequence view (same range rules as fetch_sequence()).
+     */
+    std::string_view fetch_view(const std::string& chr, int32_t start, int32_t end);
+    
+    /**
+     * @brief Attaches a shared chromosome cache (nullptr = disable cache mode).
+     */
+    void set_cache(std::shared_ptr<ReferenceCache> cache) { cache_ = std::move(cache); }
+    
+    /**
+     * @brief Gets the CpG bitmap of a chromosome (0-based positions).
+     * @return nullptr if not in cache mode or the chromosome is unknown.
+     */
+    const CpGBitmap* cpg_bitmap(const std::string& chr);
+    
     /**
      * @brief Gets the length of a chromosome.
      * @param chr Chromosome name.
@@ -58,6 +93,11 @@ public:
      */
     int64_t get_chr_length(const std::string& chr) const;
     
+    /**
+     * @brief Lists the sequence names in .fai order.
+     */
+    std::vector<std::string> chromosome_names() const;
+    
     /**
      * @brief Checks if the FASTA file was successfully loaded.
      */
@@ -71,6 +111,8 @@ public:
 private:
     std::string fasta_path_;
     faidx_t* fai_;
+    std::shared_ptr<ReferenceCache> cache_;
+    std::string buffer_;  ///< Backing store of fetch_view() without a cache
 };
 
 } // namespace InterSubMod
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace InterSubMod {
+namespace Utils {
+
+constexpr uint64_t kFnv1a64Offset = 14695981039346656037ULL;
+constexpr uint64_t kFnv1a64Prime = 1099511628211ULL;
+
+/**
+ * @brief 64-bit FNV-1a; pass a previous result as @p h to hash in pieces.
+ *
+ * Fixed across platforms and standard libraries (unlike std::hash), so it
+ * backs everything that must reproduce between runs: output checksums,
+ * shard file tags and the downsampling keys.
+ */
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t h = kFnv1a64Offset) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * kFnv1a64Prime;
+    }
+    return h;
+}
+
+inline uint64_t fnv1a64(std::string_view s, uint64_t h = kFnv1a64Offset) {
+    return fnv1a64(s.data(), s.size(), h);
+}
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -1,10 +1,14 @@
 #pragma once
 
-#include <string>
-#include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace InterSubMod {
@@ -18,7 +22,36 @@ enum class LogLevel {
 };
 
 /**
- * @brief specific logger class that supports console and file output with different log levels.
+ * @brief Lowest level compiled in. Messages below it are removed at compile time.
+ *
+ * Defaults to L_INFO in NDEBUG (release) builds and L_DEBUG otherwise; override with
+ * -DISM_LOG_MIN_LEVEL=0..3 (e.g. to keep --verbose region lines in a release build).
+ */
+#ifndef ISM_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define ISM_LOG_MIN_LEVEL 1
+#else
+#define ISM_LOG_MIN_LEVEL 0
+#endif
+#endif
+constexpr LogLevel kMinCompiledLogLevel = static_cast<LogLevel>(ISM_LOG_MIN_LEVEL);
+
+/**
+ * @brief Logger with console and optional file output, buffered per thread.
+ *
+ * log() never takes a lock: each thread appends to its own fixed-size
+ * single-producer ring, and a background thread drains all rings every
+ * few milliseconds, orders messages by time, formats and writes them.
+ * When a thread's ring is full the message is dropped and counted; the
+ * flush thread reports the number of dropped messages. Errors wake the
+ * flush thread immediately.
+ *
+ * Messages below kMinCompiledLogLevel cost nothing: debug() and enabled()
+ * fold to no-ops, so guarded `if (Logger::enabled(...)) { ... }` blocks
+ * (and the ISM_LOG_DEBUG macro) are removed by the compiler.
+ *
+ * flush() blocks until everything logged so far has been written; it runs
+ * automatically at process exit.
  */
 class Logger {
 public:
@@ -26,43 +59,112 @@ public:
 
     void set_log_level(LogLevel level);
     void set_log_file(const std::string& filename);
-    
+
     void log(LogLevel level, const std::string& message);
-    
-    // Template for variadic arguments formatting if needed, 
-    // but keeping it simple with string for now or use a helper.
-    
+
+    /**
+     * @brief Whether messages at this level are emitted (no lock; check before
+     *        formatting expensive messages on hot paths).
+     */
+    static bool enabled(LogLevel level) {
+        if (level < kMinCompiledLogLevel) {
+            return false;
+        }
+        return level >= instance().current_level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Appends to the calling thread's message under construction; end_log() emits it.
+     */
     template<typename T>
     Logger& operator<<(const T& msg) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        buffer_ << msg;
+        pending_stream() << msg;
         return *this;
     }
 
-    // Flush buffer with a specific level
+    /**
+     * @brief Emits the message built with operator<< on this thread.
+     */
     void end_log(LogLevel level);
 
+    /**
+     * @brief Writes every message logged so far (by any thread) before returning.
+     */
+    void flush();
+
+    /**
+     * @brief Messages dropped because a thread's ring was full.
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
     // Helper methods for quick logging
-    static void debug(const std::string& msg);
+    static void debug(const std::string& msg) {
+        if (kMinCompiledLogLevel <= LogLevel::L_DEBUG) {
+            instance().log(LogLevel::L_DEBUG, msg);
+        }
+    }
     static void info(const std::string& msg);
     static void warning(const std::string& msg);
     static void error(const std::string& msg);
 
+    /// Messages each thread can buffer before further messages are dropped
+    static constexpr size_t kRingCapacity = 1024;
+
 private:
-    Logger() = default;
+    Logger();
     ~Logger();
-    
+
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
-    LogLevel current_level_ = LogLevel::L_INFO;
+    struct Entry {
+        int64_t time_us = 0;   ///< system_clock, microseconds since epoch
+        LogLevel level = LogLevel::L_INFO;
+        std::string message;
+    };
+
+    /**
+     * @brief Single-producer (owning thread) / single-consumer (flush thread) ring.
+     */
+    struct ThreadRing {
+        Entry slots[kRingCapacity];
+        alignas(64) std::atomic<uint64_t> head{0};  ///< Next slot to write (producer)
+        alignas(64) std::atomic<uint64_t> tail{0};  ///< Next slot to read (consumer)
+        std::atomic<bool> retired{false};           ///< Owning thread exited
+    };
+
+    std::atomic<LogLevel> current_level_{LogLevel::L_INFO};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex rings_mutex_;                          ///< Guards rings_ (thread registration)
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+
+    std::mutex io_mutex_;                             ///< Guards the log file and draining
     std::ofstream log_file_;
-    std::mutex mutex_;
-    std::stringstream buffer_;
-    
+    uint64_t reported_dropped_ = 0;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool wake_requested_ = false;
+    std::thread flusher_;
+
     std::string level_to_string(LogLevel level);
+    ThreadRing& thread_ring();
+    static std::ostringstream& pending_stream();
+    void drain();
+    void flusher_loop();
 };
 
 } // namespace Utils
 } // namespace InterSubMod
 
+/**
+ * @brief Debug log whose argument is not even evaluated when debug logging is
+ *        compiled out or disabled at runtime.
+ */
+#define ISM_LOG_DEBUG(msg_expr)                                                           \
+    do {                                                                                  \
+        if (::InterSubMod::Utils::Logger::enabled(::InterSubMod::Utils::LogLevel::L_DEBUG)) \
+            ::InterSubMod::Utils::Logger::debug(msg_expr);                                \
+    } while (0)
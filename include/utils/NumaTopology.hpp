@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief NUMA nodes of this machine and the CPUs this process may use on each.
+ *
+ * Read from /sys/devices/system/node/node<N>/cpulist (no libnuma needed) and
+ * intersected with the process's affinity mask, so cgroup/taskset limits are
+ * respected; nodes without usable CPUs (memory-only nodes) are dropped.
+ * Without sysfs NUMA information the machine is one node with every allowed CPU.
+ *
+ * Memory placement relies on first touch: a buffer filled by a thread pinned
+ * to node N gets its pages on node N, so per-node replicas only need to be
+ * built by one of that node's threads.
+ */
+class NumaTopology {
+public:
+    /**
+     * @brief Detects the topology of the running machine.
+     */
+    static NumaTopology detect();
+
+    /**
+     * @brief Builds a topology from explicit per-node CPU lists (tests).
+     */
+    explicit NumaTopology(std::vector<std::vector<int>> node_cpus);
+
+    int num_nodes() const { return static_cast<int>(node_cpus_.size()); }
+
+    /**
+     * @brief Usable CPUs of a node, ascending.
+     */
+    const std::vector<int>& cpus(int node) const { return node_cpus_[node]; }
+
+    /**
+     * @brief Node index of a CPU (0 if unknown).
+     */
+    int node_of_cpu(int cpu) const;
+
+    /**
+     * @brief Node of the CPU the calling thread is running on right now.
+     */
+    int current_node() const;
+
+    /**
+     * @brief Node for OpenMP thread t of n: contiguous blocks of threads per node.
+     */
+    int node_for_thread(int t, int n) const;
+
+    /**
+     * @brief Parses a kernel CPU list, e.g. "0-3,8,10-11".
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+    /**
+     * @brief True if OMP_PLACES or OMP_PROC_BIND (other than "false") is set:
+     *        the OpenMP runtime places threads and they must not be re-pinned.
+     */
+    static bool omp_binding_requested();
+
+    /**
+     * @brief Restricts the calling thread to the given CPUs.
+     * @return false if the affinity call failed (the thread keeps its mask).
+     */
+    static bool pin_current_thread(const std::vector<int>& cpus);
+
+private:
+    std::vector<std::vector<int>> node_cpus_;
+};
+
+} // namespace Utils
+} // namespace InterSubMod
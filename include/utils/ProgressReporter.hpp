@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief Throttled progress line for long parallel loops.
+ *
+ * Workers only bump atomic counters (record()), so reporting never
+ * serializes them. One background thread wakes every interval and prints
+ *
+ *   [regions] 1200/5000 (24.0%), 85.3/s, ETA 44s, 3 failed
+ *
+ * When the total is still growing (streaming input: construct with 0 and
+ * add_total() as items are discovered), it is shown as "1500+" and there is
+ * no ETA until finish_total() is called.
+ *
+ * Usage:
+ *   ProgressReporter progress("regions", n, 10.0);
+ *   // workers: progress.record(ok);
+ *   progress.stop();  // final line
+ */
+class ProgressReporter {
+public:
+    /**
+     * @param label Prefix of every line
+     * @param total Expected number of items; 0 = not known yet (see add_total())
+     * @param interval_s Seconds between lines; <= 0 disables the thread and all output
+     * @param out Destination stream (written only by the reporter thread and stop())
+     */
+    ProgressReporter(const std::string& label, uint64_t total, double interval_s, std::ostream& out = std::cout);
+
+    /**
+     * @brief Stops the reporter thread (prints the final line).
+     */
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    /**
+     * @brief Counts one finished item; safe from any thread, lock-free.
+     */
+    void record(bool success) {
+        done_.fetch_add(1, std::memory_order_relaxed);
+        if (!success) {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Adds items discovered after construction (streaming input).
+     */
+    void add_total(uint64_t n) { total_.fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     * @brief Marks the total as final (enables the ETA).
+     */
+    void finish_total() { total_known_.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Joins the reporter thread and prints the final line; idempotent.
+     */
+    void stop();
+
+    uint64_t done() const { return done_.load(std::memory_order_relaxed); }
+    uint64_t failed() const { return failed_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief The current progress line (without a newline).
+     */
+    std::string format_line() const;
+
+private:
+    std::string label_;
+    double interval_s_;
+    std::ostream& out_;
+    std::chrono::steady_clock::time_point start_;
+
+    // Written by workers; kept off the line holding the reporter's state
+    alignas(64) std::atomic<uint64_t> done_{0};
+    alignas(64) std::atomic<uint64_t> failed_{0};
+    alignas(64) std::atomic<uint64_t> total_;
+    std::atomic<bool> total_known_;
+
+    std::mutex mutex_;               ///< Only for the reporter's sleep / stop handshake
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool stopped_ = false;
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace InterSubMod {
+
+/**
+ * @brief One bit per reference position, set where a CpG dinucleotide starts.
+ *
+ * Bit p is set iff seq[p] == 'C' and seq[p + 1] == 'G' (uppercase input).
+ * Costs length/8 bytes, e.g. ~31 MB for chr1.
+ */
+class CpGBitmap {
+public:
+    CpGBitmap() = default;
+
+    /**
+     * @brief Builds the bitmap for an uppercase sequence.
+     */
+    explicit CpGBitmap(std::string_view seq);
+
+    /**
+     * @brief Returns true if a CpG starts at 0-based position pos.
+     */
+    bool test(int64_t pos) const {
+        if (pos < 0 || pos >= length_) return false;
+        return (bits_[static_cast<size_t>(pos) >> 6] >> (pos & 63)) & 1u;
+    }
+
+    /**
+     * @brief Number of CpG sites in the sequence.
+     */
+    size_t count() const;
+
+    int64_t length() const { return length_; }
+    size_t bytes() const { return bits_.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> bits_;
+    int64_t length_ = 0;
+};
+
+/**
+ * @brief A fully decoded, uppercased chromosome.
+ */
+struct CachedChromosome {
+    std::string name;
+    std::string seq;   ///< Uppercase A/C/G/T/N, index = 0-based position
+    CpGBitmap cpg;
+};
+
+/**
+ * @brief Process-wide, read-only cache of whole chromosomes.
+ *
+ * Each chromosome is decompressed and uppercased once, on first request, and
+ * then shared by all threads; fetches become a std::string_view into the
+ * cached buffer instead of a faidx decode + copy + toupper per region.
+ * Chromosomes are never evicted, so expect roughly 1 byte/bp plus 1 bit/bp
+ * for the CpG bitmap for every chromosome touched (~3.5 GB for all of hg38).
+ *
+ * Thread-safety: all methods are thread-safe. Different chromosomes load in
+ * parallel (each load opens its own faidx handle); concurrent requests for
+ * the same chromosome wait for the single load. Returned pointers and views
+ * stay valid for the lifetime of the cache.
+ *
+ * Usage:
+ *   auto cache = std::make_shared<ReferenceCache>("hg38.fa");
+ *   std::string_view seq = cache->fetch("chr17", 7577000, 7579000);
+ *   bool cpg = cache->chromosome("chr17")->cpg.test(7577123);
+ */
+class ReferenceCache {
+public:
+    /**
+     * @param fasta_path Path to the FASTA file (must have a .fai index).
+     * @throws std::runtime_error if the index cannot be loaded.
+     */
+    explicit ReferenceCache(const std::string& fasta_path);
+
+    ReferenceCache(const ReferenceCache&) = delete;
+    ReferenceCache& operator=(const ReferenceCache&) = delete;
+
+    /**
+     * @brief Gets a chromosome, loading it on first use.
+     * @return nullptr if the chromosome is not in the FASTA.
+     * @throws std::runtime_error if decoding fails.
+     */
+    const CachedChromosome* chromosome(const std::string& chr);
+
+    /**
+     * @brief Same contract as FastaReader::fetch_sequence, without the copy.
+     *
+     * @param start 0-based inclusive start.
+     * @param end 0-based exclusive end (clamped to the chromosome length).
+     * @return View into the cached chromosome; empty if invalid.
+     */
+    std::string_view fetch(const std::string& chr, int32_t start, int32_t end);
+
+    /**
+     * @brief Number of chromosomes loaded so far.
+     */
+    size_t num_loaded() const { return num_loaded_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Bytes held by loaded sequences and bitmaps.
+     */
+    size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+    const std::string& get_path() const { return fasta_path_; }
+
+private:
+    struct Entry {
+        std::once_flag once;
+        std::unique_ptr<CachedChromosome> chrom;
+    };
+
+    std::string fasta_path_;
+    std::mutex mutex_;  ///< Guards entries_ (not the loads themselves)
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+    std::atomic<size_t> num_loaded_{0};
+    std::atomic<size_t> bytes_{0};
+
+    std::unique_ptr<CachedChromosome> load(const std::string& chr) const;
+};
+
+} // namespace InterSubMod
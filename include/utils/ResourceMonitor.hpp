@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <iomanip>
@@ -43,7 +44,27 @@ public:
 #endif
         return allocated;
     }
-    
+
+    /**
+     * @brief Bytes allocated so far by the calling thread (monotonic; 0 without jemalloc).
+     *
+     * Reads jemalloc's per-thread counter through a cached pointer, so it is
+     * cheap enough to call per region: the difference of two calls is what
+     * this thread allocated in between, unaffected by other threads.
+     */
+    static uint64_t thread_allocated_bytes() {
+#ifdef USE_JEMALLOC
+        thread_local uint64_t* counter = [] {
+            uint64_t* p = nullptr;
+            size_t sz = sizeof(p);
+            return mallctl("thread.allocatedp", &p, &sz, NULL, 0) == 0 ? p : nullptr;
+        }();
+        return counter ? *counter : 0;
+#else
+        return 0;
+#endif
+    }
+
     void print_stats(const std::string& label = "Execution") const {
         double time = get_elapsed_seconds();
         size_t mem = get_memory_usage();
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief 4-bit nucleotide codes used by BAM packed sequences (seq_nt16).
+ */
+enum Nt16 : uint8_t {
+    NT16_A = 1,
+    NT16_C = 2,
+    NT16_G = 4,
+    NT16_T = 8,
+    NT16_N = 15
+};
+
+/**
+ * @brief Finds all bases with a given 4-bit code in a BAM packed sequence.
+ *
+ * Works directly on the nibble array returned by bam_get_seq() (two bases
+ * per byte, high nibble first), 64 bases per step on AVX2 and 32 on NEON,
+ * with a scalar fallback. The kernel is selected once at runtime from the
+ * CPU features, so binaries built without -march=native still use AVX2
+ * where available.
+ *
+ * @param packed Packed sequence (bam_get_seq(b)).
+ * @param len Number of bases (b->core.l_qseq).
+ * @param code Nibble to search for (e.g. NT16_C).
+ * @param positions Output 0-based read positions in increasing order (cleared first).
+ * @return Number of positions found.
+ */
+size_t find_bases(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions);
+
+/**
+ * @brief Name of the kernel find_bases() dispatches to ("avx2", "neon" or "scalar").
+ */
+const char* seq_scan_kernel_name();
+
+/**
+ * @brief Reference scalar implementation (used for the tail and for testing).
+ */
+size_t find_bases_scalar(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions);
+
+} // namespace Utils
+} // namespace InterSubMod
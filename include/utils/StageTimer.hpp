@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace InterSubMod {
+namespace Utils {
+
+/**
+ * @brief Hot-path stages of region processing.
+ */
+enum class Stage : int {
+    BAM_FETCH = 0,  ///< Index seeks and record decoding (tumor + normal)
+    REF_FETCH,      ///< Reference window and CpG bitmap lookup
+    FILTER,         ///< ReadParser::should_keep()
+    PARSE,          ///< ReadInfo + MM/ML parsing and MatrixBuilder::add_read()
+    FINALIZE,       ///< MatrixBuilder::finalize()
+    WRITE,          ///< Hand-off to the writer (submit, including backpressure waits)
+    COUNT
+};
+
+constexpr size_t kNumStages = static_cast<size_t>(Stage::COUNT);
+
+/**
+ * @brief Short stable name for a stage ("bam_fetch", ...), used as a column/key in telemetry.
+ */
+inline const char* stage_name(Stage stage) {
+    static const char* const names[kNumStages] = {
+        "bam_fetch", "ref_fetch", "filter", "parse", "finalize", "write"};
+    return names[static_cast<size_t>(stage)];
+}
+
+/**
+ * @brief Milliseconds spent per stage.
+ *
+ * Plain accumulator with no synchronization: each thread fills its own
+ * instance and instances are summed with += after the parallel section.
+ */
+struct StageTimes {
+    std::array<double, kNumStages> ms{};
+
+    double& operator[](Stage stage) { return ms[static_cast<size_t>(stage)]; }
+    double operator[](Stage stage) const { return ms[static_cast<size_t>(stage)]; }
+
+    StageTimes& operator+=(const StageTimes& other) {
+        for (size_t i = 0; i < kNumStages; i++) {
+            ms[i] += other.ms[i];
+        }
+        return *this;
+    }
+
+    double total() const {
+        double sum = 0.0;
+        for (double v : ms) sum += v;
+        return sum;
+    }
+};
+
+/**
+ * @brief Adds the lifetime of the scope to one accumulator (two steady_clock reads).
+ *
+ * Usage:
+ *   { ScopedStageTimer t(times[Stage::FINALIZE]); builder.finalize(); }
+ */
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(double& accumulator_ms)
+        : accumulator_ms_(accumulator_ms), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStageTimer() {
+        accumulator_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    double& accumulator_ms_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace Utils
+} // namespace InterSubMod
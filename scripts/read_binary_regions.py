@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Reader for InterSubMod binary region shards (.ismr, version 1).
+
+Layout is documented in include/io/BinaryRegionFile.hpp. All arrays are
+little-endian and 64-byte aligned, so they are returned as zero-copy numpy
+views over an mmap of the file.
+
+Usage:
+    python3 read_binary_regions.py output/regions.shard_000.ismr [region_id]
+
+    from read_binary_regions import RegionFile
+    with RegionFile("output/regions.shard_000.ismr") as f:
+        for entry in f.index:
+            region = f.region(entry)
+            region["matrix"]  # (num_reads, num_cpgs) float32, NaN = no coverage
+"""
+
+import mmap
+import sys
+
+import numpy as np
+
+FILE_MAGIC = b"ISMREG01"
+BLOCK_MAGIC = b"ISMBLK01"
+INDEX_MAGIC = b"ISMIDX01"
+
+HEADER_DTYPE = np.dtype([
+    ("magic", "S8"), ("version", "<u4"), ("header_size", "<u4"),
+    ("index_offset", "<u8"), ("num_regions", "<u8"), ("reserved", "V32"),
+])
+
+PRELUDE_DTYPE = np.dtype([("magic", "S8"), ("block_size", "<u8"), ("reserved", "V48")])
+
+INDEX_DTYPE = np.dtype([
+    ("region_id", "<i4"), ("snv_id", "<i4"), ("chr_id", "<i4"), ("snv_pos", "<i4"),
+    ("region_start", "<i4"), ("region_end", "<i4"), ("num_reads", "<i4"), ("num_cpgs", "<i4"),
+    ("ref_base", "S1"), ("alt_base", "S1"), ("dtype", "u1"), ("reserved0", "u1"),
+    ("snv_qual", "<f4"), ("elapsed_ms", "<f4"), ("peak_memory_mb", "<f4"),
+    ("block_offset", "<u8"), ("block_size", "<u8"),
+    ("cpg_offset", "<u8"), ("reads_offset", "<u8"),
+    ("names_offset", "<u8"), ("names_size", "<u8"),
+    ("matrix_offset", "<u8"), ("matrix_size", "<u8"),
+    ("reserved", "V16"),
+])
+
+READ_DTYPE = np.dtype([
+    ("read_id", "<i4"), ("chr_id", "<i4"), ("align_start", "<i4"), ("align_end", "<i4"),
+    ("name_offset", "<u4"), ("name_len", "<u2"), ("mapq", "u1"), ("hp_tag", "i1"),
+    ("alt_support", "i1"), ("is_tumor", "u1"), ("reserved", "V6"),
+])
+
+TRAILER_DTYPE = np.dtype([
+    ("magic", "S8"), ("index_offset", "<u8"), ("num_regions", "<u8"), ("reserved", "<u8"),
+])
+
+assert HEADER_DTYPE.itemsize == 64 and INDEX_DTYPE.itemsize == 128
+assert READ_DTYPE.itemsize == 32 and TRAILER_DTYPE.itemsize == 32
+
+ALT_SUPPORT = {0: "ALT", 1: "REF", 2: "UNKNOWN"}
+
+
+class RegionFile:
+    def __init__(self, path):
+        self._fh = open(path, "rb")
+        self.buf = mmap.mmap(self._fh.fileno(), 0, access=mmap.ACCESS_READ)
+
+        header = np.frombuffer(self.buf, HEADER_DTYPE, count=1)[0]
+        if header["magic"] != FILE_MAGIC or header["version"] != 1:
+            raise ValueError(f"{path}: not an .ismr v1 file")
+
+        trailer = np.frombuffer(self.buf, TRAILER_DTYPE, count=1, offset=len(self.buf) - TRAILER_DTYPE.itemsize)[0]
+        if trailer["magic"] == INDEX_MAGIC:
+            self.index = np.frombuffer(self.buf, INDEX_DTYPE, count=int(trailer["num_regions"]),
+                                       offset=int(trailer["index_offset"]))
+            self.recovered = False
+        else:
+            self.index = self._scan_blocks()
+            self.recovered = True
+
+    def _scan_blocks(self):
+        entries = []
+        pos = HEADER_DTYPE.itemsize
+        min_block = PRELUDE_DTYPE.itemsize + INDEX_DTYPE.itemsize
+        while pos + min_block <= len(self.buf):
+            prelude = np.frombuffer(self.buf, PRELUDE_DTYPE, count=1, offset=pos)[0]
+            size = int(prelude["block_size"])
+            if prelude["magic"] != BLOCK_MAGIC or size == 0 or pos + size > len(self.buf):
+                break
+            entries.append(np.frombuffer(self.buf, INDEX_DTYPE, count=1, offset=pos + PRELUDE_DTYPE.itemsize)[0])
+            pos += size
+        return np.array(entries, dtype=INDEX_DTYPE)
+
+    def find(self, region_id):
+        hits = np.nonzero(self.index["region_id"] == region_id)[0]
+        return self.index[hits[0]] if len(hits) else None
+
+    def region(self, entry):
+        n_reads, n_cpgs = int(entry["num_reads"]), int(entry["num_cpgs"])
+        cpgs = np.frombuffer(self.buf, "<i4", count=n_cpgs, offset=int(entry["cpg_offset"]))
+        reads = np.frombuffer(self.buf, READ_DTYPE, count=n_reads, offset=int(entry["reads_offset"]))
+        names_blob = self.buf[int(entry["names_offset"]):int(entry["names_offset"] + entry["names_size"])]
+        names = [names_blob[r["name_offset"]:r["name_offset"] + r["name_len"]].decode() for r in reads]
+
+        count = n_reads * n_cpgs
+        if entry["dtype"] == 0:
+            raw = np.frombuffer(self.buf, "<f4", count=count, offset=int(entry["matrix_offset"]))
+            matrix = np.where(raw < 0, np.nan, raw)
+        else:
+            raw = np.frombuffer(self.buf, "u1", count=count, offset=int(entry["matrix_offset"]))
+            matrix = np.where(raw == 255, np.nan, raw / 255.0).astype(np.float32)
+
+        return {
+            "region_id": int(entry["region_id"]),
+            "cpg_positions": cpgs,
+            "reads": reads,
+            "read_names": names,
+            "raw_matrix": raw.reshape(n_reads, n_cpgs),
+            "matrix": matrix.reshape(n_reads, n_cpgs),
+        }
+
+    def close(self):
+        self.buf.close()
+        self._fh.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+    with RegionFile(argv[1]) as f:
+        print(f"{argv[1]}: {len(f.index)} regions{' (recovered by block scan)' if f.recovered else ''}")
+        entries = [f.find(int(argv[2]))] if len(argv) > 2 else f.index
+        for e in entries:
+            if e is None:
+                print("region not found")
+                return 1
+            r = f.region(e)
+            print(f"region {r['region_id']}: chr{e['chr_id']}:{e['region_start']}-{e['region_end']} "
+                  f"SNV {e['snv_pos']} {e['ref_base'].decode()}>{e['alt_base'].decode()} "
+                  f"{e['num_reads']} reads x {e['num_cpgs']} CpGs")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -83,7 +83,7 @@ fi
 echo "    Starting execution with ${THREADS} threads..."
 echo "    (This may take a few minutes...)"
 {
-    /usr/bin/time -v "${EXECUTABLE}" "${TEMP_TSV}" "${OUTPUT_DIR}" "${THREADS}"
+    /usr/bin/time -v "${EXECUTABLE}" "${TEMP_TSV}" "${OUTPUT_DIR}" "${THREADS}" csv
 } 2>&1 | tee "${LOG_FILE}"
 
 # Step 3: Basic Verification
@@ -89,7 +89,7 @@ fi
 # -v: verbose (gives memory, time, etc.)
 echo "    Starting execution with ${THREADS} threads..."
 {
-    /usr/bin/time -v "${EXECUTABLE}" "${TEMP_TSV}" "${OUTPUT_DIR}" "${THREADS}"
+    /usr/bin/time -v "${EXECUTABLE}" "${TEMP_TSV}" "${OUTPUT_DIR}" "${THREADS}" csv
 } 2>&1 | tee "${LOG_FILE}"
 
 # Step 3: Verify Results
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include "core/CpGIndex.hpp"
+#include "vendor/CLI11.hpp"
+
+using namespace InterSubMod;
+
+/**
+ * Offline builder for the genome-wide CpG index (.cpgi).
+ *
+ *   build_cpg_index -r hg38.fa -o hg38.cpgi --pmd pmd.bed -j 8
+ */
+int main(int argc, char** argv) {
+    CLI::App app{"Build a genome-wide CpG site index (.cpgi) from a reference FASTA"};
+
+    std::string fasta_path, out_path, pmd_bed, repressive_bed, accessible_bed;
+    int threads = 1;
+    app.add_option("-r,--reference", fasta_path, "Reference FASTA (Required, must have .fai)")
+        ->required()
+        ->check(CLI::ExistingFile);
+    app.add_option("-o,--output", out_path, "Output index path (Required)")->required();
+    app.add_option("--pmd", pmd_bed, "PMD BED file (sets the in_pmd bit)")->check(CLI::ExistingFile);
+    app.add_option("--repressive", repressive_bed, "Repressive-state BED file")->check(CLI::ExistingFile);
+    app.add_option("--accessible", accessible_bed, "Accessible-chromatin BED file")->check(CLI::ExistingFile);
+    app.add_option("-j,--threads", threads, "Chromosomes scanned in parallel (Default: 1)")
+        ->check(CLI::PositiveNumber);
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        auto t_start = std::chrono::steady_clock::now();
+
+        CpGIndexBuilder builder(fasta_path);
+        std::unique_ptr<IntervalIndex> pmd, repressive, accessible;
+        auto annotate = [&](const std::string& bed, std::unique_ptr<IntervalIndex>& index,
+                            CpGIndexFormat::CpGFlag flag, const char* label) {
+            if (bed.empty()) return;
+            index = std::make_unique<IntervalIndex>(IntervalIndex::load_bed(bed));
+            builder.set_annotation(flag, index.get());
+            std::cout << "Loaded " << index->size() << " " << label << " intervals ("
+                      << index->covered_bp() << " bp) from " << bed << std::endl;
+        };
+        annotate(pmd_bed, pmd, CpGIndexFormat::CPG_IN_PMD, "PMD");
+        annotate(repressive_bed, repressive, CpGIndexFormat::CPG_REPRESSIVE, "repressive");
+        annotate(accessible_bed, accessible, CpGIndexFormat::CPG_ACCESSIBLE, "accessible");
+
+        uint64_t num_sites = builder.write(out_path, threads);
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+        CpGIndex index(out_path);
+        std::cout << "Wrote " << num_sites << " CpG sites on " << index.num_chroms()
+                  << " chromosomes to " << out_path << " in " << elapsed << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "core/AlignmentView.hpp"
+#include <algorithm>
+
+namespace InterSubMod {
+
+void AlignmentView::reset(const bam1_t* b) {
+    blocks_.clear();
+    query_length_ = 0;
+    ref_start_ = static_cast<int32_t>(b->core.pos);
+
+    const uint32_t* cigar = bam_get_cigar(b);
+    int32_t query_pos = 0;
+    int32_t ref_pos = ref_start_;
+    for (uint32_t i = 0; i < b->core.n_cigar; i++) {
+        int op = bam_cigar_op(cigar[i]);
+        int32_t len = static_cast<int32_t>(bam_cigar_oplen(cigar[i]));
+        int type = bam_cigar_type(op);  // bit 0: consumes query, bit 1: consumes reference
+
+        if (type == 3) {
+            // M / = / X; "=" and "X" runs split one aligned stretch into many ops
+            if (!blocks_.empty() && blocks_.back().query_end() == query_pos && blocks_.back().ref_end() == ref_pos) {
+                blocks_.back().length += len;
+            } else {
+                blocks_.push_back(Block{query_pos, ref_pos, len});
+            }
+        }
+        if (type & 1) query_pos += len;
+        if (type & 2) ref_pos += len;
+    }
+    query_length_ = query_pos;
+
+    // Same convention as bam_endpos(): unmapped or reference-free alignments span one base
+    int32_t ref_len = (b->core.flag & BAM_FUNMAP) ? 0 : ref_pos - ref_start_;
+    ref_end_ = ref_start_ + (ref_len > 0 ? ref_len : 1);
+}
+
+int32_t AlignmentView::query_offset(int32_t ref_pos) const {
+    // First block ending after ref_pos
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), ref_pos,
+                               [](int32_t pos, const Block& blk) { return pos < blk.ref_end(); });
+    if (it == blocks_.end() || ref_pos < it->ref_start) {
+        return -1;
+    }
+    return it->query_start + (ref_pos - it->ref_start);
+}
+
+int32_t AlignmentView::ref_position(int32_t query_pos) const {
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), query_pos,
+                               [](int32_t pos, const Block& blk) { return pos < blk.query_end(); });
+    if (it == blocks_.end() || query_pos < it->query_start) {
+        return -1;
+    }
+    return it->ref_start + (query_pos - it->query_start);
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,76 @@
+#include "core/AnalysisPipeline.hpp"
+#include "core/IntervalIndex.hpp"
+#include "core/ShardPlan.hpp"
+#include "utils/Logger.hpp"
+#include <iostream>
+
+namespace InterSubMod {
+
+AnalysisPipeline::AnalysisPipeline(const Config& config) : config_(config) {
+    processor_ = std::make_unique<RegionProcessor>(
+        config_.tumor_bam_path,
+        config_.normal_bam_path,
+        config_.reference_fasta_path,
+        config_.output_dir,
+        config_.threads,
+        config_.window_size_bp
+    );
+
+    processor_->set_output_format(config_.output_format, config_.quantize_matrix
+                                                             ? BinaryFormat::MatrixDType::UINT8
+                                                             : BinaryFormat::MatrixDType::FLOAT32);
+    processor_->set_reference_cache(config_.cache_reference);
+    processor_->set_decompression_threads(config_.hts_threads);
+    processor_->set_methyl_cache(static_cast<size_t>(config_.methyl_cache_mb) << 20);
+    processor_->set_max_reads_per_region(config_.max_reads_per_region, config_.sample_seed);
+    processor_->set_cost_scheduling(config_.cost_schedule);
+    processor_->set_prefetch_depth(config_.prefetch_depth);
+    processor_->set_numa(config_.numa);
+    processor_->set_read_filter(ReadFilterConfig::from_config(config_));
+    if (!config_.read_filter_expression.empty()) {
+        processor_->set_read_filter_expression(config_.read_filter_expression);
+    }
+    if (config_.pmd_gating && !config_.pmd_bed_path.empty()) {
+        processor_->set_pmd_intervals(std::make_shared<IntervalIndex>(IntervalIndex::load_bed(config_.pmd_bed_path)));
+    }
+    if (!config_.snv_regions.empty()) {
+        processor_->set_snv_regions(parse_region_list(config_.snv_regions));
+    } else if (!config_.shard.empty()) {
+        processor_->set_shard(ShardSpec::parse(config_.shard));
+    }
+    processor_->set_resume(config_.resume);
+    processor_->set_progress_interval(config_.progress_interval_s);
+    if (config_.verbose) {
+        Utils::Logger::instance().set_log_level(Utils::LogLevel::L_DEBUG);
+    }
+    if (config_.num_clusters > 0) {
+        processor_->set_analysis(AnalysisOptions::from_config(config_));
+    }
+}
+
+int AnalysisPipeline::run() {
+    results_ = processor_->process_snv_stream(config_.somatic_vcf_path);
+
+    processor_->print_summary(results_);
+    if (!config_.telemetry_prefix.empty()) {
+        processor_->write_telemetry(results_, config_.telemetry_prefix);
+        std::cout << "Telemetry: " << config_.telemetry_prefix << ".{tsv,json}" << std::endl;
+    }
+
+    size_t failed = 0;
+    for (const auto& r : results_) {
+        if (!r.success && !r.resumed) {
+            if (failed < 10) {
+                std::cerr << "Region " << r.region_id << " failed: " << r.error_message << std::endl;
+            }
+            failed++;
+        }
+    }
+    if (failed > 0) {
+        std::cerr << failed << " regions failed; rerun with --resume to retry them" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+} // namespace InterSubMod
@@ -1,11 +1,11 @@
 #include "core/BamReader.hpp"
 #include <stdexcept>
-#include <sstream>
+#include <algorithm>
 
 namespace InterSubMod {
 
 BamReader::BamReader(const std::string& bam_path, int n_threads)
-    : bam_path_(bam_path), fp_(nullptr), hdr_(nullptr), idx_(nullptr) {
+    : bam_path_(bam_path), fp_(nullptr), hdr_(nullptr), idx_(nullptr), scratch_(nullptr) {
     
     // Open BAM file
     fp_ = sam_open(bam_path.c_str(), "r");
@@ -35,27 +35,54 @@ BamReader::BamReader(const std::string& bam_path, int n_threads)
         sam_close(fp_);
         throw std::runtime_error("Failed to load BAM index (.bai): " + bam_path);
     }
+    
+    // Record buffer reused by every streaming query
+    scratch_ = bam_init1();
 }
 
 BamReader::~BamReader() {
+    if (scratch_) bam_destroy1(scratch_);
     if (idx_) hts_idx_destroy(idx_);
     if (hdr_) bam_hdr_destroy(hdr_);
     if (fp_) sam_close(fp_);
 }
 
+void BamReader::set_thread_pool(htsThreadPool* pool) {
+    if (!fp_) {
+        throw std::runtime_error("BAM file not open: " + bam_path_);
+    }
+    if (hts_set_thread_pool(fp_, pool) != 0) {
+        throw std::runtime_error("Failed to attach thread pool to BAM: " + bam_path_);
+    }
+}
+
+void BamReader::set_filter_expression(const std::string& expr) {
+    if (!fp_) {
+        throw std::runtime_error("BAM file not open: " + bam_path_);
+    }
+    if (hts_set_filter_expression(fp_, expr.empty() ? nullptr : expr.c_str()) != 0) {
+        throw std::runtime_error("Invalid read filter expression \"" + expr + "\" for " + bam_path_);
+    }
+}
+
 BamReader::BamReader(BamReader&& other) noexcept
     : bam_path_(std::move(other.bam_path_)),
       fp_(other.fp_),
       hdr_(other.hdr_),
-      idx_(other.idx_) {
+      idx_(other.idx_),
+      scratch_(other.scratch_),
+      records_(std::move(other.records_)),
+      tid_by_chr_id_(std::move(other.tid_by_chr_id_)) {
     other.fp_ = nullptr;
     other.hdr_ = nullptr;
     other.idx_ = nullptr;
+    other.scratch_ = nullptr;
 }
 
 BamReader& BamReader::operator=(BamReader&& other) noexcept {
     if (this != &other) {
         // Clean up current resources
+        if (scratch_) bam_destroy1(scratch_);
         if (idx_) hts_idx_destroy(idx_);
         if (hdr_) bam_hdr_destroy(hdr_);
         if (fp_) sam_close(fp_);
@@ -65,61 +92,79 @@ BamReader& BamReader::operator=(BamReader&& other) noexcept {
         fp_ = other.fp_;
         hdr_ = other.hdr_;
         idx_ = other.idx_;
+        scratch_ = other.scratch_;
+        records_ = std::move(other.records_);
+        tid_by_chr_id_ = std::move(other.tid_by_chr_id_);
         
         other.fp_ = nullptr;
         other.hdr_ = nullptr;
         other.idx_ = nullptr;
+        other.scratch_ = nullptr;
     }
     return *this;
 }
 
-std::vector<bam1_t*> BamReader::fetch_reads(
-    const std::string& chr, 
-    int32_t start, 
-    int32_t end
-) {
-    std::vector<bam1_t*> reads;
-    
-    if (!fp_ || !hdr_ || !idx_) {
-        return reads; // Not initialized
+int BamReader::tid(const std::string& chr) const {
+    if (!hdr_) {
+        return -1;
     }
-    
-    // Build region string "chr:start-end"
-    std::ostringstream region_ss;
-    region_ss << chr << ":" << start << "-" << end;
-    std::string region_str = region_ss.str();
-    
-    // Create iterator for region query
-    hts_itr_t* iter = sam_itr_querys(idx_, hdr_, region_str.c_str());
-    if (!iter) {
-        // Region not found or invalid - return empty vector
-        return reads;
+    return sam_hdr_name2tid(hdr_, chr.c_str());
+}
+
+int BamReader::tid(int chr_id, const std::string& chr) {
+    if (chr_id < 0) {
+        return tid(chr);
     }
-    
-    // Fetch all reads in region
-    bam1_t* b = bam_init1();
-    int ret;
-    while ((ret = sam_itr_next(fp_, iter, b)) >= 0) {
-        // Duplicate the read (caller will own the memory)
-        bam1_t* copy = bam_dup1(b);
-        reads.push_back(copy);
+    if (static_cast<size_t>(chr_id) >= tid_by_chr_id_.size()) {
+        tid_by_chr_id_.resize(chr_id + 1, kUnresolvedTid);
+    }
+    int& cached = tid_by_chr_id_[chr_id];
+    if (cached == kUnresolvedTid) {
+        cached = tid(chr);
+    }
+    return cached;
+}
+
+hts_itr_t* BamReader::query(int tid, int32_t start, int32_t end) {
+    if (!fp_ || !hdr_ || !idx_ || !scratch_ || tid < 0) {
+        return nullptr; // Not initialized or chromosome not in this BAM
     }
     
-    // Clean up
-    bam_destroy1(b);
-    hts_itr_destroy(iter);
+    // Same interval as the region string "chr:start-end" (1-based, inclusive)
+    return sam_itr_queryi(idx_, tid, std::max(start - 1, 0), end);
+}
+
+uint64_t BamReader::estimate_bytes(int tid, int32_t start, int32_t end) {
+    hts_itr_t* iter = query(tid, start, end);
+    if (!iter) {
+        return 0;
+    }
     
-    // Check for read errors (ret < -1 indicates error)
-    if (ret < -1) {
-        // Error occurred during iteration
-        for (auto* r : reads) {
-            bam_destroy1(r);
+    // Typical BAM compression ratio, for chunks that begin and end in one block
+    constexpr int64_t kBgzfRatio = 3;
+    uint64_t bytes = 0;
+    for (int i = 0; i < iter->n_off; i++) {
+        // Virtual offset = compressed block offset << 16 | offset inside the uncompressed block
+        const uint64_t u = iter->off[i].u;
+        const uint64_t v = iter->off[i].v;
+        int64_t compressed = static_cast<int64_t>(v >> 16) - static_cast<int64_t>(u >> 16);
+        int64_t within = static_cast<int64_t>(v & 0xffff) - static_cast<int64_t>(u & 0xffff);
+        int64_t est = compressed + within / kBgzfRatio;
+        if (est > 0) {
+            bytes += static_cast<uint64_t>(est);
         }
-        reads.clear();
     }
-    
-    return reads;
+    hts_itr_destroy(iter);
+    return bytes;
 }
 
-} // namespace InterSubMod
+std::vector<bam1_t*> BamReader::fetch_reads(
+    const std::string& chr, 
+    int32_t start, 
+    int32_t end
+) {
+    // Owning variant: copy every record
+    return fetch_reads(chr, start, end, [](const bam1_t*) { return true; });
+}
 
+} // namespace InterSubMod
@@ -0,0 +1,87 @@
+#include "core/BamRecordPool.hpp"
+#include <new>
+#include <utility>
+
+namespace InterSubMod {
+
+BamRecordPool::BamRecordPool(size_t max_pooled_bytes)
+    : max_pooled_bytes_(max_pooled_bytes) {
+}
+
+BamRecordPool::~BamRecordPool() {
+    destroy_all();
+}
+
+BamRecordPool::BamRecordPool(BamRecordPool&& other) noexcept
+    : free_(std::move(other.free_)),
+      pooled_bytes_(other.pooled_bytes_),
+      max_pooled_bytes_(other.max_pooled_bytes_),
+      reuses_(other.reuses_),
+      allocations_(other.allocations_) {
+    other.free_.clear();
+    other.pooled_bytes_ = 0;
+}
+
+BamRecordPool& BamRecordPool::operator=(BamRecordPool&& other) noexcept {
+    if (this != &other) {
+        destroy_all();
+        free_ = std::move(other.free_);
+        pooled_bytes_ = other.pooled_bytes_;
+        max_pooled_bytes_ = other.max_pooled_bytes_;
+        reuses_ = other.reuses_;
+        allocations_ = other.allocations_;
+        other.free_.clear();
+        other.pooled_bytes_ = 0;
+    }
+    return *this;
+}
+
+void BamRecordPool::destroy_all() {
+    for (auto* b : free_) {
+        bam_destroy1(b);
+    }
+    free_.clear();
+    pooled_bytes_ = 0;
+}
+
+bam1_t* BamRecordPool::copy(const bam1_t* src) {
+    bam1_t* b;
+    if (!free_.empty()) {
+        b = free_.back();
+        free_.pop_back();
+        pooled_bytes_ -= b->m_data;
+        reuses_++;
+    } else {
+        b = bam_init1();
+        if (!b) {
+            throw std::bad_alloc();
+        }
+        allocations_++;
+    }
+    if (!bam_copy1(b, src)) {
+        bam_destroy1(b);
+        throw std::bad_alloc();
+    }
+    return b;
+}
+
+void BamRecordPool::release(bam1_t* b) {
+    if (!b) {
+        return;
+    }
+    if (pooled_bytes_ + b->m_data > max_pooled_bytes_) {
+        bam_destroy1(b);
+        return;
+    }
+    pooled_bytes_ += b->m_data;
+    free_.push_back(b);
+}
+
+void BamRecordPool::release(std::vector<bam1_t*>& records) {
+    for (auto* b : records) {
+        release(b);
+    }
+    records.clear();
+}
+
+} // namespace InterSubMod
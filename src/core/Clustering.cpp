@@ -0,0 +1,405 @@
+#include "core/Clustering.hpp"
+#include "core/DistanceMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <omp.h>
+
+namespace InterSubMod {
+
+// ============================================================================
+// FisherExactTest
+// ============================================================================
+
+FisherExactTest::FisherExactTest(int initial_n) {
+    log_fact_.push_back(0.0);  // log(0!) = 0
+    ensure(initial_n);
+}
+
+void FisherExactTest::ensure(int n) {
+    while (static_cast<int>(log_fact_.size()) <= n) {
+        size_t k = log_fact_.size();
+        log_fact_.push_back(log_fact_.back() + std::log(static_cast<double>(k)));
+    }
+}
+
+double FisherExactTest::log_hypergeom(int a, int b, int c, int d) const {
+    const int n = a + b + c + d;
+    return log_fact_[a + b] + log_fact_[c + d] + log_fact_[a + c] + log_fact_[b + d]
+         - log_fact_[n] - log_fact_[a] - log_fact_[b] - log_fact_[c] - log_fact_[d];
+}
+
+double FisherExactTest::two_sided(int a, int b, int c, int d) {
+    if (a < 0 || b < 0 || c < 0 || d < 0) {
+        return 1.0;
+    }
+    const int n = a + b + c + d;
+    if (n == 0) {
+        return 1.0;
+    }
+    ensure(n);
+
+    // Enumerate tables with the same margins via the top-left cell
+    const int row1 = a + b;
+    const int col1 = a + c;
+    const int lo = std::max(0, row1 + col1 - n);
+    const int hi = std::min(row1, col1);
+
+    // Same relative tolerance as R's fisher.test
+    const double threshold = log_hypergeom(a, b, c, d) + 1e-7;
+    double p = 0.0;
+    for (int x = lo; x <= hi; x++) {
+        double lp = log_hypergeom(x, row1 - x, col1 - x, n - row1 - col1 + x);
+        if (lp <= threshold) {
+            p += std::exp(lp);
+        }
+    }
+    return std::min(1.0, p);
+}
+
+// ============================================================================
+// HierarchicalClustering
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief Union-find over dendrogram node ids (leaves and merged nodes).
+ */
+struct NodeUnionFind {
+    std::vector<int> parent;
+
+    explicit NodeUnionFind(int num_nodes) : parent(num_nodes) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+};
+
+} // namespace
+
+HierarchicalClustering::HierarchicalClustering(LinkageMethod method) : method_(method) {}
+
+const std::vector<LinkageStep>& HierarchicalClustering::fit(const DistanceMatrix& dist) {
+    const Eigen::MatrixXd& dm = dist.dist_matrix;
+    const int n = dm.rows();
+    num_leaves_ = n;
+    merges_.clear();
+    if (n < 2) {
+        return merges_;
+    }
+
+    // 1. Condensed upper triangle; NaN -> largest finite distance
+    double max_finite = 0.0;
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < j; i++) {
+            double d = dm(i, j);
+            if (std::isfinite(d)) max_finite = std::max(max_finite, d);
+        }
+    }
+
+    std::vector<double> cond(static_cast<size_t>(n) * (n - 1) / 2);
+    auto index = [n](int i, int j) -> size_t {
+        if (i > j) std::swap(i, j);
+        return static_cast<size_t>(i) * n - static_cast<size_t>(i) * (i + 1) / 2 + (j - i - 1);
+    };
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            double d = dm(i, j);
+            cond[index(i, j)] = std::isfinite(d) ? d : max_finite;
+        }
+    }
+
+    // 2. Nearest-neighbour chain. A merged cluster keeps the slot of one of
+    // its members; `active` holds the live slots.
+    std::vector<int> size(n, 1);
+    std::vector<int> active(n);
+    std::vector<int> active_pos(n);
+    std::iota(active.begin(), active.end(), 0);
+    std::iota(active_pos.begin(), active_pos.end(), 0);
+
+    std::vector<int> chain;
+    chain.reserve(n);
+
+    struct RawMerge {
+        int slot_a;
+        int slot_b;
+        double height;
+        int size;
+    };
+    std::vector<RawMerge> raw;
+    raw.reserve(n - 1);
+
+    while (static_cast<int>(raw.size()) < n - 1) {
+        if (chain.empty()) {
+            chain.push_back(active[0]);
+        }
+
+        // Grow the chain until two clusters are reciprocal nearest neighbours
+        int x = -1;
+        int y = -1;
+        for (;;) {
+            x = chain.back();
+            const int prev = chain.size() >= 2 ? chain[chain.size() - 2] : -1;
+
+            // Ties prefer the previous chain element so the chain terminates
+            int best = prev;
+            double best_d = prev >= 0 ? cond[index(x, prev)] : std::numeric_limits<double>::infinity();
+            for (int k : active) {
+                if (k == x) continue;
+                double d = cond[index(x, k)];
+                if (d < best_d) {
+                    best_d = d;
+                    best = k;
+                }
+            }
+
+            if (best == prev) {
+                y = prev;
+                break;
+            }
+            chain.push_back(best);
+        }
+        chain.pop_back();
+        chain.pop_back();
+
+        // Merge y into x's slot with the Lance-Williams update
+        const double dxy = cond[index(x, y)];
+        const double nx = size[x];
+        const double ny = size[y];
+        raw.push_back({x, y, dxy, size[x] + size[y]});
+
+        for (int k : active) {
+            if (k == x || k == y) continue;
+            double& dxk = cond[index(x, k)];
+            const double dyk = cond[index(y, k)];
+            const double nk = size[k];
+
+            switch (method_) {
+                case LinkageMethod::AVERAGE:
+                    dxk = (nx * dxk + ny * dyk) / (nx + ny);
+                    break;
+                case LinkageMethod::COMPLETE:
+                    dxk = std::max(dxk, dyk);
+                    break;
+                case LinkageMethod::WARD: {
+                    double v = ((nx + nk) * dxk * dxk + (ny + nk) * dyk * dyk - nk * dxy * dxy) / (nx + ny + nk);
+                    dxk = std::sqrt(std::max(v, 0.0));
+                    break;
+                }
+            }
+        }
+        size[x] += size[y];
+
+        // Remove y from the active list (swap with last)
+        const int pos = active_pos[y];
+        active[pos] = active.back();
+        active_pos[active[pos]] = pos;
+        active.pop_back();
+    }
+
+    // 3. Order by height (stable keeps dependent merges in order) and
+    // translate slots into SciPy-style node ids
+    std::stable_sort(raw.begin(), raw.end(),
+                     [](const RawMerge& a, const RawMerge& b) { return a.height < b.height; });
+
+    NodeUnionFind uf(2 * n - 1);
+    merges_.reserve(n - 1);
+    for (size_t k = 0; k < raw.size(); k++) {
+        int a = uf.find(raw[k].slot_a);
+        int b = uf.find(raw[k].slot_b);
+        int node = n + static_cast<int>(k);
+        uf.parent[a] = node;
+        uf.parent[b] = node;
+        merges_.push_back({std::min(a, b), std::max(a, b), raw[k].height, raw[k].size});
+    }
+
+    return merges_;
+}
+
+std::vector<int> HierarchicalClustering::labels_after(int num_merges) const {
+    const int n = num_leaves_;
+    std::vector<int> labels(n, 0);
+    if (n == 0) {
+        return labels;
+    }
+
+    NodeUnionFind uf(2 * n - 1);
+    for (int k = 0; k < num_merges; k++) {
+        int node = n + k;
+        uf.parent[merges_[k].left] = node;
+        uf.parent[merges_[k].right] = node;
+    }
+
+    // Number clusters 1..K by first appearance
+    std::vector<int> label_of_root(2 * n - 1, 0);
+    int next_label = 1;
+    for (int i = 0; i < n; i++) {
+        int root = uf.find(i);
+        if (label_of_root[root] == 0) {
+            label_of_root[root] = next_label++;
+        }
+        labels[i] = label_of_root[root];
+    }
+    return labels;
+}
+
+std::vector<int> HierarchicalClustering::cut_k(int k) const {
+    const int n = num_leaves_;
+    if (n == 0) {
+        return {};
+    }
+    k = std::clamp(k, 1, n);
+    return labels_after(n - k);
+}
+
+std::vector<int> HierarchicalClustering::cut_height(double threshold) const {
+    int num_merges = 0;
+    while (num_merges < static_cast<int>(merges_.size()) && merges_[num_merges].height <= threshold) {
+        num_merges++;
+    }
+    return labels_after(num_merges);
+}
+
+std::vector<double> HierarchicalClustering::silhouette(const DistanceMatrix& dist, const std::vector<int>& labels) {
+    const Eigen::MatrixXd& dm = dist.dist_matrix;
+    const int n = labels.size();
+    std::vector<double> scores(n, 0.0);
+    if (n == 0 || dm.rows() != n) {
+        return scores;
+    }
+
+    const int num_clusters = *std::max_element(labels.begin(), labels.end());
+    std::vector<int> cluster_size(num_clusters + 1, 0);
+    for (int l : labels) cluster_size[l]++;
+    if (num_clusters < 2) {
+        return scores;
+    }
+
+    #pragma omp parallel if(n > 256)
+    {
+        std::vector<double> sum(num_clusters + 1);
+        std::vector<int> cnt(num_clusters + 1);
+
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < n; i++) {
+            const int own = labels[i];
+            if (cluster_size[own] <= 1) {
+                continue;  // Singleton: s = 0
+            }
+
+            std::fill(sum.begin(), sum.end(), 0.0);
+            std::fill(cnt.begin(), cnt.end(), 0);
+            const double* col = dm.data() + static_cast<size_t>(i) * n;  // Symmetric: column i == row i
+            for (int j = 0; j < n; j++) {
+                if (j == i || std::isnan(col[j])) continue;
+                sum[labels[j]] += col[j];
+                cnt[labels[j]]++;
+            }
+
+            if (cnt[own] == 0) {
+                continue;
+            }
+            const double a = sum[own] / cnt[own];
+            double b = std::numeric_limits<double>::infinity();
+            for (int c = 1; c <= num_clusters; c++) {
+                if (c != own && cnt[c] > 0) {
+                    b = std::min(b, sum[c] / cnt[c]);
+                }
+            }
+            if (!std::isfinite(b)) {
+                continue;
+            }
+            const double denom = std::max(a, b);
+            scores[i] = denom > 0.0 ? (b - a) / denom : 0.0;
+        }
+    }
+
+    return scores;
+}
+
+ClusteringResult HierarchicalClustering::summarize(const DistanceMatrix& dist, const std::vector<int>& labels,
+                                                   const ReadTable& reads) {
+    if (reads.size() < labels.size()) {
+        throw std::runtime_error("HierarchicalClustering::summarize: fewer reads than labels");
+    }
+
+    ClusteringResult result;
+    result.region_id = dist.region_id;
+    result.labels = labels;
+    result.num_clusters = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end());
+    result.silhouette_scores = silhouette(dist, labels);
+    if (labels.empty()) {
+        return result;
+    }
+
+    const size_t n = labels.size();
+    const int8_t* hp = reads.hp_tags().data();
+    const uint8_t* alt = reads.alt_supports().data();
+    const uint8_t* tumor = reads.tumor_flags().data();
+    const uint8_t kAlt = static_cast<uint8_t>(AltSupport::ALT);
+    const uint8_t kRef = static_cast<uint8_t>(AltSupport::REF);
+
+    // Totals: branch-free loops over the byte columns
+    int total_hp1 = 0, total_hp2 = 0, total_alt = 0, total_ref = 0;
+    for (size_t i = 0; i < n; i++) {
+        total_hp1 += hp[i] == 1;
+        total_hp2 += hp[i] == 2;
+        total_alt += alt[i] == kAlt;
+        total_ref += alt[i] == kRef;
+    }
+
+    // Per-cluster counts in dense arrays indexed by label (labels are 1..K in practice)
+    const int min_label = *std::min_element(labels.begin(), labels.end());
+    const size_t num_slots = static_cast<size_t>(result.num_clusters - min_label) + 1;
+    std::vector<ClusterStats> slots(num_slots);
+    for (size_t i = 0; i < n; i++) {
+        ClusterStats& cs = slots[labels[i] - min_label];
+        cs.size++;
+        cs.count_hp1 += hp[i] == 1;
+        cs.count_hp2 += hp[i] == 2;
+        cs.count_tumor += tumor[i];
+        cs.count_alt += alt[i] == kAlt;
+        cs.count_ref += alt[i] == kRef;
+    }
+    for (size_t s = 0; s < num_slots; s++) {
+        ClusterStats& cs = slots[s];
+        if (cs.size == 0) {
+            continue;
+        }
+        cs.cluster_id = min_label + static_cast<int>(s);
+        cs.count_hp_unknown = cs.size - cs.count_hp1 - cs.count_hp2;
+        cs.count_normal = cs.size - cs.count_tumor;
+        result.stats[cs.cluster_id] = cs;
+    }
+
+    // Cluster vs. rest; unknown HP / ALT support excluded from the tables
+    for (auto& [id, cs] : result.stats) {
+        cs.p_value_hp = fisher_.two_sided(cs.count_hp1, cs.count_hp2,
+                                          total_hp1 - cs.count_hp1, total_hp2 - cs.count_hp2);
+        cs.p_value_somatic = fisher_.two_sided(cs.count_alt, cs.count_ref,
+                                               total_alt - cs.count_alt, total_ref - cs.count_ref);
+    }
+
+    return result;
+}
+
+ClusteringResult HierarchicalClustering::summarize(const DistanceMatrix& dist, const std::vector<int>& labels,
+                                                   const std::vector<ReadInfo>& reads) {
+    ReadTable table;
+    table.reserve(reads.size());
+    for (const ReadInfo& r : reads) {
+        table.append(r);
+    }
+    return summarize(dist, labels, table);
+}
+
+} // namespace InterSubMod
@@ -1,4 +1,5 @@
 #include "core/Config.hpp"
+#include "core/ShardPlan.hpp"
 #include <iostream>
 #include <filesystem>
 #include <htslib/hts.h>
@@ -36,6 +37,11 @@ bool Config::validate() const {
             } else {
                 sam_hdr_destroy(hdr);
             }
+            if (!read_filter_expression.empty() &&
+                hts_set_filter_expression(fp, read_filter_expression.c_str()) != 0) {
+                std::cerr << "Error: Invalid read filter expression: " << read_filter_expression << std::endl;
+                valid = false;
+            }
             sam_close(fp);
         }
     }
@@ -92,6 +98,18 @@ bool Config::validate() const {
         }
     }
 
+    if (!snv_regions.empty() && !shard.empty()) {
+        std::cerr << "Error: --regions and --shard are mutually exclusive." << std::endl;
+        valid = false;
+    }
+    try {
+        if (!snv_regions.empty()) parse_region_list(snv_regions);
+        if (!shard.empty()) ShardSpec::parse(shard);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        valid = false;
+    }
+
     if (window_size_bp <= 0) {
         std::cerr << "Error: window_size_bp must be positive." << std::endl;
         valid = false;
@@ -118,11 +136,35 @@ void Config::print() const {
     std::cout << "Reference: " << reference_fasta_path << std::endl;
     std::cout << "Somatic VCF: " << somatic_vcf_path << std::endl;
     std::cout << "Output Dir: " << output_dir << std::endl;
+    if (!snv_regions.empty()) std::cout << "SNV Regions: " << snv_regions << std::endl;
+    if (!shard.empty()) std::cout << "Shard: " << shard << std::endl;
+    if (work_units > 0) std::cout << "Work Units: " << work_units << std::endl;
+    if (resume) std::cout << "Resume: on" << std::endl;
+    if (!telemetry_prefix.empty()) std::cout << "Telemetry: " << telemetry_prefix << ".{tsv,json}" << std::endl;
+    std::cout << "Output Format: " << (output_format == OutputFormat::CSV ? "csv" : "binary")
+              << (quantize_matrix ? " (uint8 matrix)" : "") << std::endl;
     std::cout << "Window Size: " << window_size_bp << " bp" << std::endl;
     std::cout << "Min MapQ: " << min_mapq << std::endl;
     std::cout << "Min Read Length: " << min_read_length << std::endl;
+    std::cout << "Min Base Quality: " << min_base_quality << std::endl;
+    if (!read_filter_expression.empty()) std::cout << "Read Filter: " << read_filter_expression << std::endl;
     std::cout << "Methylation Thresholds: Low=" << binary_methyl_low << ", High=" << binary_methyl_high << std::endl;
-    std::cout << "Threads: " << threads << std::endl;
+    std::cout << "Clustering: " << (num_clusters > 0 ? std::to_string(num_clusters) + " clusters" : std::string("off"))
+              << ", min site coverage " << min_site_coverage << ", min common coverage " << min_common_coverage << std::endl;
+    std::cout << "Threads: " << threads;
+    if (hts_threads > 0) std::cout << " (+" << hts_threads << " shared BGZF decompression)";
+    std::cout << std::endl;
+    std::cout << "Progress Interval: " << progress_interval_s << " s" << (verbose ? " (verbose)" : "") << std::endl;
+    std::cout << "PMD Gating: " << (pmd_gating && !pmd_bed_path.empty() ? pmd_bed_path : "off") << std::endl;
+    std::cout << "Reference Cache: " << (cache_reference ? "on" : "off") << std::endl;
+    std::cout << "Methyl-call Cache: "
+              << (methyl_cache_mb > 0 ? std::to_string(methyl_cache_mb) + " MB per thread" : std::string("off")) << std::endl;
+    std::cout << "Cost Scheduling: " << (cost_schedule ? "on" : "off") << std::endl;
+    std::cout << "Prefetch Depth: " << (prefetch_depth > 0 ? std::to_string(prefetch_depth) : std::string("off")) << std::endl;
+    std::cout << "NUMA Placement: " << (numa ? "on" : "off") << std::endl;
+    std::cout << "Max Reads per Region: "
+              << (max_reads_per_region > 0 ? std::to_string(max_reads_per_region) + " (seed " + std::to_string(sample_seed) + ")"
+                                           : std::string("no cap")) << std::endl;
     std::cout << "---------------------" << std::endl;
 }
 
@@ -0,0 +1,271 @@
+#include "core/CpGIndex.hpp"
+#include "utils/FastaReader.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace InterSubMod {
+
+using namespace CpGIndexFormat;
+
+static inline uint64_t align_up(uint64_t x) {
+    return (x + kAlign - 1) & ~static_cast<uint64_t>(kAlign - 1);
+}
+
+// ============================================================================
+// CpGIndexBuilder
+// ============================================================================
+
+CpGIndexBuilder::CpGIndexBuilder(const std::string& fasta_path)
+    : fasta_path_(fasta_path) {}
+
+void CpGIndexBuilder::set_annotation(CpGFlag flag, const IntervalIndex* intervals) {
+    annotations_.erase(std::remove_if(annotations_.begin(), annotations_.end(),
+                                      [flag](const auto& a) { return a.first == flag; }),
+                       annotations_.end());
+    if (intervals) {
+        annotations_.emplace_back(flag, intervals);
+    }
+}
+
+void CpGIndexBuilder::scan_chromosome(FastaReader& fasta, const std::string& name, ChromSites& out) const {
+    out.length = fasta.get_chr_length(name);
+    if (out.length > std::numeric_limits<int32_t>::max()) {
+        throw std::runtime_error("Chromosome too long for 32-bit coordinates: " + name);
+    }
+    std::string seq = fasta.fetch_sequence(name, 0, static_cast<int32_t>(out.length));
+    if (static_cast<int64_t>(seq.size()) != out.length) {
+        throw std::runtime_error("Failed to read chromosome " + name + " from " + fasta_path_);
+    }
+    for (size_t i = 0; i + 1 < seq.size(); i++) {
+        if (seq[i] == 'C' && seq[i + 1] == 'G') {
+            out.positions.push_back(static_cast<int32_t>(i + 1));  // 1-based
+        }
+    }
+    out.flags.assign(out.positions.size(), 0);
+
+    // Positions are sorted: walk each interval list with a cursor
+    for (const auto& [flag, intervals] : annotations_) {
+        const ChromIntervals* iv = intervals->chrom(name);
+        if (!iv) continue;
+        size_t k = 0;
+        for (size_t i = 0; i < out.positions.size(); i++) {
+            int64_t pos0 = out.positions[i] - 1;
+            while (k < iv->size() && iv->end(k) <= pos0) k++;
+            if (k == iv->size()) break;
+            if (iv->start(k) <= pos0) out.flags[i] |= flag;
+        }
+    }
+}
+
+uint64_t CpGIndexBuilder::write(const std::string& out_path, int num_threads) {
+    std::vector<std::string> names = FastaReader(fasta_path_).chromosome_names();
+    const int n = static_cast<int>(names.size());
+
+    std::vector<ChromSites> chroms(n);
+    std::string error;
+
+    // 1. Scan chromosomes in parallel (one FASTA handle per thread)
+    #pragma omp parallel num_threads(std::max(num_threads, 1))
+    {
+        std::unique_ptr<FastaReader> fasta;
+        #pragma omp for schedule(dynamic)
+        for (int c = 0; c < n; c++) {
+            try {
+                if (!fasta) {
+                    fasta = std::make_unique<FastaReader>(fasta_path_);
+                }
+                scan_chromosome(*fasta, names[c], chroms[c]);
+            } catch (const std::exception& e) {
+                #pragma omp critical
+                error = e.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    // 2. Layout
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.header_size = sizeof(FileHeader);
+    header.num_chroms = static_cast<uint32_t>(n);
+    for (const auto& a : annotations_) header.annotations |= a.first;
+    header.chrom_table_offset = sizeof(FileHeader);
+    header.names_offset = header.chrom_table_offset + n * sizeof(ChromEntry);
+    for (const auto& name : names) header.names_size += name.size();
+
+    std::vector<ChromEntry> table(n);
+    uint64_t offset = align_up(header.names_offset + header.names_size);
+    uint32_t name_offset = 0;
+    for (int c = 0; c < n; c++) {
+        ChromEntry& e = table[c];
+        e.length = chroms[c].length;
+        e.first_cpg_id = header.num_sites;
+        e.num_sites = chroms[c].positions.size();
+        e.positions_offset = offset;
+        e.flags_offset = offset + e.num_sites * sizeof(int32_t);
+        e.name_offset = name_offset;
+        e.name_len = static_cast<uint32_t>(names[c].size());
+        offset = align_up(e.flags_offset + e.num_sites);
+        name_offset += e.name_len;
+        header.num_sites += e.num_sites;
+    }
+
+    // 3. Write
+    FILE* fp = std::fopen(out_path.c_str(), "wb");
+    if (!fp) {
+        throw std::runtime_error("Failed to open CpG index for writing: " + out_path);
+    }
+    uint64_t written = 0;
+    auto put = [&](const void* data, size_t size) {
+        if (size > 0 && std::fwrite(data, 1, size, fp) != size) {
+            std::fclose(fp);
+            throw std::runtime_error("Failed to write CpG index: " + out_path);
+        }
+        written += size;
+    };
+    static const char zeros[kAlign] = {};
+    auto pad_to = [&](uint64_t target) { put(zeros, target - written); };
+
+    put(&header, sizeof(header));
+    put(table.data(), table.size() * sizeof(ChromEntry));
+    for (const auto& name : names) put(name.data(), name.size());
+    for (int c = 0; c < n; c++) {
+        pad_to(table[c].positions_offset);
+        put(chroms[c].positions.data(), chroms[c].positions.size() * sizeof(int32_t));
+        put(chroms[c].flags.data(), chroms[c].flags.size());
+    }
+    pad_to(offset);
+    if (std::fclose(fp) != 0) {
+        throw std::runtime_error("Failed to close CpG index: " + out_path);
+    }
+    return header.num_sites;
+}
+
+// ============================================================================
+// CpGIndex
+// ============================================================================
+
+CpGIndex::CpGIndex(const std::string& path)
+    : path_(path), data_(nullptr), size_(0), header_(nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open CpG index: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Not a CpG index file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap CpG index: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(map);
+    header_ = reinterpret_cast<const FileHeader*>(data_);
+
+    auto fail = [&](const std::string& msg) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        throw std::runtime_error(msg + ": " + path);
+    };
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->version != kVersion) {
+        fail("Not a CpG index file");
+    }
+    if (header_->chrom_table_offset + header_->num_chroms * sizeof(ChromEntry) > size_ ||
+        header_->names_offset + header_->names_size > size_) {
+        fail("Truncated CpG index");
+    }
+
+    const ChromEntry* table = reinterpret_cast<const ChromEntry*>(data_ + header_->chrom_table_offset);
+    const char* blob = reinterpret_cast<const char*>(data_ + header_->names_offset);
+    chroms_.assign(table, table + header_->num_chroms);
+    for (uint32_t c = 0; c < header_->num_chroms; c++) {
+        const ChromEntry& e = chroms_[c];
+        if (e.flags_offset + e.num_sites > size_ || e.name_offset + e.name_len > header_->names_size) {
+            fail("Truncated CpG index");
+        }
+        names_.emplace_back(blob + e.name_offset, e.name_len);
+        ids_[names_.back()] = static_cast<int>(c);
+    }
+}
+
+CpGIndex::~CpGIndex() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+int CpGIndex::chr_id(const std::string& chr) const {
+    auto it = ids_.find(chr);
+    return it == ids_.end() ? -1 : it->second;
+}
+
+CpGRange CpGIndex::range(const std::string& chr, int32_t start, int32_t end) const {
+    CpGRange r;
+    int id = chr_id(chr);
+    if (id < 0 || end < start) {
+        return r;
+    }
+    const ChromEntry& e = chroms_[id];
+    const int32_t* begin = positions(id);
+    const int32_t* last = begin + e.num_sites;
+    const int32_t* lo = std::lower_bound(begin, last, start);
+    const int32_t* hi = std::upper_bound(lo, last, end);
+
+    r.chr_id = id;
+    r.first_cpg_id = e.first_cpg_id + (lo - begin);
+    r.positions = lo;
+    r.flags = data_ + e.flags_offset + (lo - begin);
+    r.count = static_cast<size_t>(hi - lo);
+    return r;
+}
+
+int64_t CpGIndex::cpg_id(const std::string& chr, int32_t pos) const {
+    CpGRange r = range(chr, pos, pos);
+    return r.count ? r.cpg_id(0) : -1;
+}
+
+void CpGIndex::lookup_ids(const std::string& chr, const std::vector<int32_t>& query,
+                          std::vector<int64_t>& ids) const {
+    ids.assign(query.size(), -1);
+    if (query.empty()) {
+        return;
+    }
+    CpGRange r = range(chr, query.front(), query.back());
+    size_t k = 0;
+    for (size_t i = 0; i < query.size(); i++) {
+        while (k < r.count && r.positions[k] < query[i]) k++;
+        if (k == r.count) break;
+        if (r.positions[k] == query[i]) ids[i] = r.cpg_id(k);
+    }
+}
+
+std::vector<CpGSite> CpGIndex::sites(const std::string& chr, int32_t start, int32_t end) const {
+    CpGRange r = range(chr, start, end);
+    std::vector<CpGSite> out(r.count);
+    for (size_t i = 0; i < r.count; i++) {
+        CpGSite& s = out[i];
+        s.cpg_id = static_cast<int>(r.cpg_id(i));
+        s.chr_id = r.chr_id;
+        s.pos = r.positions[i];
+        s.in_pmd = r.flags[i] & CPG_IN_PMD;
+        s.in_repressive_state = r.flags[i] & CPG_REPRESSIVE;
+        s.accessible = r.flags[i] & CPG_ACCESSIBLE;
+    }
+    return out;
+}
+
+} // namespace InterSubMod
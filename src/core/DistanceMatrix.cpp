@@ -0,0 +1,118 @@
+#include "core/DistanceMatrix.hpp"
+#include "core/DistanceKernels.hpp"
+#include "core/MethylationMatrix.hpp"
+#include "core/MethylQuant.hpp"
+#include <cmath>
+#include <limits>
+
+namespace InterSubMod {
+
+namespace DistanceKernels {
+
+BitRows pack_binary(const Eigen::MatrixXi& bin) {
+    BitRows rows;
+    const int n = bin.rows();
+    const int m = bin.cols();
+    rows.words = (m + 63) / 64;
+    rows.meth.assign(n * rows.words, 0);
+    rows.cov.assign(n * rows.words, 0);
+
+    // Column-major source: walk columns outermost
+    for (int c = 0; c < m; c++) {
+        const uint64_t bit = 1ULL << (c & 63);
+        const size_t word = c >> 6;
+        for (int r = 0; r < n; r++) {
+            int v = bin(r, c);
+            if (v == 0 || v == 1) {
+                rows.cov[r * rows.words + word] |= bit;
+                if (v == 1) rows.meth[r * rows.words + word] |= bit;
+            }
+        }
+    }
+    return rows;
+}
+
+namespace {
+
+/**
+ * @brief Shared packing loop; value(r, c) returns the probability or NaN when missing.
+ */
+template <typename ValueFn>
+FloatRows pack_rows(int n, int m, BitRows& cov_bits, ValueFn&& value) {
+    FloatRows rows;
+    rows.stride = (m + kFloatAlign - 1) / kFloatAlign * kFloatAlign;
+    rows.val.assign(n * rows.stride, 0.0f);
+    rows.mask.assign(n * rows.stride, 0.0f);
+
+    cov_bits.words = (m + 63) / 64;
+    cov_bits.meth.clear();
+    cov_bits.cov.assign(n * cov_bits.words, 0);
+
+    for (int c = 0; c < m; c++) {
+        for (int r = 0; r < n; r++) {
+            float v = value(r, c);
+            if (!std::isnan(v)) {
+                rows.val[r * rows.stride + c] = v;
+                rows.mask[r * rows.stride + c] = 1.0f;
+                cov_bits.cov[r * cov_bits.words + (c >> 6)] |= 1ULL << (c & 63);
+            }
+        }
+    }
+    return rows;
+}
+
+} // namespace
+
+FloatRows pack_probabilities(const MethylationMatrix& methyl_mat, BitRows& cov_bits) {
+    if (methyl_mat.is_quantized()) {
+        // uint8 storage: decoded through the table, 255 = missing
+        const MethylationMatrix::QuantMatrix& quant = methyl_mat.quant_matrix;
+        return pack_rows(quant.rows(), quant.cols(), cov_bits, [&](int r, int c) {
+            const uint8_t q = quant(r, c);
+            return q == Quant::kNoCoverage ? std::numeric_limits<float>::quiet_NaN() : Quant::decode(q);
+        });
+    }
+    const Eigen::MatrixXd& raw = methyl_mat.raw_matrix;
+    return pack_rows(raw.rows(), raw.cols(), cov_bits,
+                     [&](int r, int c) { return static_cast<float>(raw(r, c)); });
+}
+
+} // namespace DistanceKernels
+
+namespace {
+
+template <typename Metric>
+void compute_with_strategy(DistanceMatrix& dm, const MethylationMatrix& methyl_mat, int min_cov,
+                           NanDistanceStrategy nan_strategy) {
+    if (nan_strategy == NanDistanceStrategy::MAX_DIST) {
+        dm.compute<Metric, DistanceKernels::MaxDist>(methyl_mat, min_cov);
+    } else {
+        dm.compute<Metric, DistanceKernels::Skip>(methyl_mat, min_cov);
+    }
+}
+
+} // namespace
+
+void DistanceMatrix::compute_from_methylation(const MethylationMatrix& methyl_mat, DistanceMetricType type, int min_cov, NanDistanceStrategy nan_strategy) {
+    // One dispatch per region; each instantiation has its own inlined pair kernel
+    switch (type) {
+        case DistanceMetricType::NHD:
+            compute_with_strategy<DistanceKernels::Nhd>(*this, methyl_mat, min_cov, nan_strategy);
+            break;
+        case DistanceMetricType::JACCARD:
+            compute_with_strategy<DistanceKernels::Jaccard>(*this, methyl_mat, min_cov, nan_strategy);
+            break;
+        case DistanceMetricType::L1:
+            compute_with_strategy<DistanceKernels::L1>(*this, methyl_mat, min_cov, nan_strategy);
+            break;
+        case DistanceMetricType::L2:
+            compute_with_strategy<DistanceKernels::L2>(*this, methyl_mat, min_cov, nan_strategy);
+            break;
+        case DistanceMetricType::CORR:
+            compute_with_strategy<DistanceKernels::Corr>(*this, methyl_mat, min_cov, nan_strategy);
+            break;
+    }
+    metric_type = type;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,153 @@
+#include "core/DistributedRunner.hpp"
+#include "core/AnalysisPipeline.hpp"
+#include "core/ShardPlan.hpp"
+#include "utils/FastaReader.hpp"
+#include <mpi.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+namespace InterSubMod {
+
+namespace {
+
+constexpr int kTagRequest = 1;  // worker -> rank 0: {finished unit (0 = none), its status}
+constexpr int kTagAssign = 2;   // rank 0 -> worker: unit to process (0 = stop)
+
+} // namespace
+
+DistributedRunner::DistributedRunner(const Config& config, int rank, int size)
+    : config_(config), rank_(rank), size_(std::max(size, 1)) {
+    const int workers = std::max(size_ - 1, 1);
+    num_units_ = config_.work_units > 0 ? config_.work_units : 4 * workers;
+}
+
+int DistributedRunner::run() {
+    if (rank_ != 0) {
+        return work();
+    }
+
+    auto t_start = std::chrono::steady_clock::now();
+    std::cout << "Distributed run: " << num_units_ << " work units over "
+              << (size_ > 1 ? size_ - 1 : 1) << " worker rank(s)" << std::endl;
+
+    int status = 0;
+    if (size_ == 1) {
+        for (int unit = 1; unit <= num_units_; unit++) {
+            status = std::max(status, process_unit(unit));
+        }
+    } else {
+        status = coordinate();
+    }
+    status = std::max(status, merge());
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    std::cout << "Distributed run finished in " << elapsed << " s (status " << status << ")" << std::endl;
+    return status;
+}
+
+int DistributedRunner::process_unit(int unit) {
+    Config unit_config = config_;
+    ShardSpec shard;
+    shard.index = unit;
+    shard.count = num_units_;
+    unit_config.snv_regions.clear();
+    unit_config.shard = std::to_string(unit) + "/" + std::to_string(num_units_);
+    if (!unit_config.telemetry_prefix.empty()) {
+        unit_config.telemetry_prefix += "." + shard.tag();
+    }
+
+    std::cout << "[rank " << rank_ << "] Work unit " << shard.tag() << std::endl;
+    try {
+        AnalysisPipeline pipeline(unit_config);
+        return pipeline.run();
+    } catch (const std::exception& e) {
+        std::cerr << "[rank " << rank_ << "] Work unit " << shard.tag() << " failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int DistributedRunner::coordinate() {
+    // Each worker starts on its own contiguous run of units (genome order);
+    // an idle worker steals from the tail of the longest remaining run
+    const int workers = size_ - 1;
+    std::vector<std::deque<int>> runs(workers);
+    for (int unit = 1; unit <= num_units_; unit++) {
+        runs[static_cast<size_t>(unit - 1) * workers / num_units_].push_back(unit);
+    }
+
+    int status = 0;
+    int active = workers;
+    size_t stolen = 0, failed_units = 0;
+    while (active > 0) {
+        int report[2];
+        MPI_Status st;
+        MPI_Recv(report, 2, MPI_INT, MPI_ANY_SOURCE, kTagRequest, MPI_COMM_WORLD, &st);
+        if (report[0] > 0) {
+            status = std::max(status, report[1]);
+            if (report[1] != 0) failed_units++;
+        }
+
+        const int w = st.MPI_SOURCE - 1;
+        int next = 0;
+        if (!runs[w].empty()) {
+            next = runs[w].front();
+            runs[w].pop_front();
+        } else {
+            auto longest = std::max_element(runs.begin(), runs.end(),
+                                            [](const auto& a, const auto& b) { return a.size() < b.size(); });
+            if (!longest->empty()) {
+                next = longest->back();
+                longest->pop_back();
+                stolen++;
+            }
+        }
+        MPI_Send(&next, 1, MPI_INT, st.MPI_SOURCE, kTagAssign, MPI_COMM_WORLD);
+        if (next == 0) {
+            active--;
+        }
+    }
+
+    std::cout << "All " << num_units_ << " work units done (" << stolen << " rebalanced, "
+              << failed_units << " with failures)" << std::endl;
+    return status;
+}
+
+int DistributedRunner::work() {
+    int status = 0;
+    int report[2] = {0, 0};
+    while (true) {
+        MPI_Send(report, 2, MPI_INT, 0, kTagRequest, MPI_COMM_WORLD);
+        int unit = 0;
+        MPI_Recv(&unit, 1, MPI_INT, 0, kTagAssign, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (unit == 0) {
+            break;
+        }
+        report[0] = unit;
+        report[1] = process_unit(unit);
+        status = std::max(status, report[1]);
+    }
+    return status;
+}
+
+int DistributedRunner::merge() {
+    if (config_.output_format != OutputFormat::BINARY) {
+        std::cout << "CSV output: shard outputs left unmerged in " << config_.output_dir << std::endl;
+        return 0;
+    }
+    try {
+        ShardMerger merger(config_.output_dir, FastaReader(config_.reference_fasta_path).chromosome_names());
+        merge_stats_ = merger.merge();
+    } catch (const std::exception& e) {
+        std::cerr << "Merge failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Merged " << merge_stats_.regions << " regions from " << merge_stats_.shard_files << " shards ("
+              << merge_stats_.duplicates << " duplicates, " << merge_stats_.failed << " failed) into "
+              << config_.output_dir << "/merged.index.tsv" << std::endl;
+    return 0;
+}
+
+} // namespace InterSubMod
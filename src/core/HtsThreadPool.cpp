@@ -0,0 +1,25 @@
+#include "core/HtsThreadPool.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace InterSubMod {
+
+HtsThreadPool::HtsThreadPool(int num_threads, int queue_size)
+    : pool_{nullptr, 0}, num_threads_(num_threads) {
+    if (num_threads <= 0) {
+        throw std::runtime_error("HtsThreadPool: thread count must be positive, got " + std::to_string(num_threads));
+    }
+    pool_.pool = hts_tpool_init(num_threads);
+    if (!pool_.pool) {
+        throw std::runtime_error("Failed to start HTSlib thread pool with " + std::to_string(num_threads) + " threads");
+    }
+    pool_.qsize = queue_size;
+}
+
+HtsThreadPool::~HtsThreadPool() {
+    if (pool_.pool) {
+        hts_tpool_destroy(pool_.pool);
+    }
+}
+
+} // namespace InterSubMod
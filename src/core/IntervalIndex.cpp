@@ -0,0 +1,114 @@
+#include "core/IntervalIndex.hpp"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+bool ChromIntervals::contains(int64_t pos) const {
+    size_t i = first_ending_after(pos);
+    return i < starts_.size() && starts_[i] <= pos;
+}
+
+bool ChromIntervals::overlaps(int64_t start, int64_t end) const {
+    if (end <= start) {
+        return false;
+    }
+    size_t i = first_ending_after(start);
+    return i < starts_.size() && starts_[i] < end;
+}
+
+size_t ChromIntervals::first_ending_after(int64_t pos) const {
+    // Merged intervals: ends are sorted as well as starts
+    return static_cast<size_t>(std::upper_bound(ends_.begin(), ends_.end(), pos) - ends_.begin());
+}
+
+int64_t ChromIntervals::covered_bp() const {
+    int64_t total = 0;
+    for (size_t i = 0; i < starts_.size(); i++) {
+        total += ends_[i] - starts_[i];
+    }
+    return total;
+}
+
+IntervalIndex IntervalIndex::load_bed(const std::string& bed_path) {
+    std::ifstream ifs(bed_path);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("Failed to open BED file: " + bed_path);
+    }
+
+    IntervalIndex index;
+    std::string line;
+    int line_num = 0;
+    while (std::getline(ifs, line)) {
+        line_num++;
+        if (line.empty() || line[0] == '#' || line.rfind("track", 0) == 0 || line.rfind("browser", 0) == 0) {
+            continue;
+        }
+        std::istringstream iss(line);
+        std::string chr;
+        int64_t start, end;
+        if (!(iss >> chr >> start >> end)) {
+            throw std::runtime_error("Malformed BED line " + std::to_string(line_num) + " in " + bed_path);
+        }
+        index.add(chr, start, end);
+    }
+    index.finalize();
+    return index;
+}
+
+void IntervalIndex::add(const std::string& chr, int64_t start, int64_t end) {
+    if (end <= start) {
+        return;
+    }
+    ChromIntervals& c = chroms_[chr];
+    c.starts_.push_back(std::max<int64_t>(start, 0));
+    c.ends_.push_back(end);
+}
+
+void IntervalIndex::finalize() {
+    for (auto& [chr, c] : chroms_) {
+        std::vector<size_t> order(c.starts_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return c.starts_[a] < c.starts_[b];
+        });
+
+        std::vector<int64_t> starts, ends;
+        for (size_t k : order) {
+            if (!ends.empty() && c.starts_[k] <= ends.back()) {
+                ends.back() = std::max(ends.back(), c.ends_[k]);  // overlapping or touching
+            } else {
+                starts.push_back(c.starts_[k]);
+                ends.push_back(c.ends_[k]);
+            }
+        }
+        c.starts_ = std::move(starts);
+        c.ends_ = std::move(ends);
+    }
+}
+
+const ChromIntervals* IntervalIndex::chrom(const std::string& chr) const {
+    auto it = chroms_.find(chr);
+    return it == chroms_.end() ? nullptr : &it->second;
+}
+
+size_t IntervalIndex::size() const {
+    size_t total = 0;
+    for (const auto& [chr, c] : chroms_) {
+        total += c.size();
+    }
+    return total;
+}
+
+int64_t IntervalIndex::covered_bp() const {
+    int64_t total = 0;
+    for (const auto& [chr, c] : chroms_) {
+        total += c.covered_bp();
+    }
+    return total;
+}
+
+} // namespace InterSubMod
@@ -1,6 +1,5 @@
 #include "core/MatrixBuilder.hpp"
 #include <algorithm>
-#include <set>
 #include <stdexcept>
 
 namespace InterSubMod {
@@ -9,16 +8,30 @@ int MatrixBuilder::add_read(const ReadInfo& read_info, const std::vector<MethylC
     if (finalized_) {
         throw std::runtime_error("MatrixBuilder::add_read: Cannot add reads after finalize()");
     }
-    
-    int read_id = reads_.size();
-    reads_.push_back(read_info);
-    
-    // Store methylation calls in temporary map
-    auto& methyl_map = read_methyl_map_[read_id];
+
+    int read_id = reads_.append(read_info);
+
+    // Append calls as flat (row, pos, prob) triples
+    for (const auto& call : methyl_calls) {
+        entries_.push_back(Entry{read_id, call.ref_pos, call.probability});
+    }
+
+    return read_id;
+}
+
+int MatrixBuilder::add_read(const ReadRecord& record, std::string_view read_name,
+                            const std::vector<MethylCall>& methyl_calls) {
+    if (finalized_) {
+        throw std::runtime_error("MatrixBuilder::add_read: Cannot add reads after finalize()");
+    }
+
+    int read_id = reads_.append(record, read_name);
+
+    // Append calls as flat (row, pos, prob) triples
     for (const auto& call : methyl_calls) {
-        methyl_map[call.ref_pos] = call.probability;
+        entries_.push_back(Entry{read_id, call.ref_pos, call.probability});
     }
-    
+
     return read_id;
 }
 
@@ -26,53 +39,118 @@ void MatrixBuilder::finalize() {
     if (finalized_) {
         return;  // Already finalized
     }
-    
-    // 1. Collect all unique CpG positions
-    std::set<int32_t> unique_cpgs;
-    for (const auto& [read_id, methyl_map] : read_methyl_map_) {
-        for (const auto& [cpg_pos, prob] : methyl_map) {
-            unique_cpgs.insert(cpg_pos);
+
+    // 1. Collect all unique CpG positions (sort/unique once, in scratch memory;
+    //    the kept column list is then allocated at its exact size)
+    std::pmr::memory_resource* scratch = entries_.get_allocator().resource();
+    {
+        std::pmr::vector<int32_t> positions(scratch);
+        positions.reserve(entries_.size());
+        for (const auto& e : entries_) {
+            positions.push_back(e.pos);
         }
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+        cpg_positions_.assign(positions.begin(), positions.end());
     }
-    
-    // 2. Convert to sorted vector (set is already sorted)
-    cpg_positions_.assign(unique_cpgs.begin(), unique_cpgs.end());
-    
-    // 3. Create position -> column index map
-    std::map<int32_t, int> pos_to_col;
-    for (size_t col = 0; col < cpg_positions_.size(); col++) {
-        pos_to_col[cpg_positions_[col]] = col;
-    }
-    
-    // 4. Allocate matrix
+
     int num_rows = reads_.size();
     int num_cols = cpg_positions_.size();
-    matrix_.resize(num_rows);
+
+    // 2. Build CSR; entries are already grouped by row (add_read order)
+    csr_.num_rows = num_rows;
+    csr_.num_cols = num_cols;
+    csr_.row_ptr.assign(num_rows + 1, 0);
+    const bool quantized = (storage_ == MatrixStorage::UINT8);
+    csr_.col_idx.clear();
+    csr_.values.clear();
+    csr_.quant_values.clear();
+    csr_.col_idx.reserve(entries_.size());
+    if (quantized) {
+        csr_.quant_values.reserve(entries_.size());
+    } else {
+        csr_.values.reserve(entries_.size());
+    }
+
+    size_t i = 0;
     for (int r = 0; r < num_rows; r++) {
-        matrix_[r].resize(num_cols, -1.0);  // -1.0 indicates no coverage
+        csr_.row_ptr[r] = static_cast<int32_t>(csr_.col_idx.size());
+
+        size_t j = i;
+        while (j < entries_.size() && entries_[j].row == r) j++;
+
+        // Order the row by position; stable so that the last duplicate wins below
+        auto by_pos = [](const Entry& a, const Entry& b) { return a.pos < b.pos; };
+        if (!std::is_sorted(entries_.begin() + i, entries_.begin() + j, by_pos)) {
+            std::stable_sort(entries_.begin() + i, entries_.begin() + j, by_pos);
+        }
+
+        auto col_it = cpg_positions_.begin();
+        for (size_t k = i; k < j; k++) {
+            if (k + 1 < j && entries_[k + 1].pos == entries_[k].pos) {
+                continue;  // Later call at the same position overrides this one
+            }
+            col_it = std::lower_bound(col_it, cpg_positions_.end(), entries_[k].pos);
+            csr_.col_idx.push_back(static_cast<int32_t>(col_it - cpg_positions_.begin()));
+            if (quantized) {
+                csr_.quant_values.push_back(Quant::encode(entries_[k].prob));
+            } else {
+                csr_.values.push_back(entries_[k].prob);
+            }
+        }
+        i = j;
     }
-    
-    // 5. Fill in methylation values
-    for (const auto& [read_id, methyl_map] : read_methyl_map_) {
-        for (const auto& [cpg_pos, prob] : methyl_map) {
-            int col = pos_to_col[cpg_pos];
-            matrix_[read_id][col] = prob;
+    csr_.row_ptr[num_rows] = static_cast<int32_t>(csr_.col_idx.size());
+
+    // 3. Allocate one contiguous row-major buffer and scatter the values
+    auto scatter = [&](auto& dense, const auto& values, auto sentinel) {
+        dense.assign(static_cast<size_t>(num_rows) * num_cols, sentinel);
+        for (int r = 0; r < num_rows; r++) {
+            auto* row = dense.data() + static_cast<size_t>(r) * num_cols;
+            for (int32_t k = csr_.row_ptr[r]; k < csr_.row_ptr[r + 1]; k++) {
+                row[csr_.col_idx[k]] = values[k];
+            }
         }
+    };
+    if (quantized) {
+        dense_.clear();
+        scatter(dense_quant_, csr_.quant_values, Quant::kNoCoverage);
+    } else {
+        dense_quant_.clear();
+        scatter(dense_, csr_.values, kNoCoverage);
     }
-    
-    // 6. Clear temporary storage
-    read_methyl_map_.clear();
-    
+
+    // 4. Release temporary storage (back to the scratch resource)
+    entries_ = std::pmr::vector<Entry>(scratch);
+
     finalized_ = true;
 }
 
+size_t MatrixBuilder::memory_bytes() const {
+    size_t bytes = reads_.memory_bytes();
+    bytes += cpg_positions_.capacity() * sizeof(int32_t);
+    bytes += csr_.row_ptr.capacity() * sizeof(int32_t);
+    bytes += csr_.col_idx.capacity() * sizeof(int32_t);
+    bytes += csr_.values.capacity() * sizeof(float);
+    bytes += csr_.quant_values.capacity();
+    bytes += dense_.capacity() * sizeof(float);
+    bytes += dense_quant_.capacity();
+    return bytes;
+}
+
 void MatrixBuilder::clear() {
     reads_.clear();
-    read_methyl_map_.clear();
+    entries_.clear();
     cpg_positions_.clear();
-    matrix_.clear();
+    csr_.num_rows = 0;
+    csr_.num_cols = 0;
+    csr_.row_ptr.clear();
+    csr_.col_idx.clear();
+    csr_.values.clear();
+    csr_.quant_values.clear();
+    dense_.clear();
+    dense_quant_.clear();
     finalized_ = false;
 }
 
 } // namespace InterSubMod
-
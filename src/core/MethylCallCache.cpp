@@ -0,0 +1,93 @@
+#include "core/MethylCallCache.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace InterSubMod {
+
+namespace {
+constexpr size_t kEntryOverhead = 96;  // List node, map node and Entry fields
+}
+
+void MethylCallCache::set_capacity(size_t max_bytes) {
+    max_bytes_ = max_bytes;
+    while (!lru_.empty() && bytes_ > max_bytes_) {
+        Entry& victim = lru_.back();
+        bytes_ -= victim.bytes;
+        map_.erase(victim.key);
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+MethylCallCache::Key MethylCallCache::make_key(const bam1_t* b, bool is_tumor) {
+    std::string_view name(bam_get_qname(b));
+    return Key{std::hash<std::string_view>{}(name), b->core.tid, static_cast<int32_t>(b->core.pos), is_tumor};
+}
+
+MethylCallCache::Entry* MethylCallCache::find(const bam1_t* b, bool is_tumor) {
+    auto it = map_.find(make_key(b, is_tumor));
+    if (it == map_.end() || it->second->name != bam_get_qname(b)) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &*it->second;
+}
+
+MethylCallCache::Entry* MethylCallCache::prepare(Entry* existing, const bam1_t* b, bool is_tumor,
+                                                 int32_t span_lo, int32_t span_hi) {
+    Key key = make_key(b, is_tumor);
+    Entry* e = existing;
+    if (!e) {
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            // Same key, different name (hash collision): take over the entry
+            lru_.splice(lru_.begin(), lru_, it->second);
+            e = &*it->second;
+        } else if (!lru_.empty() && bytes_ >= max_bytes_) {
+            // Full: recycle the least recently used entry and its buffers
+            lru_.splice(lru_.begin(), lru_, std::prev(lru_.end()));
+            e = &lru_.front();
+            map_.erase(e->key);
+            stats_.evictions++;
+            map_.emplace(key, lru_.begin());
+        } else {
+            lru_.emplace_front();
+            e = &lru_.front();
+            map_.emplace(key, lru_.begin());
+        }
+    }
+    bytes_ -= e->bytes;
+    e->bytes = 0;
+    e->key = key;
+    e->name.assign(bam_get_qname(b));
+    e->span_lo = span_lo;
+    e->span_hi = span_hi;
+    e->calls.clear();
+    return e;
+}
+
+void MethylCallCache::account(Entry& e) {
+    e.bytes = e.calls.capacity() * sizeof(MethylCall) + e.name.capacity() + kEntryOverhead;
+    bytes_ += e.bytes;
+    // Keep at least the entry just filled (the caller is about to use it)
+    while (lru_.size() > 1 && bytes_ > max_bytes_) {
+        Entry& victim = lru_.back();
+        bytes_ -= victim.bytes;
+        map_.erase(victim.key);
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+void MethylCallCache::slice(const std::vector<MethylCall>& calls, int32_t lo, int32_t hi,
+                            std::vector<MethylCall>& out) {
+    out.clear();
+    // ref_pos is 1-based: a call covers position ref_pos - 1
+    auto first = std::lower_bound(calls.begin(), calls.end(), lo + 1,
+                                  [](const MethylCall& c, int32_t pos) { return c.ref_pos < pos; });
+    auto last = std::lower_bound(first, calls.end(), hi + 1,
+                                 [](const MethylCall& c, int32_t pos) { return c.ref_pos < pos; });
+    out.assign(first, last);
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,109 @@
+#include "core/MethylationMatrix.hpp"
+#include "core/MethylQuant.hpp"
+#include <limits>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+double MethylationMatrix::probability(int r, int c) const {
+    if (raw_matrix.size() > 0) {
+        return raw_matrix(r, c);
+    }
+    const uint8_t q = quant_matrix(r, c);
+    return q == Quant::kNoCoverage ? std::numeric_limits<double>::quiet_NaN() : Quant::decode(q);
+}
+
+void MethylationMatrix::set_quantized(const MatrixView& view, double high, double low) {
+    const int rows = static_cast<int>(view.rows());
+    const int cols = static_cast<int>(view.cols());
+    const Quant::BinaryThresholds thresholds(high, low);
+
+    raw_matrix.resize(0, 0);
+    quant_matrix.resize(rows, cols);
+    binary_matrix.resize(rows, cols);
+
+    // Eigen storage is column-major; the view is row-major
+    for (int r = 0; r < rows; r++) {
+        if (view.quantized()) {
+            const uint8_t* row = view.quant_data() + static_cast<size_t>(r) * cols;
+            for (int c = 0; c < cols; c++) {
+                quant_matrix(r, c) = row[c];
+            }
+        } else {
+            const float* row = view.data() + static_cast<size_t>(r) * cols;
+            for (int c = 0; c < cols; c++) {
+                quant_matrix(r, c) = Quant::encode(row[c]);
+            }
+        }
+        for (int c = 0; c < cols; c++) {
+            binary_matrix(r, c) = thresholds.call(quant_matrix(r, c));
+        }
+    }
+}
+
+void MethylationMatrix::build(const MatrixBuilder& builder, double methyl_high, double methyl_low,
+                              int min_site_coverage) {
+    const CsrMatrix& csr = builder.get_csr();
+    const ReadTable& reads = builder.get_reads();
+    const std::vector<int32_t>& positions = builder.get_cpg_positions();
+    if (csr.num_rows != static_cast<int>(reads.size()) || csr.num_cols != static_cast<int>(positions.size())) {
+        throw std::runtime_error("MethylationMatrix::build: MatrixBuilder is not finalized");
+    }
+    const int rows = csr.num_rows;
+    const bool quantized = (builder.storage() == MatrixStorage::UINT8);
+
+    // 1. Coverage per column from the column indices alone
+    std::vector<int> coverage(csr.num_cols, 0);
+    for (int32_t c : csr.col_idx) {
+        coverage[c]++;
+    }
+
+    // 2. Kept columns get consecutive indices; dropped ones map to -1
+    std::vector<int> new_col(csr.num_cols, -1);
+    cpg_ids.clear();
+    cpg_positions.clear();
+    for (int c = 0; c < csr.num_cols; c++) {
+        if (coverage[c] >= min_site_coverage) {
+            new_col[c] = static_cast<int>(cpg_ids.size());
+            cpg_ids.push_back(c);
+            cpg_positions.push_back(positions[c]);
+        }
+    }
+    const int cols = static_cast<int>(cpg_ids.size());
+
+    read_ids.resize(rows);
+    for (int r = 0; r < rows; r++) {
+        read_ids[r] = reads.read_id(r);
+    }
+
+    // 3. One pass over the stored values fills both matrices
+    binary_matrix.setConstant(rows, cols, -1);
+    if (quantized) {
+        const Quant::BinaryThresholds thresholds(methyl_high, methyl_low);
+        raw_matrix.resize(0, 0);
+        quant_matrix.setConstant(rows, cols, Quant::kNoCoverage);
+        for (int r = 0; r < rows; r++) {
+            for (int32_t k = csr.row_ptr[r]; k < csr.row_ptr[r + 1]; k++) {
+                const int c = new_col[csr.col_idx[k]];
+                if (c < 0) continue;
+                const uint8_t q = csr.quant_values[k];
+                quant_matrix(r, c) = q;
+                binary_matrix(r, c) = thresholds.call(q);
+            }
+        }
+    } else {
+        quant_matrix.resize(0, 0);
+        raw_matrix.setConstant(rows, cols, std::numeric_limits<double>::quiet_NaN());
+        for (int r = 0; r < rows; r++) {
+            for (int32_t k = csr.row_ptr[r]; k < csr.row_ptr[r + 1]; k++) {
+                const int c = new_col[csr.col_idx[k]];
+                if (c < 0) continue;
+                const double p = csr.values[k];
+                raw_matrix(r, c) = p;
+                binary_matrix(r, c) = p >= methyl_high ? 1 : (p <= methyl_low ? 0 : -1);
+            }
+        }
+    }
+}
+
+} // namespace InterSubMod
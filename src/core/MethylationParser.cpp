@@ -1,6 +1,12 @@
 #include "core/MethylationParser.hpp"
-#include <sstream>
+#include "utils/SeqScan.hpp"
+#include "utils/ReferenceCache.hpp"
+#include "core/IntervalIndex.hpp"
 #include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 
 namespace InterSubMod {
 
@@ -12,227 +18,254 @@ static inline uint32_t le_to_u32(const uint8_t* bytes) {
            (static_cast<uint32_t>(bytes[3]) << 24);
 }
 
+// Parses a decimal int at s with std::stoi semantics (leading whitespace and
+// sign allowed, trailing characters ignored, out-of-range = invalid).
+static inline bool parse_int(const char* s, int& value) {
+    // Fast path: plain digits, short enough that int cannot overflow
+    if (*s >= '0' && *s <= '9') {
+        int v = 0;
+        int n = 0;
+        const char* p = s;
+        while (*p >= '0' && *p <= '9' && n < 9) {
+            v = v * 10 + (*p - '0');
+            p++;
+            n++;
+        }
+        if (!(*p >= '0' && *p <= '9')) {
+            value = v;
+            return true;
+        }
+    }
+
+    // General path (whitespace, sign, long numbers)
+    char* end = nullptr;
+    errno = 0;
+    long v = std::strtol(s, &end, 10);
+    if (end == s || errno == ERANGE || v < INT_MIN || v > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(v);
+    return true;
+}
+
 std::vector<MethylCall> MethylationParser::parse_read(
     const bam1_t* b,
-    const std::string& ref_seq,
+    std::string_view ref_seq,
     int32_t ref_start_pos
 ) {
     std::vector<MethylCall> calls;
-    
+    parse_read(b, ref_seq, ref_start_pos, calls);
+    return calls;
+}
+
+size_t MethylationParser::parse_read(
+    const bam1_t* b,
+    std::string_view ref_seq,
+    int32_t ref_start_pos,
+    std::vector<MethylCall>& calls,
+    const CpGBitmap* cpg_sites
+) {
+    aln_.reset(b);
+    return parse_read(b, aln_, ref_seq, ref_start_pos, calls, cpg_sites);
+}
+
+size_t MethylationParser::parse_read(
+    const bam1_t* b,
+    const AlignmentView& aln,
+    std::string_view ref_seq,
+    int32_t ref_start_pos,
+    std::vector<MethylCall>& calls,
+    const CpGBitmap* cpg_sites
+) {
+    calls.clear();
+
     // 1. Retrieve MM and ML tags
     uint8_t* mm_aux = bam_aux_get(b, "MM");
     uint8_t* ml_aux = bam_aux_get(b, "ML");
-    
+
     if (!mm_aux || !ml_aux) {
-        return calls;  // No methylation tags
+        return 0;  // No methylation tags
     }
-    
+
     const char* mm_str = bam_aux2Z(mm_aux);
-    
+    if (!mm_str) {
+        return 0;  // MM is not a string tag
+    }
+
     // 2. Parse ML array
     // Format: 'B' (array type), 'C' (uint8), [4 bytes length], [data...]
     if (ml_aux[0] != 'B' || ml_aux[1] != 'C') {
-        return calls;  // Invalid ML format
+        return 0;  // Invalid ML format
     }
-    
+
     uint32_t ml_len = le_to_u32(ml_aux + 2);
     const uint8_t* ml_data = ml_aux + 6;
-    
+
     // 3. Parse MM tag to get delta-encoded positions and ML offset
     // MM format: "C+h?,<deltas>;C+m?,<deltas>;"
-    // Each modification type has its own delta list
     // ML array contains all probabilities in order: [C+h? probs..., C+m? probs...]
-    
     int ml_offset = 0;
-    std::vector<int> deltas;
-    
-    // First, count deltas for all modification types before "C+m?"
-    std::string mm_string(mm_str);
-    size_t cm_pos = mm_string.find("C+m?");
-    
-    if (cm_pos != std::string::npos) {
-        // Count commas before "C+m?" to find ML offset
-        for (size_t i = 0; i < cm_pos; i++) {
-            if (mm_string[i] == ',') {
-                ml_offset++;
-            }
-        }
-        // Subtract semicolons (they don't count towards ML offset)
-        for (size_t i = 0; i < cm_pos; i++) {
-            if (mm_string[i] == ';') {
-                ml_offset--;
-            }
-        }
-        
-        // Now parse the deltas for "C+m?"
-        deltas = parse_mm_tag(mm_str, "C+m?");
-    }
-    
-    if (deltas.empty()) {
-        return calls;  // No 5mC modifications found
+    if (!parse_mm_tag(mm_str, "C+m?", deltas_, ml_offset) || deltas_.empty()) {
+        return 0;  // No 5mC modifications found
     }
-    
+
     // Verify we have enough ML data
-    if (static_cast<size_t>(ml_offset + deltas.size()) > ml_len) {
-        return calls;  // Not enough ML data
+    if (static_cast<size_t>(ml_offset + deltas_.size()) > ml_len) {
+        return 0;  // Not enough ML data
     }
-    
-    // 4. Build sequence-to-reference mapping
-    std::vector<int32_t> seq_to_ref = build_seq_to_ref_map(b);
-    
-    // 5. Iterate through read sequence to find modified cytosines
-    uint8_t* seq = bam_get_seq(b);
-    int seq_len = b->core.l_qseq;
-    
-    int c_count = 0;       // Count of 'C' bases in read sequence
-    size_t delta_idx = 0;  // Current index in deltas array
-    int next_c_target = deltas.empty() ? -1 : deltas[0];  // Next 'C' that has modification
-    
-    for (int seq_idx = 0; seq_idx < seq_len; seq_idx++) {
-        char base = seq_nt16_str[bam_seqi(seq, seq_idx)];
-        
-        if (base == 'C') {
-            if (c_count == next_c_target) {
-                // This 'C' has methylation information
-                int32_t ref_pos_0based = seq_to_ref[seq_idx];
-                
-                if (ref_pos_0based >= 0) {  // Not an insertion
-                    // Calculate offset in ref_seq
-                    int ref_offset = ref_pos_0based - ref_start_pos;
-                    
-                    // Validate bounds and CpG context
-                    if (ref_offset >= 0 && static_cast<size_t>(ref_offset) < ref_seq.size()) {
-                        if (ref_seq[ref_offset] == 'C' && is_cpg_site(ref_seq, ref_offset)) {
-                            // Valid CpG site - use ml_offset to get correct probability
-                            float prob = ml_data[ml_offset + delta_idx] / 255.0f;
-                            calls.emplace_back(ref_pos_0based + 1, prob);  // Convert to 1-based
+
+    // 4. Locate every 'C' of the read with the vectorized nibble scan; the
+    // MM deltas then index straight into this list (C ordinal -> read position).
+    // Bases outside M/=/X blocks (insertions, soft clips, bases beyond the
+    // CIGAR) still count towards the MM deltas but have no reference position.
+    const size_t n_c = Utils::find_bases(bam_get_seq(b), b->core.l_qseq, Utils::NT16_C, c_positions_);
+    const size_t n_deltas = deltas_.size();
+
+    // Monotonic block cursor: read positions are visited in increasing order
+    const std::vector<AlignmentView::Block>& blocks = aln.blocks();
+    const size_t n_blocks = blocks.size();
+    size_t blk = 0;
+
+    int64_t next_c_target = deltas_[0];  // Ordinal of the next 'C' that has modification
+    size_t delta_idx = 0;                // Current index in deltas array
+
+    // Exclusion cursor: reference positions only increase along the read
+    const ChromIntervals* excluded = excluded_;
+    size_t excl_idx = excluded ? excluded->first_ending_after(b->core.pos) : 0;
+
+    while (next_c_target >= 0 && static_cast<size_t>(next_c_target) < n_c) {
+        const int32_t seq_idx = c_positions_[next_c_target];
+
+        // Advance to the first aligned block not ending before seq_idx
+        while (blk < n_blocks && blocks[blk].query_end() <= seq_idx) {
+            blk++;
+        }
+        bool aligned = blk < n_blocks && blocks[blk].query_start <= seq_idx;
+
+        // This 'C' has methylation information
+        if (aligned) {
+            int32_t ref_pos_0based = blocks[blk].ref_start + (seq_idx - blocks[blk].query_start);
+
+            if (ref_pos_0based >= 0) {
+                // Calculate offset in ref_seq
+                int ref_offset = ref_pos_0based - ref_start_pos;
+
+                // Validate bounds and CpG context
+                if (ref_offset >= 0 && static_cast<size_t>(ref_offset) < ref_seq.size()) {
+                    // The bitmap covers the whole chromosome; keep the slice's
+                    // last-base rule so both paths accept the same sites
+                    bool cpg = cpg_sites
+                        ? (static_cast<size_t>(ref_offset) + 1 < ref_seq.size() && cpg_sites->test(ref_pos_0based))
+                        : (ref_seq[ref_offset] == 'C' && is_cpg_site(ref_seq, ref_offset));
+                    if (cpg && excluded) {
+                        while (excl_idx < excluded->size() && excluded->end(excl_idx) <= ref_pos_0based) {
+                            excl_idx++;
+                        }
+                        if (excl_idx < excluded->size() && excluded->start(excl_idx) <= ref_pos_0based) {
+                            cpg = false;  // Inside an excluded interval (e.g. PMD)
+                            excluded_calls_++;
                         }
                     }
-                }
-                
-                // Move to next delta
-                delta_idx++;
-                if (delta_idx < deltas.size()) {
-                    // Delta encoding: add (delta + 1) to get next target
-                    next_c_target += deltas[delta_idx] + 1;
-                } else {
-                    next_c_target = -1;  // No more modifications
+                    if (cpg) {
+                        // Valid CpG site - use ml_offset to get correct probability
+                        float prob = ml_data[ml_offset + delta_idx] / 255.0f;
+                        calls.emplace_back(ref_pos_0based + 1, prob);  // Convert to 1-based
+                    }
                 }
             }
-            c_count++;
         }
+
+        // Move to next delta
+        delta_idx++;
+        if (delta_idx >= n_deltas) {
+            break;  // No more modifications
+        }
+        // Delta encoding: add (delta + 1) to get next target
+        int64_t target = next_c_target + deltas_[delta_idx] + 1;
+        if (target <= next_c_target) {
+            break;  // Negative delta: target already passed
+        }
+        next_c_target = target;
     }
-    
-    return calls;
+
+    return calls.size();
 }
 
-std::vector<int> MethylationParser::parse_mm_tag(const char* mm_str, const std::string& mod_code) {
-    std::vector<int> deltas;
-    
-    if (!mm_str) {
-        return deltas;
+bool MethylationParser::parse_mm_tag(
+    const char* mm_str,
+    const char* mod_code,
+    std::vector<int>& deltas,
+    int& ml_offset
+) {
+    deltas.clear();
+    ml_offset = 0;
+
+    if (!mm_str || !mod_code || !mod_code[0]) {
+        return false;
     }
-    
-    std::string mm(mm_str);
-    
-    // Find the modification code (e.g., "C+m?")
-    size_t pos = mm.find(mod_code);
-    if (pos == std::string::npos) {
-        return deltas;  // Modification type not found
+
+    // Find the first occurrence of the modification code (e.g., "C+m?").
+    // Every ',' before it is one ML value of a preceding modification;
+    // each ';' closes a group header and does not count.
+    const size_t code_len = std::strlen(mod_code);
+    const char* p = mm_str;
+    int offset = 0;
+    for (;; p++) {
+        if (*p == '\0') {
+            return false;  // Modification type not found
+        }
+        if (*p == mod_code[0] && std::strncmp(p, mod_code, code_len) == 0) {
+            break;
+        }
+        if (*p == ',') {
+            offset++;
+        } else if (*p == ';') {
+            offset--;
+        }
     }
-    
+    ml_offset = offset;
+
     // Skip past the modification code and comma
-    pos += mod_code.length();
-    if (pos >= mm.length() || mm[pos] != ',') {
-        return deltas;  // No deltas following (shouldn't happen for valid MM)
+    p += code_len;
+    if (*p != ',') {
+        return true;  // No deltas following (shouldn't happen for valid MM)
     }
-    pos++;  // Skip comma
-    
+    p++;
+
     // Parse comma-separated integers until ';' or end of string
-    std::string remaining = mm.substr(pos);
-    std::istringstream ss(remaining);
-    std::string token;
-    
-    while (std::getline(ss, token, ',')) {
-        // Stop if we hit a semicolon (start of next modification type)
-        size_t semi_pos = token.find(';');
-        if (semi_pos != std::string::npos) {
-            token = token.substr(0, semi_pos);
-            if (!token.empty()) {
-                try {
-                    deltas.push_back(std::stoi(token));
-                } catch (...) {
-                    // Invalid number, skip
-                }
+    for (;;) {
+        const char* token = p;
+        while (*p != ',' && *p != ';' && *p != '\0') {
+            p++;
+        }
+        bool non_empty = (p > token);
+        int value = 0;
+
+        if (*p == ';') {
+            // Last token of this modification type; invalid numbers are skipped
+            if (non_empty && parse_int(token, value)) {
+                deltas.push_back(value);
             }
             break;
         }
-        
-        if (!token.empty()) {
-            try {
-                deltas.push_back(std::stoi(token));
-            } catch (...) {
-                // Invalid number, stop parsing
-                break;
+
+        if (non_empty) {
+            if (!parse_int(token, value)) {
+                break;  // Invalid number, stop parsing
             }
+            deltas.push_back(value);
         }
-    }
-    
-    return deltas;
-}
 
-std::vector<int32_t> MethylationParser::build_seq_to_ref_map(const bam1_t* b) {
-    std::vector<int32_t> seq_to_ref(b->core.l_qseq, -1);
-    
-    int32_t ref_pos = b->core.pos;  // Current reference position (0-based)
-    int seq_pos = 0;                 // Current sequence position
-    
-    uint32_t* cigar = bam_get_cigar(b);
-    
-    for (uint32_t i = 0; i < b->core.n_cigar; i++) {
-        int op = bam_cigar_op(cigar[i]);
-        int len = bam_cigar_oplen(cigar[i]);
-        
-        switch (op) {
-            case BAM_CMATCH:    // M
-            case BAM_CEQUAL:    // =
-            case BAM_CDIFF:     // X
-                // Match/mismatch: both ref and seq advance
-                for (int j = 0; j < len; j++) {
-                    if (seq_pos < b->core.l_qseq) {
-                        seq_to_ref[seq_pos] = ref_pos;
-                    }
-                    seq_pos++;
-                    ref_pos++;
-                }
-                break;
-                
-            case BAM_CINS:      // I
-            case BAM_CSOFT_CLIP: // S
-                // Insertion/soft clip: only seq advances, ref positions remain -1
-                seq_pos += len;
-                break;
-                
-            case BAM_CDEL:      // D
-            case BAM_CREF_SKIP:  // N
-                // Deletion/skip: only ref advances
-                ref_pos += len;
-                break;
-                
-            case BAM_CHARD_CLIP: // H
-                // Hard clip: does not appear in SEQ, no action needed
-                break;
-                
-            default:
-                // Unknown CIGAR operation, skip
-                break;
+        if (*p == '\0') {
+            break;
         }
+        p++;  // Skip comma
     }
-    
-    return seq_to_ref;
+
+    return true;
 }
 
-bool MethylationParser::is_cpg_site(const std::string& ref_seq, size_t offset) {
+bool MethylationParser::is_cpg_site(std::string_view ref_seq, size_t offset) {
     if (offset + 1 >= ref_seq.size()) {
         return false;
     }
@@ -240,4 +273,3 @@ bool MethylationParser::is_cpg_site(const std::string& ref_seq, size_t offset) {
 }
 
 } // namespace InterSubMod
-
@@ -3,142 +3,162 @@
 
 namespace InterSubMod {
 
+ReadFilterConfig ReadFilterConfig::from_config(const Config& config) {
+    ReadFilterConfig filter;
+    filter.min_mapq = config.min_mapq;
+    filter.min_read_length = config.min_read_length;
+    filter.min_base_quality = config.min_base_quality;
+    return filter;
+}
+
 ReadParser::ReadParser(const ReadFilterConfig& config)
     : config_(config) {
 }
 
-bool ReadParser::should_keep(const bam1_t* b) const {
-    // Check FLAG - filter out unwanted reads
-    uint16_t flag = b->core.flag;
-    if (flag & BAM_FSECONDARY) return false;      // Secondary alignment
-    if (flag & BAM_FSUPPLEMENTARY) return false;  // Supplementary alignment
-    if (flag & BAM_FDUP) return false;            // PCR/optical duplicate
-    if (flag & BAM_FUNMAP) return false;          // Unmapped
+bool ReadParser::passes_flag_and_mapq(const bam1_t* b, ReadFilterStats* stats) const {
+    if (stats) stats->seen++;
     
-    // Check MAPQ
-    if (b->core.qual < config_.min_mapq) {
+    // Check FLAG - filter out unwanted reads
+    // (secondary, supplementary, PCR/optical duplicate, unmapped)
+    constexpr uint16_t kRejectFlags = BAM_FSECONDARY | BAM_FSUPPLEMENTARY | BAM_FDUP | BAM_FUNMAP;
+    if (b->core.flag & kRejectFlags) {
+        if (stats) stats->failed_flag++;
         return false;
     }
     
-    // Check read length
-    int read_len = bam_cigar2qlen(b->core.n_cigar, bam_get_cigar(b));
-    if (read_len < config_.min_read_length) {
+    // Check MAPQ
+    if (b->core.qual < config_.min_mapq) {
+        if (stats) stats->failed_mapq++;
         return false;
     }
-    
+    return true;
+}
+
+bool ReadParser::has_required_tags(const bam1_t* b, ReadFilterStats* stats) const {
     // Check for MM/ML tags if required
     if (config_.require_mm_ml) {
         uint8_t* mm_aux = bam_aux_get(b, "MM");
         uint8_t* ml_aux = bam_aux_get(b, "ML");
         if (!mm_aux || !ml_aux) {
+            if (stats) stats->failed_tags++;
             return false;
         }
     }
-    
+    if (stats) stats->kept++;
     return true;
 }
 
+bool ReadParser::should_keep(const bam1_t* b, ReadFilterStats* stats) const {
+    if (!passes_flag_and_mapq(b, stats)) {
+        return false;
+    }
+    
+    // Check read length
+    int read_len = bam_cigar2qlen(b->core.n_cigar, bam_get_cigar(b));
+    if (read_len < config_.min_read_length) {
+        if (stats) stats->failed_length++;
+        return false;
+    }
+    
+    return has_required_tags(b, stats);
+}
+
+bool ReadParser::should_keep(const bam1_t* b, AlignmentView& aln, ReadFilterStats* stats) const {
+    if (!passes_flag_and_mapq(b, stats)) {
+        return false;
+    }
+    
+    // The same CIGAR pass serves parse() and the methylation mapping
+    aln.reset(b);
+    if (aln.query_length() < config_.min_read_length) {
+        if (stats) stats->failed_length++;
+        return false;
+    }
+    
+    return has_required_tags(b, stats);
+}
+
+ReadInfo ReadParser::parse(
+    const bam1_t* b,
+    int read_id,
+    bool is_tumor,
+    const SomaticSnv& anchor_snv,
+    std::string_view ref_seq,
+    int32_t ref_start_pos
+) const {
+    AlignmentView aln(b);
+    return parse(b, aln, read_id, is_tumor, anchor_snv, ref_seq, ref_start_pos);
+}
+
 ReadInfo ReadParser::parse(
     const bam1_t* b,
+    const AlignmentView& aln,
     int read_id,
     bool is_tumor,
     const SomaticSnv& anchor_snv,
-    const std::string& ref_seq,
+    std::string_view ref_seq,
     int32_t ref_start_pos
 ) const {
+    ReadRecord r = parse_record(b, aln, read_id, is_tumor, anchor_snv, ref_seq, ref_start_pos);
+    
     ReadInfo info;
+    info.read_id = r.read_id;
+    info.read_name = bam_get_qname(b);
+    info.chr_id = r.chr_id;
+    info.align_start = r.align_start;
+    info.align_end = r.align_end;
+    info.mapq = r.mapq;
+    info.hp_tag = r.hp_tag;
+    info.is_tumor = r.is_tumor;
+    info.alt_support = r.alt_support;
+    return info;
+}
+
+ReadRecord ReadParser::parse_record(
+    const bam1_t* b,
+    const AlignmentView& aln,
+    int read_id,
+    bool is_tumor,
+    const SomaticSnv& anchor_snv,
+    std::string_view ref_seq,
+    int32_t ref_start_pos
+) const {
+    ReadRecord r;
     
     // Basic information
-    info.read_id = read_id;
-    info.read_name = bam_get_qname(b);
-    info.chr_id = anchor_snv.chr_id;
-    info.align_start = b->core.pos;  // 0-based
-    info.align_end = bam_endpos(b);  // 0-based, exclusive
-    info.mapq = b->core.qual;
-    info.is_tumor = is_tumor;
+    r.read_id = read_id;
+    r.chr_id = anchor_snv.chr_id;
+    r.align_start = aln.ref_start();  // 0-based
+    r.align_end = aln.ref_end();      // 0-based, exclusive
+    r.mapq = b->core.qual;
+    r.is_tumor = is_tumor;
     
     // Extract HP tag (haplotype)
-    info.hp_tag = 0;  // Default: unknown
+    r.hp_tag = 0;  // Default: unknown
     uint8_t* hp_aux = bam_aux_get(b, "HP");
     if (hp_aux) {
-        info.hp_tag = bam_aux2i(hp_aux);
+        int64_t hp = bam_aux2i(hp_aux);
+        r.hp_tag = (hp >= -128 && hp <= 127) ? static_cast<int8_t>(hp) : 0;
     }
     
     // Determine ALT support
-    info.alt_support = determine_alt_support(b, anchor_snv, ref_seq, ref_start_pos);
+    r.alt_support = determine_alt_support(b, aln, anchor_snv, ref_seq, ref_start_pos);
     
-    return info;
+    return r;
 }
 
 AltSupport ReadParser::determine_alt_support(
     const bam1_t* b,
+    const AlignmentView& aln,
     const SomaticSnv& snv,
-    const std::string& ref_seq [[maybe_unused]],
+    std::string_view ref_seq [[maybe_unused]],
     int32_t ref_start_pos [[maybe_unused]]
 ) const {
-    // SNV position (convert 1-based to 0-based)
-    int32_t snv_pos_0based = snv.pos - 1;
-    
-    // Check if read covers the SNV position
-    int32_t read_start = b->core.pos;
-    int32_t read_end = bam_endpos(b);
-    
-    if (snv_pos_0based < read_start || snv_pos_0based >= read_end) {
-        return AltSupport::UNKNOWN;  // Does not cover SNV
-    }
-    
-    // Traverse CIGAR to find read offset at SNV position
-    int32_t ref_pos = read_start;  // Current reference position
-    int seq_pos = 0;               // Current sequence position
-    int read_offset = -1;          // Sequence offset at SNV position
-    
-    uint32_t* cigar = bam_get_cigar(b);
-    for (uint32_t i = 0; i < b->core.n_cigar; i++) {
-        int op = bam_cigar_op(cigar[i]);
-        int len = bam_cigar_oplen(cigar[i]);
-        
-        switch (op) {
-            case BAM_CMATCH:   // M
-            case BAM_CEQUAL:   // =
-            case BAM_CDIFF:    // X
-                // Match/mismatch: consumes both ref and seq
-                if (ref_pos <= snv_pos_0based && snv_pos_0based < ref_pos + len) {
-                    read_offset = seq_pos + (snv_pos_0based - ref_pos);
-                    goto found_offset;
-                }
-                ref_pos += len;
-                seq_pos += len;
-                break;
-                
-            case BAM_CINS:     // I
-            case BAM_CSOFT_CLIP: // S
-                // Insertion/soft clip: consumes only seq
-                seq_pos += len;
-                break;
-                
-            case BAM_CDEL:     // D
-            case BAM_CREF_SKIP: // N
-                // Deletion/skip: consumes only ref
-                if (ref_pos <= snv_pos_0based && snv_pos_0based < ref_pos + len) {
-                    // SNV falls within a deletion
-                    return AltSupport::UNKNOWN;
-                }
-                ref_pos += len;
-                break;
-                
-            case BAM_CHARD_CLIP: // H
-                // Hard clip: consumes nothing
-                break;
-                
-            default:
-                // Unknown CIGAR operation
-                break;
-        }
-    }
-    
-found_offset:
-    if (read_offset == -1) {
-        return AltSupport::UNKNOWN;  // Could not find SNV position in read
+    // SNV position (convert 1-based to 0-based); -1 when the read does not
+    // cover it or it falls in a deletion / reference skip
+    int32_t read_offset = aln.query_offset(snv.pos - 1);
+    if (read_offset < 0 || read_offset >= b->core.l_qseq) {
+        return AltSupport::UNKNOWN;
     }
     
     // Check base quality at SNV position
@@ -0,0 +1,135 @@
+#include "core/ReadSampler.hpp"
+#include "utils/Hash.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace InterSubMod {
+
+void ReadSampler::configure(int max_reads, uint64_t seed) {
+    max_reads_ = max_reads > 0 ? max_reads : 0;
+    seed_ = seed;
+    reset();
+}
+
+void ReadSampler::reset() {
+    seen_ = 0;
+    used_slots_ = 0;
+    free_slots_.clear();
+    for (auto& heap : reservoir_) {
+        heap.clear();
+    }
+    stratum_size_.fill(0);
+    selected_.clear();
+}
+
+size_t ReadSampler::stratum_of(const ReadRecord& record) {
+    size_t hp = (record.hp_tag == 1 || record.hp_tag == 2) ? static_cast<size_t>(record.hp_tag) : 0;
+    size_t alt = static_cast<size_t>(record.alt_support);
+    return (record.is_tumor ? 0 : 9) + hp * 3 + alt;
+}
+
+uint64_t ReadSampler::key_of(std::string_view name, uint64_t seed) {
+    // splitmix64 finalizer over FNV-1a(name) ^ seed
+    uint64_t z = Utils::fnv1a64(name) ^ (seed * 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int ReadSampler::take_slot() {
+    if (!free_slots_.empty()) {
+        int slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+    if (used_slots_ == slots_.size()) {
+        slots_.emplace_back();
+    }
+    return static_cast<int>(used_slots_++);
+}
+
+std::vector<MethylCall>* ReadSampler::offer(const ReadRecord& record, std::string_view name) {
+    const size_t stratum = stratum_of(record);
+    const uint64_t key = key_of(name, seed_);
+    const uint32_t arrival = static_cast<uint32_t>(seen_++);
+    stratum_size_[stratum]++;
+
+    std::vector<int>& heap = reservoir_[stratum];
+    auto heap_less = [this](int a, int b) { return before(a, b); };
+    int slot;
+    if (heap.size() < static_cast<size_t>(max_reads_)) {
+        slot = take_slot();
+    } else {
+        // Full: the new read must beat the largest key in the reservoir
+        const Slot& top = slots_[heap.front()];
+        if (key > top.key || (key == top.key && arrival > top.arrival)) {
+            return nullptr;
+        }
+        std::pop_heap(heap.begin(), heap.end(), heap_less);
+        slot = heap.back();
+        heap.pop_back();
+    }
+
+    Slot& s = slots_[slot];
+    s.key = key;
+    s.arrival = arrival;
+    s.record = record;
+    s.name.assign(name.data(), name.size());
+    s.calls.clear();
+    heap.push_back(slot);
+    std::push_heap(heap.begin(), heap.end(), heap_less);
+    return &s.calls;
+}
+
+void ReadSampler::select() {
+    selected_.clear();
+    const size_t total = seen_;
+    const size_t cap = static_cast<size_t>(max_reads_);
+
+    // Per-stratum quotas: proportional to stratum size, largest remainder
+    std::array<size_t, kNumStrata> quota{};
+    if (total <= cap) {
+        for (size_t s = 0; s < kNumStrata; s++) quota[s] = stratum_size_[s];
+    } else {
+        std::array<double, kNumStrata> remainder{};
+        size_t assigned = 0;
+        for (size_t s = 0; s < kNumStrata; s++) {
+            double exact = static_cast<double>(cap) * stratum_size_[s] / total;
+            quota[s] = static_cast<size_t>(exact);
+            if (stratum_size_[s] > 0 && quota[s] == 0) {
+                quota[s] = 1;  // Keep rare strata (e.g. a few ALT reads) represented
+                exact = 1.0;
+            }
+            remainder[s] = exact - quota[s];
+            assigned += quota[s];
+        }
+        std::array<size_t, kNumStrata> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return remainder[a] > remainder[b]; });
+        for (size_t i = 0; assigned < cap && i < kNumStrata; i++) {
+            size_t s = order[i];
+            if (quota[s] < std::min<size_t>(stratum_size_[s], cap)) {
+                quota[s]++;
+                assigned++;
+            }
+        }
+        // The minimum of one per stratum may overshoot: take back from the largest quotas
+        while (assigned > cap) {
+            size_t s = static_cast<size_t>(std::max_element(quota.begin(), quota.end()) - quota.begin());
+            quota[s]--;
+            assigned--;
+        }
+    }
+
+    // Smallest keys of each reservoir up to its quota
+    for (size_t s = 0; s < kNumStrata; s++) {
+        std::vector<int>& heap = reservoir_[s];
+        size_t take = std::min(quota[s], heap.size());
+        std::sort_heap(heap.begin(), heap.end(), [this](int a, int b) { return before(a, b); });
+        selected_.insert(selected_.end(), heap.begin(), heap.begin() + take);
+    }
+    std::sort(selected_.begin(), selected_.end(),
+              [this](int a, int b) { return slots_[a].arrival < slots_[b].arrival; });
+}
+
+} // namespace InterSubMod
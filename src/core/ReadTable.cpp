@@ -0,0 +1,105 @@
+#include "core/ReadTable.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+int ReadTable::append(const ReadRecord& record, std::string_view name) {
+    if (names_.size() + name.size() > UINT32_MAX) {
+        throw std::runtime_error("ReadTable::append: name pool exceeds 4 GiB");
+    }
+    int row = static_cast<int>(read_id_.size());
+    read_id_.push_back(record.read_id);
+    chr_id_.push_back(record.chr_id);
+    align_start_.push_back(record.align_start);
+    align_end_.push_back(record.align_end);
+    mapq_.push_back(record.mapq);
+    hp_tag_.push_back(record.hp_tag);
+    alt_support_.push_back(static_cast<uint8_t>(record.alt_support));
+    is_tumor_.push_back(record.is_tumor ? 1 : 0);
+    names_.append(name.data(), name.size());
+    name_offset_.push_back(static_cast<uint32_t>(names_.size()));
+    return row;
+}
+
+int ReadTable::append(const ReadInfo& info) {
+    ReadRecord record;
+    record.read_id = info.read_id;
+    record.chr_id = info.chr_id;
+    record.align_start = info.align_start;
+    record.align_end = info.align_end;
+    record.mapq = static_cast<uint8_t>(std::clamp(info.mapq, 0, 255));
+    record.hp_tag = (info.hp_tag >= -128 && info.hp_tag <= 127) ? static_cast<int8_t>(info.hp_tag) : 0;
+    record.alt_support = info.alt_support;
+    record.is_tumor = info.is_tumor;
+    return append(record, info.read_name);
+}
+
+void ReadTable::clear() {
+    read_id_.clear();
+    chr_id_.clear();
+    align_start_.clear();
+    align_end_.clear();
+    mapq_.clear();
+    hp_tag_.clear();
+    alt_support_.clear();
+    is_tumor_.clear();
+    name_offset_.assign(1, 0);
+    names_.clear();
+}
+
+void ReadTable::reserve(size_t num_reads, size_t name_bytes) {
+    read_id_.reserve(num_reads);
+    chr_id_.reserve(num_reads);
+    align_start_.reserve(num_reads);
+    align_end_.reserve(num_reads);
+    mapq_.reserve(num_reads);
+    hp_tag_.reserve(num_reads);
+    alt_support_.reserve(num_reads);
+    is_tumor_.reserve(num_reads);
+    name_offset_.reserve(num_reads + 1);
+    names_.reserve(name_bytes);
+}
+
+ReadRecord ReadTable::record(size_t row) const {
+    ReadRecord r;
+    r.read_id = read_id_[row];
+    r.chr_id = chr_id_[row];
+    r.align_start = align_start_[row];
+    r.align_end = align_end_[row];
+    r.mapq = mapq_[row];
+    r.hp_tag = hp_tag_[row];
+    r.alt_support = static_cast<AltSupport>(alt_support_[row]);
+    r.is_tumor = is_tumor_[row] != 0;
+    return r;
+}
+
+ReadInfo ReadTable::get(size_t row) const {
+    ReadInfo info;
+    info.read_id = read_id_[row];
+    info.read_name = std::string(name(row));
+    info.chr_id = chr_id_[row];
+    info.align_start = align_start_[row];
+    info.align_end = align_end_[row];
+    info.mapq = mapq_[row];
+    info.hp_tag = hp_tag_[row];
+    info.is_tumor = is_tumor_[row] != 0;
+    info.alt_support = static_cast<AltSupport>(alt_support_[row]);
+    return info;
+}
+
+size_t ReadTable::count_normal() const {
+    size_t tumor = 0;
+    for (uint8_t t : is_tumor_) {
+        tumor += t;
+    }
+    return is_tumor_.size() - tumor;
+}
+
+size_t ReadTable::memory_bytes() const {
+    return (read_id_.capacity() + chr_id_.capacity() + align_start_.capacity() + align_end_.capacity()) * sizeof(int32_t) +
+           mapq_.capacity() + hp_tag_.capacity() + alt_support_.capacity() + is_tumor_.capacity() +
+           name_offset_.capacity() * sizeof(uint32_t) + names_.capacity();
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,178 @@
+#include "core/RegionAnalyzer.hpp"
+#include "core/DistanceMatrix.hpp"
+#include "core/MethylationMatrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <omp.h>
+
+namespace InterSubMod {
+
+AnalysisOptions AnalysisOptions::from_config(const Config& config) {
+    AnalysisOptions options;
+    options.metric = config.distance_metric;
+    options.nan_strategy = config.nan_distance_strategy;
+    options.linkage = config.linkage_method;
+    options.num_clusters = config.num_clusters;
+    options.min_site_coverage = config.min_site_coverage;
+    options.min_common_coverage = config.min_common_coverage;
+    options.methyl_high = config.binary_methyl_high;
+    options.methyl_low = config.binary_methyl_low;
+    options.num_threads = std::max(config.threads / 4, 1);
+    return options;
+}
+
+RegionAnalyzer::RegionAnalyzer(const AnalysisOptions& options, AsyncRegionWriter& downstream,
+                               const std::string& clusters_path)
+    : options_(options),
+      downstream_(downstream),
+      closed_(false),
+      queue_(options.queue_capacity) {
+    downstream_.open_clusters_file(clusters_path, tsv_header());
+
+    int n = std::max(options_.num_threads, 1);
+    stats_.num_threads = n;
+    threads_.reserve(n);
+    for (int i = 0; i < n; i++) {
+        threads_.emplace_back(&RegionAnalyzer::analysis_loop, this);
+    }
+}
+
+RegionAnalyzer::~RegionAnalyzer() {
+    close();
+}
+
+bool RegionAnalyzer::submit(RegionOutput&& output) {
+    return queue_.push(std::move(output));
+}
+
+void RegionAnalyzer::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    queue_.close();
+    for (auto& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+}
+
+std::vector<std::pair<int, std::string>> RegionAnalyzer::errors() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return errors_;
+}
+
+AnalyzerStats RegionAnalyzer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AnalyzerStats s = stats_;
+    s.queue = queue_.stats();
+    return s;
+}
+
+const char* RegionAnalyzer::tsv_header() {
+    return "region_id\tchr\tpos\tref\talt\tnum_reads\tnum_sites\tcluster_id\tsize\thp1\thp2\thp_unknown"
+           "\ttumor\tnormal\talt_reads\tref_reads\tp_value_hp\tp_value_somatic\tmean_silhouette";
+}
+
+bool RegionAnalyzer::analyze(const RegionOutput& output, const AnalysisOptions& options,
+                             HierarchicalClustering& hc, ClusteringResult& result) {
+    const MatrixBuilder& builder = output.matrix;
+    if (builder.num_reads() < 2) {
+        return false;
+    }
+
+    MethylationMatrix methyl;
+    methyl.region_id = output.region_id;
+    methyl.build(builder, options.methyl_high, options.methyl_low, options.min_site_coverage);
+    if (methyl.num_sites() == 0) {
+        return false;
+    }
+
+    DistanceMatrix dist;
+    dist.compute_from_methylation(methyl, options.metric, options.min_common_coverage, options.nan_strategy);
+    hc.fit(dist);
+    result = hc.summarize(dist, hc.cut_k(std::max(options.num_clusters, 1)), builder.get_reads());
+    return true;
+}
+
+void RegionAnalyzer::analysis_loop() {
+    // Distance / silhouette kernels run single-threaded here; the cores belong to the workers
+    omp_set_num_threads(1);
+    HierarchicalClustering hc(options_.linkage);
+
+    constexpr size_t kBatch = 8;
+    std::vector<RegionOutput> batch;
+    batch.reserve(kBatch);
+    std::ostringstream lines;
+    std::vector<std::pair<int, std::string>> batch_errors;
+    std::vector<bool> forward;
+
+    while (queue_.pop_batch(batch, kBatch)) {
+        auto t0 = std::chrono::steady_clock::now();
+        batch_errors.clear();
+        forward.assign(batch.size(), false);
+        uint64_t analyzed = 0, skipped = 0, clusters = 0;
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            const RegionOutput& out = batch[i];
+            try {
+                ClusteringResult res;
+                lines.str("");
+                if (!analyze(out, options_, hc, res)) {
+                    skipped++;
+                    forward[i] = true;
+                    continue;
+                }
+                for (const auto& [id, cs] : res.stats) {
+                    double silhouette = 0.0;
+                    for (size_t k = 0; k < res.labels.size(); k++) {
+                        if (res.labels[k] == id) silhouette += res.silhouette_scores[k];
+                    }
+                    lines << out.region_id << "\t" << out.chr_name << "\t" << out.snv.pos << "\t"
+                          << out.snv.ref_base << "\t" << out.snv.alt_base << "\t"
+                          << out.matrix.num_reads() << "\t" << out.matrix.num_cpgs() << "\t"
+                          << id << "\t" << cs.size << "\t" << cs.count_hp1 << "\t" << cs.count_hp2 << "\t"
+                          << cs.count_hp_unknown << "\t" << cs.count_tumor << "\t" << cs.count_normal << "\t"
+                          << cs.count_alt << "\t" << cs.count_ref << "\t" << cs.p_value_hp << "\t"
+                          << cs.p_value_somatic << "\t" << (cs.size > 0 ? silhouette / cs.size : 0.0) << "\n";
+                    clusters++;
+                }
+                // Written by the writer together with the matrix
+                batch[i].cluster_rows = lines.str();
+                analyzed++;
+                forward[i] = true;
+            } catch (const std::exception& e) {
+                batch_errors.emplace_back(out.region_id, std::string("analysis failed: ") + e.what());
+            }
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.regions_analyzed += analyzed;
+            stats_.regions_skipped += skipped;
+            stats_.clusters += clusters;
+            stats_.analyze_ms += ms;
+        }
+
+        // Hand the regions on (may block on the writer's queue)
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (!forward[i]) continue;
+            const int region_id = batch[i].region_id;
+            if (!downstream_.submit(std::move(batch[i]))) {
+                batch_errors.emplace_back(region_id, "Output writer already closed");
+            }
+        }
+        batch.clear();
+
+        if (!batch_errors.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            errors_.insert(errors_.end(), batch_errors.begin(), batch_errors.end());
+        }
+    }
+}
+
+} // namespace InterSubMod
@@ -5,6 +5,14 @@
 #include <iostream>
 #include <omp.h>
 #include <algorithm>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <climits>
+#include <cmath>
+#include <sys/stat.h>
+#include "utils/ResourceMonitor.hpp"
+#include "utils/Logger.hpp"
 
 namespace InterSubMod {
 
@@ -20,7 +28,15 @@ RegionProcessor::RegionProcessor(
     ref_fasta_path_(ref_fasta_path),
     output_dir_(output_dir),
     num_threads_(num_threads),
-    window_size_(window_size) {
+    window_size_(window_size),
+    merge_gap_(0),
+    output_format_(OutputFormat::BINARY),
+    output_dtype_(BinaryFormat::MatrixDType::FLOAT32),
+    resource_pool_(tumor_bam_path, normal_bam_path, ref_fasta_path,
+                   std::max(num_threads, omp_get_max_threads())),
+    workspaces_(resource_pool_.num_slots()),
+    writer_threads_(1),
+    writer_queue_capacity_(64) {
     
     // Set OpenMP threads
     omp_set_num_threads(num_threads_);
@@ -30,82 +46,71 @@ RegionProcessor::RegionProcessor(
 }
 
 int RegionProcessor::load_snvs(const std::string& snv_table_path) {
-    std::ifstream ifs(snv_table_path);
-    if (!ifs.is_open()) {
-        std::cerr << "Failed to open SNV table: " << snv_table_path << std::endl;
-        return 0;
-    }
-    
     snvs_.clear();
-    std::string line;
-    int line_num = 0;
-    
-    // Skip header if present
-    std::getline(ifs, line);
-    line_num++;
-    
-    // Check if first line is header
-    bool has_header = (line.find("chr") != std::string::npos || 
-                      line.find("pos") != std::string::npos);
-    
-    if (!has_header) {
-        // First line is data, parse it
-        std::istringstream iss(line);
-        std::string chr_str;
-        int32_t pos;
-        char ref, alt;
-        float qual = 0.0f;
-        
-        if (iss >> chr_str >> pos >> ref >> alt) {
-            iss >> qual;  // Optional
-            
-            SomaticSnv snv;
-            snv.snv_id = 0;
-            snv.chr_id = 17;  // Extract from chr_str if needed
-            snv.pos = pos;
-            snv.ref_base = ref;
-            snv.alt_base = alt;
-            snv.qual = qual;
-            
-            snvs_.push_back(snv);
-            chr_names_.push_back(chr_str);
-        }
-    }
+    chr_names_.clear();
     
-    // Parse remaining lines
-    while (std::getline(ifs, line)) {
-        line_num++;
-        if (line.empty() || line[0] == '#') continue;
-        
-        std::istringstream iss(line);
-        std::string chr_str;
-        int32_t pos;
-        char ref, alt;
-        float qual = 0.0f;
-        
-        if (iss >> chr_str >> pos >> ref >> alt) {
-            iss >> qual;  // Optional
-            
-            SomaticSnv snv;
-            snv.snv_id = snvs_.size();
-            snv.chr_id = 17;  // Extract from chr_str if needed
-            snv.pos = pos;
-            snv.ref_base = ref;
-            snv.alt_base = alt;
-            snv.qual = qual;
-            
+    try {
+        std::unique_ptr<SnvSource> source = open_snv_source(snv_table_path);
+        SomaticSnv snv;
+        std::string chr_name;
+        while (source && source->next(snv, chr_name)) {
             snvs_.push_back(snv);
-            chr_names_.push_back(chr_str);
-        } else {
-            std::cerr << "Failed to parse SNV at line " << line_num << ": " << line << std::endl;
+            chr_names_.push_back(chr_name);
+        }
+        if (source && source->stats().skipped > 0) {
+            std::cout << "Skipped " << source->stats().skipped << " of " << source->stats().records
+                      << " records (filtered or malformed)" << std::endl;
         }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 0;
     }
     
-    ifs.close();
     std::cout << "Loaded " << snvs_.size() << " SNVs from " << snv_table_path << std::endl;
     return snvs_.size();
 }
 
+std::unique_ptr<SnvSource> RegionProcessor::open_snv_source(const std::string& path) {
+    if (chrom_index_.size() == 0) {
+        try {
+            for (const auto& name : FastaReader(ref_fasta_path_).chromosome_names()) {
+                chrom_index_.get_or_create_id(name);
+            }
+        } catch (const std::exception&) {
+            // Reference problems surface when the first region is fetched
+        }
+    }
+    
+    auto source = std::make_unique<SnvSource>(path, chrom_index_);
+    if (has_snv_selection_) {
+        if (snv_ranges_.empty()) {
+            return nullptr;  // e.g. a shard that covers no bases
+        }
+        source->set_regions(snv_ranges_);
+        std::cout << "Selecting SNVs in " << snv_ranges_.size() << " range(s)"
+                  << (source->stats().indexed ? " via index" : " by full scan")
+                  << ", output tag '" << output_tag_ << "'" << std::endl;
+    }
+    return source;
+}
+
+void RegionProcessor::set_snv_regions(const std::vector<GenomicRange>& ranges, const std::string& output_tag) {
+    has_snv_selection_ = true;
+    snv_ranges_ = normalize_ranges(ranges);
+    output_tag_ = !output_tag.empty() ? output_tag
+                : snv_ranges_.empty() ? "empty" : region_selection_tag(snv_ranges_);
+}
+
+void RegionProcessor::set_shard(const ShardSpec& shard) {
+    std::vector<GenomicRange> ranges = ShardPlanner::plan(ShardPlanner::weights_from_bam(tumor_bam_path_), shard);
+    std::cout << "Shard " << shard.index << "/" << shard.count << ": ";
+    for (size_t i = 0; i < ranges.size(); i++) {
+        std::cout << (i ? ", " : "") << ranges[i].to_string();
+    }
+    std::cout << (ranges.empty() ? "(no bases)" : "") << std::endl;
+    set_snv_regions(ranges, shard.tag());
+}
+
 std::vector<RegionResult> RegionProcessor::process_all_regions(int max_snvs) {
     int num_to_process = (max_snvs > 0 && max_snvs < static_cast<int>(snvs_.size())) 
                          ? max_snvs : snvs_.size();
@@ -116,34 +121,101 @@ std::vector<RegionResult> RegionProcessor::process_all_regions(int max_snvs) {
     std::vector<RegionResult> results(num_to_process);
     
     auto t_start = std::chrono::high_resolution_clock::now();
+    finish_single_regions();
+    bind_numa();
     
-    // OpenMP parallel loop
-    #pragma omp parallel for schedule(dynamic)
+    // Regions finished by an earlier run are not scheduled again
+    open_journal();
+    std::vector<int> pending;
+    std::vector<SomaticSnv> pending_snvs;
+    std::vector<std::string> pending_chr;
     for (int i = 0; i < num_to_process; i++) {
-        const auto& snv = snvs_[i];
-        const auto& chr_name = chr_names_[i];
-        
-        #pragma omp critical
-        {
-            std::cout << "[Thread " << omp_get_thread_num() << "] Processing region " 
-                      << i << " (SNV " << chr_name << ":" << snv.pos << ")" << std::endl;
+        if (!already_completed(snvs_[i], chr_names_[i], results[i])) {
+            pending.push_back(i);
+            pending_snvs.push_back(snvs_[i]);
+            pending_chr.push_back(chr_names_[i]);
         }
+    }
+    std::vector<RegionResult> pending_results(pending.size());
+    
+    // Plan: sort by (chr, pos), coalesce overlapping windows, group per chromosome
+    RegionScheduler scheduler(window_size_, merge_gap_);
+    std::vector<SuperRegion> super_regions = scheduler.build_super_regions(pending_snvs, pending_chr, pending.size());
+    std::vector<WorkBatch> batches;
+    cost_estimate_ms_ = 0.0;
+    if (cost_scheduling_ && !super_regions.empty()) {
+        // Pre-pass on the index only: the main thread's readers, before the parallel loop
+        auto t_est = std::chrono::steady_clock::now();
+        BamReader& tumor = resource_pool_.tumor_bam(0);
+        BamReader* normal = resource_pool_.normal_bam(0);
+        for (auto& sr : super_regions) {
+            sr.est_bytes = estimate_cost(sr, pending_snvs[sr.members.front()].chr_id, tumor, normal);
+        }
+        batches = scheduler.build_cost_batches(super_regions, num_threads_);
+        cost_estimate_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_est).count();
+    } else {
+        batches = scheduler.build_batches(super_regions, num_threads_);
+    }
+    
+    std::cout << "Scheduled " << pending.size() << " regions into " << super_regions.size()
+              << " super-regions (" << batches.size() << (cost_scheduling_ ? " batches, heaviest first)" : " batches)");
+    if (pending.size() < static_cast<size_t>(num_to_process)) {
+        std::cout << ", " << (num_to_process - pending.size()) << " already completed";
+    }
+    std::cout << std::endl;
+    
+    open_output();
+    progress_ = std::make_unique<Utils::ProgressReporter>("regions", pending.size(), progress_interval_s_);
+    
+    const int nodes = numa_nodes();
+    if (nodes < 2) {
+        // OpenMP parallel loop over chromosome-contiguous batches
+        #pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < static_cast<int>(batches.size()); b++) {
+            process_super_regions(super_regions.data() + batches[b].first, batches[b].last - batches[b].first,
+                                  pending_snvs, pending_results);
+        }
+    } else {
+        // Whole chromosomes per node: each thread drains its own node's batches
+        // (reads and reference stay node-local), then helps the other nodes
+        std::vector<std::vector<size_t>> per_node = RegionScheduler::partition_by_node(super_regions, batches, nodes);
+        std::vector<size_t> cursors(nodes, 0);
+        std::cout << "NUMA batches per node:";
+        for (const auto& list : per_node) {
+            std::cout << " " << list.size();
+        }
+        std::cout << std::endl;
         
-        results[i] = process_single_region(snv, i);
-        
-        #pragma omp critical
+        #pragma omp parallel
         {
-            if (results[i].success) {
-                std::cout << "[Thread " << omp_get_thread_num() << "] ✓ Region " << i 
-                          << " completed: " << results[i].num_reads << " reads, " 
-                          << results[i].num_cpgs << " CpGs, " 
-                          << results[i].elapsed_ms << " ms" << std::endl;
-            } else {
-                std::cerr << "[Thread " << omp_get_thread_num() << "] ✗ Region " << i 
-                          << " failed: " << results[i].error_message << std::endl;
+            const int home = resource_pool_.slot_node(omp_get_thread_num());
+            for (int k = 0; k < nodes; k++) {
+                const int node = (home + k) % nodes;
+                const std::vector<size_t>& list = per_node[node];
+                while (true) {
+                    size_t next;
+                    #pragma omp atomic capture
+                    next = cursors[node]++;
+                    if (next >= list.size()) {
+                        break;
+                    }
+                    const WorkBatch& batch = batches[list[next]];
+                    process_super_regions(super_regions.data() + batch.first, batch.last - batch.first,
+                                          pending_snvs, pending_results);
+                }
             }
         }
     }
+    progress_.reset();
+    for (size_t k = 0; k < pending.size(); k++) {
+        results[pending[k]] = std::move(pending_results[k]);
+    }
+    
+    size_t written = close_output(results);
+    journal_failures(results);
+    if (output_format_ == OutputFormat::BINARY) {
+        std::cout << "Wrote " << written << " regions to binary shards in " << output_dir_ << std::endl;
+    }
     
     auto t_end = std::chrono::high_resolution_clock::now();
     double total_elapsed = std::chrono::duration<double, std::milli>(t_end - t_start).count();
@@ -154,7 +226,263 @@ std::vector<RegionResult> RegionProcessor::process_all_regions(int max_snvs) {
     return results;
 }
 
+std::vector<RegionResult> RegionProcessor::process_snv_stream(const std::string& snv_path, int max_snvs) {
+    // Opened here so a missing or unreadable file fails before any thread starts
+    std::unique_ptr<SnvSource> source = open_snv_source(snv_path);
+    snvs_.clear();
+    chr_names_.clear();
+    
+    std::cout << "Streaming SNVs from " << snv_path << " into " << num_threads_ << " threads..." << std::endl;
+    
+    auto t_start = std::chrono::high_resolution_clock::now();
+    finish_single_regions();
+    bind_numa();
+    open_journal();
+    open_output();
+    progress_ = std::make_unique<Utils::ProgressReporter>("regions", 0, progress_interval_s_);
+    
+    // Producer: reads the source in file order and coalesces windows on the fly
+    // (input sorted by position, as VCFs are, merges like process_all_regions();
+    // otherwise regions are still correct, only merged less). Chunks end on
+    // super-region boundaries so every member stays with its union fetch.
+    constexpr size_t kChunkRegions = 32;
+    Utils::BoundedQueue<SnvChunk> queue(static_cast<size_t>(std::max(num_threads_, 1)) * 2);
+    size_t num_super_regions = 0;
+    size_t num_chunks = 0;
+    std::vector<RegionResult> resumed;  // completed by an earlier run, not queued
+    std::string producer_error;
+    
+    cost_estimate_ms_ = 0.0;
+    std::thread producer([&]() {
+        RegionScheduler scheduler(window_size_, merge_gap_);
+        SnvChunk chunk;
+        SuperRegion cur;
+        // Cost model: the producer's own readers (index lookups only)
+        std::unique_ptr<BamReader> est_tumor;
+        std::unique_ptr<BamReader> est_normal;
+        uint64_t est_total = 0;
+        size_t est_count = 0;
+        auto flush_chunk = [&]() {
+            if (chunk.super_regions.empty()) return;
+            num_chunks++;
+            queue.push(std::move(chunk));
+            chunk = SnvChunk();
+        };
+        auto close_super_region = [&]() {
+            if (cur.members.empty()) return;
+            bool heavy = false;
+            if (est_tumor) {
+                auto t_est = std::chrono::steady_clock::now();
+                cur.est_bytes = estimate_cost(cur, chunk.snvs[cur.members.front()].chr_id, *est_tumor, est_normal.get());
+                cost_estimate_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_est).count();
+                // Much heavier than what was seen so far (after a short warm-up)
+                constexpr size_t kWarmup = 8;
+                constexpr uint64_t kHeavyFactor = 8;
+                heavy = est_count >= kWarmup && cur.est_bytes > kHeavyFactor * (est_total / est_count);
+                est_total += cur.est_bytes;
+                est_count++;
+            }
+            if (heavy && cur.members.front() > 0) {
+                // Members are the chunk's last SNVs: move them into a chunk of their own
+                const size_t first = static_cast<size_t>(cur.members.front());
+                SnvChunk solo;
+                solo.snvs.assign(chunk.snvs.begin() + first, chunk.snvs.end());
+                chunk.snvs.resize(first);
+                for (int& m : cur.members) m -= static_cast<int>(first);
+                flush_chunk();
+                chunk = std::move(solo);
+            }
+            chunk.super_regions.push_back(std::move(cur));
+            cur = SuperRegion();
+            num_super_regions++;
+            if (heavy) {
+                flush_chunk();
+            }
+        };
+        
+        try {
+            if (cost_scheduling_) {
+                est_tumor = std::make_unique<BamReader>(tumor_bam_path_);
+                if (!normal_bam_path_.empty()) {
+                    est_normal = std::make_unique<BamReader>(normal_bam_path_);
+                }
+            }
+            SomaticSnv snv;
+            std::string chr_name;
+            while (source && (max_snvs <= 0 || static_cast<int>(snvs_.size()) < max_snvs) &&
+                   source->next(snv, chr_name)) {
+                snvs_.push_back(snv);
+                chr_names_.push_back(chr_name);
+                RegionResult done;
+                if (already_completed(snv, chr_name, done)) {
+                    resumed.push_back(std::move(done));
+                    continue;
+                }
+                
+                progress_->add_total(1);
+                int member = static_cast<int>(chunk.snvs.size());
+                if (!cur.members.empty() && scheduler.try_extend(cur, snv, chr_name, member)) {
+                    chunk.snvs.push_back(snv);
+                    continue;
+                }
+                close_super_region();
+                if (chunk.snvs.size() >= kChunkRegions) {
+                    flush_chunk();
+                }
+                cur.chr_name = chr_name;
+                scheduler.window_of(snv, cur.fetch_start, cur.fetch_end);
+                cur.members.push_back(static_cast<int>(chunk.snvs.size()));
+                chunk.snvs.push_back(snv);
+            }
+        } catch (const std::exception& e) {
+            producer_error = e.what();
+        }
+        close_super_region();
+        flush_chunk();
+        progress_->finish_total();
+        queue.close();
+    });
+    
+    // Consumers: the usual OpenMP workers, each taking one chunk at a time
+    std::vector<RegionResult> results;
+    std::mutex results_mutex;
+    #pragma omp parallel
+    {
+        SnvChunk chunk;
+        while (queue.pop(chunk)) {
+            std::vector<RegionResult> chunk_results(chunk.snvs.size());
+            process_super_regions(chunk.super_regions.data(), chunk.super_regions.size(), chunk.snvs, chunk_results);
+            
+            std::lock_guard<std::mutex> lock(results_mutex);
+            for (size_t i = 0; i < chunk.snvs.size(); i++) {
+                size_t region_id = static_cast<size_t>(chunk.snvs[i].snv_id);
+                if (region_id >= results.size()) {
+                    results.resize(region_id + 1);
+                }
+                results[region_id] = std::move(chunk_results[i]);
+            }
+        }
+    }
+    producer.join();
+    progress_.reset();
+    results.resize(snvs_.size());
+    for (auto& r : resumed) {
+        results[r.region_id] = std::move(r);
+    }
+    
+    size_t written = close_output(results);
+    journal_failures(results);
+    if (output_format_ == OutputFormat::BINARY) {
+        std::cout << "Wrote " << written << " regions to binary shards in " << output_dir_ << std::endl;
+    }
+    
+    auto t_end = std::chrono::high_resolution_clock::now();
+    double total_elapsed = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    
+    Utils::QueueStats qs = queue.stats();
+    std::cout << "Streamed " << snvs_.size() << " SNVs (" << (source ? source->stats().skipped : 0)
+              << " records skipped) as "
+              << num_super_regions << " super-regions in " << num_chunks << " chunks"
+              << " (SNV queue max depth " << qs.max_depth << "/" << qs.capacity << ")";
+    if (!resumed.empty()) {
+        std::cout << ", " << resumed.size() << " already completed";
+    }
+    std::cout << std::endl;
+    std::cout << "All regions processed in " << total_elapsed << " ms ("
+              << (total_elapsed / std::max<size_t>(results.size(), 1)) << " ms/region)" << std::endl;
+    
+    if (!producer_error.empty()) {
+        throw std::runtime_error("SNV input " + snv_path + ": " + producer_error);
+    }
+    return results;
+}
+
+RegionProcessor::~RegionProcessor() {
+    try {
+        finish_single_regions();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to finalize single-region output: " << e.what() << std::endl;
+    }
+}
+
 RegionResult RegionProcessor::process_single_region(const SomaticSnv& snv, int region_id) {
+    std::lock_guard<std::mutex> lock(single_mutex_);
+    
+    // A single region is just a super-region with one member: the given SNV
+    std::vector<SomaticSnv> member(1, snv);
+    member[0].snv_id = region_id;
+    std::string chr_name = chrom_index_.get_name(snv.chr_id);
+    if (chr_name.empty() && region_id >= 0 && region_id < static_cast<int>(chr_names_.size())) {
+        chr_name = chr_names_[region_id];
+    }
+    RegionScheduler scheduler(window_size_, merge_gap_);
+    SuperRegion sr;
+    sr.chr_name = chr_name;
+    scheduler.window_of(snv, sr.fetch_start, sr.fetch_end);
+    sr.members.push_back(0);
+    
+    // Output stays open across calls: reopening would truncate the regions already journaled
+    if (!single_output_open_) {
+        open_journal();
+        open_output();
+        single_output_open_ = true;
+    }
+    std::vector<RegionResult> results(1);
+    process_super_region(sr, member, results);
+    
+    if (region_id >= 0) {
+        if (region_id >= static_cast<int>(single_results_.size())) {
+            single_results_.resize(region_id + 1);
+        }
+        single_results_[region_id] = results[0];
+        single_keys_[region_id] = CompletionJournal::region_key(chr_name, member[0]);
+    }
+    return results[0];
+}
+
+size_t RegionProcessor::finish_single_regions() {
+    std::lock_guard<std::mutex> lock(single_mutex_);
+    if (!single_output_open_) {
+        return 0;
+    }
+    size_t written = close_output(single_results_);
+    if (journal_) {
+        std::vector<JournalEntry> failed;
+        for (const auto& [region_id, key] : single_keys_) {
+            const RegionResult& r = single_results_[region_id];
+            if (!r.success) {
+                JournalEntry e;
+                e.key = key;
+                e.region_id = region_id;
+                e.detail = r.error_message;
+                failed.push_back(std::move(e));
+            }
+        }
+        try {
+            journal_->append(failed);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    single_output_open_ = false;
+    single_results_.clear();
+    single_keys_.clear();
+    return written;
+}
+
+template <typename ForEachRead>
+RegionResult RegionProcessor::process_member(
+    const SomaticSnv& snv,
+    const std::string& chr_name,
+    int region_id,
+    ForEachRead&& for_each_kept_read,
+    RegionWorkspace& ws,
+    std::string_view ref_union,
+    int32_t union_start,
+    const CpGBitmap* cpg_sites,
+    std::string_view cache_ref,
+    int32_t cache_ref_start
+) {
     RegionResult result;
     result.region_id = region_id;
     result.snv_id = snv.snv_id;
@@ -162,67 +490,121 @@ RegionResult RegionProcessor::process_single_region(const SomaticSnv& snv, int r
     auto t_start = std::chrono::high_resolution_clock::now();
     
     try {
-        // Thread-local resources
-        BamReader bam_reader(tumor_bam_path_);
-        FastaReader fasta_reader(ref_fasta_path_);
-        ReadParser read_parser;
-        MethylationParser methyl_parser;
-        MatrixBuilder matrix_builder;
+        // Per-region scratch comes from the thread's arena (no system allocations
+        // once it has grown to the largest region); the matrix itself goes to the writer
+        ws.arena.reset();
+        MatrixBuilder matrix_builder(&ws.arena);
+        if (output_format_ == OutputFormat::BINARY && output_dtype_ == BinaryFormat::MatrixDType::UINT8) {
+            // uint8 output: keep the matrix quantized in memory too (copied verbatim by the writer)
+            matrix_builder.set_storage(MatrixStorage::UINT8);
+        }
         
         // Define region
-        int32_t region_start = snv.pos - window_size_;
-        int32_t region_end = snv.pos + window_size_;
-        
-        if (region_start < 1) region_start = 1;
-        
-        // Get chromosome name
-        std::string chr_name = chr_names_[region_id];
+        int32_t region_start, region_end;
+        RegionScheduler(window_size_).window_of(snv, region_start, region_end);
         
-        // Fetch reads
-        auto reads = bam_reader.fetch_reads(chr_name, region_start, region_end);
-        
-        // Fetch reference sequence
-        std::string ref_seq = fasta_reader.fetch_sequence(chr_name, region_start, region_end);
+        // Slice this member's reference window out of the union sequence
+        size_t ref_offset = static_cast<size_t>(region_start - union_start);
+        std::string_view ref_seq;
+        if (ref_offset < ref_union.size()) {
+            ref_seq = ref_union.substr(ref_offset, static_cast<size_t>(region_end - region_start));
+        }
         
         if (ref_seq.empty()) {
             throw std::runtime_error("Failed to fetch reference sequence");
         }
         
-        // Process reads
+        // Process reads that passed should_keep() and overlap this member's window
+        // (time outside the handler is record decoding / overlap scanning)
         int read_count = 0;
-        for (auto* b : reads) {
-            if (read_parser.should_keep(b)) {
-                ReadInfo info = read_parser.parse(b, read_count, true, snv, ref_seq, region_start);
-                auto methyl_calls = methyl_parser.parse_read(b, ref_seq, region_start);
-                
-                matrix_builder.add_read(info, methyl_calls);
+        double parse_ms = 0.0;
+        auto t_iter = std::chrono::steady_clock::now();
+        // Positions whose CpG context this window can judge (see MethylationParser::parse_read)
+        const int32_t window_lo = region_start;
+        const int32_t window_hi = region_start + static_cast<int32_t>(ref_seq.size()) - 1;
+        const bool use_cache = ws.methyl_cache.enabled() && !cache_ref.empty();
+        const int32_t cache_lo = cache_ref_start;
+        const int32_t cache_hi = cache_ref_start + static_cast<int32_t>(cache_ref.size()) - 1;
+        auto parse_calls = [&](const bam1_t* b, const AlignmentView& aln, bool is_tumor, std::vector<MethylCall>& out) {
+            if (use_cache) {
+                // Parse the whole read once, then slice this window out of its calls
+                const std::vector<MethylCall>& all = ws.methyl_cache.calls_for(
+                    b, is_tumor, window_lo, window_hi, cache_lo, cache_hi, [&](std::vector<MethylCall>& whole) {
+                        ws.methyl_parser.parse_read(b, aln, cache_ref, cache_ref_start, whole, cpg_sites);
+                    });
+                MethylCallCache::slice(all, window_lo, window_hi, out);
+            } else {
+                ws.methyl_parser.parse_read(b, aln, ref_seq, region_start, out, cpg_sites);
+            }
+        };
+        const bool sample = ws.sampler.enabled();
+        if (sample) {
+            ws.sampler.reset();
+        }
+        for_each_kept_read(region_start, region_end, [&](const bam1_t* b, const AlignmentView& aln, bool is_tumor) {
+            Utils::ScopedStageTimer timer(parse_ms);
+            ReadRecord record = ws.read_parser.parse_record(b, aln, read_count, is_tumor, snv, ref_seq, region_start);
+            if (sample) {
+                // Reads that cannot make the sample are dropped before their MM/ML tags are parsed
+                if (std::vector<MethylCall>* calls = ws.sampler.offer(record, bam_get_qname(b))) {
+                    parse_calls(b, aln, is_tumor, *calls);
+                }
                 read_count++;
+                return;
             }
+            parse_calls(b, aln, is_tumor, ws.calls);
+            
+            matrix_builder.add_read(record, bam_get_qname(b), ws.calls);
+            read_count++;
+        });
+        if (sample) {
+            Utils::ScopedStageTimer timer(parse_ms);
+            int kept = 0;
+            ws.sampler.emit([&](const ReadRecord& sampled, std::string_view name, const std::vector<MethylCall>& calls) {
+                ReadRecord record = sampled;
+                record.read_id = kept++;
+                matrix_builder.add_read(record, name, calls);
+            });
+            result.num_reads_dropped = read_count - kept;
         }
+        double iter_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_iter).count();
+        result.stages[Utils::Stage::PARSE] += parse_ms;
+        result.stages[Utils::Stage::BAM_FETCH] += iter_ms - parse_ms;
         
         // Build matrix
-        matrix_builder.finalize();
+        {
+            Utils::ScopedStageTimer timer(result.stages[Utils::Stage::FINALIZE]);
+            matrix_builder.finalize();
+        }
         
         result.num_reads = matrix_builder.num_reads();
         result.num_cpgs = matrix_builder.num_cpgs();
+        result.num_normal_reads = static_cast<int>(matrix_builder.get_reads().count_normal());
         
-        // Write output
-        RegionWriter writer(output_dir_);
-        writer.write_region(
-            snv,
-            region_id,
-            region_start,
-            region_end,
-            matrix_builder.get_reads(),
-            matrix_builder.get_cpg_positions(),
-            matrix_builder.get_matrix(),
-            0.0,  // elapsed_ms will be set below
-            0.0   // peak_memory_mb not tracked yet
-        );
-        
-        // Cleanup
-        for (auto* r : reads) {
-            bam_destroy1(r);
+        // Hand the matrix to the writer threads (blocks only when the queue is full)
+        RegionOutput output;
+        output.snv = snv;
+        output.region_id = region_id;
+        output.region_start = region_start;
+        output.region_end = region_end;
+        output.matrix = std::move(matrix_builder);
+        output.elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - t_start).count();
+        result.peak_memory_mb = (ws.arena.bytes_allocated() + output.matrix.memory_bytes()) / (1024.0 * 1024.0);
+        output.peak_memory_mb = result.peak_memory_mb;
+        if (!output_tag_.empty()) {
+            // Coordinates instead of the run-local index: stable across shards
+            output.name = "region_" + chr_name + "_" + std::to_string(snv.pos) + "_" +
+                          snv.ref_base + "_" + snv.alt_base;
+        }
+        if (journal_) {
+            output.journal_key = CompletionJournal::region_key(chr_name, snv);
+        }
+        output.chr_name = chr_name;
+        Utils::ScopedStageTimer timer(result.stages[Utils::Stage::WRITE]);
+        const bool accepted = analyzer_ ? analyzer_->submit(std::move(output)) : writer_->submit(std::move(output));
+        if (!accepted) {
+            throw std::runtime_error("Output writer already closed");
         }
         
         result.success = true;
@@ -238,16 +620,744 @@ RegionResult RegionProcessor::process_single_region(const SomaticSnv& snv, int r
     return result;
 }
 
+void RegionProcessor::fetch_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs, int slot,
+                                         bool stream_tumor, bool own_reference, FetchedSuperRegion& f) {
+    auto t_fetch_start = std::chrono::high_resolution_clock::now();
+    const uint64_t alloc_start = Utils::ResourceMonitor::thread_allocated_bytes();
+    
+    const ReadParser& read_parser = workspaces_[slot].read_parser;
+    f.tumor_reads.clear();
+    f.normal_reads.clear();
+    f.ref_union = std::string_view();
+    f.cache_ref = std::string_view();
+    f.cache_ref_start = 0;
+    f.cpg_sites = nullptr;
+    f.fetch_times = Utils::StageTimes();
+    f.tumor_filter = ReadFilterStats();
+    f.normal_filter = ReadFilterStats();
+    f.error.clear();
+    std::string normal_error;
+    // Header target IDs, resolved once per reader and chromosome (numeric queries)
+    const int chr_id = snvs[sr.members.front()].chr_id;
+    
+    // Stage times of the fetch; the normal task keeps its own counters
+    // because it may run on another thread
+    double filter_ms = 0.0;
+    double normal_fetch_ms = 0.0;
+    double normal_filter_ms = 0.0;
+    // Filtering decodes each read's CIGAR; the normal task has its own view
+    AlignmentView normal_alignment;
+    auto keep = [&](const bam1_t* b) {
+        Utils::ScopedStageTimer timer(filter_ms);
+        return read_parser.should_keep(b, f.alignment, &f.tumor_filter);
+    };
+    auto keep_normal = [&](const bam1_t* b) {
+        Utils::ScopedStageTimer timer(normal_filter_ms);
+        return read_parser.should_keep(b, normal_alignment, &f.normal_filter);
+    };
+    
+    try {
+        // Thread-local resources (opened once per slot, reused across regions)
+        BamReader& tumor_reader = resource_pool_.tumor_bam(slot);
+        BamReader* normal_reader = resource_pool_.normal_bam(slot);
+        const int tumor_tid = tumor_reader.tid(chr_id, sr.chr_name);
+        FastaReader& fasta_reader = resource_pool_.fasta(slot);
+        
+        // The normal fetch runs as a task (on this or an idle thread) while this
+        // thread fetches the reference and tumor reads; the task only touches
+        // this slot's normal reader, which nothing else uses until taskwait.
+        #pragma omp task default(shared) if(normal_reader != nullptr)
+        {
+            if (normal_reader) {
+                try {
+                    Utils::ScopedStageTimer timer(normal_fetch_ms);
+                    f.normal_reads = normal_reader->fetch_reads(normal_reader->tid(chr_id, sr.chr_name),
+                                                                sr.fetch_start, sr.fetch_end, keep_normal);
+                } catch (const std::exception& e) {
+                    normal_error = e.what();
+                }
+            }
+        }
+        
+        try {
+            // Fetch the union window once for all member SNVs and both BAMs
+            {
+                Utils::ScopedStageTimer timer(f.fetch_times[Utils::Stage::REF_FETCH]);
+                f.ref_union = fasta_reader.fetch_view(sr.chr_name, sr.fetch_start, sr.fetch_end);
+                f.cpg_sites = fasta_reader.cpg_bitmap(sr.chr_name);
+                if (own_reference && !f.cpg_sites) {
+                    // The reader's buffer is overwritten by the next fetch; shared-cache views are stable
+                    f.ref_owned.assign(f.ref_union.data(), f.ref_union.size());
+                    f.ref_union = f.ref_owned;
+                }
+                if (workspaces_[slot].methyl_cache.enabled()) {
+                    // Cached reads cover the whole chromosome when it is in memory anyway
+                    f.cache_ref = f.cpg_sites ? fasta_reader.fetch_view(sr.chr_name, 0, INT32_MAX) : f.ref_union;
+                    f.cache_ref_start = f.cpg_sites ? 0 : sr.fetch_start;
+                }
+            }
+            if (!stream_tumor) {
+                Utils::ScopedStageTimer timer(f.fetch_times[Utils::Stage::BAM_FETCH]);
+                f.tumor_reads = tumor_reader.fetch_reads(tumor_tid, sr.fetch_start, sr.fetch_end, keep);
+            }
+        } catch (...) {
+            #pragma omp taskwait
+            throw;
+        }
+        #pragma omp taskwait
+        
+        if (!normal_error.empty()) {
+            throw std::runtime_error("Normal BAM: " + normal_error);
+        }
+    } catch (const std::exception& e) {
+        f.error = e.what();
+    }
+    
+    f.fetch_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t_fetch_start).count();
+    // should_keep() runs inside the fetch calls: report it separately
+    f.fetch_times[Utils::Stage::FILTER] = filter_ms + normal_filter_ms;
+    f.fetch_times[Utils::Stage::BAM_FETCH] += normal_fetch_ms - f.fetch_times[Utils::Stage::FILTER];
+    f.alloc_bytes = Utils::ResourceMonitor::thread_allocated_bytes() - alloc_start;
+}
+
+void RegionProcessor::recycle_fetched(int slot, FetchedSuperRegion& f) {
+    // Records go back to their readers' pools for the next super-region
+    if (!f.tumor_reads.empty()) {
+        resource_pool_.tumor_bam(slot).recycle(f.tumor_reads);
+    }
+    if (!f.normal_reads.empty()) {
+        if (BamReader* normal_reader = resource_pool_.normal_bam(slot)) {
+            normal_reader->recycle(f.normal_reads);
+        }
+    }
+}
+
+void RegionProcessor::process_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs,
+                                           std::vector<RegionResult>& results) {
+    // A lone SNV streams its tumor reads straight from the BAM; only shared
+    // super-regions keep copies of the (pre-filtered) records for fan-out.
+    // Normal reads are always fetched so they can load concurrently.
+    const int slot = omp_get_thread_num();
+    const bool streaming = (sr.members.size() == 1);
+    FetchedSuperRegion& f = workspaces_[slot].fetched;
+    fetch_super_region(sr, snvs, slot, streaming, false, f);
+    compute_super_region(sr, snvs, results, f, streaming);
+    recycle_fetched(slot, f);
+}
+
+void RegionProcessor::process_super_regions(const SuperRegion* srs, size_t count, const std::vector<SomaticSnv>& snvs,
+                                            std::vector<RegionResult>& results) {
+    // The prefetch I/O thread below inherits this thread's (node) affinity
+    pin_worker(omp_get_thread_num());
+    if (prefetch_depth_ <= 0 || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            process_super_region(srs[i], snvs, results);
+        }
+        return;
+    }
+    
+    // The I/O thread owns this slot's readers for the whole run: it fetches up to
+    // prefetch_depth_ super-regions ahead, in scheduling order, while this thread
+    // computes; computed buffers come back to it so records return to the pools
+    // on the thread that uses them.
+    const int slot = omp_get_thread_num();
+    RegionWorkspace& ws = workspaces_[slot];
+    Utils::BoundedQueue<std::unique_ptr<FetchedSuperRegion>> ready(static_cast<size_t>(prefetch_depth_));
+    std::mutex spent_mutex;
+    std::vector<std::unique_ptr<FetchedSuperRegion>> spent;
+    
+    std::thread io([&]() {
+        std::vector<std::unique_ptr<FetchedSuperRegion>> reuse;
+        for (size_t i = 0; i < count; i++) {
+            {
+                std::lock_guard<std::mutex> lock(spent_mutex);
+                for (auto& s : spent) reuse.push_back(std::move(s));
+                spent.clear();
+            }
+            for (auto& r : reuse) recycle_fetched(slot, *r);
+            std::unique_ptr<FetchedSuperRegion> f;
+            if (!reuse.empty()) {
+                f = std::move(reuse.back());
+                reuse.pop_back();
+            } else {
+                f = std::make_unique<FetchedSuperRegion>();
+            }
+            fetch_super_region(srs[i], snvs, slot, false, true, *f);
+            if (!ready.push(std::move(f))) {
+                break;
+            }
+        }
+        ready.close();
+    });
+    
+    double wait_ms = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        std::unique_ptr<FetchedSuperRegion> f;
+        auto t_wait = std::chrono::steady_clock::now();
+        if (!ready.pop(f)) {
+            break;
+        }
+        wait_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_wait).count();
+        compute_super_region(srs[i], snvs, results, *f, false);
+        std::lock_guard<std::mutex> lock(spent_mutex);
+        spent.push_back(std::move(f));
+    }
+    io.join();
+    for (auto& s : spent) {
+        recycle_fetched(slot, *s);
+    }
+    ws.prefetched += count;
+    ws.prefetch_wait_ms += wait_ms;
+}
+
+void RegionProcessor::compute_super_region(const SuperRegion& sr, const std::vector<SomaticSnv>& snvs,
+                                           std::vector<RegionResult>& results, FetchedSuperRegion& f, bool streaming) {
+    const int slot = omp_get_thread_num();
+    RegionWorkspace& ws = workspaces_[slot];
+    const ReadParser& read_parser = ws.read_parser;
+    const IntervalIndex* pmd = pmd_for(slot);
+    ws.methyl_parser.set_excluded_intervals(pmd ? pmd->chrom(sr.chr_name) : nullptr);
+    ws.tumor_filter += f.tumor_filter;
+    ws.normal_filter += f.normal_filter;
+    
+    Utils::StageTimes fetch_times = f.fetch_times;
+    for (double& ms : fetch_times.ms) {
+        ms /= sr.members.size();
+    }
+    double fetch_share_ms = f.fetch_ms / sr.members.size();
+    double fetch_alloc_share_mb = f.alloc_bytes / (1024.0 * 1024.0) / sr.members.size();
+    
+    double filter_ms = 0.0;
+    auto keep = [&](const bam1_t* b) {
+        Utils::ScopedStageTimer timer(filter_ms);
+        return read_parser.should_keep(b, ws.alignment, &ws.tumor_filter);
+    };
+    
+    // Visits the kept reads overlapping a member window
+    // (same overlap rule as the "chr:start-end" region query); the decoded
+    // alignment gives the end position and then serves the parsers
+    auto visit_overlapping = [&ws](const std::vector<bam1_t*>& records, bool is_tumor,
+                                   int32_t region_start, int32_t region_end, auto&& handle) {
+        for (auto* b : records) {
+            if (b->core.pos >= region_end) {
+                continue;
+            }
+            ws.alignment.reset(b);
+            if (ws.alignment.ref_end() <= region_start - 1) {
+                continue;
+            }
+            handle(b, ws.alignment, is_tumor);
+        }
+    };
+    auto from_fetched = [&](int32_t region_start, int32_t region_end, auto&& handle) {
+        visit_overlapping(f.tumor_reads, true, region_start, region_end, handle);
+        visit_overlapping(f.normal_reads, false, region_start, region_end, handle);
+    };
+    auto from_stream = [&](int32_t region_start, int32_t region_end, auto&& handle) {
+        BamReader& tumor_reader = resource_pool_.tumor_bam(slot);
+        const int tumor_tid = tumor_reader.tid(snvs[sr.members.front()].chr_id, sr.chr_name);
+        int64_t ret = tumor_reader.for_each_read(tumor_tid, region_start, region_end, [&](const bam1_t* b) {
+            if (keep(b)) {
+                handle(b, ws.alignment, true);  // Decoded by keep()
+            }
+            return true;
+        });
+        if (ret < 0) {
+            throw std::runtime_error("Failed to read BAM records in " + sr.chr_name);
+        }
+        visit_overlapping(f.normal_reads, false, region_start, region_end, handle);
+    };
+    
+    // Fan out to member SNVs
+    for (int member : sr.members) {
+        const auto& snv = snvs[member];
+        int region_id = snv.snv_id;
+        
+        if (Utils::Logger::enabled(Utils::LogLevel::L_DEBUG)) {
+            Utils::Logger::debug("[Thread " + std::to_string(omp_get_thread_num()) + "] Processing region " +
+                                 std::to_string(region_id) + " (SNV " + sr.chr_name + ":" + std::to_string(snv.pos) + ")");
+        }
+        
+        RegionResult& result = results[member];
+        if (!f.error.empty()) {
+            result.region_id = region_id;
+            result.snv_id = snv.snv_id;
+            result.success = false;
+            result.error_message = f.error;
+        } else if (streaming) {
+            // Filtering now happens while this member streams its reads
+            filter_ms = 0.0;
+            result = process_member(snv, sr.chr_name, region_id, from_stream, ws, f.ref_union, sr.fetch_start,
+                                    f.cpg_sites, f.cache_ref, f.cache_ref_start);
+            result.stages[Utils::Stage::FILTER] += filter_ms;
+            result.stages[Utils::Stage::BAM_FETCH] -= filter_ms;
+        } else {
+            result = process_member(snv, sr.chr_name, region_id, from_fetched, ws, f.ref_union, sr.fetch_start,
+                                    f.cpg_sites, f.cache_ref, f.cache_ref_start);
+        }
+        result.elapsed_ms += fetch_share_ms;
+        result.est_bytes = static_cast<double>(sr.est_bytes) / sr.members.size();
+        result.stages += fetch_times;
+        result.peak_memory_mb += fetch_alloc_share_mb;
+        ws.stage_totals += result.stages;
+        ws.regions++;
+        
+        // Workers only bump counters; the reporter thread prints the throttled line
+        if (progress_) {
+            progress_->record(result.success);
+        }
+        if (!result.success) {
+            Utils::Logger::warning("Region " + std::to_string(region_id) + " (" + sr.chr_name + ":" +
+                                   std::to_string(snv.pos) + ") failed: " + result.error_message);
+        } else if (Utils::Logger::enabled(Utils::LogLevel::L_DEBUG)) {
+            Utils::Logger::debug("[Thread " + std::to_string(omp_get_thread_num()) + "] Region " +
+                                 std::to_string(region_id) + " completed: " + std::to_string(result.num_reads) +
+                                 " reads, " + std::to_string(result.num_cpgs) + " CpGs, " +
+                                 std::to_string(result.elapsed_ms) + " ms");
+        }
+    }
+}
+
+void RegionProcessor::set_reference_cache(bool enabled) {
+    reference_cache_enabled_ = enabled;
+    resource_pool_.set_reference_cache(enabled ? std::make_shared<ReferenceCache>(ref_fasta_path_) : nullptr);
+}
+
+void RegionProcessor::bind_numa() {
+    if (!numa_) {
+        return;
+    }
+    if (!numa_topology_) {
+        numa_topology_ = std::make_unique<Utils::NumaTopology>(Utils::NumaTopology::detect());
+        numa_pin_ = !Utils::NumaTopology::omp_binding_requested();
+        std::cout << "NUMA: " << numa_topology_->num_nodes() << " node(s), "
+                  << (numa_pin_ ? "workers pinned per node" : "placement from OMP_PLACES/OMP_PROC_BIND") << std::endl;
+    }
+    const Utils::NumaTopology& topo = *numa_topology_;
+    const int nodes = topo.num_nodes();
+    
+    // Same team as the worker loops; each thread records (and, if ours to do, pins) its node
+    #pragma omp parallel
+    {
+        const int slot = omp_get_thread_num();
+        const int node = numa_pin_ ? topo.node_for_thread(slot, omp_get_num_threads()) : topo.current_node();
+        resource_pool_.set_slot_node(slot, node);
+        pin_worker(slot);
+    }
+    if (nodes < 2) {
+        return;
+    }
+    
+    // Caches load each chromosome on the first thread that asks, i.e. one of the node's own workers
+    if (reference_cache_enabled_ && resource_pool_.reference_caches().size() != static_cast<size_t>(nodes)) {
+        std::vector<std::shared_ptr<ReferenceCache>> caches;
+        for (int n = 0; n < nodes; n++) {
+            caches.push_back(std::make_shared<ReferenceCache>(ref_fasta_path_));
+        }
+        resource_pool_.set_reference_caches(std::move(caches));
+    }
+    
+    // The PMD index was built by the main thread: copy it once per node, on that node
+    if (pmd_index_ && pmd_replicas_.empty()) {
+        std::vector<int> builder(nodes, -1);
+        for (int s = 0; s < num_threads_ && s < resource_pool_.num_slots(); s++) {
+            int& b = builder[resource_pool_.slot_node(s)];
+            if (b < 0) b = s;
+        }
+        pmd_replicas_.assign(nodes, nullptr);
+        #pragma omp parallel
+        {
+            const int slot = omp_get_thread_num();
+            const int node = resource_pool_.slot_node(slot);
+            if (builder[node] == slot) {
+                pin_worker(slot);
+                pmd_replicas_[node] = std::make_shared<const IntervalIndex>(*pmd_index_);
+            }
+        }
+    }
+}
+
+void RegionProcessor::pin_worker(int slot) const {
+    if (!numa_pin_ || !numa_topology_ || numa_topology_->num_nodes() < 2) {
+        return;
+    }
+    // OpenMP may hand a thread number to a different OS thread in a later team
+    thread_local int pinned_node = -1;
+    const int node = resource_pool_.slot_node(slot);
+    if (pinned_node != node && Utils::NumaTopology::pin_current_thread(numa_topology_->cpus(node))) {
+        pinned_node = node;
+    }
+}
+
+const IntervalIndex* RegionProcessor::pmd_for(int slot) const {
+    if (!pmd_replicas_.empty()) {
+        if (const auto& replica = pmd_replicas_[resource_pool_.slot_node(slot)]) {
+            return replica.get();
+        }
+    }
+    return pmd_index_.get();
+}
+
+void RegionProcessor::set_decompression_threads(int num_threads) {
+    if (num_threads > 0) {
+        resource_pool_.set_decompression_pool(std::make_shared<HtsThreadPool>(num_threads));
+    }
+}
+
+void RegionProcessor::set_methyl_cache(size_t bytes_per_thread) {
+    for (auto& ws : workspaces_) {
+        ws.methyl_cache.set_capacity(bytes_per_thread);
+    }
+}
+
+MethylCacheStats RegionProcessor::methyl_cache_stats() const {
+    MethylCacheStats total;
+    for (const auto& ws : workspaces_) {
+        total += ws.methyl_cache.stats();
+    }
+    return total;
+}
+
+uint64_t RegionProcessor::estimate_cost(const SuperRegion& sr, int chr_id, BamReader& tumor, BamReader* normal) {
+    uint64_t bytes = tumor.estimate_bytes(tumor.tid(chr_id, sr.chr_name), sr.fetch_start, sr.fetch_end);
+    if (normal) {
+        bytes += normal->estimate_bytes(normal->tid(chr_id, sr.chr_name), sr.fetch_start, sr.fetch_end);
+    }
+    return bytes;
+}
+
+void RegionProcessor::set_max_reads_per_region(int max_reads, uint64_t seed) {
+    for (auto& ws : workspaces_) {
+        ws.sampler.configure(max_reads, seed);
+    }
+}
+
+void RegionProcessor::set_read_filter(const ReadFilterConfig& filter) {
+    for (auto& ws : workspaces_) {
+        ws.read_parser = ReadParser(filter);
+    }
+}
+
+ReadFilterStats RegionProcessor::read_filter_stats(bool tumor) const {
+    ReadFilterStats total;
+    for (const auto& ws : workspaces_) {
+        total += tumor ? ws.tumor_filter : ws.normal_filter;
+    }
+    return total;
+}
+
+void RegionProcessor::open_journal() {
+    if (journal_) {
+        return;
+    }
+    mkdir(output_dir_.c_str(), 0755);
+    std::string path = output_dir_ + "/completed." + (output_tag_.empty() ? "" : output_tag_ + ".") + "journal";
+    journal_ = std::make_unique<CompletionJournal>(path, resume_);
+    if (resume_) {
+        std::cout << "Resuming from " << path << ": " << journal_->num_completed() << " regions completed, "
+                  << journal_->num_failed() << " to retry" << std::endl;
+    }
+}
+
+bool RegionProcessor::already_completed(const SomaticSnv& snv, const std::string& chr_name,
+                                        RegionResult& result) const {
+    if (!resume_ || !journal_ || !journal_->is_completed(CompletionJournal::region_key(chr_name, snv))) {
+        return false;
+    }
+    result = RegionResult();
+    result.region_id = snv.snv_id;
+    result.snv_id = snv.snv_id;
+    result.success = true;
+    result.resumed = true;
+    return true;
+}
+
+void RegionProcessor::journal_failures(const std::vector<RegionResult>& results) {
+    if (!journal_) {
+        return;
+    }
+    std::vector<JournalEntry> failed;
+    for (const auto& r : results) {
+        if (r.success || r.region_id < 0 || r.region_id >= static_cast<int>(snvs_.size())) {
+            continue;
+        }
+        JournalEntry e;
+        e.key = CompletionJournal::region_key(chr_names_[r.region_id], snvs_[r.region_id]);
+        e.region_id = r.region_id;
+        e.detail = r.error_message;
+        failed.push_back(std::move(e));
+    }
+    try {
+        journal_->append(failed);
+    } catch (const std::exception& e) {
+        // Failures are retried on resume whether or not they were journaled
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void RegionProcessor::open_output() {
+    std::string file_tag = output_tag_;
+    const bool keep_existing = resume_ || outputs_opened_++ > 0;
+    auto clusters_path = [&](const std::string& tag) {
+        return output_dir_ + "/clusters" + (tag.empty() ? "" : "." + tag) + ".tsv";
+    };
+    if (keep_existing) {
+        // Earlier shards / cluster tables (of a previous run, or of this processor's
+        // previous process_*() call) hold completed regions: write next to them, never over them
+        // (CSV region directories are per SNV and need no new tag)
+        auto taken = [&](const std::string& tag) {
+            struct stat st;
+            const std::string shard0 = output_dir_ + "/regions." + (tag.empty() ? "" : tag + ".") + "shard_000.ismr";
+            return (output_format_ == OutputFormat::BINARY && stat(shard0.c_str(), &st) == 0) ||
+                   (analysis_enabled_ && stat(clusters_path(tag).c_str(), &st) == 0);
+        };
+        for (int n = 1; taken(file_tag); n++) {
+            char suffix[16];
+            std::snprintf(suffix, sizeof(suffix), "resume%02d", n);
+            file_tag = output_tag_.empty() ? suffix : output_tag_ + "." + suffix;
+        }
+    }
+    writer_ = std::make_unique<AsyncRegionWriter>(
+        output_dir_, output_format_, output_dtype_, writer_threads_, writer_queue_capacity_, 16, file_tag);
+    writer_->set_journal(journal_.get());
+    if (analysis_enabled_) {
+        analyzer_ = std::make_unique<RegionAnalyzer>(analysis_options_, *writer_, clusters_path(file_tag));
+    }
+}
+
+size_t RegionProcessor::close_output(std::vector<RegionResult>& results) {
+    if (!writer_) {
+        return 0;
+    }
+    
+    // The analysis stage drains into the writer, so it closes first
+    std::vector<std::pair<int, std::string>> analysis_errors;
+    if (analyzer_) {
+        analyzer_->close();
+        analysis_errors = analyzer_->errors();
+        analyzer_stats_ = analyzer_->stats();
+        analyzer_.reset();
+    }
+    
+    std::string close_error;
+    try {
+        writer_->close();
+    } catch (const std::exception& e) {
+        close_error = e.what();
+    }
+    
+    for (const auto& [region_id, message] : analysis_errors) {
+        if (region_id >= 0 && region_id < static_cast<int>(results.size())) {
+            results[region_id].success = false;
+            results[region_id].error_message = message;
+        }
+    }
+    
+    // Regions that computed fine but never reached disk count as failures
+    for (const auto& [region_id, message] : writer_->errors()) {
+        if (region_id >= 0 && region_id < static_cast<int>(results.size())) {
+            results[region_id].success = false;
+            results[region_id].error_message = "write failed: " + message;
+        }
+    }
+    if (!close_error.empty()) {
+        std::cerr << "Failed to finalize output: " << close_error << std::endl;
+    }
+    
+    writer_stats_ = writer_->stats();
+    writer_.reset();
+    return writer_stats_.regions_written;
+}
+
+Utils::StageTimes RegionProcessor::stage_totals() const {
+    Utils::StageTimes totals;
+    for (const auto& ws : workspaces_) {
+        totals += ws.stage_totals;
+    }
+    return totals;
+}
+
+namespace {
+
+/// Estimated cost vs measured time over the regions that have an estimate
+struct CostModelFit {
+    size_t regions = 0;
+    double pearson_r = 0.0;  ///< Correlation of est_bytes and elapsed_ms
+    double ms_per_mb = 0.0;  ///< Total elapsed / total estimated MB
+};
+
+CostModelFit fit_cost_model(const std::vector<RegionResult>& results) {
+    CostModelFit fit;
+    double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    for (const auto& r : results) {
+        if (!r.success || r.resumed || r.est_bytes <= 0.0) continue;
+        double x = r.est_bytes, y = r.elapsed_ms;
+        sx += x; sy += y; sxx += x * x; syy += y * y; sxy += x * y;
+        fit.regions++;
+    }
+    if (fit.regions == 0) {
+        return fit;
+    }
+    double n = static_cast<double>(fit.regions);
+    double vx = sxx - sx * sx / n, vy = syy - sy * sy / n;
+    if (vx > 0 && vy > 0) {
+        fit.pearson_r = (sxy - sx * sy / n) / std::sqrt(vx * vy);
+    }
+    fit.ms_per_mb = sy / (sx / (1024.0 * 1024.0));
+    return fit;
+}
+
+} // namespace
+
+void RegionProcessor::write_telemetry(const std::vector<RegionResult>& results, const std::string& path_prefix) const {
+    using Utils::Stage;
+    using Utils::kNumStages;
+    
+    std::ofstream tsv(path_prefix + ".tsv");
+    if (!tsv) {
+        throw std::runtime_error("Failed to write telemetry: " + path_prefix + ".tsv");
+    }
+    tsv << "region_id\tchr\tpos\tref\talt\tstatus\tnum_reads\tnum_normal_reads\tnum_reads_dropped\tnum_cpgs\telapsed_ms\talloc_mb\test_bytes";
+    for (size_t i = 0; i < kNumStages; i++) {
+        tsv << "\t" << Utils::stage_name(static_cast<Stage>(i)) << "_ms";
+    }
+    tsv << "\terror\n";
+    for (const auto& r : results) {
+        if (r.region_id < 0 || r.region_id >= static_cast<int>(snvs_.size())) {
+            continue;
+        }
+        const SomaticSnv& snv = snvs_[r.region_id];
+        std::string error = r.error_message;
+        std::replace(error.begin(), error.end(), '\t', ' ');
+        std::replace(error.begin(), error.end(), '\n', ' ');
+        tsv << r.region_id << "\t" << chr_names_[r.region_id] << "\t" << snv.pos << "\t"
+            << snv.ref_base << "\t" << snv.alt_base << "\t"
+            << (r.resumed ? "resumed" : r.success ? "ok" : "failed") << "\t"
+            << r.num_reads << "\t" << r.num_normal_reads << "\t" << r.num_reads_dropped << "\t" << r.num_cpgs << "\t"
+            << r.elapsed_ms << "\t" << r.peak_memory_mb << "\t" << r.est_bytes;
+        for (double ms : r.stages.ms) {
+            tsv << "\t" << ms;
+        }
+        tsv << "\t" << error << "\n";
+    }
+    
+    // Summary: stage totals merged from the per-thread accumulators
+    std::ofstream json(path_prefix + ".json");
+    if (!json) {
+        throw std::runtime_error("Failed to write telemetry: " + path_prefix + ".json");
+    }
+    auto stage_object = [&](const Utils::StageTimes& t) {
+        json << "{";
+        for (size_t i = 0; i < kNumStages; i++) {
+            json << (i ? ", " : "") << "\"" << Utils::stage_name(static_cast<Stage>(i)) << "_ms\": " << t.ms[i];
+        }
+        json << "}";
+    };
+    
+    Utils::StageTimes totals = stage_totals();
+    size_t processed = 0, failed = 0, resumed = 0;
+    double alloc_mb = 0.0;
+    for (const auto& r : results) {
+        if (r.resumed) resumed++;
+        else if (r.success) processed++;
+        else failed++;
+        alloc_mb += r.peak_memory_mb;
+    }
+    const AsyncWriterStats& w = writer_stats_;
+    double io_ms = totals[Stage::BAM_FETCH] + totals[Stage::REF_FETCH] + w.write_ms;
+    double cpu_ms = totals[Stage::FILTER] + totals[Stage::PARSE] + totals[Stage::FINALIZE];
+    
+    json << "{\n";
+    json << "  \"regions\": {\"ok\": " << processed << ", \"failed\": " << failed
+         << ", \"resumed\": " << resumed << "},\n";
+    json << "  \"threads\": " << num_threads_ << ",\n";
+    json << "  \"hts_threads\": "
+         << (resource_pool_.decompression_pool() ? resource_pool_.decompression_pool()->size() : 0) << ",\n";
+    json << "  \"stages\": ";
+    stage_object(totals);
+    json << ",\n";
+    json << "  \"per_thread\": [";
+    bool first = true;
+    for (size_t t = 0; t < workspaces_.size(); t++) {
+        if (workspaces_[t].regions == 0) continue;
+        json << (first ? "\n" : ",\n") << "    {\"thread\": " << t << ", \"regions\": " << workspaces_[t].regions
+             << ", \"arena_mb\": " << workspaces_[t].arena.capacity() / (1024.0 * 1024.0)
+             << ", \"arena_system_allocs\": " << workspaces_[t].arena.system_allocations()
+             << ", \"stages\": ";
+        stage_object(workspaces_[t].stage_totals);
+        json << "}";
+        first = false;
+    }
+    json << "\n  ],\n";
+    json << "  \"writer\": {\"threads\": " << w.num_writer_threads << ", \"batches\": " << w.batches
+         << ", \"write_ms\": " << w.write_ms << ", \"queue_max_depth\": " << w.queue.max_depth
+         << ", \"queue_capacity\": " << w.queue.capacity << ", \"push_stalls\": " << w.queue.push_stalls
+         << ", \"push_stall_ms\": " << w.queue.push_stall_ms << "},\n";
+    if (analyzer_stats_.num_threads > 0) {
+        const AnalyzerStats& a = analyzer_stats_;
+        json << "  \"analysis\": {\"threads\": " << a.num_threads << ", \"regions\": " << a.regions_analyzed
+             << ", \"skipped\": " << a.regions_skipped << ", \"clusters\": " << a.clusters
+             << ", \"analyze_ms\": " << a.analyze_ms << ", \"queue_max_depth\": " << a.queue.max_depth
+             << ", \"queue_capacity\": " << a.queue.capacity << ", \"push_stalls\": " << a.queue.push_stalls
+             << ", \"push_stall_ms\": " << a.queue.push_stall_ms << "},\n";
+    }
+    auto filter_object = [&](const ReadFilterStats& f) {
+        json << "{\"seen\": " << f.seen << ", \"flag\": " << f.failed_flag << ", \"mapq\": " << f.failed_mapq
+             << ", \"length\": " << f.failed_length << ", \"tags\": " << f.failed_tags << ", \"kept\": " << f.kept << "}";
+    };
+    json << "  \"read_filter\": {\"tumor\": ";
+    filter_object(read_filter_stats(true));
+    json << ", \"normal\": ";
+    filter_object(read_filter_stats(false));
+    json << "},\n";
+    uint64_t reads_dropped = 0, regions_downsampled = 0;
+    for (const auto& r : results) {
+        reads_dropped += r.num_reads_dropped;
+        regions_downsampled += r.num_reads_dropped > 0;
+    }
+    json << "  \"downsampling\": {\"max_reads_per_region\": " << workspaces_.front().sampler.max_reads()
+         << ", \"regions\": " << regions_downsampled << ", \"reads_dropped\": " << reads_dropped << "},\n";
+    size_t prefetched = 0;
+    double prefetch_wait_ms = 0.0;
+    for (const auto& ws : workspaces_) {
+        prefetched += ws.prefetched;
+        prefetch_wait_ms += ws.prefetch_wait_ms;
+    }
+    json << "  \"prefetch\": {\"depth\": " << prefetch_depth_ << ", \"super_regions\": " << prefetched
+         << ", \"wait_ms\": " << prefetch_wait_ms << "},\n";
+    CostModelFit fit = fit_cost_model(results);
+    json << "  \"cost_model\": {\"enabled\": " << (cost_scheduling_ ? "true" : "false")
+         << ", \"estimate_ms\": " << cost_estimate_ms_ << ", \"regions\": " << fit.regions
+         << ", \"pearson_r\": " << fit.pearson_r << ", \"ms_per_mb\": " << fit.ms_per_mb << "},\n";
+    MethylCacheStats mc = methyl_cache_stats();
+    json << "  \"methyl_cache\": {\"hits\": " << mc.hits << ", \"misses\": " << mc.misses
+         << ", \"evictions\": " << mc.evictions << ", \"hit_rate\": " << mc.hit_rate() << "},\n";
+    json << "  \"alloc_mb\": " << alloc_mb << ",\n";
+    json << "  \"io_ms\": " << io_ms << ",\n";
+    json << "  \"cpu_ms\": " << cpu_ms << ",\n";
+    json << "  \"bound\": \"" << (io_ms > cpu_ms ? "io" : "cpu") << "\"\n";
+    json << "}\n";
+}
+
 void RegionProcessor::print_summary(const std::vector<RegionResult>& results) const {
     int success_count = 0;
+    int resumed_count = 0;
     int total_reads = 0;
+    int total_normal_reads = 0;
+    int total_dropped = 0;
+    int regions_downsampled = 0;
     int total_cpgs = 0;
     double total_time = 0.0;
     
     for (const auto& r : results) {
-        if (r.success) {
+        if (r.resumed) {
+            resumed_count++;
+        } else if (r.success) {
             success_count++;
             total_reads += r.num_reads;
+            total_normal_reads += r.num_normal_reads;
+            total_dropped += r.num_reads_dropped;
+            regions_downsampled += r.num_reads_dropped > 0;
             total_cpgs += r.num_cpgs;
             total_time += r.elapsed_ms;
         }
@@ -255,14 +1365,109 @@ void RegionProcessor::print_summary(const std::vector<RegionResult>& results) co
     
     std::cout << "\n=== Processing Summary ===" << std::endl;
     std::cout << "Total regions: " << results.size() << std::endl;
+    if (resumed_count > 0) {
+        std::cout << "Completed in a previous run: " << resumed_count << std::endl;
+    }
     std::cout << "Successful: " << success_count << std::endl;
-    std::cout << "Failed: " << (results.size() - success_count) << std::endl;
-    std::cout << "Total reads processed: " << total_reads << std::endl;
+    std::cout << "Failed: " << (results.size() - success_count - resumed_count) << std::endl;
+    std::cout << "Total reads processed: " << total_reads
+              << " (tumor " << (total_reads - total_normal_reads)
+              << ", normal " << total_normal_reads << ")" << std::endl;
+    if (workspaces_.front().sampler.enabled()) {
+        std::cout << "Downsampled regions (max " << workspaces_.front().sampler.max_reads() << " reads): "
+                  << regions_downsampled << ", " << total_dropped << " reads dropped" << std::endl;
+    }
     std::cout << "Total CpG sites found: " << total_cpgs << std::endl;
     std::cout << "Total processing time: " << total_time << " ms" << std::endl;
-    std::cout << "Average time per region: " << (total_time / results.size()) << " ms" << std::endl;
+    std::cout << "Average time per region: " << (total_time / (results.size() - resumed_count)) << " ms" << std::endl;
     std::cout << "Average reads per region: " << (total_reads / static_cast<double>(success_count)) << std::endl;
     std::cout << "Average CpGs per region: " << (total_cpgs / static_cast<double>(success_count)) << std::endl;
+    
+    ThreadResourceStats rs = resource_pool_.stats();
+    std::cout << "Reader opens (tumor/normal/fasta): " << rs.tumor_bam.opens << "/"
+              << rs.normal_bam.opens << "/" << rs.fasta.opens << std::endl;
+    std::cout << "Reader opens avoided by thread-local pool: " << rs.total_avoided()
+              << " (tumor " << rs.tumor_bam.avoided()
+              << ", normal " << rs.normal_bam.avoided()
+              << ", fasta " << rs.fasta.avoided() << ")" << std::endl;
+    std::cout << "BAM records reused from pool: " << rs.records_reused
+              << " (allocated " << rs.records_allocated << ")" << std::endl;
+    auto print_filter = [](const char* label, const ReadFilterStats& f) {
+        std::cout << "Read filter (" << label << "): " << f.seen << " seen, " << f.failed_flag << " flag, "
+                  << f.failed_mapq << " MAPQ, " << f.failed_length << " length, " << f.failed_tags
+                  << " no MM/ML -> " << f.kept << " kept" << std::endl;
+    };
+    print_filter("tumor", read_filter_stats(true));
+    if (resource_pool_.has_normal()) {
+        print_filter("normal", read_filter_stats(false));
+    }
+    if (pmd_index_) {
+        size_t excluded = 0;
+        for (const auto& ws : workspaces_) {
+            excluded += ws.methyl_parser.excluded_calls();
+        }
+        std::cout << "CpG calls dropped in PMDs: " << excluded << std::endl;
+    }
+    if (prefetch_depth_ > 0) {
+        size_t prefetched = 0;
+        double prefetch_wait_ms = 0.0;
+        for (const auto& ws : workspaces_) {
+            prefetched += ws.prefetched;
+            prefetch_wait_ms += ws.prefetch_wait_ms;
+        }
+        std::cout << "Prefetch (depth " << prefetch_depth_ << "): " << prefetched
+                  << " super-regions, workers waited " << prefetch_wait_ms << " ms for I/O" << std::endl;
+    }
+    if (cost_scheduling_) {
+        CostModelFit fit = fit_cost_model(results);
+        std::cout << "Cost model: estimated in " << cost_estimate_ms_ << " ms; estimated bytes vs actual time r = "
+                  << fit.pearson_r << " over " << fit.regions << " regions (" << fit.ms_per_mb
+                  << " ms per estimated MB)" << std::endl;
+    }
+    if (workspaces_.front().methyl_cache.enabled()) {
+        MethylCacheStats mc = methyl_cache_stats();
+        std::cout << "Methyl-call cache: " << mc.hits << " hits, " << mc.misses << " misses ("
+                  << (100.0 * mc.hit_rate()) << "% hit rate), " << mc.evictions << " evictions" << std::endl;
+    }
+    if (const auto& pool = resource_pool_.decompression_pool()) {
+        std::cout << "Shared BGZF decompression threads: " << pool->size() << std::endl;
+    }
+    if (const auto& caches = resource_pool_.reference_caches(); !caches.empty()) {
+        size_t loaded = 0;
+        size_t bytes = 0;
+        for (const auto& cache : caches) {
+            loaded += cache->num_loaded();
+            bytes += cache->bytes();
+        }
+        std::cout << "Reference cache: " << loaded << " chromosomes, " << (bytes / (1024.0 * 1024.0)) << " MB";
+        if (caches.size() > 1) {
+            std::cout << " over " << caches.size() << " NUMA node copies";
+        }
+        std::cout << std::endl;
+    }
+    
+    Utils::StageTimes st = stage_totals();
+    std::cout << "Stage time (ms, all threads):";
+    for (size_t i = 0; i < Utils::kNumStages; i++) {
+        std::cout << " " << Utils::stage_name(static_cast<Utils::Stage>(i)) << "=" << st.ms[i];
+    }
+    std::cout << std::endl;
+    
+    const AsyncWriterStats& ws = writer_stats_;
+    std::cout << "Writer threads: " << ws.num_writer_threads << ", batches: " << ws.batches
+              << ", write time: " << ws.write_ms << " ms" << std::endl;
+    std::cout << "Writer queue max depth: " << ws.queue.max_depth << "/" << ws.queue.capacity
+              << ", producer stalls: " << ws.queue.push_stalls
+              << " (" << ws.queue.push_stall_ms << " ms)" << std::endl;
+    if (analyzer_stats_.num_threads > 0) {
+        const AnalyzerStats& as = analyzer_stats_;
+        std::cout << "Analysis threads: " << as.num_threads << ", clustered regions: " << as.regions_analyzed
+                  << " (" << as.regions_skipped << " too small), clusters: " << as.clusters
+                  << ", analysis time: " << as.analyze_ms << " ms" << std::endl;
+        std::cout << "Analysis queue max depth: " << as.queue.max_depth << "/" << as.queue.capacity
+                  << ", producer stalls: " << as.queue.push_stalls
+                  << " (" << as.queue.push_stall_ms << " ms)" << std::endl;
+    }
 }
 
 } // namespace InterSubMod
@@ -0,0 +1,188 @@
+#include "core/RegionScheduler.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace InterSubMod {
+
+RegionScheduler::RegionScheduler(int32_t window_size, int32_t merge_gap, int32_t max_span)
+    : window_size_(window_size), merge_gap_(merge_gap), max_span_(max_span) {
+}
+
+void RegionScheduler::window_of(const SomaticSnv& snv, int32_t& start, int32_t& end) const {
+    start = snv.pos - window_size_;
+    end = snv.pos + window_size_;
+    if (start < 1) start = 1;
+}
+
+std::vector<SuperRegion> RegionScheduler::build_super_regions(
+    const std::vector<SomaticSnv>& snvs,
+    const std::vector<std::string>& chr_names,
+    int count
+) const {
+    std::vector<SuperRegion> super_regions;
+    if (count <= 0) {
+        return super_regions;
+    }
+
+    // Rank chromosomes by first appearance to keep the input's contig order
+    std::unordered_map<std::string, int> chr_rank;
+    std::vector<int> rank_of(count);
+    for (int i = 0; i < count; i++) {
+        auto it = chr_rank.emplace(chr_names[i], static_cast<int>(chr_rank.size())).first;
+        rank_of[i] = it->second;
+    }
+
+    // Sort region IDs by (chromosome, position); ties keep input order
+    std::vector<int> order(count);
+    for (int i = 0; i < count; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (rank_of[a] != rank_of[b]) return rank_of[a] < rank_of[b];
+        return snvs[a].pos < snvs[b].pos;
+    });
+
+    // Sweep and coalesce overlapping / nearby windows
+    for (int id : order) {
+        int32_t start, end;
+        window_of(snvs[id], start, end);
+
+        if (!super_regions.empty() && try_extend(super_regions.back(), snvs[id], chr_names[id], id)) {
+            continue;
+        }
+
+        SuperRegion sr;
+        sr.chr_name = chr_names[id];
+        sr.fetch_start = start;
+        sr.fetch_end = end;
+        sr.members.push_back(id);
+        super_regions.push_back(std::move(sr));
+    }
+
+    return super_regions;
+}
+
+bool RegionScheduler::try_extend(SuperRegion& cur, const SomaticSnv& snv, const std::string& chr_name,
+                                 int region_id) const {
+    int32_t start, end;
+    window_of(snv, start, end);
+
+    bool same_chr = (cur.chr_name == chr_name);
+    bool ordered = (start >= cur.fetch_start);
+    bool close = (static_cast<int64_t>(start) <= static_cast<int64_t>(cur.fetch_end) + merge_gap_);
+    bool fits = (static_cast<int64_t>(std::max(end, cur.fetch_end)) - cur.fetch_start <= max_span_);
+    if (!(same_chr && ordered && close && fits)) {
+        return false;
+    }
+    cur.fetch_end = std::max(cur.fetch_end, end);
+    cur.members.push_back(region_id);
+    return true;
+}
+
+std::vector<WorkBatch> RegionScheduler::build_batches(
+    const std::vector<SuperRegion>& super_regions,
+    int num_threads
+) const {
+    std::vector<WorkBatch> batches;
+    if (super_regions.empty()) {
+        return batches;
+    }
+
+    size_t total = 0;
+    for (const auto& sr : super_regions) total += sr.members.size();
+
+    // ~4 batches per thread; never split a super-region
+    size_t target = total / (static_cast<size_t>(std::max(num_threads, 1)) * 4);
+    if (target < 1) target = 1;
+
+    WorkBatch cur{0, 0, 0};
+    for (size_t i = 0; i < super_regions.size(); i++) {
+        bool new_chr = (i > cur.first && super_regions[i].chr_name != super_regions[cur.first].chr_name);
+        if (cur.last > cur.first && (new_chr || static_cast<size_t>(cur.num_regions) >= target)) {
+            batches.push_back(cur);
+            cur = WorkBatch{i, i, 0};
+        }
+        cur.last = i + 1;
+        cur.num_regions += static_cast<int>(super_regions[i].members.size());
+    }
+    batches.push_back(cur);
+
+    return batches;
+}
+
+std::vector<WorkBatch> RegionScheduler::build_cost_batches(
+    const std::vector<SuperRegion>& super_regions,
+    int num_threads
+) const {
+    std::vector<WorkBatch> batches;
+    if (super_regions.empty()) {
+        return batches;
+    }
+
+    uint64_t total = 0;
+    for (const auto& sr : super_regions) total += sr.est_bytes;
+
+    // ~4 batches per thread by estimated cost; never split a super-region
+    uint64_t target = total / (static_cast<uint64_t>(std::max(num_threads, 1)) * 4);
+    if (target < 1) target = 1;
+
+    WorkBatch cur{0, 0, 0};
+    for (size_t i = 0; i < super_regions.size(); i++) {
+        bool new_chr = (i > cur.first && super_regions[i].chr_name != super_regions[cur.first].chr_name);
+        bool heavy = super_regions[i].est_bytes >= target;
+        if (cur.last > cur.first && (new_chr || heavy || cur.est_bytes >= target)) {
+            batches.push_back(cur);
+            cur = WorkBatch{i, i, 0};
+        }
+        cur.last = i + 1;
+        cur.num_regions += static_cast<int>(super_regions[i].members.size());
+        cur.est_bytes += super_regions[i].est_bytes;
+    }
+    batches.push_back(cur);
+
+    // Longest first; ties keep genome order
+    std::stable_sort(batches.begin(), batches.end(),
+                     [](const WorkBatch& a, const WorkBatch& b) { return a.est_bytes > b.est_bytes; });
+    return batches;
+}
+
+std::vector<std::vector<size_t>> RegionScheduler::partition_by_node(
+    const std::vector<SuperRegion>& super_regions,
+    const std::vector<WorkBatch>& batches,
+    int num_nodes
+) {
+    std::vector<std::vector<size_t>> per_node(static_cast<size_t>(std::max(num_nodes, 1)));
+
+    bool estimated = false;
+    for (const auto& b : batches) {
+        if (b.est_bytes > 0) estimated = true;
+    }
+
+    // Chromosome weights, in first-appearance order
+    std::vector<uint64_t> weights;
+    std::unordered_map<std::string, size_t> chrom_of;
+    std::vector<size_t> batch_chrom(batches.size());
+    for (size_t b = 0; b < batches.size(); b++) {
+        auto it = chrom_of.emplace(super_regions[batches[b].first].chr_name, weights.size()).first;
+        if (it->second == weights.size()) weights.push_back(0);
+        weights[it->second] += estimated ? batches[b].est_bytes : static_cast<uint64_t>(batches[b].num_regions);
+        batch_chrom[b] = it->second;
+    }
+
+    // Heaviest chromosome onto the lightest node; ties keep genome order / lowest node
+    std::vector<size_t> order(weights.size());
+    for (size_t c = 0; c < order.size(); c++) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return weights[a] > weights[b]; });
+    std::vector<uint64_t> load(per_node.size(), 0);
+    std::vector<size_t> node_of(weights.size(), 0);
+    for (size_t c : order) {
+        size_t node = std::min_element(load.begin(), load.end()) - load.begin();
+        node_of[c] = node;
+        load[node] += weights[c];
+    }
+
+    for (size_t b = 0; b < batches.size(); b++) {
+        per_node[node_of[batch_chrom[b]]].push_back(b);
+    }
+    return per_node;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,248 @@
+#include "core/ShardPlan.hpp"
+#include "utils/Hash.hpp"
+#include <htslib/sam.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace InterSubMod {
+
+std::string GenomicRange::to_string() const {
+    if (start <= 1 && end == INT64_MAX) {
+        return chr;
+    }
+    if (end == INT64_MAX) {
+        return chr + ":" + std::to_string(start);
+    }
+    return chr + ":" + std::to_string(start) + "-" + std::to_string(end);
+}
+
+// "12,500", "50M", "1.5k" -> bases; false if not a number
+static bool parse_position(std::string s, int64_t& out) {
+    s.erase(std::remove(s.begin(), s.end(), ','), s.end());
+    if (s.empty()) {
+        return false;
+    }
+    double scale = 1.0;
+    switch (s.back()) {
+        case 'k': case 'K': scale = 1e3; break;
+        case 'm': case 'M': scale = 1e6; break;
+        case 'g': case 'G': scale = 1e9; break;
+        default: break;
+    }
+    if (scale != 1.0) {
+        s.pop_back();
+    }
+    if (s.empty() || s.find_first_not_of("0123456789.") != std::string::npos) {
+        return false;
+    }
+    double value = std::stod(s) * scale;
+    if (value < 0 || value > 9.0e18) {
+        return false;
+    }
+    out = static_cast<int64_t>(std::llround(value));
+    return true;
+}
+
+static GenomicRange parse_one_region(const std::string& item) {
+    GenomicRange r;
+    size_t colon = item.rfind(':');
+    if (colon != std::string::npos) {
+        std::string coords = item.substr(colon + 1);
+        size_t dash = coords.find('-');
+        int64_t start = 0, end = INT64_MAX;
+        bool ok = parse_position(coords.substr(0, dash), start);
+        if (ok && dash != std::string::npos && dash + 1 < coords.size()) {
+            ok = parse_position(coords.substr(dash + 1), end);
+        }
+        if (ok) {
+            r.chr = item.substr(0, colon);
+            r.start = std::max<int64_t>(start, 1);
+            r.end = end;
+            if (r.chr.empty() || r.end < r.start) {
+                throw std::runtime_error("Invalid region: " + item);
+            }
+            return r;
+        }
+        // Not coordinates: a contig name containing ':' (e.g. HLA alleles)
+    }
+    if (item.empty()) {
+        throw std::runtime_error("Empty region in region list");
+    }
+    r.chr = item;
+    return r;
+}
+
+std::vector<GenomicRange> normalize_ranges(std::vector<GenomicRange> ranges) {
+    std::unordered_map<std::string, int> rank;
+    for (const auto& r : ranges) {
+        rank.emplace(r.chr, static_cast<int>(rank.size()));
+    }
+    std::stable_sort(ranges.begin(), ranges.end(), [&](const GenomicRange& a, const GenomicRange& b) {
+        if (rank[a.chr] != rank[b.chr]) return rank[a.chr] < rank[b.chr];
+        return a.start < b.start;
+    });
+
+    std::vector<GenomicRange> merged;
+    for (auto& r : ranges) {
+        if (!merged.empty() && merged.back().chr == r.chr &&
+            (merged.back().end == INT64_MAX || r.start <= merged.back().end + 1)) {
+            merged.back().end = std::max(merged.back().end, r.end);
+        } else {
+            merged.push_back(std::move(r));
+        }
+    }
+    return merged;
+}
+
+std::vector<GenomicRange> parse_region_list(const std::string& spec) {
+    std::vector<GenomicRange> ranges;
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        // ',' is also a digit separator: an item ends at a ',' followed by a non-digit
+        size_t end = begin;
+        while (end < spec.size()) {
+            if (spec[end] == ',' && (end + 1 >= spec.size() || !std::isdigit(static_cast<unsigned char>(spec[end + 1])))) {
+                break;
+            }
+            end++;
+        }
+        std::string item = spec.substr(begin, end - begin);
+        if (!item.empty()) {
+            ranges.push_back(parse_one_region(item));
+        }
+        begin = end + 1;
+    }
+    if (ranges.empty()) {
+        throw std::runtime_error("Empty region list");
+    }
+    return normalize_ranges(std::move(ranges));
+}
+
+ShardSpec ShardSpec::parse(const std::string& spec) {
+    ShardSpec s;
+    size_t slash = spec.find('/');
+    int64_t index = 0, count = 0;
+    if (slash == std::string::npos ||
+        !parse_position(spec.substr(0, slash), index) || !parse_position(spec.substr(slash + 1), count) ||
+        count < 1 || index < 1 || index > count || count > 100000) {
+        throw std::runtime_error("Invalid shard '" + spec + "' (expected i/N with 1 <= i <= N)");
+    }
+    s.index = static_cast<int>(index);
+    s.count = static_cast<int>(count);
+    return s;
+}
+
+std::string ShardSpec::tag() const {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "part_%03d_of_%03d", index, count);
+    return buf;
+}
+
+std::vector<GenomicRange> ShardPlanner::plan(const std::vector<ContigWeight>& contigs, const ShardSpec& shard) {
+    std::vector<GenomicRange> ranges;
+    const size_t n = contigs.size();
+    if (!shard.enabled() || n == 0) {
+        return ranges;
+    }
+
+    // Uniform weights when nothing better is known
+    bool use_weight = false;
+    for (const auto& c : contigs) {
+        if (c.weight > 0) use_weight = true;
+    }
+    std::vector<double> w(n), offset(n + 1, 0.0);
+    for (size_t c = 0; c < n; c++) {
+        w[c] = use_weight ? std::max(contigs[c].weight, 0.0) : static_cast<double>(std::max<int64_t>(contigs[c].length, 0));
+        offset[c + 1] = offset[c] + w[c];
+    }
+    const double total = offset[n];
+    if (total <= 0) {
+        return ranges;
+    }
+
+    // Cut k of N as (contig, 1-based first position of shard k); (n, 1) is the end
+    auto cut = [&](int k, size_t& contig, int64_t& pos) {
+        contig = 0;
+        pos = 1;
+        if (k <= 0) return;
+        if (k >= shard.count) { contig = n; return; }
+        double x = total * k / shard.count;
+        while (contig < n && offset[contig] + w[contig] <= x) contig++;
+        if (contig == n) return;
+        double frac = (x - offset[contig]) / w[contig];
+        pos = 1 + static_cast<int64_t>(std::floor(frac * contigs[contig].length));
+        pos = std::min(std::max<int64_t>(pos, 1), std::max<int64_t>(contigs[contig].length, 1));
+    };
+
+    size_t c0, c1;
+    int64_t p0, p1;
+    cut(shard.index - 1, c0, p0);
+    cut(shard.index, c1, p1);
+    for (size_t c = c0; c <= c1 && c < n; c++) {
+        GenomicRange r;
+        r.chr = contigs[c].name;
+        r.start = (c == c0) ? p0 : 1;
+        r.end = (c == c1) ? p1 - 1 : contigs[c].length;
+        if (r.end >= r.start) {
+            ranges.push_back(std::move(r));
+        }
+    }
+    return ranges;
+}
+
+std::vector<ContigWeight> ShardPlanner::weights_from_bam(const std::string& bam_path) {
+    samFile* fp = sam_open(bam_path.c_str(), "r");
+    if (!fp) {
+        throw std::runtime_error("Failed to open BAM file: " + bam_path);
+    }
+    sam_hdr_t* hdr = sam_hdr_read(fp);
+    hts_idx_t* idx = hdr ? sam_index_load(fp, bam_path.c_str()) : nullptr;
+    if (!idx) {
+        if (hdr) sam_hdr_destroy(hdr);
+        sam_close(fp);
+        throw std::runtime_error("Failed to load BAM header/index: " + bam_path);
+    }
+
+    // Index metadata only: mapped read counts per contig, no records are read
+    std::vector<ContigWeight> contigs(sam_hdr_nref(hdr));
+    for (int tid = 0; tid < static_cast<int>(contigs.size()); tid++) {
+        uint64_t mapped = 0, unmapped = 0;
+        contigs[tid].name = sam_hdr_tid2name(hdr, tid);
+        contigs[tid].length = sam_hdr_tid2len(hdr, tid);
+        if (hts_idx_get_stat(idx, tid, &mapped, &unmapped) == 0) {
+            contigs[tid].weight = static_cast<double>(mapped);
+        }
+    }
+
+    hts_idx_destroy(idx);
+    sam_hdr_destroy(hdr);
+    sam_close(fp);
+    return contigs;
+}
+
+std::string region_selection_tag(const std::vector<GenomicRange>& ranges) {
+    std::string joined;
+    for (const auto& r : ranges) {
+        if (!joined.empty()) joined += '+';
+        joined += r.to_string();
+    }
+    std::string tag;
+    for (char ch : joined) {
+        bool safe = std::isalnum(static_cast<unsigned char>(ch)) || ch == '.' || ch == '-' || ch == '+';
+        tag += safe ? ch : '_';
+    }
+    if (tag.size() <= 48) {
+        return tag;
+    }
+    // Stable across runs and platforms
+    uint64_t h = Utils::fnv1a64(joined);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "regions_%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,220 @@
+#include "core/SnvSource.hpp"
+#include "utils/Logger.hpp"
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    std::string suf(suffix);
+    return s.size() >= suf.size() && s.compare(s.size() - suf.size(), suf.size(), suf) == 0;
+}
+
+bool SnvSource::is_vcf_path(const std::string& path) {
+    return ends_with(path, ".vcf") || ends_with(path, ".vcf.gz") || ends_with(path, ".vcf.bgz") ||
+           ends_with(path, ".bcf");
+}
+
+SnvSource::SnvSource(const std::string& path, ChromIndex& chrom_index, Format format)
+    : path_(path), chrom_index_(chrom_index), format_(format),
+      vcf_(nullptr), hdr_(nullptr), rec_(nullptr), af_buf_(nullptr), af_cap_(0),
+      tbx_(nullptr), bcf_idx_(nullptr), itr_(nullptr), next_range_(0), line_buf_{0, 0, nullptr},
+      first_line_(true) {
+    if (format_ == Format::AUTO) {
+        format_ = is_vcf_path(path) ? Format::VCF : Format::TSV;
+    }
+
+    if (format_ == Format::TSV) {
+        tsv_.open(path);
+        if (!tsv_.is_open()) {
+            throw std::runtime_error("Failed to open SNV table: " + path);
+        }
+        return;
+    }
+
+    vcf_ = vcf_open(path.c_str(), "r");
+    if (!vcf_) {
+        throw std::runtime_error("Failed to open VCF file: " + path);
+    }
+    hdr_ = vcf_hdr_read(vcf_);
+    if (!hdr_) {
+        vcf_close(vcf_);
+        throw std::runtime_error("Failed to read VCF header: " + path);
+    }
+
+    // Register header contigs first so chr_id follows the header order
+    int nseq = 0;
+    const char** seqnames = bcf_hdr_seqnames(hdr_, &nseq);
+    if (seqnames) {
+        for (int i = 0; i < nseq; i++) {
+            chrom_index_.get_or_create_id(seqnames[i]);
+        }
+        free(seqnames);
+    }
+    if (bcf_hdr_id2int(hdr_, BCF_DT_ID, "PASS") < 0) {
+        Utils::Logger::warning("Filter 'PASS' not found in VCF header definitions.");
+    }
+    rec_ = bcf_init();
+}
+
+SnvSource::~SnvSource() {
+    if (itr_) hts_itr_destroy(itr_);
+    if (tbx_) tbx_destroy(tbx_);
+    if (bcf_idx_) hts_idx_destroy(bcf_idx_);
+    free(line_buf_.s);
+    if (af_buf_) free(af_buf_);
+    if (rec_) bcf_destroy(rec_);
+    if (hdr_) bcf_hdr_destroy(hdr_);
+    if (vcf_) vcf_close(vcf_);
+}
+
+bool SnvSource::next(SomaticSnv& snv, std::string& chr_name) {
+    bool ok = (format_ == Format::VCF) ? next_vcf(snv, chr_name) : next_tsv(snv, chr_name);
+    if (ok) {
+        snv.snv_id = static_cast<int>(stats_.loaded++);
+    }
+    return ok;
+}
+
+void SnvSource::set_regions(const std::vector<GenomicRange>& ranges) {
+    ranges_ = normalize_ranges(ranges);
+    range_filter_ = IntervalIndex();
+    for (const auto& r : ranges_) {
+        range_filter_.add(r.chr, r.start - 1, r.end);
+    }
+    range_filter_.finalize();
+    if (format_ != Format::VCF || ranges_.empty()) {
+        return;
+    }
+
+    // Seek with the index when there is one (.tbi or .csi next to the file)
+    if (ends_with(path_, ".bcf")) {
+        bcf_idx_ = bcf_index_load(path_.c_str());
+    } else {
+        tbx_ = tbx_index_load(path_.c_str());
+    }
+    stats_.indexed = (tbx_ || bcf_idx_);
+    if (!stats_.indexed) {
+        Utils::Logger::warning("No .tbi/.csi index for " + path_ + "; scanning the whole file for the selected regions");
+    }
+}
+
+bool SnvSource::selected(const std::string& chr_name, int64_t pos) const {
+    return ranges_.empty() || range_filter_.contains(chr_name, pos - 1);
+}
+
+int SnvSource::read_vcf_record() {
+    if (!stats_.indexed) {
+        return vcf_read(vcf_, hdr_, rec_);
+    }
+    while (true) {
+        if (!itr_) {
+            if (next_range_ >= ranges_.size()) {
+                return -1;
+            }
+            std::string region = ranges_[next_range_++].to_string();
+            itr_ = tbx_ ? tbx_itr_querys(tbx_, region.c_str()) : bcf_itr_querys(bcf_idx_, hdr_, region.c_str());
+            if (!itr_) {
+                continue;  // contig has no records in the index
+            }
+        }
+        int ret = tbx_ ? tbx_itr_next(vcf_, tbx_, itr_, &line_buf_) : bcf_itr_next(vcf_, itr_, rec_);
+        if (ret >= 0) {
+            return (tbx_ && vcf_parse(&line_buf_, hdr_, rec_) < 0) ? -2 : 0;
+        }
+        hts_itr_destroy(itr_);
+        itr_ = nullptr;
+        if (ret < -1) {
+            return ret;
+        }
+    }
+}
+
+bool SnvSource::next_vcf(SomaticSnv& snv, std::string& chr_name) {
+    int ret;
+    while ((ret = read_vcf_record()) >= 0) {
+        stats_.records++;
+
+        // Index queries return overlapping records; the filter keeps range
+        // edges exact and drops everything else in a full scan
+        const char* rec_chr = bcf_hdr_id2name(hdr_, rec_->rid);
+        if (!ranges_.empty() && !selected(rec_chr, rec_->pos + 1)) {
+            stats_.outside++;
+            continue;
+        }
+
+        // CHROM/POS/QUAL are always decoded; alleles and FILTER are all we need
+        // to decide, so FORMAT is only unpacked for records that are kept
+        bcf_unpack(rec_, BCF_UN_STR | BCF_UN_FLT);
+        if (bcf_has_filter(hdr_, rec_, const_cast<char*>("PASS")) != 1 ||
+            !bcf_is_snp(rec_) || rec_->n_allele != 2) {
+            stats_.skipped++;
+            continue;
+        }
+
+        bcf_unpack(rec_, BCF_UN_FMT);
+        float tumor_vaf = 0.0f;
+        if (bcf_get_format_float(hdr_, rec_, "AF", &af_buf_, &af_cap_) > 0) {
+            tumor_vaf = af_buf_[0];  // single-sample (tumor) VCF
+        }
+
+        chr_name = rec_chr;
+        snv.chr_id = chrom_index_.get_or_create_id(chr_name);
+        snv.pos = static_cast<int32_t>(rec_->pos + 1);  // 0-based to 1-based
+        snv.ref_base = rec_->d.allele[0][0];
+        snv.alt_base = rec_->d.allele[1][0];
+        snv.qual = rec_->qual;
+        snv.is_pass_filter = true;
+        snv.somatic_conf = tumor_vaf;
+        snv.info_flags.clear();
+        return true;
+    }
+    if (ret < -1) {
+        throw std::runtime_error("Failed to read VCF record " + std::to_string(stats_.records + 1) +
+                                 " in " + path_);
+    }
+    return false;
+}
+
+bool SnvSource::next_tsv(SomaticSnv& snv, std::string& chr_name) {
+    while (std::getline(tsv_, line_)) {
+        bool first = first_line_;
+        first_line_ = false;
+        if (line_.empty() || line_[0] == '#') {
+            continue;
+        }
+
+        std::istringstream iss(line_);
+        int32_t pos;
+        char ref, alt;
+        float qual = 0.0f;
+        if (!(iss >> chr_name >> pos >> ref >> alt)) {
+            if (!first) {  // a non-numeric first line is the header
+                stats_.records++;
+                stats_.skipped++;
+                Utils::Logger::warning("Failed to parse SNV line in " + path_ + ": " + line_);
+            }
+            continue;
+        }
+        iss >> qual;  // Optional
+        stats_.records++;
+        if (!selected(chr_name, pos)) {
+            stats_.outside++;
+            continue;
+        }
+
+        snv.chr_id = chrom_index_.get_or_create_id(chr_name);
+        snv.pos = pos;
+        snv.ref_base = ref;
+        snv.alt_base = alt;
+        snv.qual = qual;
+        snv.is_pass_filter = true;
+        snv.somatic_conf = 0.0f;
+        snv.info_flags.clear();
+        return true;
+    }
+    return false;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,146 @@
+#include "core/ThreadResourcePool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+ThreadResourcePool::ThreadResourcePool(
+    const std::string& tumor_bam_path,
+    const std::string& normal_bam_path,
+    const std::string& ref_fasta_path,
+    int num_slots
+) : tumor_bam_path_(tumor_bam_path),
+    normal_bam_path_(normal_bam_path),
+    ref_fasta_path_(ref_fasta_path),
+    slots_(num_slots > 0 ? num_slots : 1) {
+}
+
+ThreadResourcePool::Slot& ThreadResourcePool::slot_at(int slot) {
+    if (slot < 0 || slot >= static_cast<int>(slots_.size())) {
+        throw std::out_of_range("ThreadResourcePool: invalid slot " + std::to_string(slot));
+    }
+    return slots_[slot];
+}
+
+BamReader& ThreadResourcePool::tumor_bam(int slot) {
+    Slot& s = slot_at(slot);
+    s.stats.tumor_bam.acquisitions++;
+    if (!s.tumor_bam) {
+        s.tumor_bam = std::make_unique<BamReader>(tumor_bam_path_);
+        if (decompression_pool_) {
+            s.tumor_bam->set_thread_pool(decompression_pool_->get());
+        }
+        if (!read_filter_expression_.empty()) {
+            s.tumor_bam->set_filter_expression(read_filter_expression_);
+        }
+        s.stats.tumor_bam.opens++;
+    }
+    return *s.tumor_bam;
+}
+
+BamReader* ThreadResourcePool::normal_bam(int slot) {
+    if (normal_bam_path_.empty()) {
+        return nullptr;
+    }
+
+    Slot& s = slot_at(slot);
+    s.stats.normal_bam.acquisitions++;
+    if (!s.normal_bam) {
+        s.normal_bam = std::make_unique<BamReader>(normal_bam_path_);
+        if (decompression_pool_) {
+            s.normal_bam->set_thread_pool(decompression_pool_->get());
+        }
+        if (!read_filter_expression_.empty()) {
+            s.normal_bam->set_filter_expression(read_filter_expression_);
+        }
+        s.stats.normal_bam.opens++;
+    }
+    return s.normal_bam.get();
+}
+
+FastaReader& ThreadResourcePool::fasta(int slot) {
+    Slot& s = slot_at(slot);
+    s.stats.fasta.acquisitions++;
+    if (!s.fasta) {
+        s.fasta = std::make_unique<FastaReader>(ref_fasta_path_);
+        s.fasta->set_cache(cache_for(s));
+        s.stats.fasta.opens++;
+    }
+    return *s.fasta;
+}
+
+const std::shared_ptr<ReferenceCache>& ThreadResourcePool::cache_for(const Slot& s) const {
+    static const std::shared_ptr<ReferenceCache> none;
+    if (reference_caches_.empty()) {
+        return none;
+    }
+    return reference_caches_[std::min<size_t>(static_cast<size_t>(s.node), reference_caches_.size() - 1)];
+}
+
+void ThreadResourcePool::set_reference_cache(std::shared_ptr<ReferenceCache> cache) {
+    std::vector<std::shared_ptr<ReferenceCache>> caches;
+    if (cache) {
+        caches.push_back(std::move(cache));
+    }
+    set_reference_caches(std::move(caches));
+}
+
+void ThreadResourcePool::set_reference_caches(std::vector<std::shared_ptr<ReferenceCache>> caches) {
+    reference_caches_ = std::move(caches);
+    for (auto& s : slots_) {
+        if (s.fasta) {
+            s.fasta->set_cache(cache_for(s));
+        }
+    }
+}
+
+void ThreadResourcePool::set_slot_node(int slot, int node) {
+    Slot& s = slot_at(slot);
+    s.node = std::max(node, 0);
+    if (s.fasta) {
+        s.fasta->set_cache(cache_for(s));
+    }
+}
+
+void ThreadResourcePool::set_decompression_pool(std::shared_ptr<HtsThreadPool> pool) {
+    if (decompression_pool_) {
+        throw std::runtime_error("ThreadResourcePool: decompression pool already set");
+    }
+    decompression_pool_ = std::move(pool);
+    if (!decompression_pool_) {
+        return;
+    }
+    for (auto& s : slots_) {
+        if (s.tumor_bam) s.tumor_bam->set_thread_pool(decompression_pool_->get());
+        if (s.normal_bam) s.normal_bam->set_thread_pool(decompression_pool_->get());
+    }
+}
+
+void ThreadResourcePool::set_read_filter_expression(const std::string& expr) {
+    read_filter_expression_ = expr;
+    for (auto& s : slots_) {
+        if (s.tumor_bam) s.tumor_bam->set_filter_expression(expr);
+        if (s.normal_bam) s.normal_bam->set_filter_expression(expr);
+    }
+}
+
+ThreadResourceStats ThreadResourcePool::stats() const {
+    ThreadResourceStats total;
+    for (const auto& s : slots_) {
+        total.tumor_bam.opens += s.stats.tumor_bam.opens;
+        total.tumor_bam.acquisitions += s.stats.tumor_bam.acquisitions;
+        total.normal_bam.opens += s.stats.normal_bam.opens;
+        total.normal_bam.acquisitions += s.stats.normal_bam.acquisitions;
+        total.fasta.opens += s.stats.fasta.opens;
+        total.fasta.acquisitions += s.stats.fasta.acquisitions;
+        for (const BamReader* r : {s.tumor_bam.get(), s.normal_bam.get()}) {
+            if (r) {
+                total.records_reused += r->record_pool().reuses();
+                total.records_allocated += r->record_pool().allocations();
+            }
+        }
+    }
+    return total;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,248 @@
+#include "io/AsyncRegionWriter.hpp"
+#include "io/RegionWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace InterSubMod {
+
+AsyncRegionWriter::AsyncRegionWriter(
+    const std::string& output_dir,
+    OutputFormat format,
+    BinaryFormat::MatrixDType dtype,
+    int num_writer_threads,
+    size_t queue_capacity,
+    size_t batch_size,
+    const std::string& file_tag
+) : output_dir_(output_dir),
+    format_(format),
+    dtype_(dtype),
+    batch_size_(batch_size > 0 ? batch_size : 1),
+    closed_(false),
+    journal_(nullptr),
+    queue_(queue_capacity) {
+    int n = std::max(num_writer_threads, 1);
+    stats_.num_writer_threads = n;
+
+    mkdir(output_dir_.c_str(), 0755);
+    if (format_ == OutputFormat::BINARY) {
+        // Open every shard up front so a bad output path fails before any work starts
+        for (int i = 0; i < n; i++) {
+            std::ostringstream path;
+            path << output_dir_ << "/regions." << (file_tag.empty() ? "" : file_tag + ".")
+                 << "shard_" << std::setw(3) << std::setfill('0') << i << ".ismr";
+            shards_.push_back(std::make_unique<BinaryRegionWriter>(path.str(), dtype_));
+        }
+    }
+
+    threads_.reserve(n);
+    for (int i = 0; i < n; i++) {
+        threads_.emplace_back(&AsyncRegionWriter::writer_loop, this, i);
+    }
+}
+
+AsyncRegionWriter::~AsyncRegionWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructor must not throw; shards stay recoverable by block scan
+    }
+}
+
+bool AsyncRegionWriter::submit(RegionOutput&& output) {
+    return queue_.push(std::move(output));
+}
+
+void AsyncRegionWriter::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    queue_.close();
+    for (auto& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+
+    std::string first_error;
+    for (auto& shard : shards_) {
+        try {
+            shard->close();
+        } catch (const std::exception& e) {
+            if (first_error.empty()) first_error = e.what();
+        }
+    }
+    if (clusters_fp_) {
+        if (std::fclose(clusters_fp_) != 0 && first_error.empty()) {
+            first_error = "Failed to close clusters file: " + clusters_path_;
+        }
+        clusters_fp_ = nullptr;
+    }
+    if (!first_error.empty()) {
+        throw std::runtime_error(first_error);
+    }
+}
+
+void AsyncRegionWriter::open_clusters_file(const std::string& path, const std::string& header) {
+    std::lock_guard<std::mutex> lock(clusters_mutex_);
+    if (clusters_fp_) {
+        throw std::runtime_error("Clusters file already open: " + clusters_path_);
+    }
+    clusters_fp_ = std::fopen(path.c_str(), "wb");
+    if (!clusters_fp_) {
+        throw std::runtime_error("Failed to create clusters file: " + path);
+    }
+    clusters_path_ = path;
+    const std::string line = header + "\n";
+    if (std::fwrite(line.data(), 1, line.size(), clusters_fp_) != line.size() || std::fflush(clusters_fp_) != 0) {
+        throw std::runtime_error("Failed to write clusters file: " + path);
+    }
+}
+
+void AsyncRegionWriter::append_cluster_rows(const std::string& rows) {
+    std::lock_guard<std::mutex> lock(clusters_mutex_);
+    if (std::fwrite(rows.data(), 1, rows.size(), clusters_fp_) != rows.size() || std::fflush(clusters_fp_) != 0) {
+        throw std::runtime_error("Failed to write clusters file: " + clusters_path_);
+    }
+    // Same rule as the shards: on disk before the journal marks the regions done
+    if (journal_ && ::fsync(fileno(clusters_fp_)) != 0) {
+        throw std::runtime_error("Failed to sync clusters file: " + clusters_path_);
+    }
+}
+
+std::vector<std::pair<int, std::string>> AsyncRegionWriter::errors() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return errors_;
+}
+
+AsyncWriterStats AsyncRegionWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AsyncWriterStats s = stats_;
+    s.queue = queue_.stats();
+    return s;
+}
+
+void AsyncRegionWriter::writer_loop(int index) {
+    std::vector<RegionOutput> batch;
+    batch.reserve(batch_size_);
+    std::vector<std::pair<int, std::string>> batch_errors;
+    std::vector<JournalEntry> completed;
+    std::vector<bool> ok;
+    std::string rows;
+
+    while (queue_.pop_batch(batch, batch_size_)) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t written = 0;
+        batch_errors.clear();
+        completed.clear();
+        ok.assign(batch.size(), false);
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            const RegionOutput& output = batch[i];
+            try {
+                JournalEntry entry = write_one(index, output);
+                written++;
+                ok[i] = true;
+                if (journal_ && !output.journal_key.empty()) {
+                    completed.push_back(std::move(entry));
+                }
+            } catch (const std::exception& e) {
+                batch_errors.emplace_back(output.region_id, e.what());
+            }
+        }
+        if (format_ == OutputFormat::BINARY) {
+            try {
+                // With a journal the blocks must be on disk before they are marked done
+                if (journal_) {
+                    shards_[index]->sync();
+                } else {
+                    shards_[index]->flush();
+                }
+            } catch (const std::exception& e) {
+                // Blocks already handed to stdio but not flushed may be lost
+                batch_errors.clear();
+                for (const auto& output : batch) {
+                    batch_errors.emplace_back(output.region_id, e.what());
+                }
+                written = 0;
+                completed.clear();
+                ok.assign(batch.size(), false);
+            }
+        }
+        if (clusters_fp_ && written > 0) {
+            // Rows only for regions whose data made it out
+            rows.clear();
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (ok[i]) rows += batch[i].cluster_rows;
+            }
+            try {
+                if (!rows.empty()) append_cluster_rows(rows);
+            } catch (const std::exception& e) {
+                // Not journaled: resume redoes these regions; ShardMerger drops any partial rows left behind
+                for (size_t i = 0; i < batch.size(); i++) {
+                    if (ok[i]) batch_errors.emplace_back(batch[i].region_id, e.what());
+                }
+                written = 0;
+                completed.clear();
+            }
+        }
+        try {
+            if (journal_) journal_->append(completed);
+        } catch (const std::exception& e) {
+            // The data is written, but a resumed run will redo these regions
+            for (const auto& entry : completed) {
+                batch_errors.emplace_back(entry.region_id, e.what());
+            }
+        }
+
+        // Release the matrices before waiting for the next batch
+        batch.clear();
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.regions_written += written;
+        stats_.batches++;
+        stats_.write_ms += ms;
+        errors_.insert(errors_.end(), batch_errors.begin(), batch_errors.end());
+    }
+}
+
+JournalEntry AsyncRegionWriter::write_one(int index, const RegionOutput& output) {
+    const MatrixBuilder& m = output.matrix;
+    JournalEntry entry;
+    entry.key = output.journal_key;
+    entry.region_id = output.region_id;
+    entry.success = true;
+
+    if (format_ == OutputFormat::CSV) {
+        RegionWriter writer(output_dir_);
+        entry.detail = writer.write_region(output.snv, output.region_id, output.region_start, output.region_end,
+                                           m.get_reads(), m.get_cpg_positions(), m.get_matrix(),
+                                           output.elapsed_ms, output.peak_memory_mb, output.name);
+        if (journal_) {
+            // Same rule as the binary shards: on disk before the journal marks it done
+            writer.sync_region(entry.detail);
+        }
+        const auto& cpgs = m.get_cpg_positions();
+        const MatrixView matrix = m.get_matrix();
+        entry.checksum = Utils::fnv1a64(cpgs.data(), cpgs.size() * sizeof(int32_t));
+        entry.checksum = Utils::fnv1a64(matrix.bytes(), matrix.byte_size(), entry.checksum);
+        return entry;
+    }
+
+    BinaryRegionWriter& shard = *shards_[index];
+    const uint64_t offset = shard.bytes_written();
+    entry.checksum = shard.write_region(output.snv, output.region_id, output.region_start, output.region_end,
+                                        m.get_reads(), m.get_cpg_positions(), m.get_matrix(),
+                                        output.elapsed_ms, output.peak_memory_mb);
+    const std::string& path = shard.path();
+    entry.detail = path.substr(path.find_last_of('/') + 1) + "@" + std::to_string(offset);
+    return entry;
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,357 @@
+#include "io/BinaryRegionFile.hpp"
+#include "utils/Hash.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace InterSubMod {
+
+using namespace BinaryFormat;
+
+static inline uint64_t align_up(uint64_t x) {
+    return (x + kAlign - 1) & ~static_cast<uint64_t>(kAlign - 1);
+}
+
+// ============================================================================
+// BinaryRegionWriter
+// ============================================================================
+
+BinaryRegionWriter::BinaryRegionWriter(const std::string& path, MatrixDType dtype)
+    : path_(path), dtype_(dtype), fp_(nullptr), offset_(0) {
+    fp_ = std::fopen(path.c_str(), "wb");
+    if (!fp_) {
+        throw std::runtime_error("Failed to open binary output file: " + path);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.header_size = sizeof(FileHeader);
+    write_bytes(&header, sizeof(header));
+}
+
+BinaryRegionWriter::~BinaryRegionWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructor must not throw; the file stays recoverable by block scan
+    }
+}
+
+void BinaryRegionWriter::write_bytes(const void* data, size_t size) {
+    if (size > 0 && std::fwrite(data, 1, size, fp_) != size) {
+        throw std::runtime_error("Failed to write binary output file: " + path_);
+    }
+    offset_ += size;
+}
+
+uint64_t BinaryRegionWriter::write_region(
+    const SomaticSnv& snv,
+    int region_id,
+    int32_t region_start,
+    int32_t region_end,
+    const ReadTable& reads,
+    const std::vector<int32_t>& cpg_positions,
+    const MatrixView& matrix,
+    double elapsed_ms,
+    double peak_memory_mb
+) {
+    if (!fp_) {
+        throw std::runtime_error("BinaryRegionWriter::write_region: file already closed");
+    }
+
+    const size_t num_reads = reads.size();
+    const size_t num_cpgs = cpg_positions.size();
+    const size_t elem_size = (dtype_ == MatrixDType::FLOAT32) ? sizeof(float) : sizeof(uint8_t);
+
+    size_t names_size = 0;
+    for (size_t i = 0; i < num_reads; i++) {
+        names_size += std::min<size_t>(reads.name(i).size(), UINT16_MAX);
+    }
+
+    // 1. Layout (offsets relative to the block start, arrays 64-byte aligned)
+    const uint64_t cpg_rel = sizeof(BlockPrelude) + sizeof(RegionIndexEntry);
+    const uint64_t reads_rel = align_up(cpg_rel + num_cpgs * sizeof(int32_t));
+    const uint64_t names_rel = align_up(reads_rel + num_reads * sizeof(PackedRead));
+    const uint64_t matrix_rel = align_up(names_rel + names_size);
+    const uint64_t matrix_size = static_cast<uint64_t>(num_reads) * num_cpgs * elem_size;
+    const uint64_t block_size = align_up(matrix_rel + matrix_size);
+
+    block_.assign(block_size, 0);
+    char* blk = block_.data();
+    const uint64_t base = offset_;
+
+    // 2. Prelude and index entry
+    BlockPrelude prelude{};
+    std::memcpy(prelude.magic, kBlockMagic, sizeof(prelude.magic));
+    prelude.block_size = block_size;
+    std::memcpy(blk, &prelude, sizeof(prelude));
+
+    RegionIndexEntry e{};
+    e.region_id = region_id;
+    e.snv_id = snv.snv_id;
+    e.chr_id = snv.chr_id;
+    e.snv_pos = snv.pos;
+    e.region_start = region_start;
+    e.region_end = region_end;
+    e.num_reads = static_cast<int32_t>(num_reads);
+    e.num_cpgs = static_cast<int32_t>(num_cpgs);
+    e.ref_base = snv.ref_base;
+    e.alt_base = snv.alt_base;
+    e.dtype = static_cast<uint8_t>(dtype_);
+    e.snv_qual = snv.qual;
+    e.elapsed_ms = static_cast<float>(elapsed_ms);
+    e.peak_memory_mb = static_cast<float>(peak_memory_mb);
+    e.block_offset = base;
+    e.block_size = block_size;
+    e.cpg_offset = base + cpg_rel;
+    e.reads_offset = base + reads_rel;
+    e.names_offset = base + names_rel;
+    e.names_size = names_size;
+    e.matrix_offset = base + matrix_rel;
+    e.matrix_size = matrix_size;
+    std::memcpy(blk + sizeof(BlockPrelude), &e, sizeof(e));
+
+    // 3. CpG positions
+    if (num_cpgs > 0) {
+        std::memcpy(blk + cpg_rel, cpg_positions.data(), num_cpgs * sizeof(int32_t));
+    }
+
+    // 4. Packed reads and names
+    char* names = blk + names_rel;
+    uint32_t name_offset = 0;
+    for (size_t i = 0; i < num_reads; i++) {
+        const std::string_view name = reads.name(i);
+        PackedRead p{};
+        p.read_id = reads.read_id(i);
+        p.chr_id = reads.chr_id(i);
+        p.align_start = reads.align_start(i);
+        p.align_end = reads.align_end(i);
+        p.name_offset = name_offset;
+        p.name_len = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+        p.mapq = static_cast<uint8_t>(reads.mapq(i));
+        p.hp_tag = static_cast<int8_t>(reads.hp_tag(i));
+        p.alt_support = static_cast<int8_t>(reads.alt_support(i));
+        p.is_tumor = reads.is_tumor(i) ? 1 : 0;
+        std::memcpy(blk + reads_rel + i * sizeof(PackedRead), &p, sizeof(p));
+
+        std::memcpy(names + name_offset, name.data(), p.name_len);
+        name_offset += p.name_len;
+    }
+
+    // 5. Matrix (row-major, contiguous in the MatrixView); copied as-is when
+    //    the in-memory storage already matches the file dtype
+    if (matrix_size > 0) {
+        const size_t count = num_reads * num_cpgs;
+        if (dtype_ == MatrixDType::FLOAT32) {
+            if (matrix.quantized()) {
+                float* out = reinterpret_cast<float*>(blk + matrix_rel);
+                const uint8_t* in = matrix.quant_data();
+                for (size_t k = 0; k < count; k++) {
+                    out[k] = dequantize(in[k]);
+                }
+            } else {
+                std::memcpy(blk + matrix_rel, matrix.data(), count * sizeof(float));
+            }
+        } else {
+            if (matrix.quantized()) {
+                std::memcpy(blk + matrix_rel, matrix.quant_data(), count);
+            } else {
+                uint8_t* out = reinterpret_cast<uint8_t*>(blk + matrix_rel);
+                const float* in = matrix.data();
+                for (size_t k = 0; k < count; k++) {
+                    out[k] = quantize(in[k]);
+                }
+            }
+        }
+    }
+
+    write_bytes(blk, block_size);
+    index_.push_back(e);
+    return Utils::fnv1a64(blk, block_size);
+}
+
+void BinaryRegionWriter::flush() {
+    if (fp_ && std::fflush(fp_) != 0) {
+        throw std::runtime_error("Failed to flush binary output file: " + path_);
+    }
+}
+
+void BinaryRegionWriter::sync() {
+    flush();
+    if (fp_ && ::fsync(fileno(fp_)) != 0) {
+        throw std::runtime_error("Failed to sync binary output file: " + path_);
+    }
+}
+
+void BinaryRegionWriter::close() {
+    if (!fp_) {
+        return;
+    }
+
+    FILE* fp = fp_;
+    try {
+        // Index and trailer
+        const uint64_t index_offset = offset_;
+        write_bytes(index_.data(), index_.size() * sizeof(RegionIndexEntry));
+
+        FileTrailer trailer{};
+        std::memcpy(trailer.magic, kIndexMagic, sizeof(trailer.magic));
+        trailer.index_offset = index_offset;
+        trailer.num_regions = index_.size();
+        write_bytes(&trailer, sizeof(trailer));
+
+        // Back-fill the header
+        FileHeader header{};
+        std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+        header.version = kVersion;
+        header.header_size = sizeof(FileHeader);
+        header.index_offset = index_offset;
+        header.num_regions = index_.size();
+        if (std::fseek(fp_, 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1, fp_) != 1) {
+            throw std::runtime_error("Failed to finalize binary output file: " + path_);
+        }
+    } catch (...) {
+        std::fclose(fp);
+        fp_ = nullptr;
+        throw;
+    }
+
+    fp_ = nullptr;
+    if (std::fclose(fp) != 0) {
+        throw std::runtime_error("Failed to close binary output file: " + path_);
+    }
+}
+
+// ============================================================================
+// BinaryRegionReader
+// ============================================================================
+
+BinaryRegionReader::BinaryRegionReader(const std::string& path)
+    : path_(path), data_(nullptr), size_(0), recovered_(false) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open binary region file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Invalid binary region file (too small): " + path);
+    }
+    size_ = st.st_size;
+
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap binary region file: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(map);
+
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 || header.version != kVersion) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        throw std::runtime_error("Not a binary region file (bad magic/version): " + path);
+    }
+
+    // Prefer the trailer index; fall back to scanning if the writer never closed
+    bool have_index = false;
+    if (size_ >= sizeof(FileHeader) + sizeof(FileTrailer)) {
+        FileTrailer trailer;
+        std::memcpy(&trailer, data_ + size_ - sizeof(trailer), sizeof(trailer));
+        if (std::memcmp(trailer.magic, kIndexMagic, sizeof(trailer.magic)) == 0 &&
+            trailer.index_offset + trailer.num_regions * sizeof(RegionIndexEntry) + sizeof(FileTrailer) == size_) {
+            index_.resize(trailer.num_regions);
+            if (!index_.empty()) {
+                std::memcpy(index_.data(), data_ + trailer.index_offset, index_.size() * sizeof(RegionIndexEntry));
+            }
+            have_index = true;
+        }
+    }
+    if (!have_index) {
+        scan_blocks();
+        recovered_ = true;
+    }
+
+    for (const auto& e : index_) {
+        if (e.block_offset + e.block_size > size_ || e.matrix_offset + e.matrix_size > size_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+            throw std::runtime_error("Corrupt binary region file (index out of range): " + path);
+        }
+    }
+}
+
+BinaryRegionReader::~BinaryRegionReader() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+void BinaryRegionReader::scan_blocks() {
+    index_.clear();
+    uint64_t pos = sizeof(FileHeader);
+    while (pos + sizeof(BlockPrelude) + sizeof(RegionIndexEntry) <= size_) {
+        BlockPrelude prelude;
+        std::memcpy(&prelude, data_ + pos, sizeof(prelude));
+        if (std::memcmp(prelude.magic, kBlockMagic, sizeof(prelude.magic)) != 0 ||
+            prelude.block_size == 0 || pos + prelude.block_size > size_) {
+            break;  // Truncated or partially written block
+        }
+
+        RegionIndexEntry e;
+        std::memcpy(&e, data_ + pos + sizeof(BlockPrelude), sizeof(e));
+        index_.push_back(e);
+        pos += prelude.block_size;
+    }
+}
+
+const RegionIndexEntry* BinaryRegionReader::find(int region_id) const {
+    for (const auto& e : index_) {
+        if (e.region_id == region_id) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+const int32_t* BinaryRegionReader::cpg_positions(const RegionIndexEntry& e) const {
+    return reinterpret_cast<const int32_t*>(data_ + e.cpg_offset);
+}
+
+const PackedRead* BinaryRegionReader::reads(const RegionIndexEntry& e) const {
+    return reinterpret_cast<const PackedRead*>(data_ + e.reads_offset);
+}
+
+std::string_view BinaryRegionReader::read_name(const RegionIndexEntry& e, int row) const {
+    const PackedRead& r = reads(e)[row];
+    return std::string_view(reinterpret_cast<const char*>(data_ + e.names_offset + r.name_offset), r.name_len);
+}
+
+const float* BinaryRegionReader::matrix_f32(const RegionIndexEntry& e) const {
+    if (e.dtype != static_cast<uint8_t>(MatrixDType::FLOAT32)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(data_ + e.matrix_offset);
+}
+
+const uint8_t* BinaryRegionReader::matrix_u8(const RegionIndexEntry& e) const {
+    if (e.dtype != static_cast<uint8_t>(MatrixDType::UINT8)) {
+        return nullptr;
+    }
+    return data_ + e.matrix_offset;
+}
+
+float BinaryRegionReader::value(const RegionIndexEntry& e, int row, int col) const {
+    size_t k = static_cast<size_t>(row) * e.num_cpgs + col;
+    if (e.dtype == static_cast<uint8_t>(MatrixDType::UINT8)) {
+        return dequantize(matrix_u8(e)[k]);
+    }
+    return matrix_f32(e)[k];
+}
+
+} // namespace InterSubMod
@@ -0,0 +1,138 @@
+#include "io/CompletionJournal.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace InterSubMod {
+
+static std::string sanitize_field(const std::string& s) {
+    std::string out = s;
+    for (char& ch : out) {
+        if (ch == '\t' || ch == '\n' || ch == '\r') ch = ' ';
+    }
+    return out;
+}
+
+CompletionJournal::CompletionJournal(const std::string& path, bool resume)
+    : path_(path), fd_(-1) {
+    int flags = O_WRONLY | O_CREAT | O_APPEND;
+    if (!resume) {
+        flags |= O_TRUNC;
+    }
+    if (resume) {
+        load();
+    }
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open completion journal: " + path + " (" + std::strerror(errno) + ")");
+    }
+}
+
+CompletionJournal::~CompletionJournal() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void CompletionJournal::load() {
+    FILE* fp = std::fopen(path_.c_str(), "rb");
+    if (!fp) {
+        return;  // First run
+    }
+    std::string content;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0) {
+        content.append(buf, n);
+    }
+    std::fclose(fp);
+
+    // Only complete lines count; a record cut off by a crash is dropped from
+    // the file so the next append starts on a fresh line
+    size_t valid = content.rfind('\n');
+    valid = (valid == std::string::npos) ? 0 : valid + 1;
+    if (valid < content.size() && ::truncate(path_.c_str(), static_cast<off_t>(valid)) != 0) {
+        throw std::runtime_error("Failed to repair completion journal: " + path_);
+    }
+
+    std::istringstream iss(content.substr(0, valid));
+    std::string line;
+    while (std::getline(iss, line)) {
+        std::istringstream fields(line);
+        std::string status, key;
+        if (!(fields >> status >> key) || (status != "OK" && status != "FAIL")) {
+            continue;
+        }
+        status_[key] = (status == "OK");
+    }
+}
+
+void CompletionJournal::append(const std::vector<JournalEntry>& entries) {
+    if (entries.empty()) {
+        return;
+    }
+    std::string text;
+    for (const auto& e : entries) {
+        char checksum[24];
+        std::snprintf(checksum, sizeof(checksum), "%016llx", static_cast<unsigned long long>(e.checksum));
+        text += e.success ? "OK\t" : "FAIL\t";
+        text += e.key + '\t' + std::to_string(e.region_id) + '\t' + checksum + '\t' +
+                sanitize_field(e.detail) + '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t done = 0;
+    while (done < text.size()) {
+        ssize_t w = ::write(fd_, text.data() + done, text.size() - done);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Failed to write completion journal: " + path_);
+        }
+        done += static_cast<size_t>(w);
+    }
+    if (::fsync(fd_) != 0) {
+        throw std::runtime_error("Failed to sync completion journal: " + path_);
+    }
+    for (const auto& e : entries) {
+        status_[e.key] = e.success;
+    }
+}
+
+bool CompletionJournal::is_completed(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = status_.find(key);
+    return it != status_.end() && it->second;
+}
+
+size_t CompletionJournal::num_completed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& kv : status_) {
+        if (kv.second) n++;
+    }
+    return n;
+}
+
+size_t CompletionJournal::num_failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& kv : status_) {
+        if (!kv.second) n++;
+    }
+    return n;
+}
+
+std::string CompletionJournal::region_key(const std::string& chr_name, const SomaticSnv& snv) {
+    std::string key = sanitize_field(chr_name);
+    for (char& ch : key) {
+        if (ch == ' ') ch = '_';
+    }
+    return key + ':' + std::to_string(snv.pos) + ':' + snv.ref_base + ':' + snv.alt_base;
+}
+
+} // namespace InterSubMod
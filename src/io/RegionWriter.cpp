@@ -5,6 +5,9 @@
 #include <cmath>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdexcept>
 
 namespace InterSubMod {
 
@@ -14,27 +17,32 @@ RegionWriter::RegionWriter(const std::string& output_dir)
     mkdir(output_dir_.c_str(), 0755);
 }
 
-std::string RegionWriter::create_region_dir(int region_id) {
+std::string RegionWriter::create_region_dir(int region_id, const std::string& dir_name) {
     std::ostringstream oss;
-    oss << output_dir_ << "/region_" << std::setw(4) << std::setfill('0') << region_id;
+    if (!dir_name.empty()) {
+        oss << output_dir_ << "/" << dir_name;
+    } else {
+        oss << output_dir_ << "/region_" << std::setw(4) << std::setfill('0') << region_id;
+    }
     std::string region_dir = oss.str();
     
     mkdir(region_dir.c_str(), 0755);
     return region_dir;
 }
 
-void RegionWriter::write_region(
+std::string RegionWriter::write_region(
     const SomaticSnv& snv,
     int region_id,
     int32_t region_start,
     int32_t region_end,
-    const std::vector<ReadInfo>& reads,
+    const ReadTable& reads,
     const std::vector<int32_t>& cpg_positions,
-    const std::vector<std::vector<double>>& matrix,
+    const MatrixView& matrix,
     double elapsed_ms,
-    double peak_memory_mb
+    double peak_memory_mb,
+    const std::string& dir_name
 ) {
-    std::string region_dir = create_region_dir(region_id);
+    std::string region_dir = create_region_dir(region_id, dir_name);
     
     write_metadata(region_dir, snv, region_id, region_start, region_end,
                    reads.size(), cpg_positions.size(), elapsed_ms, peak_memory_mb);
@@ -42,6 +50,29 @@ void RegionWriter::write_region(
     write_reads(region_dir, reads);
     write_cpg_sites(region_dir, snv.chr_id, cpg_positions);
     write_matrix_csv(region_dir, matrix, cpg_positions);
+    return region_dir;
+}
+
+// fsync() of a file or directory opened read-only
+static void sync_path(const std::string& path, bool directory) {
+    int fd = ::open(path.c_str(), directory ? (O_RDONLY | O_DIRECTORY) : O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open for sync: " + path);
+    }
+    int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to sync: " + path);
+    }
+}
+
+void RegionWriter::sync_region(const std::string& region_dir) const {
+    for (const char* name : {"metadata.txt", "reads.tsv", "cpg_sites.tsv", "methylation.csv"}) {
+        sync_path(region_dir + "/" + name, false);
+    }
+    // Directory entries: the files in the region directory, the region directory in the output root
+    sync_path(region_dir, true);
+    sync_path(output_dir_, true);
 }
 
 void RegionWriter::write_metadata(
@@ -78,7 +109,7 @@ void RegionWriter::write_metadata(
 
 void RegionWriter::write_reads(
     const std::string& region_dir,
-    const std::vector<ReadInfo>& reads
+    const ReadTable& reads
 ) {
     std::ofstream ofs(region_dir + "/reads.tsv");
     
@@ -86,24 +117,24 @@ void RegionWriter::write_reads(
     ofs << "read_id\tread_name\tchr_id\tstart\tend\tmapq\thp\talt_support\tis_tumor\n";
     
     // Data
-    for (const auto& read : reads) {
-        ofs << read.read_id << "\t"
-            << read.read_name << "\t"
-            << read.chr_id << "\t"
-            << read.align_start << "\t"
-            << read.align_end << "\t"
-            << read.mapq << "\t"
-            << read.hp_tag << "\t";
+    for (size_t i = 0; i < reads.size(); i++) {
+        ofs << reads.read_id(i) << "\t"
+            << reads.name(i) << "\t"
+            << reads.chr_id(i) << "\t"
+            << reads.align_start(i) << "\t"
+            << reads.align_end(i) << "\t"
+            << reads.mapq(i) << "\t"
+            << reads.hp_tag(i) << "\t";
         
         // AltSupport enum
-        switch (read.alt_support) {
+        switch (reads.alt_support(i)) {
             case AltSupport::REF:     ofs << "REF"; break;
             case AltSupport::ALT:     ofs << "ALT"; break;
             case AltSupport::UNKNOWN: ofs << "UNKNOWN"; break;
         }
         
         ofs << "\t"
-            << (read.is_tumor ? "1" : "0") << "\n";
+            << (reads.is_tumor(i) ? "1" : "0") << "\n";
     }
     
     ofs.close();
@@ -131,7 +162,7 @@ void RegionWriter::write_cpg_sites(
 
 void RegionWriter::write_matrix_csv(
     const std::string& region_dir,
-    const std::vector<std::vector<double>>& matrix,
+    const MatrixView& matrix,
     const std::vector<int32_t>& cpg_positions
 ) {
     std::ofstream ofs(region_dir + "/methylation.csv");
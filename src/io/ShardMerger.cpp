@@ -0,0 +1,273 @@
+#include "io/ShardMerger.hpp"
+#include "io/BinaryRegionFile.hpp"
+#include "io/CompletionJournal.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace InterSubMod {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct MergedRow {
+    int32_t chr_id;
+    int32_t snv_pos;
+    char ref_base;
+    char alt_base;
+    int32_t num_reads;
+    int32_t num_cpgs;
+    uint8_t dtype;
+    size_t file;
+    uint64_t block_offset;
+    uint64_t block_size;
+};
+
+// "prefix*suffix", excluding our own merged.* outputs
+bool is_shard_output(const std::string& name, const std::string& prefix, const std::string& suffix) {
+    return name.size() >= prefix.size() + suffix.size() &&
+           name.compare(0, prefix.size(), prefix) == 0 &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+           name.compare(0, 7, "merged.") != 0;
+}
+
+std::vector<std::string> split_tabs(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t begin = 0;
+    while (true) {
+        size_t tab = line.find('\t', begin);
+        fields.push_back(line.substr(begin, tab == std::string::npos ? std::string::npos : tab - begin));
+        if (tab == std::string::npos) break;
+        begin = tab + 1;
+    }
+    return fields;
+}
+
+} // namespace
+
+ShardMerger::ShardMerger(const std::string& output_dir, std::vector<std::string> chr_names)
+    : output_dir_(output_dir), chr_names_(std::move(chr_names)) {}
+
+const char* ShardMerger::index_header() {
+    return "region_id\tchr\tpos\tref\talt\tnum_reads\tnum_cpgs\tdtype\tfile\tblock_offset\tblock_size";
+}
+
+std::string ShardMerger::chr_name(int32_t chr_id) const {
+    if (chr_id >= 0 && chr_id < static_cast<int32_t>(chr_names_.size())) {
+        return chr_names_[chr_id];
+    }
+    return "chr_id_" + std::to_string(chr_id);
+}
+
+MergeStats ShardMerger::merge() {
+    std::vector<std::string> shards, cluster_files, journals;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(output_dir_, ec)) {
+        if (!de.is_regular_file()) continue;
+        std::string name = de.path().filename().string();
+        if (is_shard_output(name, "regions", ".ismr")) shards.push_back(name);
+        else if (is_shard_output(name, "clusters", ".tsv")) cluster_files.push_back(name);
+        else if (is_shard_output(name, "completed", ".journal")) journals.push_back(name);
+    }
+    if (ec) {
+        throw std::runtime_error("Failed to list output directory " + output_dir_ + ": " + ec.message());
+    }
+    std::sort(shards.begin(), shards.end());
+    std::sort(cluster_files.begin(), cluster_files.end());
+    std::sort(journals.begin(), journals.end());
+
+    MergeStats stats;
+    stats.shard_files = shards.size();
+    stats.cluster_files = cluster_files.size();
+
+    // Index entries only: blocks stay where they are
+    std::vector<MergedRow> rows;
+    std::vector<size_t> file_regions(shards.size(), 0);
+    std::unordered_map<std::string, size_t> seen;  // region_key -> row
+    SomaticSnv snv{};
+    for (size_t f = 0; f < shards.size(); f++) {
+        BinaryRegionReader reader(output_dir_ + "/" + shards[f]);
+        if (reader.recovered()) stats.recovered_files++;
+        for (size_t i = 0; i < reader.num_regions(); i++) {
+            const BinaryFormat::RegionIndexEntry& e = reader.entry(i);
+            snv.pos = e.snv_pos;
+            snv.ref_base = e.ref_base;
+            snv.alt_base = e.alt_base;
+            if (!seen.emplace(CompletionJournal::region_key(chr_name(e.chr_id), snv), rows.size()).second) {
+                stats.duplicates++;
+                continue;
+            }
+            rows.push_back({e.chr_id, e.snv_pos, e.ref_base, e.alt_base, e.num_reads, e.num_cpgs,
+                            e.dtype, f, e.block_offset, e.block_size});
+            file_regions[f]++;
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const MergedRow& a, const MergedRow& b) {
+        return std::tie(a.chr_id, a.snv_pos, a.ref_base, a.alt_base) <
+               std::tie(b.chr_id, b.snv_pos, b.ref_base, b.alt_base);
+    });
+    stats.regions = rows.size();
+
+    std::string index_path = output_dir_ + "/merged.index.tsv";
+    std::ofstream index(index_path);
+    if (!index) {
+        throw std::runtime_error("Failed to create merged index: " + index_path);
+    }
+    index << index_header() << "\n";
+    for (size_t r = 0; r < rows.size(); r++) {
+        const MergedRow& row = rows[r];
+        const std::string chr = chr_name(row.chr_id);
+        snv.pos = row.snv_pos;
+        snv.ref_base = row.ref_base;
+        snv.alt_base = row.alt_base;
+        seen[CompletionJournal::region_key(chr, snv)] = r;
+        stats.reads += row.num_reads;
+        stats.cpgs += row.num_cpgs;
+        index << r << '\t' << chr << '\t' << row.snv_pos << '\t' << row.ref_base << '\t' << row.alt_base << '\t'
+              << row.num_reads << '\t' << row.num_cpgs << '\t'
+              << (row.dtype == static_cast<uint8_t>(BinaryFormat::MatrixDType::UINT8) ? "uint8" : "float32") << '\t'
+              << shards[row.file] << '\t' << row.block_offset << '\t' << row.block_size << "\n";
+    }
+    if (!index.flush()) {
+        throw std::runtime_error("Failed to write merged index: " + index_path);
+    }
+
+    // Clusters: region_id is only unique within a shard, so rows are re-keyed by coordinates
+    if (!cluster_files.empty()) {
+        std::string header;
+        size_t header_fields = 0;
+        std::vector<std::pair<long long, std::string>> lines;
+        std::vector<std::pair<size_t, std::string>> line_keys;  // (file, region key) of each row
+        std::unordered_map<std::string, std::unordered_map<size_t, size_t>> key_rows;
+        for (size_t f = 0; f < cluster_files.size(); f++) {
+            const std::string& name = cluster_files[f];
+            std::ifstream in(output_dir_ + "/" + name);
+            if (!in) {
+                throw std::runtime_error("Failed to read clusters file: " + output_dir_ + "/" + name);
+            }
+            std::string line;
+            bool first = true;
+            while (std::getline(in, line)) {
+                if (first) {
+                    first = false;
+                    if (header.empty()) {
+                        header = line;
+                        header_fields = split_tabs(header).size();
+                    }
+                    continue;
+                }
+                std::vector<std::string> fields = split_tabs(line);
+                if (fields.size() < 5 || fields[3].empty() || fields[4].empty()) continue;
+                if (fields.size() != header_fields) {
+                    // Cut short by a crash mid-append; the region's rows were redone elsewhere
+                    stats.cluster_duplicates++;
+                    continue;
+                }
+                long long id = -1;
+                std::string key;
+                try {
+                    snv.pos = std::stoi(fields[2]);
+                    snv.ref_base = fields[3][0];
+                    snv.alt_base = fields[4][0];
+                    key = CompletionJournal::region_key(fields[1], snv);
+                    auto it = seen.find(key);
+                    if (it != seen.end()) id = static_cast<long long>(it->second);
+                } catch (const std::exception&) {
+                    // Malformed position: keep the row, unmatched
+                }
+                if (!key.empty()) key_rows[key][f]++;
+                lines.emplace_back(id, line.substr(line.find('\t')));
+                line_keys.emplace_back(f, std::move(key));
+            }
+        }
+
+        // A region redone by a resumed run has rows in more than one file: keep one file's rows
+        std::unordered_map<std::string, size_t> key_file;
+        for (const auto& [key, per_file] : key_rows) {
+            size_t best = 0, best_rows = 0;
+            for (const auto& [f, n] : per_file) {
+                if (n > best_rows || (n == best_rows && f < best)) {
+                    best = f;
+                    best_rows = n;
+                }
+            }
+            key_file[key] = best;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            const auto& [f, key] = line_keys[i];
+            if (!key.empty() && key_file[key] != f) {
+                stats.cluster_duplicates++;
+                continue;
+            }
+            if (kept != i) lines[kept] = std::move(lines[i]);
+            kept++;
+        }
+        lines.resize(kept);
+        std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) {
+            return (a.first < 0 ? INT64_MAX : a.first) < (b.first < 0 ? INT64_MAX : b.first);
+        });
+
+        std::string clusters_path = output_dir_ + "/merged.clusters.tsv";
+        std::ofstream clusters(clusters_path);
+        if (!clusters) {
+            throw std::runtime_error("Failed to create merged clusters file: " + clusters_path);
+        }
+        clusters << header << "\n";
+        for (const auto& [id, rest] : lines) {
+            clusters << id << rest << "\n";
+        }
+        stats.cluster_rows = lines.size();
+        if (!clusters.flush()) {
+            throw std::runtime_error("Failed to write merged clusters file: " + clusters_path);
+        }
+    }
+
+    // Failures: last journal record per key is FAIL and the region has no block anywhere
+    std::unordered_map<std::string, bool> status;
+    for (const auto& name : journals) {
+        std::ifstream in(output_dir_ + "/" + name);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields = split_tabs(line);
+            if (fields.size() >= 2) status[fields[1]] = (fields[0] == "OK");
+        }
+    }
+    for (const auto& [key, ok] : status) {
+        if (!ok && seen.find(key) == seen.end()) stats.failed++;
+    }
+
+    std::string summary_path = output_dir_ + "/merged.summary.json";
+    std::ofstream json(summary_path);
+    if (!json) {
+        throw std::runtime_error("Failed to create merge summary: " + summary_path);
+    }
+    json << "{\n";
+    json << "  \"regions\": " << stats.regions << ",\n";
+    json << "  \"failed\": " << stats.failed << ",\n";
+    json << "  \"duplicates\": " << stats.duplicates << ",\n";
+    json << "  \"reads\": " << stats.reads << ",\n";
+    json << "  \"cpgs\": " << stats.cpgs << ",\n";
+    json << "  \"cluster_files\": " << stats.cluster_files << ", \"cluster_rows\": " << stats.cluster_rows
+         << ", \"cluster_duplicates\": " << stats.cluster_duplicates << ",\n";
+    json << "  \"journals\": " << journals.size() << ",\n";
+    json << "  \"recovered_shards\": " << stats.recovered_files << ",\n";
+    json << "  \"shards\": [";
+    for (size_t f = 0; f < shards.size(); f++) {
+        json << (f ? ",\n" : "\n") << "    {\"file\": \"" << shards[f] << "\", \"regions\": " << file_regions[f] << "}";
+    }
+    json << (shards.empty() ? "]\n" : "\n  ]\n");
+    json << "}\n";
+    if (!json.flush()) {
+        throw std::runtime_error("Failed to write merge summary: " + summary_path);
+    }
+    return stats;
+}
+
+} // namespace InterSubMod
@@ -1,11 +1,10 @@
 #include <iostream>
+#include <stdexcept>
 #include "core/Config.hpp"
+#include "core/AnalysisPipeline.hpp"
 #include "utils/ArgParser.hpp"
 #include "utils/ResourceMonitor.hpp"
 
-// Placeholder for future core logic includes
-// #include "core/SomaticSnv.hpp"
-
 int main(int argc, char** argv) {
     InterSubMod::Utils::ResourceMonitor monitor;
 
@@ -23,15 +22,17 @@ int main(int argc, char** argv) {
 
     config.print();
 
-    std::cout << "Configuration valid. Starting analysis (Not implemented yet)..." << std::endl;
-    
-    // Future main loop:
-    // 1. Load VCF -> SomaticSnvTable
-    // 2. Generate Regions
-    // 3. For each region:
-    //    Fetch Reads -> Parse MM -> Build Matrix -> Calculate Distance -> Cluster -> Assoc
+    // Stream SNVs -> fetch/parse/matrix (OpenMP workers) -> distance/clustering -> writers
+    int status = 0;
+    try {
+        InterSubMod::AnalysisPipeline pipeline(config);
+        status = pipeline.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
+    }
     
     monitor.print_stats("Total Execution");
 
-    return 0;
+    return status;
 }
@@ -0,0 +1,50 @@
+#include <mpi.h>
+#include <iostream>
+#include "core/Config.hpp"
+#include "core/DistributedRunner.hpp"
+#include "utils/ArgParser.hpp"
+#include "utils/ResourceMonitor.hpp"
+
+/**
+ * Multi-node entry point: same options as inter_sub_mod, plus --work-units.
+ *
+ *   mpirun -np 65 inter_sub_mod_mpi -t tumor.bam -r hg38.fa -v somatic.vcf.gz -o /shared/out -j 32
+ */
+int main(int argc, char** argv) {
+    // Only the main thread talks to MPI; OpenMP and pipeline threads never do
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    InterSubMod::Utils::ResourceMonitor monitor;
+    InterSubMod::Config config;
+
+    // Every rank parses and validates, so a bad option stops all of them alike
+    bool ok = InterSubMod::Utils::ArgParser::parse(argc, argv, config);
+    if (ok && (!config.snv_regions.empty() || !config.shard.empty())) {
+        if (rank == 0) std::cerr << "Error: --regions / --shard are chosen per work unit; use --work-units" << std::endl;
+        ok = false;
+    }
+    if (ok && !config.validate()) {
+        if (rank == 0) std::cerr << "Configuration validation failed." << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        MPI_Finalize();
+        return 1;
+    }
+    if (rank == 0) {
+        config.print();
+    }
+
+    InterSubMod::DistributedRunner runner(config, rank, size);
+    int status = runner.run();
+
+    if (rank == 0) {
+        monitor.print_stats("Total Execution");
+    }
+    MPI_Finalize();
+    return status;
+}
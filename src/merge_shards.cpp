@@ -0,0 +1,42 @@
+#include <chrono>
+#include <iostream>
+#include "io/ShardMerger.hpp"
+#include "utils/FastaReader.hpp"
+#include "vendor/CLI11.hpp"
+
+using namespace InterSubMod;
+
+/**
+ * Offline merge of sharded outputs (--shard i/N runs, inter_sub_mod_mpi) into one index.
+ *
+ *   merge_shards -o results/ -r hg38.fa
+ */
+int main(int argc, char** argv) {
+    CLI::App app{"Merge sharded region outputs into merged.index.tsv, merged.clusters.tsv and merged.summary.json"};
+
+    std::string output_dir, fasta_path;
+    app.add_option("-o,--output-dir", output_dir, "Directory holding the shard outputs (Required)")
+        ->required()
+        ->check(CLI::ExistingDirectory);
+    app.add_option("-r,--reference", fasta_path, "Reference FASTA used for the run (Required, maps chr_id to names)")
+        ->required()
+        ->check(CLI::ExistingFile);
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        auto t_start = std::chrono::steady_clock::now();
+
+        ShardMerger merger(output_dir, FastaReader(fasta_path).chromosome_names());
+        MergeStats stats = merger.merge();
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+        std::cout << "Merged " << stats.regions << " regions from " << stats.shard_files << " shards ("
+                  << stats.duplicates << " duplicates, " << stats.failed << " failed, "
+                  << stats.recovered_files << " recovered) and " << stats.cluster_rows << " cluster rows into "
+                  << output_dir << "/merged.* in " << elapsed << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -80,7 +80,7 @@ int main() {
         std::cout << "[5] Building matrix..." << std::endl;
         matrix_builder.finalize();
         
-        const auto& matrix = matrix_builder.get_matrix();
+        auto matrix = matrix_builder.get_matrix();
         const auto& cpg_pos = matrix_builder.get_cpg_positions();
         
         std::cout << "✓ Matrix dimensions: " << matrix.size() << " reads × " << (matrix.empty() ? 0 : matrix[0].size()) << " CpGs" << std::endl;
@@ -136,10 +136,7 @@ int main() {
         std::cout << "  Reads processed: " << passed << std::endl;
         std::cout << "  CpG sites found: " << cpg_pos.size() << std::endl;
         
-        size_t matrix_mem = 0;
-        for (const auto& row : matrix) {
-            matrix_mem += row.size() * sizeof(double);
-        }
+        size_t matrix_mem = matrix.rows() * matrix.cols() * sizeof(float);
         std::cout << "  Matrix size: " << (matrix_mem / 1024.0 / 1024.0) << " MB" << std::endl;
         
         // Cleanup
@@ -28,12 +28,22 @@ int main(int argc, char** argv) {
         if (argc > 3) {
             num_threads = std::stoi(argv[3]);
         }
+        OutputFormat output_format = OutputFormat::BINARY;
+        BinaryFormat::MatrixDType output_dtype = BinaryFormat::MatrixDType::FLOAT32;
+        if (argc > 4 && std::string(argv[4]) == "csv") {
+            output_format = OutputFormat::CSV;
+        } else if (argc > 4 && std::string(argv[4]) == "u8") {
+            output_dtype = BinaryFormat::MatrixDType::UINT8;
+        }
         
         std::cout << "[1] Initializing RegionProcessor..." << std::endl;
         std::cout << "  - SNV Table: " << snv_table << std::endl;
         std::cout << "  - Threads: " << num_threads << std::endl;
         std::cout << "  - Window size: ±" << window_size << " bp" << std::endl;
-        std::cout << "  - Output: " << output_dir << std::endl << std::endl;
+        std::cout << "  - Output: " << output_dir
+                  << (output_format == OutputFormat::CSV ? " (csv)"
+                      : output_dtype == BinaryFormat::MatrixDType::UINT8 ? " (binary, uint8)" : " (binary)")
+                  << std::endl << std::endl;
         
         RegionProcessor processor(
             tumor_bam,
@@ -43,36 +53,67 @@ int main(int argc, char** argv) {
             num_threads,
             window_size
         );
-        
-        std::cout << "[2] Loading SNV table..." << std::endl;
-        int num_snvs = processor.load_snvs(snv_table);
-        std::cout << "✓ Loaded " << num_snvs << " SNVs" << std::endl << std::endl;
-        
-        if (num_snvs == 0) {
-            std::cerr << "✗ No SNVs loaded, exiting" << std::endl;
-            return 1;
+        processor.set_output_format(output_format, output_dtype);
+        if (argc > 5 && std::string(argv[5]) == "cache") {
+            processor.set_reference_cache(true);
+        }
+        if (argc > 6) {
+            processor.set_pmd_intervals(std::make_shared<IntervalIndex>(IntervalIndex::load_bed(argv[6])));
         }
         
-        // Show first few SNVs
-        std::cout << "First 5 SNVs:" << std::endl;
-        const auto& snvs = processor.get_snvs();
-        for (size_t i = 0; i < std::min(snvs.size(), size_t(5)); i++) {
-            std::cout << "  " << i << ". chr" << snvs[i].chr_id << ":" 
-                      << snvs[i].pos << " " << snvs[i].ref_base 
-                      << ">" << snvs[i].alt_base << std::endl;
+        // argv[7] == "stream": read the SNV file while regions are processed
+        bool stream = (argc > 7 && std::string(argv[7]) == "stream");
+        // argv[8]: "i/N" shard or a region list such as "chr17:7500000-7700000"
+        if (argc > 8) {
+            std::string selection = argv[8];
+            if (selection.find('/') != std::string::npos) {
+                processor.set_shard(ShardSpec::parse(selection));
+            } else {
+                processor.set_snv_regions(parse_region_list(selection));
+            }
         }
-        std::cout << std::endl;
         
-        std::cout << "[3] Processing all regions with " << num_threads << " threads..." << std::endl;
+        std::vector<RegionResult> results;
         auto t_start = std::chrono::high_resolution_clock::now();
-        
-        auto results = processor.process_all_regions(0);  // Process all loaded SNVs
+        if (stream) {
+            std::cout << "[2-3] Streaming SNV table into " << num_threads << " threads..." << std::endl;
+            results = processor.process_snv_stream(snv_table);
+            if (results.empty()) {
+                std::cerr << "✗ No SNVs loaded, exiting" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "[2] Loading SNV table..." << std::endl;
+            int num_snvs = processor.load_snvs(snv_table);
+            std::cout << "✓ Loaded " << num_snvs << " SNVs" << std::endl << std::endl;
+            
+            if (num_snvs == 0) {
+                std::cerr << "✗ No SNVs loaded, exiting" << std::endl;
+                return 1;
+            }
+            
+            // Show first few SNVs
+            std::cout << "First 5 SNVs:" << std::endl;
+            const auto& snvs = processor.get_snvs();
+            for (size_t i = 0; i < std::min(snvs.size(), size_t(5)); i++) {
+                std::cout << "  " << i << ". " << processor.chrom_index().get_name(snvs[i].chr_id) << ":" 
+                          << snvs[i].pos << " " << snvs[i].ref_base 
+                          << ">" << snvs[i].alt_base << std::endl;
+            }
+            std::cout << std::endl;
+            
+            std::cout << "[3] Processing all regions with " << num_threads << " threads..." << std::endl;
+            t_start = std::chrono::high_resolution_clock::now();
+            results = processor.process_all_regions(0);  // Process all loaded SNVs
+        }
         
         auto t_end = std::chrono::high_resolution_clock::now();
         double total_time = std::chrono::duration<double, std::milli>(t_end - t_start).count();
         
         std::cout << "\n[4] Results Summary" << std::endl;
         processor.print_summary(results);
+        processor.write_telemetry(results, output_dir + "/telemetry");
+        std::cout << "Telemetry: " << output_dir << "/telemetry.{tsv,json}" << std::endl;
         
         std::cout << "\n[5] Performance Metrics" << std::endl;
         std::cout << "Wall-clock time: " << total_time << " ms" << std::endl;
@@ -0,0 +1,75 @@
+#include "utils/Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace InterSubMod {
+namespace Utils {
+
+Arena::Arena(size_t initial_bytes)
+    : initial_bytes_(std::max<size_t>(initial_bytes, 64)) {
+}
+
+Arena::~Arena() {
+    release_chunks();
+}
+
+void Arena::release_chunks() {
+    for (const Chunk& c : chunks_) {
+        ::operator delete(c.data);
+    }
+    chunks_.clear();
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Chunk& c : chunks_) {
+        total += c.size;
+    }
+    return total;
+}
+
+void Arena::add_chunk(size_t min_bytes) {
+    // Geometric growth keeps the number of chunks per region logarithmic
+    size_t size = chunks_.empty() ? initial_bytes_ : chunks_.back().size * 2;
+    size = std::max(size, min_bytes);
+    chunks_.push_back(Chunk{static_cast<char*>(::operator new(size)), size});
+    system_allocations_++;
+}
+
+void Arena::reset() {
+    if (chunks_.size() > 1) {
+        // Coalesce: the next region of this size fits in one chunk
+        size_t total = capacity();
+        release_chunks();
+        chunks_.push_back(Chunk{static_cast<char*>(::operator new(total)), total});
+        system_allocations_++;
+    }
+    current_ = 0;
+    offset_ = 0;
+    allocated_ = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    // After reset() there is at most one chunk, and new chunks are always
+    // appended, so only the last chunk ever has free space
+    for (;;) {
+        if (!chunks_.empty()) {
+            Chunk& c = chunks_[current_];
+            uintptr_t base = reinterpret_cast<uintptr_t>(c.data);
+            uintptr_t aligned = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            size_t end = static_cast<size_t>(aligned - base) + bytes;
+            if (end <= c.size) {
+                offset_ = end;
+                allocated_ += bytes;
+                return reinterpret_cast<void*>(aligned);
+            }
+        }
+        add_chunk(bytes + alignment);
+        current_ = chunks_.size() - 1;
+        offset_ = 0;
+    }
+}
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -1,4 +1,5 @@
 #include "utils/FastaReader.hpp"
+#include "utils/ReferenceCache.hpp"
 #include <stdexcept>
 #include <algorithm>
 #include <cctype>
@@ -23,7 +24,9 @@ FastaReader::~FastaReader() {
 
 FastaReader::FastaReader(FastaReader&& other) noexcept
     : fasta_path_(std::move(other.fasta_path_)),
-      fai_(other.fai_) {
+      fai_(other.fai_),
+      cache_(std::move(other.cache_)),
+      buffer_(std::move(other.buffer_)) {
     other.fai_ = nullptr;
 }
 
@@ -35,6 +38,8 @@ FastaReader& FastaReader::operator=(FastaReader&& other) noexcept {
         fasta_path_ = std::move(other.fasta_path_);
         fai_ = other.fai_;
         other.fai_ = nullptr;
+        cache_ = std::move(other.cache_);
+        buffer_ = std::move(other.buffer_);
     }
     return *this;
 }
@@ -74,6 +79,26 @@ std::string FastaReader::fetch_sequence(
     return result;
 }
 
+std::string_view FastaReader::fetch_view(
+    const std::string& chr,
+    int32_t start,
+    int32_t end
+) {
+    if (cache_) {
+        return cache_->fetch(chr, start, end);
+    }
+    buffer_ = fetch_sequence(chr, start, end);
+    return buffer_;
+}
+
+const CpGBitmap* FastaReader::cpg_bitmap(const std::string& chr) {
+    if (!cache_) {
+        return nullptr;
+    }
+    const CachedChromosome* chrom = cache_->chromosome(chr);
+    return chrom ? &chrom->cpg : nullptr;
+}
+
 int64_t FastaReader::get_chr_length(const std::string& chr) const {
     if (!fai_) {
         return -1;
@@ -82,5 +107,17 @@ int64_t FastaReader::get_chr_length(const std::string& chr) const {
     return faidx_seq_len(fai_, chr.c_str());
 }
 
-} // namespace InterSubMod
+std::vector<std::string> FastaReader::chromosome_names() const {
+    std::vector<std::string> names;
+    if (!fai_) {
+        return names;
+    }
+    int n = faidx_nseq(fai_);
+    names.reserve(n);
+    for (int i = 0; i < n; i++) {
+        names.emplace_back(faidx_iseq(fai_, i));
+    }
+    return names;
+}
 
+} // namespace InterSubMod
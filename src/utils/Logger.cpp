@@ -1,7 +1,9 @@
 #include "utils/Logger.hpp"
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <iostream>
 
 namespace InterSubMod {
 namespace Utils {
@@ -11,23 +13,38 @@ Logger& Logger::instance() {
     return instance;
 }
 
+Logger::Logger() {
+    flusher_ = std::thread(&Logger::flusher_loop, this);
+}
+
 Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+    drain();
     if (log_file_.is_open()) {
         log_file_.close();
     }
 }
 
 void Logger::set_log_level(LogLevel level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    current_level_ = level;
+    current_level_.store(level, std::memory_order_relaxed);
 }
 
 void Logger::set_log_file(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    drain();  // Earlier messages belong to the previous file
+    std::lock_guard<std::mutex> lock(io_mutex_);
     if (log_file_.is_open()) {
         log_file_.close();
     }
-    log_file_.open(filename, std::ios::app);
+    if (!filename.empty()) {
+        log_file_.open(filename, std::ios::app);
+    }
 }
 
 std::string Logger::level_to_string(LogLevel level) {
@@ -40,31 +57,127 @@ std::string Logger::level_to_string(LogLevel level) {
     }
 }
 
+Logger::ThreadRing& Logger::thread_ring() {
+    // The registry keeps the ring alive after the thread exits so the flush
+    // thread can still drain it; the handle only marks it retired
+    struct Handle {
+        std::shared_ptr<ThreadRing> ring;
+        ~Handle() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Handle handle;
+    if (!handle.ring) {
+        handle.ring = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(handle.ring);
+    }
+    return *handle.ring;
+}
+
+std::ostringstream& Logger::pending_stream() {
+    thread_local std::ostringstream stream;
+    return stream;
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (level < current_level_) {
+    if (!enabled(level)) {
         return;
     }
 
-    // Get current time
-    auto now = std::chrono::system_clock::now();
-    auto now_time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    ThreadRing& ring = thread_ring();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kRingCapacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Entry& e = ring.slots[head % kRingCapacity];
+    e.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    e.level = level;
+    e.message = message;
+    ring.head.store(head + 1, std::memory_order_release);
+
+    if (level == LogLevel::L_ERROR) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            wake_requested_ = true;
+        }
+        wake_.notify_one();
+    }
+}
 
-    std::stringstream ss;
-    // Note: std::put_time is not thread-safe on some old platforms but generally ok in modern C++.
-    // Using localtime_r or localtime_s is better but std::put_time takes tm*.
-    struct tm* time_info = std::localtime(&now_time);
-    
-    ss << "[" << std::put_time(time_info, "%Y-%m-%d %H:%M:%S") 
-       << "." << std::setfill('0') << std::setw(3) << ms.count() << "] "
-       << "[" << level_to_string(level) << "] "
-       << message << std::endl;
+void Logger::end_log(LogLevel level) {
+    std::ostringstream& stream = pending_stream();
+    std::string msg = stream.str();
+    stream.str("");  // Clear buffer
+    stream.clear();
+    log(level, msg);
+}
+
+void Logger::flush() {
+    drain();
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings = rings_;
+    }
+
+    std::vector<Entry> batch;
+    std::vector<ThreadRing*> finished;
+    for (const auto& ring : rings) {
+        // Read retired first: every message of an exited thread is then visible
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail < head; tail++) {
+            batch.push_back(std::move(ring->slots[tail % kRingCapacity]));
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        if (retired) {
+            finished.push_back(ring.get());
+        }
+    }
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [&](const std::shared_ptr<ThreadRing>& r) {
+            return std::find(finished.begin(), finished.end(), r.get()) != finished.end();
+        }), rings_.end());
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (batch.empty() && dropped == reported_dropped_) {
+        return;
+    }
+
+    // Interleave the threads' messages in time order
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const Entry& a, const Entry& b) { return a.time_us < b.time_us; });
+
+    std::ostringstream ss;
+    for (const auto& e : batch) {
+        std::time_t secs = static_cast<std::time_t>(e.time_us / 1000000);
+        struct tm time_info;
+        localtime_r(&secs, &time_info);
+        ss << "[" << std::put_time(&time_info, "%Y-%m-%d %H:%M:%S")
+           << "." << std::setfill('0') << std::setw(3) << (e.time_us / 1000) % 1000 << "] "
+           << "[" << level_to_string(e.level) << "] "
+           << e.message << "\n";
+    }
+    if (dropped != reported_dropped_) {
+        ss << "[WARNING] Logger dropped " << (dropped - reported_dropped_)
+           << " messages (per-thread buffer full)\n";
+        reported_dropped_ = dropped;
+    }
 
     // Output to console
-    std::cout << ss.str();
-    
+    std::cout << ss.str() << std::flush;
+
     // Output to file if open
     if (log_file_.is_open()) {
         log_file_ << ss.str();
@@ -72,23 +185,18 @@ void Logger::log(LogLevel level, const std::string& message) {
     }
 }
 
-void Logger::end_log(LogLevel level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string msg = buffer_.str();
-    buffer_.str(""); // Clear buffer
-    buffer_.clear();
-    
-    // Note: calling log() from here is tricky if we hold mutex, but log() also locks.
-    // To avoid deadlock, we shouldn't call log() while holding mutex.
-    // But we just cleared buffer. 
-    // The correct way would be:
+void Logger::flusher_loop() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(20), [this] { return stopping_ || wake_requested_; });
+        wake_requested_ = false;
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
 }
 
 // Static helpers
-void Logger::debug(const std::string& msg) {
-    instance().log(LogLevel::L_DEBUG, msg);
-}
-
 void Logger::info(const std::string& msg) {
     instance().log(LogLevel::L_INFO, msg);
 }
@@ -0,0 +1,134 @@
+#include "utils/NumaTopology.hpp"
+
+#include <sched.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace InterSubMod {
+namespace Utils {
+
+// CPUs the process may run on (taskset / cgroup cpuset)
+static std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+NumaTopology::NumaTopology(std::vector<std::vector<int>> node_cpus) : node_cpus_(std::move(node_cpus)) {
+    for (auto& cpus : node_cpus_) {
+        std::sort(cpus.begin(), cpus.end());
+    }
+    if (node_cpus_.empty()) {
+        node_cpus_.emplace_back();
+    }
+}
+
+NumaTopology NumaTopology::detect() {
+    std::vector<int> allowed = allowed_cpus();
+    std::vector<std::vector<int>> nodes;
+
+    // node<N> directories, in node-number order
+    std::map<int, std::string> node_dirs;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](unsigned char ch) { return std::isdigit(ch); })) {
+            node_dirs[std::atoi(name.c_str() + 4)] = entry.path().string();
+        }
+    }
+
+    for (const auto& [id, dir] : node_dirs) {
+        std::ifstream in(dir + "/cpulist");
+        std::string list;
+        if (!std::getline(in, list)) continue;
+        std::vector<int> cpus;
+        for (int c : parse_cpu_list(list)) {
+            if (allowed.empty() || std::binary_search(allowed.begin(), allowed.end(), c)) {
+                cpus.push_back(c);
+            }
+        }
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+
+    if (nodes.empty()) {
+        nodes.push_back(allowed);
+    }
+    return NumaTopology(std::move(nodes));
+}
+
+int NumaTopology::node_of_cpu(int cpu) const {
+    for (int n = 0; n < num_nodes(); n++) {
+        if (std::binary_search(node_cpus_[n].begin(), node_cpus_[n].end(), cpu)) return n;
+    }
+    return 0;
+}
+
+int NumaTopology::current_node() const {
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : node_of_cpu(cpu);
+}
+
+int NumaTopology::node_for_thread(int t, int n) const {
+    if (n <= 0 || num_nodes() == 1) return 0;
+    return std::min(num_nodes() - 1, static_cast<int>(static_cast<int64_t>(t) * num_nodes() / n));
+}
+
+std::vector<int> NumaTopology::parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        const std::string item = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        const size_t dash = item.find('-');
+        char* tail = nullptr;
+        const long first = std::strtol(item.c_str(), &tail, 10);
+        if (tail == item.c_str()) continue;  // empty or whitespace-only item
+        const long last = dash == std::string::npos ? first : std::strtol(item.c_str() + dash + 1, nullptr, 10);
+        for (long c = first; c <= last; c++) {
+            cpus.push_back(static_cast<int>(c));
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+bool NumaTopology::omp_binding_requested() {
+    if (const char* places = std::getenv("OMP_PLACES"); places && *places) {
+        return true;
+    }
+    const char* bind = std::getenv("OMP_PROC_BIND");
+    return bind && *bind && strcasecmp(bind, "false") != 0;
+}
+
+bool NumaTopology::pin_current_thread(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -0,0 +1,67 @@
+#include "utils/ProgressReporter.hpp"
+#include <iomanip>
+#include <sstream>
+
+namespace InterSubMod {
+namespace Utils {
+
+ProgressReporter::ProgressReporter(const std::string& label, uint64_t total, double interval_s, std::ostream& out)
+    : label_(label), interval_s_(interval_s), out_(out), start_(std::chrono::steady_clock::now()),
+      total_(total), total_known_(total > 0) {
+    if (interval_s_ > 0) {
+        thread_ = std::thread(&ProgressReporter::run, this);
+    }
+}
+
+ProgressReporter::~ProgressReporter() {
+    stop();
+}
+
+void ProgressReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+        out_ << format_line() << std::endl;
+    }
+}
+
+void ProgressReporter::run() {
+    const auto interval = std::chrono::duration<double>(interval_s_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+        out_ << format_line() << std::endl;
+    }
+}
+
+std::string ProgressReporter::format_line() const {
+    const uint64_t done = done_.load(std::memory_order_relaxed);
+    const uint64_t failed = failed_.load(std::memory_order_relaxed);
+    const uint64_t total = total_.load(std::memory_order_relaxed);
+    const bool known = total_known_.load(std::memory_order_relaxed);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    const double rate = secs > 0 ? done / secs : 0.0;
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "[" << label_ << "] " << done << "/" << total << (known ? "" : "+");
+    if (known && total > 0) {
+        oss << " (" << 100.0 * done / total << "%)";
+    }
+    oss << ", " << rate << "/s";
+    if (known && rate > 0 && done < total) {
+        oss << std::setprecision(0) << ", ETA " << (total - done) / rate << "s";
+    }
+    oss << ", " << failed << " failed";
+    return oss.str();
+}
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -0,0 +1,92 @@
+#include "utils/ReferenceCache.hpp"
+#include "utils/FastaReader.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace InterSubMod {
+
+CpGBitmap::CpGBitmap(std::string_view seq)
+    : bits_((seq.size() + 63) / 64, 0), length_(static_cast<int64_t>(seq.size())) {
+    const char* s = seq.data();
+    const size_t n = seq.size();
+    for (size_t w = 0; w < bits_.size(); w++) {
+        const size_t begin = w * 64;
+        const size_t end = std::min(begin + 64, n > 0 ? n - 1 : 0);
+        uint64_t word = 0;
+        for (size_t i = begin; i < end; i++) {
+            word |= static_cast<uint64_t>(s[i] == 'C' && s[i + 1] == 'G') << (i - begin);
+        }
+        bits_[w] = word;
+    }
+}
+
+size_t CpGBitmap::count() const {
+    size_t total = 0;
+    for (uint64_t w : bits_) {
+        total += static_cast<size_t>(__builtin_popcountll(w));
+    }
+    return total;
+}
+
+ReferenceCache::ReferenceCache(const std::string& fasta_path)
+    : fasta_path_(fasta_path) {
+    // Fail early on a missing index rather than on the first region
+    FastaReader probe(fasta_path_);
+}
+
+std::unique_ptr<CachedChromosome> ReferenceCache::load(const std::string& chr) const {
+    FastaReader reader(fasta_path_);
+    int64_t len = reader.get_chr_length(chr);
+    if (len <= 0) {
+        return nullptr;
+    }
+    if (len > std::numeric_limits<int32_t>::max()) {
+        throw std::runtime_error("Chromosome too long for 32-bit coordinates: " + chr);
+    }
+
+    auto chrom = std::make_unique<CachedChromosome>();
+    chrom->name = chr;
+    chrom->seq = reader.fetch_sequence(chr, 0, static_cast<int32_t>(len));  // uppercased
+    if (static_cast<int64_t>(chrom->seq.size()) != len) {
+        throw std::runtime_error("Failed to load chromosome " + chr + " from " + fasta_path_);
+    }
+    chrom->cpg = CpGBitmap(chrom->seq);
+    return chrom;
+}
+
+const CachedChromosome* ReferenceCache::chromosome(const std::string& chr) {
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = entries_[chr];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+        }
+        entry = slot.get();
+    }
+
+    // A throwing load leaves the flag unset, so the next caller retries
+    std::call_once(entry->once, [&] {
+        entry->chrom = load(chr);
+        if (entry->chrom) {
+            num_loaded_.fetch_add(1, std::memory_order_relaxed);
+            bytes_.fetch_add(entry->chrom->seq.size() + entry->chrom->cpg.bytes(), std::memory_order_relaxed);
+        }
+    });
+    return entry->chrom.get();
+}
+
+std::string_view ReferenceCache::fetch(const std::string& chr, int32_t start, int32_t end) {
+    if (start < 0 || end <= start) {
+        return {};
+    }
+    const CachedChromosome* chrom = chromosome(chr);
+    if (!chrom || static_cast<size_t>(start) >= chrom->seq.size()) {
+        return {};
+    }
+    std::string_view seq(chrom->seq);
+    return seq.substr(static_cast<size_t>(start), static_cast<size_t>(end - start));
+}
+
+} // namespace InterSubMod
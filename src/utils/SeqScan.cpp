@@ -0,0 +1,144 @@
+#include "utils/SeqScan.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SEQ_SCAN_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SEQ_SCAN_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace InterSubMod {
+namespace Utils {
+
+// Appends matches in bases [from, len) one nibble at a time
+static inline void scan_scalar(const uint8_t* packed, int32_t from, int32_t len, uint8_t code,
+                               std::vector<int32_t>& positions) {
+    for (int32_t i = from; i < len; i++) {
+        uint8_t nt = (packed[i >> 1] >> ((~i & 1) << 2)) & 0x0F;  // same as bam_seqi()
+        if (nt == code) {
+            positions.push_back(i);
+        }
+    }
+}
+
+size_t find_bases_scalar(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions) {
+    positions.clear();
+    scan_scalar(packed, 0, len, code, positions);
+    return positions.size();
+}
+
+#ifdef SEQ_SCAN_HAVE_AVX2
+// Spreads the 32 bits of x to the even bit positions of a 64-bit word
+static inline uint64_t spread_bits(uint32_t x) {
+    uint64_t v = x;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v | (v << 2)) & 0x3333333333333333ULL;
+    v = (v | (v << 1)) & 0x5555555555555555ULL;
+    return v;
+}
+
+__attribute__((target("avx2")))
+static size_t find_bases_avx2(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions) {
+    positions.clear();
+
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i target = _mm256_set1_epi8(static_cast<char>(code));
+    const int32_t num_blocks = len / 64;  // 32 bytes = 64 bases per block
+
+    for (int32_t blk = 0; blk < num_blocks; blk++) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(packed + blk * 32));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);  // even bases
+        __m256i lo = _mm256_and_si256(v, nibble);                         // odd bases
+
+        uint32_t even = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, target)));
+        uint32_t odd = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, target)));
+        uint64_t mask = spread_bits(even) | (spread_bits(odd) << 1);  // bit k = base k
+
+        const int32_t base = blk * 64;
+        while (mask) {
+            positions.push_back(base + __builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    scan_scalar(packed, num_blocks * 64, len, code, positions);
+    return positions.size();
+}
+#endif
+
+#ifdef SEQ_SCAN_HAVE_NEON
+// Emits the set lanes of a 16-byte compare result (0x00/0xFF per base)
+static inline void emit_lanes(uint8x16_t eq, int32_t base, std::vector<int32_t>& positions) {
+    // Narrow to 4 bits per lane, keep one bit per lane
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+    mask &= 0x8888888888888888ULL;
+    while (mask) {
+        positions.push_back(base + (__builtin_ctzll(mask) >> 2));
+        mask &= mask - 1;
+    }
+}
+
+static size_t find_bases_neon(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions) {
+    positions.clear();
+
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    const uint8x16_t target = vdupq_n_u8(code);
+    const int32_t num_blocks = len / 32;  // 16 bytes = 32 bases per block
+
+    for (int32_t blk = 0; blk < num_blocks; blk++) {
+        uint8x16_t v = vld1q_u8(packed + blk * 16);
+        uint8x16_t even = vceqq_u8(vshrq_n_u8(v, 4), target);
+        uint8x16_t odd = vceqq_u8(vandq_u8(v, nibble), target);
+
+        // Interleave back into base order
+        const int32_t base = blk * 32;
+        emit_lanes(vzip1q_u8(even, odd), base, positions);
+        emit_lanes(vzip2q_u8(even, odd), base + 16, positions);
+    }
+
+    scan_scalar(packed, num_blocks * 32, len, code, positions);
+    return positions.size();
+}
+#endif
+
+using FindBasesFn = size_t (*)(const uint8_t*, int32_t, uint8_t, std::vector<int32_t>&);
+
+struct SeqScanKernel {
+    FindBasesFn fn;
+    const char* name;
+};
+
+static SeqScanKernel select_kernel() {
+#ifdef SEQ_SCAN_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {find_bases_avx2, "avx2"};
+    }
+#endif
+#ifdef SEQ_SCAN_HAVE_NEON
+    return {find_bases_neon, "neon"};
+#else
+    return {find_bases_scalar, "scalar"};
+#endif
+}
+
+static const SeqScanKernel& kernel() {
+    static const SeqScanKernel k = select_kernel();
+    return k;
+}
+
+size_t find_bases(const uint8_t* packed, int32_t len, uint8_t code, std::vector<int32_t>& positions) {
+    return kernel().fn(packed, len, code, positions);
+}
+
+const char* seq_scan_kernel_name() {
+    return kernel().name;
+}
+
+} // namespace Utils
+} // namespace InterSubMod
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <htslib/sam.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace InterSubMod {
+namespace Testing {
+
+/**
+ * @brief Encodes one CIGAR operation (length << 4 | BAM_C*).
+ */
+inline uint32_t op(int len, int type) { return (static_cast<uint32_t>(len) << 4) | type; }
+
+/**
+ * @brief Appends an MM (Z) tag and an ML (B:C) tag to a record.
+ */
+inline void append_methylation_tags(bam1_t* b, const std::string& mm, const std::vector<uint8_t>& ml) {
+    bam_aux_append(b, "MM", 'Z', mm.size() + 1, reinterpret_cast<const uint8_t*>(mm.c_str()));
+
+    // B-array payload: subtype, little-endian count, values
+    std::vector<uint8_t> payload(5 + ml.size());
+    payload[0] = 'C';
+    uint32_t n = ml.size();
+    std::memcpy(&payload[1], &n, 4);
+    std::memcpy(payload.data() + 5, ml.data(), ml.size());
+    bam_aux_append(b, "ML", 'B', payload.size(), payload.data());
+}
+
+/**
+ * @brief Builds an in-memory BAM record (tid 0, MAPQ 60), with MM/ML tags unless @p mm is empty.
+ *
+ * Shared by the unit tests and the benchmark fixtures; free with bam_destroy1().
+ *
+ * @param qual Base qualities (nullptr = missing, 0xff).
+ */
+inline bam1_t* make_record(int32_t pos, const std::vector<uint32_t>& cigar, const std::string& seq,
+                           const std::string& mm = "", const std::vector<uint8_t>& ml = {},
+                           const std::string& name = "read", const char* qual = nullptr) {
+    bam1_t* b = bam_init1();
+    bam_set1(b, name.size(), name.c_str(), 0, 0, pos, 60, cigar.size(), cigar.data(), -1, -1, 0,
+             seq.size(), seq.c_str(), qual, 0);
+    if (!mm.empty()) {
+        append_methylation_tags(b, mm, ml);
+    }
+    return b;
+}
+
+} // namespace Testing
+} // namespace InterSubMod
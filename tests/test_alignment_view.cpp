@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "core/AlignmentView.hpp"
+#include "core/MethylationParser.hpp"
+#include "core/ReadParser.hpp"
+#include "BamTestRecords.hpp"
+#include <string>
+#include <vector>
+
+using namespace InterSubMod;
+
+namespace {
+
+using Testing::make_record;
+using Testing::op;
+
+// 5S 10M 2I 3= 2X 4D 6M 100N 5M 3S 7H at pos 1000
+std::vector<uint32_t> complex_cigar() {
+    return {op(5, BAM_CSOFT_CLIP), op(10, BAM_CMATCH), op(2, BAM_CINS), op(3, BAM_CEQUAL),
+            op(2, BAM_CDIFF), op(4, BAM_CDEL), op(6, BAM_CMATCH), op(100, BAM_CREF_SKIP),
+            op(5, BAM_CMATCH), op(3, BAM_CSOFT_CLIP), op(7, BAM_CHARD_CLIP)};
+}
+
+} // namespace
+
+TEST(AlignmentViewTest, BlocksAndSpansMatchHtslib) {
+    std::vector<uint32_t> cigar = complex_cigar();
+    bam1_t* b = make_record(1000, cigar, std::string(36, 'A'));
+    AlignmentView aln(b);
+
+    EXPECT_EQ(aln.query_length(), bam_cigar2qlen(b->core.n_cigar, bam_get_cigar(b)));
+    EXPECT_EQ(aln.ref_start(), 1000);
+    EXPECT_EQ(aln.ref_end(), bam_endpos(b));
+
+    // 3= 2X merge into one block; D and N split blocks
+    ASSERT_EQ(aln.blocks().size(), 4u);
+    EXPECT_EQ(aln.blocks()[0].query_start, 5);
+    EXPECT_EQ(aln.blocks()[0].ref_start, 1000);
+    EXPECT_EQ(aln.blocks()[0].length, 10);
+    EXPECT_EQ(aln.blocks()[1].query_start, 17);
+    EXPECT_EQ(aln.blocks()[1].ref_start, 1010);
+    EXPECT_EQ(aln.blocks()[1].length, 5);
+    EXPECT_EQ(aln.blocks()[2].ref_start, 1019);
+    EXPECT_EQ(aln.blocks()[3].ref_start, 1125);
+
+    // reset() on another read replaces everything
+    bam_destroy1(b);
+    b = make_record(0, {op(8, BAM_CMATCH)}, "ACGTACGT");
+    aln.reset(b);
+    EXPECT_EQ(aln.query_length(), 8);
+    EXPECT_EQ(aln.ref_end(), 8);
+    ASSERT_EQ(aln.blocks().size(), 1u);
+    bam_destroy1(b);
+}
+
+TEST(AlignmentViewTest, LookupsSkipGaps) {
+    bam1_t* b = make_record(1000, complex_cigar(), std::string(36, 'A'));
+    AlignmentView aln(b);
+
+    EXPECT_EQ(aln.query_offset(999), -1);    // Before the alignment
+    EXPECT_EQ(aln.query_offset(1000), 5);    // After the soft clip
+    EXPECT_EQ(aln.query_offset(1010), 17);   // After the insertion
+    EXPECT_EQ(aln.query_offset(1016), -1);   // Deletion
+    EXPECT_EQ(aln.query_offset(1050), -1);   // Reference skip
+    EXPECT_EQ(aln.query_offset(1129), 32);
+    EXPECT_EQ(aln.query_offset(1130), -1);   // Past the end
+
+    EXPECT_EQ(aln.ref_position(0), -1);      // Soft clip
+    EXPECT_EQ(aln.ref_position(15), -1);     // Insertion
+    EXPECT_EQ(aln.ref_position(21), 1014);
+    EXPECT_EQ(aln.ref_position(28), 1125);
+    EXPECT_EQ(aln.ref_position(34), -1);     // Trailing soft clip
+    bam_destroy1(b);
+}
+
+TEST(AlignmentViewTest, ReadParserUsesViewForFilterAndAltSupport) {
+    ReadFilterConfig config;
+    config.min_read_length = 10;
+    config.require_mm_ml = false;
+    ReadParser parser(config);
+
+    // 4M 2D 4M at pos 100: ref 100-103 aligned, 104-105 deleted, 106-109 aligned
+    bam1_t* b = make_record(100, {op(4, BAM_CMATCH), op(2, BAM_CDEL), op(4, BAM_CMATCH)}, "ACGTTAGC");
+    AlignmentView aln;
+    EXPECT_FALSE(parser.should_keep(b, aln));  // 8 query bases < 10
+    EXPECT_EQ(aln.query_length(), 8);          // Decoded anyway (passed FLAG/MAPQ)
+
+    config.min_read_length = 8;
+    ReadParser lenient(config);
+    EXPECT_TRUE(lenient.should_keep(b, aln));
+    EXPECT_EQ(lenient.should_keep(b), lenient.should_keep(b, aln));
+
+    SomaticSnv snv{};
+    snv.ref_base = 'T';
+    snv.alt_base = 'A';
+    snv.pos = 108;  // 0-based 107 -> query 5 ('A')
+    ReadInfo info = lenient.parse(b, aln, 0, true, snv, "", 100);
+    EXPECT_EQ(info.alt_support, AltSupport::ALT);
+    EXPECT_EQ(info.align_end, bam_endpos(b));
+    EXPECT_EQ(lenient.parse(b, 0, true, snv, "", 100).alt_support, AltSupport::ALT);
+
+    snv.pos = 105;  // In the deletion
+    EXPECT_EQ(lenient.parse(b, aln, 0, true, snv, "", 100).alt_support, AltSupport::UNKNOWN);
+    bam_destroy1(b);
+}
+
+TEST(AlignmentViewTest, MethylationOverloadsAgree) {
+    // 4= 1X 3= 2I 4M 3D 5M over ref "ACGTACGT..." at 0
+    std::string ref;
+    for (int i = 0; i < 10; i++) ref += "ACGT";
+    std::string seq = "ACGT" "A" "CGT" "CG" "ACGT" "ACGTA";
+    bam1_t* b = make_record(0, {op(4, BAM_CEQUAL), op(1, BAM_CDIFF), op(3, BAM_CEQUAL), op(2, BAM_CINS),
+                                op(4, BAM_CMATCH), op(3, BAM_CDEL), op(5, BAM_CMATCH)},
+                            seq, "C+m?,0,0,0,0,0;", {10, 20, 30, 40, 50});
+
+    MethylationParser parser;
+    std::vector<MethylCall> expected;
+    parser.parse_read(b, ref, 0, expected);
+
+    AlignmentView aln(b);
+    std::vector<MethylCall> calls;
+    parser.parse_read(b, aln, ref, 0, calls);
+
+    ASSERT_EQ(calls.size(), expected.size());
+    ASSERT_FALSE(calls.empty());
+    for (size_t i = 0; i < calls.size(); i++) {
+        EXPECT_EQ(calls[i].ref_pos, expected[i].ref_pos);
+        EXPECT_FLOAT_EQ(calls[i].probability, expected[i].probability);
+    }
+    ASSERT_EQ(calls.size(), 3u);  // Query Cs 1, 5, 11 are CpGs; 8 is inserted, 15 maps to an A
+    // C at query 8 is inserted: its ML value (30) must not appear
+    for (const auto& c : calls) {
+        EXPECT_NE(c.probability, 30 / 255.0f);
+    }
+    bam_destroy1(b);
+}
+
+TEST(AlignmentViewTest, ReadFilterCountsFirstRejectingStage) {
+    Config cfg;
+    cfg.min_mapq = 30;
+    cfg.min_read_length = 8;
+    cfg.min_base_quality = 7;
+    ReadFilterConfig config = ReadFilterConfig::from_config(cfg);
+    EXPECT_EQ(config.min_mapq, 30);
+    EXPECT_EQ(config.min_read_length, 8);
+    EXPECT_EQ(config.min_base_quality, 7);
+    EXPECT_TRUE(config.require_mm_ml);
+    ReadParser parser(config);
+
+    const std::vector<uint32_t> cigar8{op(8, BAM_CMATCH)};
+    std::vector<bam1_t*> reads{
+        make_record(100, cigar8, "ACGTACGT", "C+m,0;", {200}),             // Kept
+        make_record(100, cigar8, "ACGTACGT", "C+m,0;", {200}),             // Duplicate
+        make_record(100, cigar8, "ACGTACGT", "C+m,0;", {200}),             // MAPQ 10
+        make_record(100, {op(6, BAM_CMATCH)}, "ACGTAC", "C+m,0;", {200}),  // Too short
+        make_record(100, cigar8, "ACGTACGT"),                              // No MM/ML
+    };
+    reads[1]->core.flag |= BAM_FDUP;
+    reads[2]->core.qual = 10;
+
+    ReadFilterStats stats;
+    AlignmentView aln;
+    int kept = 0;
+    for (size_t i = 0; i < reads.size(); i++) {
+        kept += (i % 2 ? parser.should_keep(reads[i], &stats) : parser.should_keep(reads[i], aln, &stats));
+    }
+    EXPECT_EQ(kept, 1);
+    EXPECT_EQ(stats.seen, 5u);
+    EXPECT_EQ(stats.failed_flag, 1u);
+    EXPECT_EQ(stats.failed_mapq, 1u);
+    EXPECT_EQ(stats.failed_length, 1u);
+    EXPECT_EQ(stats.failed_tags, 1u);
+    EXPECT_EQ(stats.kept, 1u);
+
+    ReadFilterStats total;
+    total += stats;
+    total += stats;
+    EXPECT_EQ(total.seen, 10u);
+    EXPECT_EQ(total.kept, 2u);
+
+    for (auto* b : reads) bam_destroy1(b);
+}
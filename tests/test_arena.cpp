@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "utils/Arena.hpp"
+#include "core/MatrixBuilder.hpp"
+#include <cstdint>
+#include <vector>
+
+using namespace InterSubMod;
+using namespace InterSubMod::Utils;
+
+TEST(ArenaTest, AlignsAndCountsBytes) {
+    Arena arena(256);
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    void* c = arena.allocate(32, 32);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 32, 0u);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(arena.bytes_allocated(), 43u);
+    EXPECT_EQ(arena.system_allocations(), 1u);
+
+    arena.reset();
+    EXPECT_EQ(arena.bytes_allocated(), 0u);
+    EXPECT_EQ(arena.allocate(3, 1), a);  // Memory is reused from the start
+}
+
+TEST(ArenaTest, SteadyStateMakesNoSystemAllocations) {
+    Arena arena(64);
+    auto region = [&] {
+        arena.reset();
+        std::pmr::vector<int64_t> v(&arena);
+        for (int i = 0; i < 1000; i++) v.push_back(i);  // Grows past several chunks
+        return v.back();
+    };
+
+    EXPECT_EQ(region(), 999);
+    size_t grown = arena.system_allocations();
+    EXPECT_GT(grown, 1u);
+
+    // The first reset() coalesces into one chunk; after that nothing new is requested
+    region();
+    size_t coalesced = arena.system_allocations();
+    for (int i = 0; i < 5; i++) region();
+    EXPECT_EQ(arena.system_allocations(), coalesced);
+    EXPECT_GT(arena.bytes_allocated(), 0u);
+}
+
+TEST(ArenaTest, MatrixBuilderScratchMatchesDefault) {
+    auto fill = [](MatrixBuilder& m) {
+        ReadInfo r{};
+        r.read_name = "a_read_name_longer_than_sso";
+        m.add_read(r, {MethylCall(130, 0.5f), MethylCall(100, 0.25f), MethylCall(130, 0.75f)});
+        m.add_read(r, {MethylCall(120, 1.0f)});
+        m.finalize();
+    };
+
+    Arena arena;
+    MatrixBuilder with_arena(&arena);
+    MatrixBuilder plain;
+    fill(with_arena);
+    fill(plain);
+
+    EXPECT_GT(arena.bytes_allocated(), 0u);  // entries + sort buffer
+    EXPECT_EQ(with_arena.get_cpg_positions(), plain.get_cpg_positions());
+    EXPECT_EQ(with_arena.get_dense(), plain.get_dense());
+    EXPECT_EQ(with_arena.get_cpg_positions().capacity(), 3u);  // Exact-size column list
+    EXPECT_EQ(with_arena.memory_bytes(), plain.memory_bytes());
+    EXPECT_GE(plain.memory_bytes(), 2 * 24 + 3 * sizeof(int32_t) + 6 * sizeof(float));
+
+    // Scratch is released in finalize(): the result survives an arena reset and a move
+    arena.reset();
+    MatrixBuilder moved = std::move(with_arena);
+    EXPECT_EQ(moved.get_dense(), plain.get_dense());
+}
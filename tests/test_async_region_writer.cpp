@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "io/AsyncRegionWriter.hpp"
+#include "io/CompletionJournal.hpp"
+#include <filesystem>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace InterSubMod;
+using namespace InterSubMod::BinaryFormat;
+
+namespace {
+
+RegionOutput make_output(int region_id) {
+    RegionOutput out;
+    out.snv.snv_id = region_id;
+    out.snv.chr_id = 0;
+    out.snv.pos = 5000 + region_id;
+    out.snv.ref_base = 'G';
+    out.snv.alt_base = 'A';
+    out.region_id = region_id;
+    out.region_start = out.snv.pos - 50;
+    out.region_end = out.snv.pos + 50;
+
+    ReadInfo info{};
+    info.read_id = 0;
+    info.read_name = "r" + std::to_string(region_id);
+    info.alt_support = AltSupport::REF;
+    out.matrix.add_read(info, {MethylCall(out.snv.pos, 0.5f)});
+    out.matrix.finalize();
+    out.elapsed_ms = 1.0;
+    return out;
+}
+
+} // namespace
+
+TEST(AsyncRegionWriterTest, ConcurrentProducersReachShards) {
+    std::string dir = "/tmp/async_writer_test_" + std::to_string(getpid());
+    const int kProducers = 4, kPerProducer = 50;
+    AsyncWriterStats stats;
+    {
+        // Small queue so producers actually hit backpressure
+        AsyncRegionWriter writer(dir, OutputFormat::BINARY, MatrixDType::FLOAT32, 2, 4, 3);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; p++) {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < kPerProducer; i++) {
+                    EXPECT_TRUE(writer.submit(make_output(p * kPerProducer + i)));
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        writer.close();
+        EXPECT_FALSE(writer.submit(make_output(-1)));
+        EXPECT_TRUE(writer.errors().empty());
+        stats = writer.stats();
+    }
+
+    EXPECT_EQ(stats.regions_written, static_cast<uint64_t>(kProducers * kPerProducer));
+    EXPECT_EQ(stats.num_writer_threads, 2);
+    EXPECT_LE(stats.queue.max_depth, 4u);
+    EXPECT_EQ(stats.queue.popped, stats.queue.pushed);
+
+    std::set<int> seen;
+    for (int shard = 0; shard < 2; shard++) {
+        std::string path = dir + "/regions.shard_00" + std::to_string(shard) + ".ismr";
+        BinaryRegionReader reader(path);
+        EXPECT_FALSE(reader.recovered());
+        for (size_t i = 0; i < reader.num_regions(); i++) {
+            const RegionIndexEntry& e = reader.entry(i);
+            seen.insert(e.region_id);
+            EXPECT_EQ(reader.read_name(e, 0), "r" + std::to_string(e.region_id));
+            EXPECT_FLOAT_EQ(reader.value(e, 0, 0), 0.5f);
+        }
+        std::remove(path.c_str());
+    }
+    EXPECT_EQ(seen.size(), static_cast<size_t>(kProducers * kPerProducer));
+    rmdir(dir.c_str());
+}
+
+TEST(AsyncRegionWriterTest, CsvRegionsAreJournaledAfterSync) {
+    std::string dir = "/tmp/async_writer_csv_test_" + std::to_string(getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        CompletionJournal journal(dir + "/completed.journal", false);
+        AsyncRegionWriter writer(dir, OutputFormat::CSV);
+        writer.set_journal(&journal);
+        for (int i = 0; i < 3; i++) {
+            RegionOutput out = make_output(i);
+            out.journal_key = CompletionJournal::region_key("chr1", out.snv);
+            EXPECT_TRUE(writer.submit(std::move(out)));
+        }
+        writer.close();
+        EXPECT_TRUE(writer.errors().empty());
+        EXPECT_EQ(journal.num_completed(), 3u);
+    }
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(std::filesystem::exists(dir + "/region_000" + std::to_string(i) + "/methylation.csv"));
+    }
+    CompletionJournal reopened(dir + "/completed.journal", true);
+    EXPECT_TRUE(reopened.is_completed(CompletionJournal::region_key("chr1", make_output(2).snv)));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(AsyncRegionWriterTest, ClusterRowsOnlyForWrittenRegions) {
+    std::string dir = "/tmp/async_writer_clusters_test_" + std::to_string(getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        CompletionJournal journal(dir + "/completed.journal", false);
+        AsyncRegionWriter writer(dir, OutputFormat::CSV);
+        writer.set_journal(&journal);
+        writer.open_clusters_file(dir + "/clusters.tsv", "region_id\tcluster_id");
+        for (int i = 0; i < 3; i++) {
+            RegionOutput out = make_output(i);
+            out.journal_key = CompletionJournal::region_key("chr1", out.snv);
+            out.cluster_rows = std::to_string(i) + "\t1\n" + std::to_string(i) + "\t2\n";
+            // Parent directory does not exist: the region fails to sync and is not journaled
+            if (i == 1) out.name = "missing/region";
+            EXPECT_TRUE(writer.submit(std::move(out)));
+        }
+        writer.close();
+        ASSERT_EQ(writer.errors().size(), 1u);
+        EXPECT_EQ(writer.errors()[0].first, 1);
+        EXPECT_EQ(journal.num_completed(), 2u);
+    }
+    std::ifstream in(dir + "/clusters.tsv");
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, "region_id\tcluster_id\n0\t1\n0\t2\n2\t1\n2\t2\n");
+    std::filesystem::remove_all(dir);
+}
@@ -56,6 +56,45 @@ TEST_F(BamReaderTest, FetchReadsFromInvalidChromosome) {
     EXPECT_EQ(reads.size(), 0);
 }
 
+TEST_F(BamReaderTest, ForEachReadMatchesFetchReads) {
+    BamReader reader(test_bam_path);
+    
+    auto reads = reader.fetch_reads("chr17", 7577000, 7578000);
+    
+    // Streaming iteration must visit the same records in the same order
+    size_t idx = 0;
+    bool same_order = true;
+    int64_t visited = reader.for_each_read("chr17", 7577000, 7578000, [&](const bam1_t* b) {
+        if (idx >= reads.size() || reads[idx]->core.pos != b->core.pos ||
+            std::string(bam_get_qname(reads[idx])) != bam_get_qname(b)) {
+            same_order = false;
+        }
+        idx++;
+        return true;
+    });
+    
+    EXPECT_EQ(visited, static_cast<int64_t>(reads.size()));
+    EXPECT_TRUE(same_order);
+    
+    // Filtered fetch only copies accepted reads
+    auto none = reader.fetch_reads("chr17", 7577000, 7578000, [](const bam1_t*) { return false; });
+    EXPECT_TRUE(none.empty());
+    
+    for (auto* r : reads) {
+        bam_destroy1(r);
+    }
+}
+
+TEST_F(BamReaderTest, EstimateBytesGrowsWithTheRegion) {
+    BamReader reader(test_bam_path);
+    int tid = reader.tid("chr17");
+    
+    uint64_t small = reader.estimate_bytes(tid, 7577000, 7578000);
+    uint64_t large = reader.estimate_bytes(tid, 7500000, 7700000);
+    EXPECT_LE(small, large);
+    EXPECT_EQ(reader.estimate_bytes(-1, 0, 1000), 0u);
+}
+
 TEST_F(BamReaderTest, MoveConstructor) {
     BamReader reader1(test_bam_path);
     EXPECT_TRUE(reader1.is_open());
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "core/BamRecordPool.hpp"
+#include <string>
+#include <vector>
+
+using namespace InterSubMod;
+
+namespace {
+
+bam1_t* make_read(const std::string& name, const std::string& seq, int32_t pos) {
+    bam1_t* b = bam_init1();
+    uint32_t cigar = (static_cast<uint32_t>(seq.size()) << 4) | BAM_CMATCH;
+    bam_set1(b, name.size(), name.c_str(), 0, 0, pos, 60, 1, &cigar, -1, -1, 0,
+             seq.size(), seq.c_str(), nullptr, 0);
+    return b;
+}
+
+} // namespace
+
+TEST(BamRecordPoolTest, RecyclesRecordsAndTheirBuffers) {
+    bam1_t* long_read = make_read("long", std::string(400, 'A'), 100);
+    bam1_t* short_read = make_read("short", "ACGT", 200);
+
+    BamRecordPool pool;
+    std::vector<bam1_t*> records{pool.copy(long_read), pool.copy(short_read)};
+    EXPECT_EQ(pool.allocations(), 2u);
+    EXPECT_EQ(pool.reuses(), 0u);
+    EXPECT_EQ(records[0]->core.pos, 100);
+    EXPECT_STREQ(bam_get_qname(records[1]), "short");
+
+    pool.release(records);
+    EXPECT_TRUE(records.empty());
+    EXPECT_EQ(pool.pooled(), 2u);
+    EXPECT_GT(pool.pooled_bytes(), 0u);
+
+    // Copies are independent of the source and served from the pool
+    bam1_t* again = pool.copy(short_read);
+    EXPECT_EQ(pool.reuses(), 1u);
+    EXPECT_EQ(pool.allocations(), 2u);
+    EXPECT_EQ(again->core.pos, 200);
+    EXPECT_EQ(again->core.l_qseq, 4);
+    EXPECT_STREQ(bam_get_qname(again), "short");
+    EXPECT_NE(again->data, short_read->data);
+
+    // Records from the pool may still be freed directly
+    bam_destroy1(again);
+    EXPECT_EQ(pool.pooled(), 1u);
+
+    bam_destroy1(long_read);
+    bam_destroy1(short_read);
+}
+
+TEST(BamRecordPoolTest, DestroysRecordsBeyondByteLimit) {
+    bam1_t* read = make_read("r", std::string(1000, 'C'), 0);
+
+    bam1_t* probe = bam_dup1(read);
+    const size_t limit = probe->m_data + probe->m_data / 2;  // Room for one record
+    bam_destroy1(probe);
+
+    BamRecordPool pool(limit);
+    std::vector<bam1_t*> records{pool.copy(read), pool.copy(read), pool.copy(read)};
+    pool.release(records);
+    EXPECT_EQ(pool.pooled(), 1u);
+    EXPECT_LE(pool.pooled_bytes(), limit);
+
+    BamRecordPool moved(std::move(pool));
+    EXPECT_EQ(moved.pooled(), 1u);
+    EXPECT_EQ(pool.pooled(), 0u);
+
+    bam_destroy1(read);
+}
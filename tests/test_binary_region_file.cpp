@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "io/BinaryRegionFile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+using namespace InterSubMod;
+using namespace InterSubMod::BinaryFormat;
+
+namespace {
+
+struct RegionFixture {
+    SomaticSnv snv{};
+    MatrixBuilder builder;
+
+    explicit RegionFixture(int id, MatrixStorage storage = MatrixStorage::FLOAT32) {
+        builder.set_storage(storage);
+        snv.snv_id = id;
+        snv.chr_id = 17;
+        snv.pos = 1000 + id;
+        snv.ref_base = 'C';
+        snv.alt_base = 'T';
+        snv.qual = 42.5f;
+
+        for (int r = 0; r < 3; r++) {
+            ReadInfo info{};
+            info.read_id = r;
+            info.read_name = "read_" + std::to_string(id) + "_" + std::to_string(r);
+            info.chr_id = 17;
+            info.align_start = 900 + r;
+            info.align_end = 1900 + r;
+            info.mapq = 60;
+            info.hp_tag = r % 3;
+            info.is_tumor = (r != 2);
+            info.alt_support = (r == 0) ? AltSupport::ALT : AltSupport::UNKNOWN;
+            std::vector<MethylCall> calls;
+            if (r != 1) calls = {MethylCall(1001, 0.25f * r), MethylCall(1010 + id, 1.0f)};
+            builder.add_read(info, calls);
+        }
+        builder.finalize();
+    }
+
+    void write(BinaryRegionWriter& w, int region_id) {
+        w.write_region(snv, region_id, snv.pos - 100, snv.pos + 100, builder.get_reads(),
+                       builder.get_cpg_positions(), builder.get_matrix(), 12.5, 3.0);
+    }
+};
+
+std::string temp_path(const char* tag) {
+    return std::string("/tmp/ismr_test_") + tag + "_" + std::to_string(getpid()) + ".ismr";
+}
+
+} // namespace
+
+TEST(BinaryRegionFileTest, RoundTripFloat32) {
+    std::string path = temp_path("f32");
+    RegionFixture a(0), b(1);
+    {
+        BinaryRegionWriter w(path);
+        a.write(w, 0);
+        b.write(w, 5);
+        EXPECT_EQ(w.num_regions(), 2u);
+    }
+
+    BinaryRegionReader reader(path);
+    EXPECT_FALSE(reader.recovered());
+    ASSERT_EQ(reader.num_regions(), 2u);
+    ASSERT_EQ(reader.find(3), nullptr);
+    const RegionIndexEntry* e = reader.find(5);
+    ASSERT_NE(e, nullptr);
+
+    EXPECT_EQ(e->snv_pos, 1001);
+    EXPECT_EQ(e->ref_base, 'C');
+    EXPECT_EQ(e->num_reads, 3);
+    EXPECT_EQ(e->num_cpgs, b.builder.num_cpgs());
+    EXPECT_EQ(e->matrix_offset % kAlign, 0u);
+    EXPECT_EQ(e->cpg_offset % kAlign, 0u);
+    EXPECT_EQ(e->reads_offset % kAlign, 0u);
+
+    const int32_t* cpgs = reader.cpg_positions(*e);
+    for (int c = 0; c < e->num_cpgs; c++) {
+        EXPECT_EQ(cpgs[c], b.builder.get_cpg_positions()[c]);
+    }
+
+    const PackedRead* reads = reader.reads(*e);
+    EXPECT_EQ(reader.read_name(*e, 2), "read_1_2");
+    EXPECT_EQ(reads[0].alt_support, static_cast<int8_t>(AltSupport::ALT));
+    EXPECT_EQ(reads[2].is_tumor, 0);
+    EXPECT_EQ(reads[2].hp_tag, 2);
+
+    ASSERT_NE(reader.matrix_f32(*e), nullptr);
+    EXPECT_EQ(reader.matrix_u8(*e), nullptr);
+    auto m = b.builder.get_matrix();
+    for (int r = 0; r < e->num_reads; r++) {
+        for (int c = 0; c < e->num_cpgs; c++) {
+            EXPECT_FLOAT_EQ(reader.value(*e, r, c), m.at(r, c));
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryRegionFileTest, QuantizedMatrixUsesSentinel) {
+    std::string path = temp_path("u8");
+    RegionFixture a(0);
+    {
+        BinaryRegionWriter w(path, MatrixDType::UINT8);
+        a.write(w, 0);
+    }
+
+    BinaryRegionReader reader(path);
+    const RegionIndexEntry& e = reader.entry(0);
+    ASSERT_NE(reader.matrix_u8(e), nullptr);
+    auto m = a.builder.get_matrix();
+    for (int r = 0; r < e.num_reads; r++) {
+        for (int c = 0; c < e.num_cpgs; c++) {
+            if (m.at(r, c) < 0) {
+                EXPECT_EQ(reader.matrix_u8(e)[r * e.num_cpgs + c], kQuantNoCoverage);
+                EXPECT_EQ(reader.value(e, r, c), -1.0f);
+            } else {
+                EXPECT_NEAR(reader.value(e, r, c), m.at(r, c), 1.0 / 255.0 + 1e-6);  // 1.0 clamps to 254
+            }
+        }
+    }
+    EXPECT_EQ(quantize(1.0f), 254);
+    EXPECT_EQ(quantize(-1.0f), 255);
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryRegionFileTest, QuantizedBuilderWritesEitherDType) {
+    std::string path = temp_path("u8mem");
+    RegionFixture f(0), q(0, MatrixStorage::UINT8);
+    ASSERT_TRUE(q.builder.get_matrix().quantized());
+    {
+        BinaryRegionWriter w(path, MatrixDType::UINT8);
+        f.write(w, 0);  // Quantized by the writer
+        q.write(w, 1);  // Copied as-is
+    }
+    std::string path_f32 = temp_path("u8mem_f32");
+    {
+        BinaryRegionWriter w(path_f32);
+        q.write(w, 0);  // Decoded by the writer
+    }
+
+    BinaryRegionReader reader(path);
+    const RegionIndexEntry& a = reader.entry(0);
+    const RegionIndexEntry& b = reader.entry(1);
+    ASSERT_EQ(a.matrix_size, b.matrix_size);
+    EXPECT_EQ(std::memcmp(reader.matrix_u8(a), reader.matrix_u8(b), a.matrix_size), 0);
+    EXPECT_EQ(std::memcmp(reader.matrix_u8(b), q.builder.get_quantized().data(), b.matrix_size), 0);
+
+    BinaryRegionReader reader_f32(path_f32);
+    const RegionIndexEntry& c = reader_f32.entry(0);
+    ASSERT_NE(reader_f32.matrix_f32(c), nullptr);
+    for (int r = 0; r < c.num_reads; r++) {
+        for (int k = 0; k < c.num_cpgs; k++) {
+            EXPECT_FLOAT_EQ(reader_f32.value(c, r, k), reader.value(b, r, k));
+        }
+    }
+
+    std::remove(path.c_str());
+    std::remove(path_f32.c_str());
+}
+
+TEST(BinaryRegionFileTest, RecoversIndexWhenTrailerMissing) {
+    std::string path = temp_path("trunc");
+    RegionFixture a(0), b(1);
+    uint64_t blocks_end = 0;
+    {
+        BinaryRegionWriter w(path);
+        a.write(w, 0);
+        b.write(w, 1);
+    }
+    {
+        BinaryRegionReader reader(path);
+        blocks_end = reader.entry(1).block_offset + reader.entry(1).block_size;
+    }
+
+    // Simulate a crash before close(): drop the index and trailer
+    ASSERT_EQ(truncate(path.c_str(), blocks_end), 0);
+
+    BinaryRegionReader reader(path);
+    EXPECT_TRUE(reader.recovered());
+    ASSERT_EQ(reader.num_regions(), 2u);
+    EXPECT_EQ(reader.entry(1).region_id, 1);
+    EXPECT_EQ(reader.read_name(reader.entry(0), 0), "read_0_0");
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryRegionFileTest, RejectsNonRegionFiles) {
+    std::string path = temp_path("bad");
+    FILE* fp = std::fopen(path.c_str(), "wb");
+    std::string junk(200, 'x');
+    std::fwrite(junk.data(), 1, junk.size(), fp);
+    std::fclose(fp);
+
+    EXPECT_THROW(BinaryRegionReader reader(path), std::runtime_error);
+    EXPECT_THROW(BinaryRegionReader reader("/nonexistent/file.ismr"), std::runtime_error);
+
+    std::remove(path.c_str());
+}
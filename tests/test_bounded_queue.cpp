@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "utils/BoundedQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace InterSubMod::Utils;
+
+TEST(BoundedQueueTest, BlocksProducerWhenFull) {
+    BoundedQueue<int> q(2);
+    ASSERT_TRUE(q.push(1));
+    ASSERT_TRUE(q.push(2));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        q.push(3);
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());
+    EXPECT_EQ(q.size(), 2u);
+
+    int v = 0;
+    ASSERT_TRUE(q.pop(v));
+    EXPECT_EQ(v, 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+
+    QueueStats s = q.stats();
+    EXPECT_EQ(s.pushed, 3u);
+    EXPECT_EQ(s.popped, 1u);
+    EXPECT_EQ(s.push_stalls, 1u);
+    EXPECT_GT(s.push_stall_ms, 0.0);
+    EXPECT_EQ(s.max_depth, 2u);
+    EXPECT_EQ(s.capacity, 2u);
+}
+
+TEST(BoundedQueueTest, CloseDrainsThenStops) {
+    BoundedQueue<int> q(8);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(q.push(int(i)));
+    }
+    q.close();
+    EXPECT_FALSE(q.push(99));
+
+    std::vector<int> batch;
+    ASSERT_TRUE(q.pop_batch(batch, 3));
+    EXPECT_EQ(batch, (std::vector<int>{0, 1, 2}));
+    ASSERT_TRUE(q.pop_batch(batch, 3));
+    EXPECT_EQ(batch, (std::vector<int>{3, 4}));
+    EXPECT_FALSE(q.pop_batch(batch, 3));
+    EXPECT_TRUE(batch.empty());
+
+    // close() also wakes a consumer blocked on an empty queue
+    BoundedQueue<int> empty(1);
+    std::thread consumer([&] {
+        int v;
+        EXPECT_FALSE(empty.pop(v));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    empty.close();
+    consumer.join();
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "core/Clustering.hpp"
+#include "core/DistanceMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace InterSubMod;
+
+namespace {
+
+DistanceMatrix points_to_distances(const std::vector<std::pair<double, double>>& pts) {
+    DistanceMatrix dm;
+    dm.region_id = 3;
+    const int n = pts.size();
+    dm.dist_matrix.resize(n, n);
+    for (int i = 0; i < n; i++) {
+        dm.read_ids.push_back(i);
+        for (int j = 0; j < n; j++) {
+            dm.dist_matrix(i, j) = std::hypot(pts[i].first - pts[j].first, pts[i].second - pts[j].second);
+        }
+    }
+    return dm;
+}
+
+/**
+ * @brief Naive O(N^3) agglomeration; returns sorted merge heights.
+ */
+std::vector<double> naive_heights(const Eigen::MatrixXd& d0, LinkageMethod method) {
+    const int n = d0.rows();
+    Eigen::MatrixXd d = d0;
+    std::vector<int> size(n, 1);
+    std::vector<bool> alive(n, true);
+    std::vector<double> heights;
+
+    for (int step = 0; step < n - 1; step++) {
+        int bi = -1, bj = -1;
+        double best = 1e300;
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (alive[i] && alive[j] && d(i, j) < best) {
+                    best = d(i, j);
+                    bi = i;
+                    bj = j;
+                }
+            }
+        }
+        heights.push_back(best);
+        for (int k = 0; k < n; k++) {
+            if (!alive[k] || k == bi || k == bj) continue;
+            double v = 0.0;
+            double ni = size[bi], nj = size[bj], nk = size[k];
+            switch (method) {
+                case LinkageMethod::AVERAGE: v = (ni * d(bi, k) + nj * d(bj, k)) / (ni + nj); break;
+                case LinkageMethod::COMPLETE: v = std::max(d(bi, k), d(bj, k)); break;
+                case LinkageMethod::WARD:
+                    v = std::sqrt(((ni + nk) * d(bi, k) * d(bi, k) + (nj + nk) * d(bj, k) * d(bj, k)
+                                   - nk * best * best) / (ni + nj + nk));
+                    break;
+            }
+            d(bi, k) = d(k, bi) = v;
+        }
+        size[bi] += size[bj];
+        alive[bj] = false;
+    }
+    std::sort(heights.begin(), heights.end());
+    return heights;
+}
+
+} // namespace
+
+TEST(ClusteringTest, NnChainMatchesNaiveLinkage) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> u(0.0, 10.0);
+    std::vector<std::pair<double, double>> pts;
+    for (int i = 0; i < 60; i++) pts.emplace_back(u(rng), u(rng));
+    DistanceMatrix dm = points_to_distances(pts);
+
+    for (auto method : {LinkageMethod::AVERAGE, LinkageMethod::COMPLETE, LinkageMethod::WARD}) {
+        HierarchicalClustering hc(method);
+        const auto& merges = hc.fit(dm);
+        ASSERT_EQ(merges.size(), 59u);
+
+        auto expected = naive_heights(dm.dist_matrix, method);
+        for (size_t k = 0; k < merges.size(); k++) {
+            EXPECT_NEAR(merges[k].height, expected[k], 1e-9) << "method " << int(method) << " step " << k;
+            EXPECT_LT(merges[k].left, 60 + static_cast<int>(k));
+            EXPECT_LT(merges[k].right, 60 + static_cast<int>(k));
+        }
+        EXPECT_EQ(merges.back().size, 60);
+    }
+}
+
+TEST(ClusteringTest, CutsSeparateWellSeparatedGroups) {
+    std::vector<std::pair<double, double>> pts = {
+        {0, 0}, {0, 1}, {1, 0},          // group A
+        {100, 100}, {100, 101}, {101, 100}  // group B
+    };
+    DistanceMatrix dm = points_to_distances(pts);
+
+    HierarchicalClustering hc(LinkageMethod::AVERAGE);
+    hc.fit(dm);
+
+    EXPECT_EQ(hc.cut_k(2), (std::vector<int>{1, 1, 1, 2, 2, 2}));
+    EXPECT_EQ(hc.cut_height(10.0), (std::vector<int>{1, 1, 1, 2, 2, 2}));
+    EXPECT_EQ(hc.cut_k(1), (std::vector<int>(6, 1)));
+    EXPECT_EQ(hc.cut_height(0.0), (std::vector<int>{1, 2, 3, 4, 5, 6}));
+
+    auto s = HierarchicalClustering::silhouette(dm, hc.cut_k(2));
+    for (double v : s) {
+        EXPECT_GT(v, 0.95);
+    }
+    auto single = HierarchicalClustering::silhouette(dm, hc.cut_k(1));
+    for (double v : single) {
+        EXPECT_EQ(v, 0.0);
+    }
+}
+
+TEST(ClusteringTest, FisherExactKnownValues) {
+    FisherExactTest fisher(4);  // Table grows on demand
+    EXPECT_NEAR(fisher.two_sided(1, 9, 11, 3), 0.002759456, 1e-8);
+    EXPECT_NEAR(fisher.two_sided(3, 1, 1, 3), 0.4857143, 1e-6);
+    EXPECT_DOUBLE_EQ(fisher.two_sided(0, 0, 0, 0), 1.0);
+    EXPECT_NEAR(fisher.two_sided(5, 0, 0, 5), 0.007936508, 1e-8);
+}
+
+TEST(ClusteringTest, SummarizeCountsAndTestsPerCluster) {
+    std::vector<std::pair<double, double>> pts;
+    std::vector<ReadInfo> reads;
+    for (int i = 0; i < 10; i++) {
+        bool left = i < 5;
+        pts.emplace_back(left ? 0.0 : 50.0, i * 0.1);
+        ReadInfo r{};
+        r.read_id = i;
+        r.hp_tag = left ? 1 : 2;
+        r.is_tumor = true;
+        r.alt_support = left ? AltSupport::ALT : (i == 9 ? AltSupport::UNKNOWN : AltSupport::REF);
+        reads.push_back(r);
+    }
+    DistanceMatrix dm = points_to_distances(pts);
+
+    HierarchicalClustering hc(LinkageMethod::WARD);
+    hc.fit(dm);
+    ClusteringResult res = hc.summarize(dm, hc.cut_k(2), reads);
+
+    EXPECT_EQ(res.region_id, 3);
+    EXPECT_EQ(res.num_clusters, 2);
+    ASSERT_EQ(res.stats.size(), 2u);
+    const ClusterStats& a = res.stats.at(1);
+    EXPECT_EQ(a.size, 5);
+    EXPECT_EQ(a.count_hp1, 5);
+    EXPECT_EQ(a.count_hp2, 0);
+    EXPECT_EQ(a.count_alt, 5);
+    EXPECT_EQ(a.count_tumor, 5);
+    EXPECT_NEAR(a.p_value_hp, 0.007936508, 1e-8);
+
+    const ClusterStats& b = res.stats.at(2);
+    EXPECT_EQ(b.count_ref, 4);  // UNKNOWN excluded
+    EXPECT_NEAR(b.p_value_somatic, 1.0 / 126.0, 1e-9);  // [[0, 4], [5, 0]]
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "io/AsyncRegionWriter.hpp"
+#include "io/CompletionJournal.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+using namespace InterSubMod;
+using namespace InterSubMod::BinaryFormat;
+
+namespace {
+
+JournalEntry entry(const std::string& key, int region_id, bool success) {
+    JournalEntry e;
+    e.key = key;
+    e.region_id = region_id;
+    e.success = success;
+    e.checksum = success ? 0xabcdefULL : 0;
+    e.detail = success ? "regions.shard_000.ismr@64" : "no reads\tin window";
+    return e;
+}
+
+std::string journal_path(const std::string& name) {
+    return "/tmp/journal_test_" + name + "_" + std::to_string(getpid()) + ".journal";
+}
+
+} // namespace
+
+TEST(CompletionJournalTest, LastRecordPerKeyWinsAcrossRestarts) {
+    std::string path = journal_path("restart");
+    {
+        CompletionJournal journal(path, false);
+        journal.append({entry("chr1:100:C:T", 0, true), entry("chr1:200:G:A", 1, false)});
+        EXPECT_TRUE(journal.is_completed("chr1:100:C:T"));
+        EXPECT_FALSE(journal.is_completed("chr1:200:G:A"));
+    }
+    {
+        // Retried region succeeds on the second run
+        CompletionJournal journal(path, true);
+        EXPECT_EQ(journal.num_completed(), 1u);
+        EXPECT_EQ(journal.num_failed(), 1u);
+        journal.append({entry("chr1:200:G:A", 1, true)});
+    }
+    {
+        CompletionJournal journal(path, true);
+        EXPECT_TRUE(journal.is_completed("chr1:100:C:T"));
+        EXPECT_TRUE(journal.is_completed("chr1:200:G:A"));
+        EXPECT_EQ(journal.num_failed(), 0u);
+    }
+    {
+        // Without resume a run starts from scratch
+        CompletionJournal journal(path, false);
+        EXPECT_EQ(journal.num_completed(), 0u);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(CompletionJournalTest, TornLastLineIsDropped) {
+    std::string path = journal_path("torn");
+    {
+        CompletionJournal journal(path, false);
+        journal.append({entry("chr2:5:A:G", 3, true)});
+    }
+    {
+        std::ofstream ofs(path, std::ios::app);
+        ofs << "OK\tchr2:9:C:T\t4\t00";  // crash in the middle of a record
+    }
+    {
+        CompletionJournal journal(path, true);
+        EXPECT_TRUE(journal.is_completed("chr2:5:A:G"));
+        EXPECT_FALSE(journal.is_completed("chr2:9:C:T"));
+        journal.append({entry("chr2:9:C:T", 4, true)});
+    }
+    std::ifstream ifs(path);
+    std::string line;
+    int lines = 0;
+    while (std::getline(ifs, line)) {
+        EXPECT_TRUE(line.rfind("OK\t", 0) == 0) << line;
+        lines++;
+    }
+    EXPECT_EQ(lines, 2);
+    std::remove(path.c_str());
+}
+
+TEST(CompletionJournalTest, RegionKeyUsesCoordinates) {
+    SomaticSnv snv{};
+    snv.snv_id = 42;
+    snv.pos = 7578000;
+    snv.ref_base = 'C';
+    snv.alt_base = 'T';
+    EXPECT_EQ(CompletionJournal::region_key("chr17", snv), "chr17:7578000:C:T");
+}
+
+TEST(CompletionJournalTest, WriterJournalsBlocksAfterSync) {
+    std::string dir = "/tmp/journal_writer_test_" + std::to_string(getpid());
+    std::string path = journal_path("writer");
+    const int kRegions = 20;
+    {
+        CompletionJournal journal(path, false);
+        AsyncRegionWriter writer(dir, OutputFormat::BINARY, MatrixDType::FLOAT32, 2, 4, 3);
+        writer.set_journal(&journal);
+        for (int i = 0; i < kRegions; i++) {
+            RegionOutput out;
+            out.snv.snv_id = i;
+            out.snv.chr_id = 0;
+            out.snv.pos = 1000 + i;
+            out.snv.ref_base = 'C';
+            out.snv.alt_base = 'T';
+            out.region_id = i;
+            out.region_start = out.snv.pos - 10;
+            out.region_end = out.snv.pos + 10;
+            ReadInfo info{};
+            info.read_name = "r" + std::to_string(i);
+            out.matrix.add_read(info, {MethylCall(out.snv.pos, 0.25f)});
+            out.matrix.finalize();
+            out.journal_key = CompletionJournal::region_key("chr1", out.snv);
+            EXPECT_TRUE(writer.submit(std::move(out)));
+        }
+        writer.close();
+        EXPECT_TRUE(writer.errors().empty());
+        EXPECT_EQ(journal.num_completed(), static_cast<size_t>(kRegions));
+    }
+
+    // Every journaled location points at the block of that region
+    std::map<std::string, std::unique_ptr<BinaryRegionReader>> readers;
+    std::ifstream ifs(path);
+    std::string line;
+    int lines = 0;
+    while (std::getline(ifs, line)) {
+        std::istringstream fields(line);
+        std::string status, key, checksum, location;
+        int region_id = -1;
+        ASSERT_TRUE(fields >> status >> key >> region_id >> checksum >> location);
+        EXPECT_EQ(status, "OK");
+        EXPECT_EQ(key, "chr1:" + std::to_string(1000 + region_id) + ":C:T");
+        EXPECT_EQ(checksum.size(), 16u);
+
+        size_t at = location.find('@');
+        ASSERT_NE(at, std::string::npos);
+        std::string file = dir + "/" + location.substr(0, at);
+        uint64_t offset = std::stoull(location.substr(at + 1));
+        if (!readers.count(file)) {
+            readers[file] = std::make_unique<BinaryRegionReader>(file);
+        }
+        const BinaryRegionReader& reader = *readers[file];
+        bool found = false;
+        for (size_t i = 0; i < reader.num_regions(); i++) {
+            if (reader.entry(i).region_id == region_id) {
+                EXPECT_EQ(reader.entry(i).block_offset, offset);
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found) << line;
+        lines++;
+    }
+    EXPECT_EQ(lines, kRegions);
+
+    readers.clear();
+    for (int shard = 0; shard < 2; shard++) {
+        std::remove((dir + "/regions.shard_00" + std::to_string(shard) + ".ismr").c_str());
+    }
+    rmdir(dir.c_str());
+    std::remove(path.c_str());
+}
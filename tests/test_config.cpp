@@ -92,3 +92,27 @@ TEST(ArgParserTest, ParseArgumentsShortOptions) {
     std::remove("r.fa");
     std::remove("s.vcf");
 }
+
+TEST(ConfigTest, RegionAndShardSelection) {
+    Config config;
+    config.snv_regions = "chr1:1-50M,chr2";
+    config.shard = "2/8";
+    EXPECT_FALSE(config.validate());   // mutually exclusive (and paths missing)
+
+    create_dummy_file("t.bam");
+    create_dummy_file("r.fa");
+    create_dummy_file("s.vcf");
+    const char* argv[] = {"program", "-t", "t.bam", "-r", "r.fa", "-v", "s.vcf", "--shard", "3/16"};
+    Config parsed;
+    EXPECT_TRUE(Utils::ArgParser::parse(9, const_cast<char**>(argv), parsed));
+    EXPECT_EQ(parsed.shard, "3/16");
+
+    const char* argv_both[] = {"program", "-t", "t.bam", "-r", "r.fa", "-v", "s.vcf",
+                               "--shard", "3/16", "--regions", "chr1"};
+    Config rejected;
+    EXPECT_FALSE(Utils::ArgParser::parse(11, const_cast<char**>(argv_both), rejected));
+
+    std::remove("t.bam");
+    std::remove("r.fa");
+    std::remove("s.vcf");
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "core/CpGIndex.hpp"
+#include "core/IntervalIndex.hpp"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+using namespace InterSubMod;
+using namespace InterSubMod::CpGIndexFormat;
+
+namespace {
+
+std::string temp_path(const char* tag) {
+    return "/tmp/cpg_index_test_" + std::string(tag) + "_" + std::to_string(getpid());
+}
+
+/**
+ * @brief Writes a single-line-per-chromosome FASTA plus its .fai.
+ */
+void write_fasta(const std::string& path, const std::vector<std::pair<std::string, std::string>>& chroms) {
+    std::ofstream fa(path), fai(path + ".fai");
+    long offset = 0;
+    for (const auto& [name, seq] : chroms) {
+        fa << ">" << name << "\n" << seq << "\n";
+        offset += name.size() + 2;
+        fai << name << "\t" << seq.size() << "\t" << offset << "\t" << seq.size() << "\t" << seq.size() + 1 << "\n";
+        offset += seq.size() + 1;
+    }
+}
+
+} // namespace
+
+TEST(IntervalIndexTest, MergesAndAnswersPointQueries) {
+    std::string bed = temp_path("bed") + ".bed";
+    {
+        std::ofstream out(bed);
+        out << "track name=pmd\n# comment\n"
+            << "chr1\t100\t200\n"
+            << "chr1\t150\t250\textra\n"   // overlaps -> merged to [100, 250)
+            << "chr1\t250\t260\n"          // touches -> merged to [100, 260)
+            << "chr1\t500\t600\n"
+            << "chr2\t0\t10\n";
+    }
+    IntervalIndex index = IntervalIndex::load_bed(bed);
+    std::remove(bed.c_str());
+
+    const ChromIntervals* c1 = index.chrom("chr1");
+    ASSERT_NE(c1, nullptr);
+    ASSERT_EQ(c1->size(), 2u);
+    EXPECT_EQ(c1->start(0), 100);
+    EXPECT_EQ(c1->end(0), 260);
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(index.covered_bp(), 160 + 100 + 10);
+
+    EXPECT_FALSE(index.contains("chr1", 99));
+    EXPECT_TRUE(index.contains("chr1", 100));
+    EXPECT_TRUE(index.contains("chr1", 259));
+    EXPECT_FALSE(index.contains("chr1", 260));   // half-open
+    EXPECT_TRUE(index.contains("chr1", 599));
+    EXPECT_FALSE(index.contains("chr3", 5));
+    EXPECT_TRUE(c1->overlaps(255, 300));
+    EXPECT_FALSE(c1->overlaps(260, 500));
+
+    EXPECT_THROW(IntervalIndex::load_bed("/nonexistent.bed"), std::runtime_error);
+}
+
+TEST(CpGIndexTest, BuildsStableIdsAndAnnotations) {
+    std::string fa = temp_path("ref") + ".fa";
+    std::string out = temp_path("idx") + ".cpgi";
+    //                 0         1         2
+    //                 012345678901234567890123
+    std::string chr1 = "ACGTTcgAACGNNCGCGTTTTACG";
+    std::string chr2 = "TTTTCGTT";
+    write_fasta(fa, {{"chr1", chr1}, {"chrEmpty", "AAAA"}, {"chr2", chr2}});
+
+    IntervalIndex pmd;
+    pmd.add("chr1", 8, 14);   // covers C at 0-based 9 and 13
+    pmd.finalize();
+
+    CpGIndexBuilder builder(fa);
+    builder.set_annotation(CPG_IN_PMD, &pmd);
+    uint64_t n = builder.write(out, 2);
+
+    // chr1 CpGs (1-based): 2, 6, 10, 14, 16, 23 ; chr2: 5
+    EXPECT_EQ(n, 7u);
+    CpGIndex index(out);
+    EXPECT_EQ(index.num_sites(), 7u);
+    ASSERT_EQ(index.num_chroms(), 3u);
+    EXPECT_EQ(index.chr_name(1), "chrEmpty");
+    EXPECT_EQ(index.annotations(), CPG_IN_PMD);
+
+    CpGRange all = index.range("chr1", 1, 24);
+    ASSERT_EQ(all.count, 6u);
+    std::vector<int32_t> expected{2, 6, 10, 14, 16, 23};
+    for (size_t i = 0; i < all.count; i++) {
+        EXPECT_EQ(all.positions[i], expected[i]);
+        EXPECT_EQ(all.cpg_id(i), static_cast<int64_t>(i));
+    }
+
+    CpGRange mid = index.range("chr1", 6, 14);
+    ASSERT_EQ(mid.count, 3u);
+    EXPECT_EQ(mid.cpg_id(0), 1);
+    EXPECT_EQ(mid.flags[0], 0);
+    EXPECT_EQ(mid.flags[1], CPG_IN_PMD);
+    EXPECT_EQ(mid.flags[2], CPG_IN_PMD);
+
+    // Global ids continue across chromosomes in FASTA order
+    EXPECT_EQ(index.cpg_id("chr2", 5), 6);
+    EXPECT_EQ(index.cpg_id("chr2", 6), -1);
+    EXPECT_EQ(index.range("chrEmpty", 1, 4).count, 0u);
+    EXPECT_EQ(index.range("chrX", 1, 4).count, 0u);
+
+    std::vector<int64_t> ids;
+    index.lookup_ids("chr1", {2, 3, 14, 23}, ids);
+    EXPECT_EQ(ids, (std::vector<int64_t>{0, -1, 3, 5}));
+
+    auto sites = index.sites("chr1", 10, 16);
+    ASSERT_EQ(sites.size(), 3u);
+    EXPECT_EQ(sites[0].cpg_id, 2);
+    EXPECT_EQ(sites[0].chr_id, 0);
+    EXPECT_TRUE(sites[0].in_pmd);
+    EXPECT_FALSE(sites[2].in_pmd);
+
+    std::remove(fa.c_str());
+    std::remove((fa + ".fai").c_str());
+    std::remove(out.c_str());
+}
+
+TEST(CpGIndexTest, RejectsForeignFiles) {
+    std::string path = temp_path("bad");
+    {
+        std::ofstream out(path);
+        out << std::string(128, 'x');
+    }
+    EXPECT_THROW(CpGIndex index(path), std::runtime_error);
+    EXPECT_THROW(CpGIndex index("/nonexistent.cpgi"), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "core/DistanceMatrix.hpp"
+#include "core/DistanceKernels.hpp"
+#include "core/MethylationMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace InterSubMod;
+
+namespace {
+
+MethylationMatrix random_matrix(int reads, int sites, double missing_rate, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+
+    MethylationMatrix m;
+    m.region_id = 7;
+    m.raw_matrix.resize(reads, sites);
+    m.binary_matrix.resize(reads, sites);
+    for (int r = 0; r < reads; r++) {
+        m.read_ids.push_back(r);
+        for (int c = 0; c < sites; c++) {
+            if (u(rng) < missing_rate) {
+                m.raw_matrix(r, c) = std::nan("");
+                m.binary_matrix(r, c) = -1;
+            } else {
+                double p = u(rng);
+                m.raw_matrix(r, c) = p;
+                m.binary_matrix(r, c) = p >= 0.5 ? 1 : 0;
+            }
+        }
+    }
+    for (int c = 0; c < sites; c++) m.cpg_ids.push_back(c);
+    return m;
+}
+
+/**
+ * @brief Straightforward per-pair reference implementation.
+ */
+double naive_distance(const MethylationMatrix& m, int i, int j, DistanceMetricType type, int min_cov, double fallback) {
+    std::vector<double> a, b;
+    std::vector<int> ba, bb;
+    const bool binary = (type == DistanceMetricType::NHD || type == DistanceMetricType::JACCARD);
+    for (int c = 0; c < m.num_sites(); c++) {
+        if (binary) {
+            if (m.binary_matrix(i, c) < 0 || m.binary_matrix(j, c) < 0) continue;
+            ba.push_back(m.binary_matrix(i, c));
+            bb.push_back(m.binary_matrix(j, c));
+        } else {
+            if (std::isnan(m.raw_matrix(i, c)) || std::isnan(m.raw_matrix(j, c))) continue;
+            a.push_back(m.raw_matrix(i, c));
+            b.push_back(m.raw_matrix(j, c));
+        }
+    }
+    const int n = binary ? ba.size() : a.size();
+    if (n < std::max(min_cov, 1)) return fallback;
+
+    double sum = 0.0;
+    switch (type) {
+        case DistanceMetricType::NHD:
+            for (int k = 0; k < n; k++) sum += (ba[k] != bb[k]);
+            return sum / n;
+        case DistanceMetricType::JACCARD: {
+            int inter = 0, uni = 0;
+            for (int k = 0; k < n; k++) {
+                inter += (ba[k] && bb[k]);
+                uni += (ba[k] || bb[k]);
+            }
+            return uni == 0 ? 0.0 : 1.0 - static_cast<double>(inter) / uni;
+        }
+        case DistanceMetricType::L1:
+            for (int k = 0; k < n; k++) sum += std::fabs(a[k] - b[k]);
+            return sum / n;
+        case DistanceMetricType::L2:
+            for (int k = 0; k < n; k++) sum += (a[k] - b[k]) * (a[k] - b[k]);
+            return std::sqrt(sum / n);
+        case DistanceMetricType::CORR: {
+            double ma = 0, mb = 0;
+            for (int k = 0; k < n; k++) { ma += a[k]; mb += b[k]; }
+            ma /= n; mb /= n;
+            double cov = 0, va = 0, vb = 0;
+            for (int k = 0; k < n; k++) {
+                cov += (a[k] - ma) * (b[k] - mb);
+                va += (a[k] - ma) * (a[k] - ma);
+                vb += (b[k] - mb) * (b[k] - mb);
+            }
+            return 1.0 - cov / std::sqrt(va * vb);
+        }
+    }
+    return fallback;
+}
+
+/**
+ * @brief Custom metric policy: largest absolute difference over common sites.
+ */
+struct Chebyshev {
+    static constexpr bool kBinary = false;
+    static constexpr double kMaxDistance = 1.0;
+    static double from_rows(const float* a, const float* b, const float* wa, const float* wb, int m, int /*common*/) {
+        float best = 0.0f;
+        #pragma omp simd reduction(max:best)
+        for (int k = 0; k < m; k++) {
+            best = std::max(best, wa[k] * wb[k] * std::fabs(a[k] - b[k]));
+        }
+        return best;
+    }
+};
+
+} // namespace
+
+TEST(DistanceMatrixTest, MatchesNaiveForAllMetrics) {
+    // > 64 sites and enough reads for several tiles and the parallel path
+    auto m = random_matrix(150, 130, 0.4, 11);
+
+    for (auto type : {DistanceMetricType::NHD, DistanceMetricType::JACCARD, DistanceMetricType::L1,
+                      DistanceMetricType::L2, DistanceMetricType::CORR}) {
+        DistanceMatrix dm;
+        dm.compute_from_methylation(m, type, 3, NanDistanceStrategy::MAX_DIST);
+        ASSERT_EQ(dm.dist_matrix.rows(), 150);
+        EXPECT_EQ(dm.region_id, 7);
+        EXPECT_EQ(dm.read_ids.size(), 150u);
+
+        double fallback = type == DistanceMetricType::CORR ? 2.0 : 1.0;
+        for (int i = 0; i < 150; i++) {
+            EXPECT_EQ(dm.dist_matrix(i, i), 0.0);
+            for (int j = i + 1; j < 150; j++) {
+                double expected = naive_distance(m, i, j, type, 3, fallback);
+                ASSERT_NEAR(dm.dist_matrix(i, j), expected, 1e-5) << "metric " << int(type) << " pair " << i << "," << j;
+                ASSERT_EQ(dm.dist_matrix(i, j), dm.dist_matrix(j, i));
+            }
+        }
+    }
+}
+
+TEST(DistanceMatrixTest, InsufficientOverlapFollowsNanStrategy) {
+    MethylationMatrix m;
+    m.region_id = 1;
+    m.read_ids = {0, 1};
+    m.cpg_ids = {0, 1, 2};
+    m.binary_matrix.resize(2, 3);
+    m.binary_matrix << 1, 0, -1,
+                       1, -1, 0;   // One common site
+    m.raw_matrix = m.binary_matrix.cast<double>();
+
+    DistanceMatrix dm;
+    dm.compute_from_methylation(m, DistanceMetricType::NHD, 2, NanDistanceStrategy::MAX_DIST);
+    EXPECT_EQ(dm.dist_matrix(0, 1), 1.0);
+    EXPECT_EQ(dm.min_common_coverage, 2);
+
+    dm.compute_from_methylation(m, DistanceMetricType::NHD, 2, NanDistanceStrategy::SKIP);
+    EXPECT_TRUE(std::isnan(dm.dist_matrix(0, 1)));
+    EXPECT_EQ(dm.dist_matrix(0, 0), 0.0);
+
+    dm.compute_from_methylation(m, DistanceMetricType::NHD, 1, NanDistanceStrategy::SKIP);
+    EXPECT_EQ(dm.dist_matrix(0, 1), 0.0);
+}
+
+TEST(DistanceMatrixTest, TemplatedKernelMatchesRuntimeDispatch) {
+    auto m = random_matrix(90, 70, 0.5, 5);
+
+    DistanceMatrix runtime, templated;
+    runtime.compute_from_methylation(m, DistanceMetricType::JACCARD, 4, NanDistanceStrategy::SKIP);
+    templated.compute<DistanceKernels::Jaccard, DistanceKernels::Skip>(m, 4);
+    for (int i = 0; i < 90; i++) {
+        for (int j = 0; j < 90; j++) {
+            const double a = runtime.dist_matrix(i, j);
+            const double b = templated.dist_matrix(i, j);
+            ASSERT_TRUE((std::isnan(a) && std::isnan(b)) || a == b) << i << "," << j;
+        }
+    }
+
+    runtime.compute_from_methylation(m, DistanceMetricType::CORR, 4, NanDistanceStrategy::MAX_DIST);
+    templated.compute<DistanceKernels::Corr, DistanceKernels::MaxDist>(m, 4);
+    EXPECT_TRUE(runtime.dist_matrix.isApprox(templated.dist_matrix));
+    EXPECT_EQ(templated.read_ids.size(), 90u);
+}
+
+TEST(DistanceMatrixTest, CustomMetricPolicy) {
+    auto m = random_matrix(40, 50, 0.3, 9);
+
+    DistanceMatrix dm;
+    dm.compute<Chebyshev, DistanceKernels::MaxDist>(m, 3);
+    for (int i = 0; i < 40; i++) {
+        for (int j = i + 1; j < 40; j++) {
+            double expected = 0.0;
+            int common = 0;
+            for (int c = 0; c < 50; c++) {
+                if (std::isnan(m.raw_matrix(i, c)) || std::isnan(m.raw_matrix(j, c))) continue;
+                expected = std::max(expected, std::fabs(m.raw_matrix(i, c) - m.raw_matrix(j, c)));
+                common++;
+            }
+            if (common < 3) expected = 1.0;
+            ASSERT_NEAR(dm.dist_matrix(i, j), expected, 1e-6) << i << "," << j;
+            ASSERT_EQ(dm.dist_matrix(i, j), dm.dist_matrix(j, i));
+        }
+    }
+}
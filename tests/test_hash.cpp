@@ -0,0 +1,18 @@
+#include <gtest/gtest.h>
+#include "utils/Hash.hpp"
+#include <string>
+
+using namespace InterSubMod::Utils;
+
+TEST(HashTest, Fnv1a64MatchesReferenceVectors) {
+    EXPECT_EQ(fnv1a64(""), 0xcbf29ce484222325ULL);
+    EXPECT_EQ(fnv1a64("a"), 0xaf63dc4c8601ec8cULL);
+    EXPECT_EQ(fnv1a64("foobar"), 0x85944171f73967e8ULL);
+}
+
+TEST(HashTest, Fnv1a64HashesInPieces) {
+    const std::string whole = "chr17:7577000-7579000";
+    uint64_t h = fnv1a64(whole.substr(0, 5));
+    h = fnv1a64(whole.data() + 5, whole.size() - 5, h);
+    EXPECT_EQ(h, fnv1a64(whole));
+}
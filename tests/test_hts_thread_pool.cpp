@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "core/HtsThreadPool.hpp"
+#include "core/ThreadResourcePool.hpp"
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+using namespace InterSubMod;
+
+TEST(HtsThreadPoolTest, StartsPoolOfRequestedSize) {
+    HtsThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3);
+    ASSERT_NE(pool.get(), nullptr);
+    EXPECT_NE(pool.get()->pool, nullptr);
+
+    EXPECT_THROW(HtsThreadPool(0), std::runtime_error);
+    EXPECT_THROW(HtsThreadPool(-2), std::runtime_error);
+}
+
+TEST(HtsThreadPoolTest, ResourcePoolAcceptsOnePool) {
+    ThreadResourcePool resources("tumor.bam", "", "ref.fa", 2);
+    EXPECT_EQ(resources.decompression_pool(), nullptr);
+
+    auto pool = std::make_shared<HtsThreadPool>(2);
+    resources.set_decompression_pool(pool);  // No reader open yet: nothing touches the files
+    EXPECT_EQ(resources.decompression_pool(), pool);
+    EXPECT_THROW(resources.set_decompression_pool(std::make_shared<HtsThreadPool>(2)), std::runtime_error);
+}
+
+// Integration test - requires actual BAM data
+TEST(HtsThreadPoolTest, SharedPoolReadersSeeSameReads) {
+    const std::string bam_path = "/big8_disk/liaoyoyo2001/InterSubMod/data/bam/test.bam";
+    if (!std::filesystem::exists(bam_path)) {
+        GTEST_SKIP() << "Test BAM not found";
+    }
+
+    BamReader inline_reader(bam_path);
+    int64_t expected = inline_reader.for_each_read("chr17", 7570000, 7590000, [](const bam1_t*) { return true; });
+
+    auto pool = std::make_shared<HtsThreadPool>(4);
+    ThreadResourcePool resources(bam_path, bam_path, "", 2);
+    resources.set_decompression_pool(pool);
+    for (int slot = 0; slot < 2; slot++) {
+        EXPECT_EQ(resources.tumor_bam(slot).for_each_read("chr17", 7570000, 7590000,
+                                                          [](const bam1_t*) { return true; }), expected);
+        EXPECT_EQ(resources.normal_bam(slot)->for_each_read("chr17", 7570000, 7590000,
+                                                            [](const bam1_t*) { return true; }), expected);
+    }
+}
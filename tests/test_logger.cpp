@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "utils/Logger.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace InterSubMod::Utils;
+
+namespace {
+
+std::vector<std::string> read_lines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line)) lines.push_back(line);
+    return lines;
+}
+
+size_t count_containing(const std::vector<std::string>& lines, const std::string& needle) {
+    size_t n = 0;
+    for (const auto& l : lines) {
+        if (l.find(needle) != std::string::npos) n++;
+    }
+    return n;
+}
+
+} // namespace
+
+TEST(LoggerTest, MessagesFromManyThreadsReachTheFile) {
+    std::string path = "/tmp/logger_test_threads_" + std::to_string(getpid()) + ".log";
+    Logger& logger = Logger::instance();
+    logger.set_log_file(path);
+
+    const int kThreads = 8, kPerThread = 100;  // below the per-thread ring capacity
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kPerThread; i++) {
+                Logger::warning("threads-test " + std::to_string(t) + "/" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    logger.flush();
+    logger.set_log_file("");
+
+    std::vector<std::string> lines = read_lines(path);
+    EXPECT_EQ(count_containing(lines, "threads-test "), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(count_containing(lines, "[WARNING] threads-test 3/99"), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(LoggerTest, LevelFilterAndStreamApi) {
+    std::string path = "/tmp/logger_test_levels_" + std::to_string(getpid()) + ".log";
+    Logger& logger = Logger::instance();
+    logger.set_log_file(path);
+
+    logger.set_log_level(LogLevel::L_WARNING);
+    EXPECT_FALSE(Logger::enabled(LogLevel::L_INFO));
+    Logger::info("levels-test hidden");
+    logger << "levels-test " << 42 << " streamed";
+    logger.end_log(LogLevel::L_ERROR);
+    logger.set_log_level(LogLevel::L_INFO);
+    logger.flush();
+    logger.set_log_file("");
+
+    std::vector<std::string> lines = read_lines(path);
+    EXPECT_EQ(count_containing(lines, "levels-test hidden"), 0u);
+    EXPECT_EQ(count_containing(lines, "[ERROR] levels-test 42 streamed"), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(LoggerTest, FullRingDropsAndCounts) {
+    std::string path = "/tmp/logger_test_overflow_" + std::to_string(getpid()) + ".log";
+    Logger& logger = Logger::instance();
+    logger.set_log_file(path);
+
+    const uint64_t dropped_before = logger.dropped();
+    const size_t kMessages = Logger::kRingCapacity * 4;
+    std::thread writer([&] {
+        for (size_t i = 0; i < kMessages; i++) {
+            Logger::warning("overflow-test " + std::to_string(i));
+        }
+    });
+    writer.join();
+    logger.flush();
+    logger.set_log_file("");
+
+    // Never blocks: whatever did not fit is counted, the rest is written
+    uint64_t dropped = logger.dropped() - dropped_before;
+    std::vector<std::string> lines = read_lines(path);
+    EXPECT_EQ(count_containing(lines, "overflow-test "), kMessages - dropped);
+    if (dropped > 0) {
+        EXPECT_EQ(count_containing(lines, "Logger dropped"), 1u);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(LoggerTest, DebugIsCompiledOutInReleaseBuilds) {
+    Logger::instance().set_log_level(LogLevel::L_DEBUG);
+#ifdef NDEBUG
+    EXPECT_EQ(kMinCompiledLogLevel, LogLevel::L_INFO);
+    EXPECT_FALSE(Logger::enabled(LogLevel::L_DEBUG));  // even at runtime level DEBUG
+#else
+    EXPECT_EQ(kMinCompiledLogLevel, LogLevel::L_DEBUG);
+    EXPECT_TRUE(Logger::enabled(LogLevel::L_DEBUG));
+#endif
+    int evaluated = 0;
+    auto message = [&] { evaluated++; return std::string("debug-test"); };
+    Logger::instance().set_log_level(LogLevel::L_INFO);
+    ISM_LOG_DEBUG(message());
+    EXPECT_EQ(evaluated, 0);  // runtime level filters before the argument is built
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "core/MatrixBuilder.hpp"
+
+using namespace InterSubMod;
+
+namespace {
+
+ReadInfo make_read(int id) {
+    ReadInfo info{};
+    info.read_id = id;
+    info.read_name = "read" + std::to_string(id);
+    info.alt_support = AltSupport::UNKNOWN;
+    return info;
+}
+
+} // namespace
+
+TEST(MatrixBuilderTest, BuildsSortedColumnsAndDenseMatrix) {
+    MatrixBuilder builder;
+    builder.add_read(make_read(0), {MethylCall(300, 0.5f), MethylCall(100, 1.0f)});
+    builder.add_read(make_read(1), {});
+    builder.add_read(make_read(2), {MethylCall(200, 0.25f), MethylCall(300, 0.0f)});
+    builder.finalize();
+
+    ASSERT_EQ(builder.num_reads(), 3);
+    ASSERT_EQ(builder.num_cpgs(), 3);
+    EXPECT_EQ(builder.get_cpg_positions(), (std::vector<int32_t>{100, 200, 300}));
+
+    auto m = builder.get_matrix();
+    ASSERT_EQ(m.size(), 3u);
+    ASSERT_EQ(m[0].size(), 3u);
+    EXPECT_DOUBLE_EQ(m[0][0], 1.0);
+    EXPECT_DOUBLE_EQ(m[0][1], -1.0);
+    EXPECT_DOUBLE_EQ(m[0][2], 0.5);
+    for (size_t c = 0; c < 3; c++) {
+        EXPECT_DOUBLE_EQ(m[1][c], -1.0);
+    }
+    EXPECT_DOUBLE_EQ(m[2][0], -1.0);
+    EXPECT_DOUBLE_EQ(m[2][1], 0.25);
+    EXPECT_DOUBLE_EQ(m[2][2], 0.0);
+
+    size_t rows_visited = 0;
+    for (auto row : m) {
+        EXPECT_EQ(row.size(), 3u);
+        rows_visited++;
+    }
+    EXPECT_EQ(rows_visited, 3u);
+}
+
+TEST(MatrixBuilderTest, CsrMatchesDense) {
+    MatrixBuilder builder;
+    builder.add_read(make_read(0), {MethylCall(10, 0.1f), MethylCall(30, 0.3f)});
+    builder.add_read(make_read(1), {MethylCall(20, 0.2f)});
+    builder.finalize();
+
+    const CsrMatrix& csr = builder.get_csr();
+    EXPECT_EQ(csr.num_rows, 2);
+    EXPECT_EQ(csr.num_cols, 3);
+    EXPECT_EQ(csr.row_ptr, (std::vector<int32_t>{0, 2, 3}));
+    EXPECT_EQ(csr.col_idx, (std::vector<int32_t>{0, 2, 1}));
+    ASSERT_EQ(csr.nnz(), 3u);
+
+    const auto& dense = builder.get_dense();
+    for (int r = 0; r < csr.num_rows; r++) {
+        for (int32_t k = csr.row_ptr[r]; k < csr.row_ptr[r + 1]; k++) {
+            EXPECT_FLOAT_EQ(dense[r * csr.num_cols + csr.col_idx[k]], csr.values[k]);
+        }
+    }
+}
+
+TEST(MatrixBuilderTest, DuplicatePositionKeepsLastCall) {
+    MatrixBuilder builder;
+    builder.add_read(make_read(0), {MethylCall(50, 0.2f), MethylCall(50, 0.9f)});
+    builder.finalize();
+
+    ASSERT_EQ(builder.num_cpgs(), 1);
+    EXPECT_FLOAT_EQ(builder.get_dense()[0], 0.9f);
+    EXPECT_EQ(builder.get_csr().nnz(), 1u);
+}
+
+TEST(MatrixBuilderTest, AddAfterFinalizeThrowsAndClearResets) {
+    MatrixBuilder builder;
+    builder.add_read(make_read(0), {MethylCall(1, 0.5f)});
+    builder.finalize();
+    EXPECT_THROW(builder.add_read(make_read(1), {}), std::runtime_error);
+
+    builder.clear();
+    EXPECT_EQ(builder.num_reads(), 0);
+    EXPECT_EQ(builder.num_cpgs(), 0);
+    EXPECT_TRUE(builder.get_matrix().empty());
+
+    builder.add_read(make_read(0), {});
+    builder.finalize();
+    EXPECT_EQ(builder.num_reads(), 1);
+    EXPECT_EQ(builder.num_cpgs(), 0);
+}
+
+TEST(MatrixBuilderTest, Uint8StorageQuantizesCsrAndDense) {
+    MatrixBuilder builder;
+    builder.set_storage(MatrixStorage::UINT8);
+    builder.add_read(make_read(0), {MethylCall(300, 0.5f), MethylCall(100, 1.0f)});
+    builder.add_read(make_read(1), {MethylCall(200, 20 / 255.0f)});
+    builder.finalize();
+
+    EXPECT_TRUE(builder.get_dense().empty());
+    ASSERT_EQ(builder.get_quantized().size(), 6u);
+    EXPECT_EQ(builder.get_quantized(), (std::vector<uint8_t>{254, 255, 128, 255, 20, 255}));
+    EXPECT_EQ(builder.get_csr().nnz(), 3u);
+    EXPECT_TRUE(builder.get_csr().values.empty());
+    EXPECT_EQ(builder.get_csr().quant_values, (std::vector<uint8_t>{254, 128, 20}));
+
+    auto m = builder.get_matrix();
+    ASSERT_TRUE(m.quantized());
+    EXPECT_EQ(m.byte_size(), 6u);
+    EXPECT_DOUBLE_EQ(m[0][1], -1.0);
+    EXPECT_FLOAT_EQ(m.at(1, 1), 20 / 255.0f);
+    EXPECT_FLOAT_EQ(m[0][2], 128 / 255.0f);
+
+    // Storage survives clear(); switching back takes effect at the next finalize()
+    builder.clear();
+    builder.set_storage(MatrixStorage::FLOAT32);
+    builder.add_read(make_read(0), {MethylCall(100, 0.5f)});
+    builder.finalize();
+    EXPECT_TRUE(builder.get_quantized().empty());
+    EXPECT_FALSE(builder.get_matrix().quantized());
+    EXPECT_FLOAT_EQ(builder.get_dense()[0], 0.5f);
+}
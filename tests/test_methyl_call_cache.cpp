@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "core/MethylCallCache.hpp"
+#include "BamTestRecords.hpp"
+#include <string>
+#include <vector>
+
+using namespace InterSubMod;
+
+namespace {
+
+bam1_t* make_record(const std::string& name, int32_t pos, const std::string& seq, const std::string& mm,
+                    const std::vector<uint8_t>& ml) {
+    return Testing::make_record(pos, {Testing::op(seq.size(), BAM_CMATCH)}, seq, mm, ml, name);
+}
+
+// Reference with a CpG every 5 bp; the read matches it from position 0 and
+// reports every C as modified
+struct Fixture {
+    std::string ref;
+    std::string mm = "C+m?";
+    std::vector<uint8_t> ml;
+
+    explicit Fixture(int n) {
+        for (int i = 0; i < n; i++) {
+            ref += "ACGTT";
+            mm += ",0";
+            ml.push_back(static_cast<uint8_t>(i % 256));
+        }
+        mm += ";";
+    }
+};
+
+} // namespace
+
+TEST(MethylCallCacheTest, SlicesMatchPerWindowParsing) {
+    Fixture f(200);  // 1000 bp, CpGs at 5k + 1
+    bam1_t* b = make_record("read", 0, f.ref, f.mm, f.ml);
+    AlignmentView aln(b);
+
+    MethylationParser parser;
+    MethylCallCache cache(1 << 20);
+    std::vector<MethylCall> expected, sliced;
+    int parses = 0;
+    for (int32_t start : {0, 37, 250, 251, 600, 990}) {
+        int32_t end = std::min<int32_t>(start + 100, f.ref.size());
+        std::string_view window = std::string_view(f.ref).substr(start, end - start);
+        parser.parse_read(b, aln, window, start, expected);
+
+        // Positions whose CpG context the window can judge: [start, start + size - 1)
+        const auto& all = cache.calls_for(b, true, start, start + static_cast<int32_t>(window.size()) - 1,
+                                          0, static_cast<int32_t>(f.ref.size()) - 1, [&](std::vector<MethylCall>& out) {
+                                              parses++;
+                                              parser.parse_read(b, aln, f.ref, 0, out);
+                                          });
+        MethylCallCache::slice(all, start, start + static_cast<int32_t>(window.size()) - 1, sliced);
+
+        ASSERT_EQ(sliced.size(), expected.size()) << "window " << start;
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_EQ(sliced[i].ref_pos, expected[i].ref_pos);
+            EXPECT_EQ(sliced[i].probability, expected[i].probability);
+        }
+    }
+    EXPECT_EQ(parses, 1);
+    EXPECT_EQ(cache.stats().misses, 1u);
+    EXPECT_EQ(cache.stats().hits, 5u);
+    EXPECT_EQ(cache.size(), 1u);
+
+    // The normal BAM's copy of the same read is a different entry
+    cache.calls_for(b, false, 0, 10, 0, 999, [&](std::vector<MethylCall>& out) { parser.parse_read(b, aln, f.ref, 0, out); });
+    EXPECT_EQ(cache.stats().misses, 2u);
+    EXPECT_EQ(cache.size(), 2u);
+
+    bam_destroy1(b);
+}
+
+TEST(MethylCallCacheTest, ReparsesOutsideSpanAndEvictsLeastRecentlyUsed) {
+    Fixture f(100);
+    bam1_t* a = make_record("a", 0, f.ref, f.mm, f.ml);
+    bam1_t* b = make_record("b", 0, f.ref, f.mm, f.ml);
+    bam1_t* c = make_record("c", 0, f.ref, f.mm, f.ml);
+    AlignmentView aln(a);  // Same CIGAR for all three
+    MethylationParser parser;
+    auto parse = [&](const bam1_t* r, int32_t span_hi) {
+        return [&parser, &aln, &f, r, span_hi](std::vector<MethylCall>& out) {
+            parser.parse_read(r, aln, std::string_view(f.ref).substr(0, span_hi + 1), 0, out);
+        };
+    };
+
+    MethylCallCache cache(1 << 20);
+    // Parsed over [0, 199): a window reaching beyond that span re-parses
+    EXPECT_EQ(cache.calls_for(a, true, 0, 100, 0, 199, parse(a, 199)).size(), 40u);
+    EXPECT_EQ(cache.calls_for(a, true, 300, 400, 0, 499, parse(a, 499)).size(), 100u);
+    EXPECT_EQ(cache.stats().misses, 2u);
+    EXPECT_EQ(cache.size(), 1u);
+
+    // Budget for roughly two entries: the least recently used one goes
+    cache.calls_for(b, true, 0, 10, 0, 499, parse(b, 499));
+    cache.set_capacity(cache.bytes());
+    cache.calls_for(a, true, 0, 10, 0, 499, parse(a, 499));  // Hit, a becomes most recent
+    cache.calls_for(c, true, 0, 10, 0, 499, parse(c, 499));  // Evicts b
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_GE(cache.stats().evictions, 1u);
+    const uint64_t misses = cache.stats().misses;
+    cache.calls_for(a, true, 0, 10, 0, 499, parse(a, 499));
+    EXPECT_EQ(cache.stats().misses, misses);
+    cache.calls_for(b, true, 0, 10, 0, 499, parse(b, 499));
+    EXPECT_EQ(cache.stats().misses, misses + 1);
+
+    cache.set_capacity(0);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(cache.enabled());
+
+    bam_destroy1(a);
+    bam_destroy1(b);
+    bam_destroy1(c);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "core/DistanceMatrix.hpp"
+#include "core/MethylationMatrix.hpp"
+#include "core/MethylQuant.hpp"
+#include <cmath>
+
+using namespace InterSubMod;
+
+TEST(MethylQuantTest, MlValuesRoundTrip) {
+    for (int ml = 0; ml < 255; ml++) {
+        EXPECT_EQ(Quant::encode(ml / 255.0f), ml);
+        EXPECT_EQ(Quant::decode(static_cast<uint8_t>(ml)), ml / 255.0f);
+    }
+    EXPECT_EQ(Quant::encode(1.0f), 254);  // 255 is reserved
+    EXPECT_EQ(Quant::encode(-1.0f), Quant::kNoCoverage);
+    EXPECT_EQ(Quant::decode(Quant::kNoCoverage), -1.0f);
+}
+
+TEST(MethylQuantTest, ThresholdsMatchFloatComparison) {
+    const double pairs[][2] = {{0.8, 0.2}, {0.5, 0.5}, {0.9, 0.1}, {0.7529411764705882, 0.0}, {1.0, -0.1}};
+    for (const auto& p : pairs) {
+        Quant::BinaryThresholds t(p[0], p[1]);
+        for (int q = 0; q < 255; q++) {
+            const double prob = Quant::decode(static_cast<uint8_t>(q));
+            const int expected = prob >= p[0] ? 1 : (prob <= p[1] ? 0 : -1);
+            EXPECT_EQ(t.call(static_cast<uint8_t>(q)), expected) << "q=" << q << " high=" << p[0];
+        }
+        EXPECT_EQ(t.call(Quant::kNoCoverage), -1);
+    }
+}
+
+TEST(MethylQuantTest, QuantizedMatrixMatchesFloatDistances) {
+    MatrixBuilder builder;
+    for (int r = 0; r < 12; r++) {
+        ReadInfo info{};
+        info.read_id = r;
+        std::vector<MethylCall> calls;
+        for (int c = 0; c < 40; c++) {
+            if ((r * 7 + c * 3) % 5 == 0) continue;  // Missing
+            calls.emplace_back(100 + c, ((r * 31 + c * 17) % 255) / 255.0f);
+        }
+        builder.add_read(info, calls);
+    }
+    builder.finalize();
+
+    MethylationMatrix quant;
+    quant.set_quantized(builder.get_matrix(), 0.8, 0.2);
+    ASSERT_TRUE(quant.is_quantized());
+    ASSERT_EQ(quant.quant_matrix.rows(), 12);
+
+    // Float reference built from the same (exactly representable) ML values
+    MethylationMatrix raw;
+    raw.raw_matrix.resize(12, 40);
+    raw.binary_matrix.resize(12, 40);
+    for (int r = 0; r < 12; r++) {
+        for (int c = 0; c < 40; c++) {
+            double p = quant.probability(r, c);
+            raw.raw_matrix(r, c) = p;
+            raw.binary_matrix(r, c) = std::isnan(p) ? -1 : (p >= 0.8 ? 1 : (p <= 0.2 ? 0 : -1));
+            EXPECT_EQ(std::isnan(p), builder.get_matrix().at(r, c) < 0);
+        }
+    }
+    EXPECT_EQ(quant.binary_matrix, raw.binary_matrix);
+
+    for (DistanceMetricType type : {DistanceMetricType::L1, DistanceMetricType::L2, DistanceMetricType::CORR,
+                                    DistanceMetricType::NHD}) {
+        DistanceMatrix dq, dr;
+        dq.compute_from_methylation(quant, type, 3, NanDistanceStrategy::MAX_DIST);
+        dr.compute_from_methylation(raw, type, 3, NanDistanceStrategy::MAX_DIST);
+        ASSERT_EQ(dq.dist_matrix.rows(), 12);
+        for (int i = 0; i < 12; i++) {
+            for (int j = 0; j < 12; j++) {
+                EXPECT_NEAR(dq.dist_matrix(i, j), dr.dist_matrix(i, j), 1e-6);
+            }
+        }
+    }
+}
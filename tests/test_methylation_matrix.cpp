@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "core/MethylationMatrix.hpp"
+#include <cmath>
+
+using namespace InterSubMod;
+
+namespace {
+
+// 4 reads over CpGs 100 (4 reads), 200 (1 read), 300 (3 reads)
+void fill(MatrixBuilder& builder) {
+    const std::vector<std::vector<MethylCall>> calls = {
+        {MethylCall(100, 0.9f), MethylCall(300, 0.1f)},
+        {MethylCall(100, 0.5f), MethylCall(200, 1.0f)},
+        {MethylCall(100, 0.0f), MethylCall(300, 0.85f)},
+        {MethylCall(300, 0.15f), MethylCall(100, 0.8f)},
+    };
+    for (size_t r = 0; r < calls.size(); r++) {
+        ReadInfo info{};
+        info.read_id = 10 + static_cast<int>(r);
+        builder.add_read(info, calls[r]);
+    }
+    builder.finalize();
+}
+
+} // namespace
+
+TEST(MethylationMatrixTest, BuildDropsLowCoverageColumnsAndBinarizes) {
+    MatrixBuilder builder;
+    fill(builder);
+
+    MethylationMatrix m;
+    m.build(builder, 0.8, 0.2, 2);
+
+    EXPECT_EQ(m.read_ids, (std::vector<int>{10, 11, 12, 13}));
+    EXPECT_EQ(m.cpg_ids, (std::vector<int>{0, 2}));  // 200 has one read
+    EXPECT_EQ(m.cpg_positions, (std::vector<int32_t>{100, 300}));
+    ASSERT_EQ(m.raw_matrix.rows(), 4);
+    ASSERT_EQ(m.raw_matrix.cols(), 2);
+    EXPECT_FALSE(m.is_quantized());
+
+    EXPECT_FLOAT_EQ(m.raw_matrix(0, 0), 0.9f);
+    EXPECT_TRUE(std::isnan(m.raw_matrix(1, 1)));
+    EXPECT_FLOAT_EQ(m.raw_matrix(3, 1), 0.15f);
+
+    // >= 0.8 -> 1, <= 0.2 -> 0, between or missing -> -1
+    Eigen::MatrixXi expected(4, 2);
+    expected << 1, 0,
+               -1, -1,
+                0, 1,
+                1, 0;
+    EXPECT_EQ(m.binary_matrix, expected);
+
+    // Column-major: a site's reads are contiguous
+    EXPECT_EQ(m.raw_matrix.data()[1], m.raw_matrix(1, 0));
+}
+
+TEST(MethylationMatrixTest, QuantizedBuildMatchesFloatBuild) {
+    MatrixBuilder fb, qb;
+    qb.set_storage(MatrixStorage::UINT8);
+    fill(fb);
+    fill(qb);
+
+    Config config;
+    config.min_site_coverage = 3;
+    MethylationMatrix f, q;
+    f.build(fb, config);
+    q.build(qb, config);
+
+    ASSERT_TRUE(q.is_quantized());
+    EXPECT_EQ(q.cpg_ids, f.cpg_ids);
+    EXPECT_EQ(q.binary_matrix, f.binary_matrix);
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 2; c++) {
+            if (std::isnan(f.probability(r, c))) {
+                EXPECT_TRUE(std::isnan(q.probability(r, c)));
+            } else {
+                EXPECT_NEAR(q.probability(r, c), f.probability(r, c), 0.5 / 255 + 1e-6);
+            }
+        }
+    }
+}
+
+TEST(MethylationMatrixTest, BuildRequiresFinalizedBuilder) {
+    MatrixBuilder builder;
+    ReadInfo info{};
+    builder.add_read(info, {MethylCall(100, 0.5f)});
+
+    MethylationMatrix m;
+    EXPECT_THROW(m.build(builder, 0.8, 0.2, 1), std::runtime_error);
+
+    builder.finalize();
+    m.build(builder, 0.8, 0.2, 5);  // Every column dropped
+    EXPECT_EQ(m.num_reads(), 1);
+    EXPECT_EQ(m.num_sites(), 0);
+    EXPECT_EQ(m.binary_matrix.cols(), 0);
+}
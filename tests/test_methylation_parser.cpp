@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "core/MethylationParser.hpp"
+#include "utils/ReferenceCache.hpp"
+#include "core/IntervalIndex.hpp"
+#include "BamTestRecords.hpp"
+#include <string>
+#include <vector>
+
+using namespace InterSubMod;
+using Testing::make_record;
+using Testing::op;
+
+TEST(MethylationParserTest, ParseMmTagFindsOffsetAndDeltas) {
+    std::vector<int> deltas;
+    int ml_offset = -1;
+
+    // NOTE: pins the existing offset rule (',' count minus ';' count before the
+    // code), which yields 1 here. Per the SAM spec the C+m? values start at ML
+    // index 2 (two C+h? deltas precede them); see the commit introducing this test.
+    ASSERT_TRUE(MethylationParser::parse_mm_tag("C+h?,1,0;C+m?,3,5,0,2;", "C+m?", deltas, ml_offset));
+    EXPECT_EQ(ml_offset, 1);
+    EXPECT_EQ(deltas, (std::vector<int>{3, 5, 0, 2}));
+
+    ASSERT_TRUE(MethylationParser::parse_mm_tag("C+m?,7", "C+m?", deltas, ml_offset));
+    EXPECT_EQ(ml_offset, 0);
+    EXPECT_EQ(deltas, (std::vector<int>{7}));
+
+    EXPECT_FALSE(MethylationParser::parse_mm_tag("C+h?,1,2;", "C+m?", deltas, ml_offset));
+    EXPECT_TRUE(deltas.empty());
+
+    // Invalid token stops parsing
+    ASSERT_TRUE(MethylationParser::parse_mm_tag("C+m?,1,x,2;", "C+m?", deltas, ml_offset));
+    EXPECT_EQ(deltas, (std::vector<int>{1}));
+}
+
+TEST(MethylationParserTest, MapsDeltasToCpGCalls) {
+    //               0123456789
+    std::string seq = "ACGTTCGACG";
+    bam1_t* b = make_record(100, {op(10, BAM_CMATCH)}, seq, "C+m?,0,1;", {200, 100});
+
+    MethylationParser parser;
+    auto calls = parser.parse_read(b, seq, 100);
+
+    // Modified Cs are the 1st (idx 1) and 3rd (idx 8) C of the read
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_EQ(calls[0].ref_pos, 102);
+    EXPECT_FLOAT_EQ(calls[0].probability, 200 / 255.0f);
+    EXPECT_EQ(calls[1].ref_pos, 109);
+    EXPECT_FLOAT_EQ(calls[1].probability, 100 / 255.0f);
+
+    bam_destroy1(b);
+}
+
+TEST(MethylationParserTest, InsertionsConsumeDeltasButEmitNothing) {
+    // Read: AC G [CG inserted] TCGA ; CIGAR 3M2I4M
+    std::string seq = "ACGCGTCGA";
+    std::string ref = "ACGTCGA";
+    bam1_t* b = make_record(0, {op(3, BAM_CMATCH), op(2, BAM_CINS), op(4, BAM_CMATCH)},
+                            seq, "C+m?,0,0,0;", {10, 20, 30});
+
+    MethylationParser parser;
+    auto calls = parser.parse_read(b, ref, 0);
+
+    // C#0 -> ref 1, C#1 is inserted, C#2 -> ref 4
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_EQ(calls[0].ref_pos, 2);
+    EXPECT_FLOAT_EQ(calls[0].probability, 10 / 255.0f);
+    EXPECT_EQ(calls[1].ref_pos, 5);
+    EXPECT_FLOAT_EQ(calls[1].probability, 30 / 255.0f);
+
+    bam_destroy1(b);
+}
+
+TEST(MethylationParserTest, RejectsNonCpGAndShortMl) {
+    std::string seq = "ACATCA";
+    bam1_t* b = make_record(0, {op(6, BAM_CMATCH)}, seq, "C+m?,0,0;", {255, 255});
+    MethylationParser parser;
+    EXPECT_TRUE(parser.parse_read(b, seq, 0).empty());  // CA, not CG
+    bam_destroy1(b);
+
+    std::string cg = "ACGTCG";
+    b = make_record(0, {op(6, BAM_CMATCH)}, cg, "C+m?,0,0;", {255});
+    EXPECT_TRUE(parser.parse_read(b, cg, 0).empty());   // ML shorter than MM
+    bam_destroy1(b);
+}
+
+TEST(MethylationParserTest, BufferOverloadMatchesAndReusesBuffer) {
+    std::string seq = "ACGTTCGACG";
+    bam1_t* b = make_record(100, {op(10, BAM_CMATCH)}, seq, "C+m?,0,0,0;", {1, 2, 3});
+
+    MethylationParser parser;
+    auto expected = parser.parse_read(b, seq, 100);
+
+    std::vector<MethylCall> buf(10);  // stale content must be cleared
+    size_t n = parser.parse_read(b, seq, 100, buf);
+    ASSERT_EQ(n, expected.size());
+    ASSERT_EQ(buf.size(), expected.size());
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_EQ(buf[i].ref_pos, expected[i].ref_pos);
+        EXPECT_EQ(buf[i].probability, expected[i].probability);
+    }
+
+    bam_destroy1(b);
+}
+
+TEST(MethylationParserTest, CpGBitmapPathMatchesStringCheck) {
+    // Chromosome = 100 N + read; the slice ends on a 'C' whose 'G' lies beyond it
+    std::string chrom = std::string(100, 'N') + "ACGTTCGACGG";
+    std::string_view slice = std::string_view(chrom).substr(100, 9);  // "ACGTTCGAC"
+    CpGBitmap cpg(chrom);
+    bam1_t* b = make_record(100, {op(9, BAM_CMATCH)}, "ACGTTCGAC", "C+m?,0,0,0;", {1, 2, 3});
+
+    MethylationParser parser;
+    std::vector<MethylCall> expected, actual;
+    parser.parse_read(b, slice, 100, expected);
+    parser.parse_read(b, slice, 100, actual, &cpg);
+
+    ASSERT_EQ(expected.size(), 2u);  // last C is dropped at the slice boundary
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+        EXPECT_EQ(actual[i].ref_pos, expected[i].ref_pos);
+        EXPECT_EQ(actual[i].probability, expected[i].probability);
+    }
+
+    bam_destroy1(b);
+}
+
+TEST(MethylationParserTest, ExcludedIntervalsGateCallsDuringParse) {
+    std::string seq = "ACGTTCGACG";
+    bam1_t* b = make_record(100, {op(10, BAM_CMATCH)}, seq, "C+m?,0,0,0;", {1, 2, 3});
+
+    IntervalIndex pmd;
+    pmd.add("chr1", 104, 107);  // covers the CpG at 0-based 105
+    pmd.add("chr1", 0, 50);
+    pmd.finalize();
+
+    MethylationParser parser;
+    parser.set_excluded_intervals(pmd.chrom("chr1"));
+    auto calls = parser.parse_read(b, seq, 100);
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_EQ(calls[0].ref_pos, 102);
+    EXPECT_EQ(calls[1].ref_pos, 109);
+    EXPECT_EQ(parser.excluded_calls(), 1u);
+
+    parser.set_excluded_intervals(nullptr);
+    EXPECT_EQ(parser.parse_read(b, seq, 100).size(), 3u);
+
+    bam_destroy1(b);
+}
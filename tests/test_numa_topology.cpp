@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "utils/NumaTopology.hpp"
+#include <cstdlib>
+
+using namespace InterSubMod::Utils;
+
+TEST(NumaTopologyTest, ParsesKernelCpuLists) {
+    EXPECT_EQ(NumaTopology::parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(NumaTopology::parse_cpu_list("5"), (std::vector<int>{5}));
+    EXPECT_EQ(NumaTopology::parse_cpu_list("2,1,1-2"), (std::vector<int>{1, 2}));
+    EXPECT_TRUE(NumaTopology::parse_cpu_list("").empty());
+    EXPECT_TRUE(NumaTopology::parse_cpu_list("\n").empty());
+}
+
+TEST(NumaTopologyTest, MapsThreadsAndCpusToNodes) {
+    NumaTopology topo({{4, 5, 6, 7}, {0, 1, 2, 3}});
+    ASSERT_EQ(topo.num_nodes(), 2);
+    EXPECT_EQ(topo.cpus(0).front(), 4);
+    EXPECT_EQ(topo.node_of_cpu(2), 1);
+    EXPECT_EQ(topo.node_of_cpu(6), 0);
+    EXPECT_EQ(topo.node_of_cpu(99), 0);
+
+    // Contiguous blocks of threads per node
+    EXPECT_EQ(topo.node_for_thread(0, 8), 0);
+    EXPECT_EQ(topo.node_for_thread(3, 8), 0);
+    EXPECT_EQ(topo.node_for_thread(4, 8), 1);
+    EXPECT_EQ(topo.node_for_thread(7, 8), 1);
+    EXPECT_EQ(topo.node_for_thread(0, 1), 0);
+
+    NumaTopology single({{0, 1}});
+    EXPECT_EQ(single.node_for_thread(1, 2), 0);
+}
+
+TEST(NumaTopologyTest, DetectsAtLeastOneNodeWithTheCurrentCpu) {
+    NumaTopology topo = NumaTopology::detect();
+    ASSERT_GE(topo.num_nodes(), 1);
+    for (int n = 0; n < topo.num_nodes(); n++) {
+        EXPECT_FALSE(topo.cpus(n).empty());
+    }
+    const int node = topo.current_node();
+    EXPECT_GE(node, 0);
+    EXPECT_LT(node, topo.num_nodes());
+    EXPECT_TRUE(NumaTopology::pin_current_thread(topo.cpus(node)));
+}
+
+TEST(NumaTopologyTest, RespectsOpenMpBindingVariables) {
+    unsetenv("OMP_PLACES");
+    unsetenv("OMP_PROC_BIND");
+    EXPECT_FALSE(NumaTopology::omp_binding_requested());
+    setenv("OMP_PROC_BIND", "FALSE", 1);
+    EXPECT_FALSE(NumaTopology::omp_binding_requested());
+    setenv("OMP_PROC_BIND", "spread", 1);
+    EXPECT_TRUE(NumaTopology::omp_binding_requested());
+    unsetenv("OMP_PROC_BIND");
+    setenv("OMP_PLACES", "sockets", 1);
+    EXPECT_TRUE(NumaTopology::omp_binding_requested());
+    unsetenv("OMP_PLACES");
+}
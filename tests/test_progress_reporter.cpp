@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "utils/ProgressReporter.hpp"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace InterSubMod::Utils;
+
+TEST(ProgressReporterTest, CountsFromManyThreads) {
+    std::ostringstream out;
+    ProgressReporter progress("regions", 800, 0.0, out);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 100; i++) {
+                progress.record(!(t == 0 && i < 5));
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    progress.stop();
+
+    EXPECT_EQ(progress.done(), 800u);
+    EXPECT_EQ(progress.failed(), 5u);
+    EXPECT_NE(progress.format_line().find("[regions] 800/800 (100.0%)"), std::string::npos);
+    EXPECT_NE(progress.format_line().find("5 failed"), std::string::npos);
+    EXPECT_TRUE(out.str().empty());  // interval <= 0: no reporter thread, no output
+}
+
+TEST(ProgressReporterTest, ReporterThreadPrintsThrottledLines) {
+    std::ostringstream out;
+    {
+        ProgressReporter progress("regions", 10, 0.01, out);
+        for (int i = 0; i < 4; i++) {
+            progress.record(true);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        progress.stop();
+        progress.stop();  // idempotent
+    }
+    std::string text = out.str();
+    EXPECT_NE(text.find("[regions] 4/10 (40.0%)"), std::string::npos);
+    EXPECT_NE(text.find("ETA"), std::string::npos);
+    EXPECT_GE(std::count(text.begin(), text.end(), '\n'), 2);
+}
+
+TEST(ProgressReporterTest, GrowingTotalHasNoEtaUntilFinished) {
+    std::ostringstream out;
+    ProgressReporter progress("regions", 0, 0.0, out);
+    progress.add_total(3);
+    progress.record(true);
+    EXPECT_NE(progress.format_line().find("1/3+"), std::string::npos);
+    EXPECT_EQ(progress.format_line().find("ETA"), std::string::npos);
+    progress.add_total(1);
+    progress.finish_total();
+    EXPECT_NE(progress.format_line().find("1/4 (25.0%)"), std::string::npos);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "core/ReadSampler.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace InterSubMod;
+
+namespace {
+
+ReadRecord make_record(int hp, AltSupport alt, bool is_tumor = true) {
+    ReadRecord rec;
+    rec.hp_tag = static_cast<int8_t>(hp);
+    rec.alt_support = alt;
+    rec.is_tumor = is_tumor;
+    return rec;
+}
+
+// Offers the reads, tagging each one's calls with its index; returns the emitted indices
+std::vector<int> sample(ReadSampler& sampler, const std::vector<ReadRecord>& reads, const std::vector<std::string>& names) {
+    sampler.reset();
+    for (size_t i = 0; i < reads.size(); i++) {
+        if (std::vector<MethylCall>* calls = sampler.offer(reads[i], names[i])) {
+            calls->push_back(MethylCall{static_cast<int32_t>(i), 0.5f});
+        }
+    }
+    std::vector<int> kept;
+    sampler.emit([&](const ReadRecord&, std::string_view name, const std::vector<MethylCall>& calls) {
+        EXPECT_EQ(calls.size(), 1u);
+        EXPECT_EQ(name, names[calls[0].ref_pos]);
+        kept.push_back(calls[0].ref_pos);
+    });
+    return kept;
+}
+
+} // namespace
+
+TEST(ReadSamplerTest, DeterministicAndIndependentOfFetchOrder) {
+    std::vector<ReadRecord> reads;
+    std::vector<std::string> names;
+    for (int i = 0; i < 500; i++) {
+        reads.push_back(make_record(1 + i % 2, i % 5 == 0 ? AltSupport::ALT : AltSupport::REF));
+        names.push_back("read_" + std::to_string(i));
+    }
+
+    ReadSampler sampler(50, 7);
+    std::vector<int> first = sample(sampler, reads, names);
+    ASSERT_EQ(first.size(), 50u);
+    EXPECT_TRUE(std::is_sorted(first.begin(), first.end()));  // Emitted in fetch order
+    EXPECT_EQ(sample(sampler, reads, names), first);
+
+    // Same reads in reverse order -> same selection
+    std::vector<ReadRecord> rev_reads(reads.rbegin(), reads.rend());
+    std::vector<std::string> rev_names(names.rbegin(), names.rend());
+    std::vector<std::string> picked, rev_picked;
+    for (int i : first) picked.push_back(names[i]);
+    for (int i : sample(sampler, rev_reads, rev_names)) rev_picked.push_back(rev_names[i]);
+    std::sort(picked.begin(), picked.end());
+    std::sort(rev_picked.begin(), rev_picked.end());
+    EXPECT_EQ(rev_picked, picked);
+
+    // Another seed draws another sample
+    ReadSampler other(50, 8);
+    EXPECT_NE(sample(other, reads, names), first);
+
+    // Under the cap nothing is dropped
+    ReadSampler wide(1000, 7);
+    EXPECT_EQ(sample(wide, reads, names).size(), reads.size());
+}
+
+TEST(ReadSamplerTest, QuotasFollowStrataAndKeepRareOnes) {
+    std::vector<ReadRecord> reads;
+    std::vector<std::string> names;
+    // 600 HP1 REF, 300 HP2 REF, 97 HP2 ALT, 3 normal reads
+    for (int i = 0; i < 1000; i++) {
+        if (i < 600) reads.push_back(make_record(1, AltSupport::REF));
+        else if (i < 900) reads.push_back(make_record(2, AltSupport::REF));
+        else if (i < 997) reads.push_back(make_record(2, AltSupport::ALT));
+        else reads.push_back(make_record(0, AltSupport::UNKNOWN, false));
+        names.push_back("r" + std::to_string(i * 7919));
+    }
+
+    ReadSampler sampler(100, 0);
+    std::vector<int> kept = sample(sampler, reads, names);
+    ASSERT_EQ(kept.size(), 100u);
+    EXPECT_EQ(sampler.seen(), 1000u);
+
+    int hp1 = 0, hp2_ref = 0, alt = 0, normal = 0;
+    for (int i : kept) {
+        if (i < 600) hp1++;
+        else if (i < 900) hp2_ref++;
+        else if (i < 997) alt++;
+        else normal++;
+    }
+    EXPECT_EQ(normal, 1);  // 0.3 reads proportionally, kept by the at-least-one rule
+    EXPECT_NEAR(hp1, 60, 1);
+    EXPECT_NEAR(hp2_ref, 30, 1);
+    EXPECT_NEAR(alt, 10, 1);
+    EXPECT_EQ(ReadSampler::stratum_of(reads[0]), ReadSampler::stratum_of(reads[1]));
+    EXPECT_NE(ReadSampler::stratum_of(reads[0]), ReadSampler::stratum_of(reads[999]));
+}
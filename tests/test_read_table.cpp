@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "core/ReadTable.hpp"
+#include "core/MatrixBuilder.hpp"
+#include <string>
+
+using namespace InterSubMod;
+
+TEST(ReadTableTest, AppendRoundTripsRecordsAndNames) {
+    ReadTable table;
+    ReadRecord rec;
+    rec.read_id = 7;
+    rec.chr_id = 2;
+    rec.align_start = 100;
+    rec.align_end = 250;
+    rec.mapq = 60;
+    rec.hp_tag = 2;
+    rec.alt_support = AltSupport::ALT;
+    rec.is_tumor = false;
+    EXPECT_EQ(table.append(rec, "read/one"), 0);
+
+    ReadInfo info{};
+    info.read_id = 8;
+    info.read_name = "";
+    info.mapq = 300;   // Clamped
+    info.hp_tag = 1000; // Out of int8 range -> unknown
+    info.is_tumor = true;
+    EXPECT_EQ(table.append(info), 1);
+
+    ASSERT_EQ(table.size(), 2u);
+    EXPECT_EQ(table.name(0), "read/one");
+    EXPECT_EQ(table.name(1), "");
+    EXPECT_EQ(table.name_bytes(), 8u);
+
+    ReadInfo back = table.get(0);
+    EXPECT_EQ(back.read_id, 7);
+    EXPECT_EQ(back.read_name, "read/one");
+    EXPECT_EQ(back.align_end, 250);
+    EXPECT_EQ(back.mapq, 60);
+    EXPECT_EQ(back.hp_tag, 2);
+    EXPECT_EQ(back.alt_support, AltSupport::ALT);
+    EXPECT_FALSE(back.is_tumor);
+    EXPECT_EQ(table.mapq(1), 255);
+    EXPECT_EQ(table.hp_tag(1), 0);
+    EXPECT_EQ(table.count_normal(), 1u);
+
+    ReadRecord r1 = table.record(1);
+    EXPECT_EQ(r1.read_id, 8);
+    EXPECT_TRUE(r1.is_tumor);
+}
+
+TEST(ReadTableTest, ClearKeepsCapacity) {
+    ReadTable table;
+    table.reserve(100, 1000);
+    const size_t reserved = table.memory_bytes();
+    EXPECT_GE(reserved, 100 * 24 + 1000u);
+
+    ReadRecord rec;
+    for (int i = 0; i < 100; i++) {
+        rec.read_id = i;
+        table.append(rec, "name" + std::to_string(i));
+    }
+    EXPECT_EQ(table.memory_bytes(), reserved);
+    EXPECT_EQ(table.name(42), "name42");
+
+    table.clear();
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.name_bytes(), 0u);
+    EXPECT_EQ(table.memory_bytes(), reserved);
+    table.append(rec, "again");
+    EXPECT_EQ(table.name(0), "again");
+}
+
+TEST(ReadTableTest, MatrixBuilderStoresReadsInTable) {
+    MatrixBuilder builder;
+    ReadRecord rec;
+    rec.read_id = 0;
+    rec.is_tumor = true;
+    builder.add_read(rec, "t0", {{100, 0.9f}});
+    ReadInfo normal{};
+    normal.read_id = 1;
+    normal.read_name = "n1";
+    normal.is_tumor = false;
+    builder.add_read(normal, {{100, 0.1f}, {200, 0.2f}});
+    builder.finalize();
+
+    const ReadTable& reads = builder.get_reads();
+    ASSERT_EQ(reads.size(), 2u);
+    EXPECT_EQ(reads.name(0), "t0");
+    EXPECT_EQ(reads.name(1), "n1");
+    EXPECT_EQ(reads.count_normal(), 1u);
+    EXPECT_EQ(builder.num_cpgs(), 2);
+}
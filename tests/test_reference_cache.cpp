@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "utils/ReferenceCache.hpp"
+#include "utils/FastaReader.hpp"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace InterSubMod;
+
+namespace {
+
+/**
+ * @brief Writes a two-chromosome FASTA (60 bp lines, mixed case) plus its .fai.
+ */
+class ReferenceCacheTest : public ::testing::Test {
+protected:
+    std::string path = "/tmp/ref_cache_test_" + std::to_string(getpid()) + ".fa";
+    std::string chr1, chr2;
+
+    void SetUp() override {
+        const char* motif = "acgTTCgCGnaCGt";
+        for (int i = 0; i < 150; i++) chr1 += motif[i % 14];
+        for (int i = 0; i < 70; i++) chr2 += (i % 3 == 0) ? 'C' : 'G';
+
+        std::ofstream fa(path), fai(path + ".fai");
+        long offset = 0;
+        for (auto [name, seq] : {std::pair<std::string, std::string>{"chr1", chr1}, {"chr2", chr2}}) {
+            fa << ">" << name << "\n";
+            offset += name.size() + 2;
+            fai << name << "\t" << seq.size() << "\t" << offset << "\t60\t61\n";
+            for (size_t p = 0; p < seq.size(); p += 60) {
+                std::string line = seq.substr(p, 60);
+                fa << line << "\n";
+                offset += line.size() + 1;
+            }
+        }
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".fai").c_str());
+    }
+};
+
+} // namespace
+
+TEST_F(ReferenceCacheTest, FetchMatchesFastaReader) {
+    ReferenceCache cache(path);
+    FastaReader fasta(path);
+
+    for (auto [s, e] : {std::pair<int, int>{0, 10}, {55, 125}, {140, 400}, {149, 150}}) {
+        EXPECT_EQ(cache.fetch("chr1", s, e), fasta.fetch_sequence("chr1", s, e)) << s << "-" << e;
+    }
+    EXPECT_TRUE(cache.fetch("chr1", 150, 160).empty());
+    EXPECT_TRUE(cache.fetch("chr1", 20, 20).empty());
+    EXPECT_TRUE(cache.fetch("chrX", 0, 10).empty());
+    EXPECT_EQ(cache.chromosome("chrX"), nullptr);
+
+    // Cache mode of FastaReader serves the same views
+    fasta.set_cache(std::make_shared<ReferenceCache>(path));
+    EXPECT_EQ(fasta.fetch_view("chr2", 3, 40), fasta.fetch_sequence("chr2", 3, 40));
+    EXPECT_NE(fasta.cpg_bitmap("chr2"), nullptr);
+}
+
+TEST_F(ReferenceCacheTest, CpGBitmapMarksDinucleotides) {
+    ReferenceCache cache(path);
+    const CachedChromosome* c = cache.chromosome("chr1");
+    ASSERT_NE(c, nullptr);
+    ASSERT_EQ(c->seq.size(), chr1.size());
+
+    size_t expected = 0;
+    for (int64_t p = 0; p < static_cast<int64_t>(c->seq.size()); p++) {
+        bool cg = p + 1 < static_cast<int64_t>(c->seq.size()) && c->seq[p] == 'C' && c->seq[p + 1] == 'G';
+        EXPECT_EQ(c->cpg.test(p), cg) << p;
+        expected += cg;
+    }
+    EXPECT_EQ(c->cpg.count(), expected);
+    EXPECT_FALSE(c->cpg.test(-1));
+    EXPECT_FALSE(c->cpg.test(100000));
+}
+
+TEST_F(ReferenceCacheTest, ConcurrentRequestsLoadOnce) {
+    ReferenceCache cache(path);
+    std::vector<const CachedChromosome*> seen(8, nullptr);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t] { seen[t] = cache.chromosome(t % 2 ? "chr1" : "chr2"); });
+    }
+    for (auto& t : threads) t.join();
+
+    for (int t = 2; t < 8; t++) {
+        EXPECT_EQ(seen[t], seen[t % 2]);
+    }
+    EXPECT_EQ(cache.num_loaded(), 2u);
+    EXPECT_GE(cache.bytes(), chr1.size() + chr2.size());
+}
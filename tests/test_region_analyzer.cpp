@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "core/RegionAnalyzer.hpp"
+#include <fstream>
+#include <set>
+#include <string>
+#include <unistd.h>
+
+using namespace InterSubMod;
+
+namespace {
+
+// 8 reads over 20 CpGs: reads 0-3 methylated (HP1, ALT), reads 4-7 unmethylated (HP2, REF)
+RegionOutput make_region(int region_id, int num_reads = 8) {
+    RegionOutput out;
+    out.region_id = region_id;
+    out.chr_name = "chr7";
+    out.snv.pos = 1000 + region_id;
+    out.snv.ref_base = 'C';
+    out.snv.alt_base = 'T';
+    for (int r = 0; r < num_reads; r++) {
+        const bool meth = r < num_reads / 2;
+        ReadInfo info{};
+        info.read_id = r;
+        info.read_name = "r" + std::to_string(r);
+        info.hp_tag = meth ? 1 : 2;
+        info.is_tumor = true;
+        info.alt_support = meth ? AltSupport::ALT : AltSupport::REF;
+        std::vector<MethylCall> calls;
+        for (int c = 0; c < 20; c++) {
+            calls.emplace_back(100 + 2 * c, meth ? 0.95f : 0.05f);
+        }
+        out.matrix.add_read(info, calls);
+    }
+    out.matrix.finalize();
+    return out;
+}
+
+AnalysisOptions small_options() {
+    AnalysisOptions options;
+    options.min_site_coverage = 2;
+    options.num_threads = 2;
+    options.queue_capacity = 2;
+    return options;
+}
+
+} // namespace
+
+TEST(RegionAnalyzerTest, AnalyzeSeparatesMethylationStates) {
+    HierarchicalClustering hc(LinkageMethod::AVERAGE);
+    ClusteringResult res;
+    ASSERT_TRUE(RegionAnalyzer::analyze(make_region(3), small_options(), hc, res));
+
+    EXPECT_EQ(res.region_id, 3);
+    EXPECT_EQ(res.num_clusters, 2);
+    ASSERT_EQ(res.stats.size(), 2u);
+    const ClusterStats& a = res.stats.at(1);
+    EXPECT_EQ(a.size, 4);
+    EXPECT_EQ(a.count_hp1, 4);
+    EXPECT_EQ(a.count_alt, 4);
+    EXPECT_LT(a.p_value_hp, 0.05);
+
+    // Too few reads, or no column with enough coverage: not clustered
+    EXPECT_FALSE(RegionAnalyzer::analyze(make_region(4, 1), small_options(), hc, res));
+    AnalysisOptions strict = small_options();
+    strict.min_site_coverage = 9;
+    EXPECT_FALSE(RegionAnalyzer::analyze(make_region(5), strict, hc, res));
+}
+
+TEST(RegionAnalyzerTest, ForwardsEveryRegionToTheWriter) {
+    const std::string dir = "/tmp/region_analyzer_test_" + std::to_string(getpid());
+    const int kRegions = 20;
+    AnalyzerStats stats;
+    AsyncWriterStats wstats;
+    {
+        AsyncRegionWriter writer(dir, OutputFormat::BINARY, BinaryFormat::MatrixDType::FLOAT32, 1, 4, 4);
+        {
+            RegionAnalyzer analyzer(small_options(), writer, dir + "/clusters.tsv");
+            for (int i = 0; i < kRegions; i++) {
+                ASSERT_TRUE(analyzer.submit(make_region(i, i % 5 == 0 ? 1 : 8)));
+            }
+            analyzer.close();
+            EXPECT_FALSE(analyzer.submit(make_region(99)));
+            EXPECT_TRUE(analyzer.errors().empty());
+            stats = analyzer.stats();
+        }
+        writer.close();
+        wstats = writer.stats();
+    }
+
+    EXPECT_EQ(stats.num_threads, 2);
+    EXPECT_EQ(stats.regions_skipped, 4u);   // Single-read regions
+    EXPECT_EQ(stats.regions_analyzed, 16u);
+    EXPECT_EQ(stats.clusters, 32u);
+    EXPECT_EQ(wstats.regions_written, static_cast<uint64_t>(kRegions));
+
+    std::ifstream tsv(dir + "/clusters.tsv");
+    std::string line;
+    ASSERT_TRUE(std::getline(tsv, line));
+    EXPECT_EQ(line, RegionAnalyzer::tsv_header());
+    std::set<int> regions;
+    size_t rows = 0;
+    while (std::getline(tsv, line)) {
+        regions.insert(std::stoi(line));
+        EXPECT_NE(line.find("\tchr7\t"), std::string::npos);
+        rows++;
+    }
+    EXPECT_EQ(rows, 32u);
+    EXPECT_EQ(regions.size(), 16u);
+
+    std::remove((dir + "/clusters.tsv").c_str());
+    std::remove((dir + "/regions.shard_000.ismr").c_str());
+    rmdir(dir.c_str());
+}
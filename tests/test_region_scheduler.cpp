@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "core/RegionScheduler.hpp"
+
+using namespace InterSubMod;
+
+namespace {
+
+SomaticSnv make_snv(int id, int32_t pos) {
+    SomaticSnv snv{};
+    snv.snv_id = id;
+    snv.pos = pos;
+    snv.ref_base = 'C';
+    snv.alt_base = 'T';
+    return snv;
+}
+
+} // namespace
+
+TEST(RegionSchedulerTest, MergesOverlappingWindowsInGenomeOrder) {
+    // Input order is deliberately shuffled
+    std::vector<SomaticSnv> snvs = {
+        make_snv(0, 50000),
+        make_snv(1, 10000),
+        make_snv(2, 11500),   // overlaps SNV 1 (±1000)
+        make_snv(3, 30000),
+    };
+    std::vector<std::string> chr = {"chr1", "chr1", "chr1", "chr1"};
+
+    RegionScheduler scheduler(1000);
+    auto srs = scheduler.build_super_regions(snvs, chr, 4);
+
+    ASSERT_EQ(srs.size(), 3u);
+    EXPECT_EQ(srs[0].members, (std::vector<int>{1, 2}));
+    EXPECT_EQ(srs[0].fetch_start, 9000);
+    EXPECT_EQ(srs[0].fetch_end, 12500);
+    EXPECT_EQ(srs[1].members, (std::vector<int>{3}));
+    EXPECT_EQ(srs[2].members, (std::vector<int>{0}));
+}
+
+TEST(RegionSchedulerTest, DoesNotMergeAcrossChromosomes) {
+    std::vector<SomaticSnv> snvs = {make_snv(0, 10000), make_snv(1, 10000), make_snv(2, 10100)};
+    std::vector<std::string> chr = {"chr2", "chr1", "chr2"};
+
+    RegionScheduler scheduler(1000);
+    auto srs = scheduler.build_super_regions(snvs, chr, 3);
+
+    // chr2 appears first in the input, so it is scheduled first
+    ASSERT_EQ(srs.size(), 2u);
+    EXPECT_EQ(srs[0].chr_name, "chr2");
+    EXPECT_EQ(srs[0].members, (std::vector<int>{0, 2}));
+    EXPECT_EQ(srs[1].chr_name, "chr1");
+}
+
+TEST(RegionSchedulerTest, MergeGapAndMaxSpan) {
+    std::vector<SomaticSnv> snvs = {make_snv(0, 10000), make_snv(1, 12500), make_snv(2, 15000)};
+    std::vector<std::string> chr(3, "chr1");
+
+    // Windows are 500 bp apart: only merged when merge_gap allows it
+    EXPECT_EQ(RegionScheduler(1000, 0).build_super_regions(snvs, chr, 3).size(), 3u);
+    EXPECT_EQ(RegionScheduler(1000, 500).build_super_regions(snvs, chr, 3).size(), 1u);
+
+    // A small max_span stops the chain
+    EXPECT_EQ(RegionScheduler(1000, 500, 5000).build_super_regions(snvs, chr, 3).size(), 2u);
+}
+
+TEST(RegionSchedulerTest, ClampsWindowStartAndHonoursCount) {
+    std::vector<SomaticSnv> snvs = {make_snv(0, 200), make_snv(1, 90000)};
+    std::vector<std::string> chr(2, "chr1");
+
+    RegionScheduler scheduler(1000);
+    auto srs = scheduler.build_super_regions(snvs, chr, 1);
+    ASSERT_EQ(srs.size(), 1u);
+    EXPECT_EQ(srs[0].fetch_start, 1);
+    EXPECT_EQ(srs[0].fetch_end, 1200);
+}
+
+TEST(RegionSchedulerTest, BatchesAreChromosomeContiguous) {
+    std::vector<SomaticSnv> snvs;
+    std::vector<std::string> chr;
+    for (int i = 0; i < 20; i++) {
+        snvs.push_back(make_snv(i, 10000 + i * 10000));
+        chr.push_back(i < 12 ? "chr1" : "chr2");
+    }
+
+    RegionScheduler scheduler(1000);
+    auto srs = scheduler.build_super_regions(snvs, chr, 20);
+    auto batches = scheduler.build_batches(srs, 2);
+
+    int total = 0;
+    size_t expected_first = 0;
+    for (const auto& b : batches) {
+        EXPECT_EQ(b.first, expected_first);
+        EXPECT_LT(b.first, b.last);
+        for (size_t s = b.first; s < b.last; s++) {
+            EXPECT_EQ(srs[s].chr_name, srs[b.first].chr_name);
+        }
+        expected_first = b.last;
+        total += b.num_regions;
+    }
+    EXPECT_EQ(expected_first, srs.size());
+    EXPECT_EQ(total, 20);
+}
+
+TEST(RegionSchedulerTest, CostBatchesRunHeaviestFirst) {
+    std::vector<SomaticSnv> snvs;
+    std::vector<std::string> chr;
+    for (int i = 0; i < 20; i++) {
+        snvs.push_back(make_snv(i, 10000 + i * 10000));
+        chr.push_back(i < 12 ? "chr1" : "chr2");
+    }
+
+    RegionScheduler scheduler(1000);
+    auto srs = scheduler.build_super_regions(snvs, chr, 20);
+    ASSERT_EQ(srs.size(), 20u);
+    for (auto& sr : srs) sr.est_bytes = 100;
+    srs[5].est_bytes = 10000;  // Straggler in the middle of chr1
+
+    auto batches = scheduler.build_cost_batches(srs, 2);
+    ASSERT_FALSE(batches.empty());
+    // The straggler is a batch of its own and comes first
+    EXPECT_EQ(batches[0].first, 5u);
+    EXPECT_EQ(batches[0].last, 6u);
+    EXPECT_EQ(batches[0].est_bytes, 10000u);
+
+    // Still a chromosome-contiguous partition of all super-regions
+    std::vector<int> covered(srs.size(), 0);
+    for (size_t i = 0; i < batches.size(); i++) {
+        if (i > 0) {
+            EXPECT_GE(batches[i - 1].est_bytes, batches[i].est_bytes);
+        }
+        for (size_t s = batches[i].first; s < batches[i].last; s++) {
+            covered[s]++;
+            EXPECT_EQ(srs[s].chr_name, srs[batches[i].first].chr_name);
+        }
+    }
+    for (int c : covered) EXPECT_EQ(c, 1);
+}
+
+TEST(RegionSchedulerTest, TryExtendMatchesBatchMerging) {
+    // Streaming planners feed SNVs in file order through try_extend()
+    std::vector<SomaticSnv> snvs = {make_snv(0, 10000), make_snv(1, 11500), make_snv(2, 30000), make_snv(3, 30500)};
+    std::vector<std::string> chr(4, "chr1");
+    RegionScheduler scheduler(1000);
+
+    std::vector<SuperRegion> streamed;
+    for (int i = 0; i < 4; i++) {
+        if (!streamed.empty() && scheduler.try_extend(streamed.back(), snvs[i], chr[i], i)) {
+            continue;
+        }
+        SuperRegion sr;
+        sr.chr_name = chr[i];
+        scheduler.window_of(snvs[i], sr.fetch_start, sr.fetch_end);
+        sr.members.push_back(i);
+        streamed.push_back(sr);
+    }
+    auto batch = scheduler.build_super_regions(snvs, chr, 4);
+    ASSERT_EQ(streamed.size(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(streamed[i].members, batch[i].members);
+        EXPECT_EQ(streamed[i].fetch_start, batch[i].fetch_start);
+        EXPECT_EQ(streamed[i].fetch_end, batch[i].fetch_end);
+    }
+
+    // Out-of-order SNVs never extend a union that starts after their window
+    SuperRegion cur = batch[1];
+    EXPECT_FALSE(scheduler.try_extend(cur, make_snv(4, 28500), "chr1", 4));
+    EXPECT_FALSE(scheduler.try_extend(cur, make_snv(5, 30200), "chr2", 5));
+    EXPECT_EQ(cur.members.size(), 2u);
+}
+
+TEST(RegionSchedulerTest, PartitionByNodeKeepsChromosomesTogether) {
+    auto make_sr = [](const std::string& chr) {
+        SuperRegion sr;
+        sr.chr_name = chr;
+        sr.fetch_start = 1;
+        sr.fetch_end = 2;
+        sr.members = {0};
+        return sr;
+    };
+    std::vector<SuperRegion> srs = {make_sr("chr1"), make_sr("chr1"), make_sr("chr2"), make_sr("chr3"), make_sr("chr3")};
+    std::vector<WorkBatch> batches = {{0, 1, 1, 500}, {1, 2, 1, 400}, {2, 3, 1, 600}, {3, 4, 1, 200}, {4, 5, 1, 100}};
+
+    // chr1 (900) -> node 0, chr2 (600) -> node 1, chr3 (300) -> node 1
+    auto per_node = RegionScheduler::partition_by_node(srs, batches, 2);
+    ASSERT_EQ(per_node.size(), 2u);
+    EXPECT_EQ(per_node[0], (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(per_node[1], (std::vector<size_t>{2, 3, 4}));
+
+    // Without estimates chromosomes are weighed by region count:
+    // chr1 (2) -> node 0, chr3 (2) -> node 1, chr2 (1) -> tie, lowest node
+    for (auto& b : batches) b.est_bytes = 0;
+    per_node = RegionScheduler::partition_by_node(srs, batches, 2);
+    EXPECT_EQ(per_node[0], (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(per_node[1], (std::vector<size_t>{3, 4}));
+
+    // One node takes everything
+    per_node = RegionScheduler::partition_by_node(srs, batches, 1);
+    ASSERT_EQ(per_node.size(), 1u);
+    EXPECT_EQ(per_node[0].size(), batches.size());
+}
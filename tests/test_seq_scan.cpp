@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "utils/SeqScan.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace InterSubMod::Utils;
+
+namespace {
+
+/**
+ * @brief Packs an ACGTN string into 4-bit BAM encoding (high nibble first).
+ */
+std::vector<uint8_t> pack(const std::string& seq) {
+    std::vector<uint8_t> packed((seq.size() + 1) / 2 + 32, 0);
+    for (size_t i = 0; i < seq.size(); i++) {
+        uint8_t code = NT16_N;
+        switch (seq[i]) {
+            case 'A': code = NT16_A; break;
+            case 'C': code = NT16_C; break;
+            case 'G': code = NT16_G; break;
+            case 'T': code = NT16_T; break;
+        }
+        packed[i / 2] |= (i % 2 == 0) ? (code << 4) : code;
+    }
+    return packed;
+}
+
+} // namespace
+
+TEST(SeqScanTest, FindsCytosinesInOrder) {
+    std::string seq = "ACGTCCNNGC";
+    auto packed = pack(seq);
+    std::vector<int32_t> positions;
+
+    EXPECT_EQ(find_bases(packed.data(), seq.size(), NT16_C, positions), 4u);
+    EXPECT_EQ(positions, (std::vector<int32_t>{1, 4, 5, 9}));
+
+    EXPECT_EQ(find_bases(packed.data(), seq.size(), NT16_G, positions), 2u);
+    EXPECT_EQ(positions, (std::vector<int32_t>{2, 8}));
+
+    EXPECT_EQ(find_bases(packed.data(), 0, NT16_C, positions), 0u);
+    EXPECT_TRUE(positions.empty());
+}
+
+TEST(SeqScanTest, DispatchedKernelMatchesScalar) {
+    std::mt19937 rng(7);
+    const char* bases = "ACGTN";
+    std::vector<int32_t> fast, ref;
+
+    for (int len : {1, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000, 4097}) {
+        std::string seq;
+        for (int i = 0; i < len; i++) seq += bases[rng() % 5];
+        auto packed = pack(seq);
+
+        for (uint8_t code : {NT16_C, NT16_G, NT16_N}) {
+            find_bases(packed.data(), len, code, fast);
+            find_bases_scalar(packed.data(), len, code, ref);
+            EXPECT_EQ(fast, ref) << "len=" << len << " code=" << int(code)
+                                 << " kernel=" << seq_scan_kernel_name();
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "io/BinaryRegionFile.hpp"
+#include "io/CompletionJournal.hpp"
+#include "io/ShardMerger.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace InterSubMod;
+
+namespace {
+
+std::string make_dir(const std::string& name) {
+    std::string dir = "/tmp/shard_merger_test_" + name + "_" + std::to_string(getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+// One region with `reads` reads covering a single CpG
+void write_region(BinaryRegionWriter& w, int chr_id, int32_t pos, int region_id, int reads) {
+    SomaticSnv snv{};
+    snv.snv_id = region_id;
+    snv.chr_id = chr_id;
+    snv.pos = pos;
+    snv.ref_base = 'C';
+    snv.alt_base = 'T';
+
+    MatrixBuilder builder;
+    for (int r = 0; r < reads; r++) {
+        ReadInfo info{};
+        info.read_id = r;
+        info.read_name = "read_" + std::to_string(pos) + "_" + std::to_string(r);
+        info.chr_id = chr_id;
+        info.align_start = pos - 100;
+        info.align_end = pos + 100;
+        info.mapq = 60;
+        info.is_tumor = true;
+        info.alt_support = AltSupport::UNKNOWN;
+        builder.add_read(info, {MethylCall(pos + 1, 0.5f)});
+    }
+    builder.finalize();
+    w.write_region(snv, region_id, pos - 100, pos + 100, builder.get_reads(), builder.get_cpg_positions(),
+                   builder.get_matrix());
+}
+
+std::vector<std::vector<std::string>> read_tsv(const std::string& path) {
+    std::vector<std::vector<std::string>> rows;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, '\t')) fields.push_back(field);
+        rows.push_back(fields);
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(ShardMergerTest, MergesShardsIntoOneSortedIndex) {
+    std::string dir = make_dir("index");
+    {
+        // Second shard in genome order, written by a later work unit
+        BinaryRegionWriter w(dir + "/regions.part_002_of_002.shard_000.ismr");
+        write_region(w, 1, 500, 0, 2);
+        write_region(w, 1, 100, 1, 3);
+    }
+    {
+        BinaryRegionWriter w(dir + "/regions.part_001_of_002.shard_000.ismr");
+        write_region(w, 0, 900, 0, 4);
+    }
+    {
+        // Same SNV written again by a resumed run: kept once
+        BinaryRegionWriter w(dir + "/regions.part_002_of_002.resume01.shard_000.ismr");
+        write_region(w, 1, 500, 0, 2);
+    }
+
+    ShardMerger merger(dir, {"chr1", "chr2"});
+    MergeStats stats = merger.merge();
+    EXPECT_EQ(stats.shard_files, 3u);
+    EXPECT_EQ(stats.regions, 3u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.reads, 9u);
+    EXPECT_EQ(stats.recovered_files, 0u);
+
+    auto rows = read_tsv(dir + "/merged.index.tsv");
+    ASSERT_EQ(rows.size(), 4u);
+    EXPECT_EQ(rows[0].size(), 11u);
+    EXPECT_EQ(rows[1][0], "0");
+    EXPECT_EQ(rows[1][1], "chr1");
+    EXPECT_EQ(rows[1][2], "900");
+    EXPECT_EQ(rows[2][1], "chr2");
+    EXPECT_EQ(rows[2][2], "100");
+    EXPECT_EQ(rows[3][2], "500");
+    EXPECT_EQ(rows[3][8], "regions.part_002_of_002.resume01.shard_000.ismr");  // first by file name
+
+    // The index points straight at the blocks
+    BinaryRegionReader reader(dir + "/" + rows[2][8]);
+    const BinaryFormat::RegionIndexEntry* e = reader.find(1);
+    ASSERT_NE(e, nullptr);
+    EXPECT_EQ(std::to_string(e->block_offset), rows[2][9]);
+    EXPECT_EQ(e->num_reads, 3);
+
+    // Merging again ignores its own outputs
+    EXPECT_EQ(merger.merge().regions, 3u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardMergerTest, RekeysClustersAndCountsFailures) {
+    std::string dir = make_dir("clusters");
+    {
+        BinaryRegionWriter w(dir + "/regions.part_001_of_002.shard_000.ismr");
+        write_region(w, 0, 300, 0, 2);
+    }
+    {
+        BinaryRegionWriter w(dir + "/regions.part_002_of_002.shard_000.ismr");
+        write_region(w, 0, 200, 0, 2);
+    }
+    const std::string header = "region_id\tchr\tpos\tref\talt\tnum_reads";
+    std::ofstream(dir + "/clusters.part_001_of_002.tsv") << header << "\n0\tchr1\t300\tC\tT\t2\n";
+    std::ofstream(dir + "/clusters.part_002_of_002.tsv") << header << "\n0\tchr1\t200\tC\tT\t2\n"
+                                                         << "7\tchr1\t250\tC\tT\t2\n";
+    {
+        SomaticSnv failed{};
+        failed.pos = 250;
+        failed.ref_base = 'C';
+        failed.alt_base = 'T';
+        JournalEntry e;
+        e.key = CompletionJournal::region_key("chr1", failed);
+        e.region_id = 1;
+        CompletionJournal journal(dir + "/completed.part_002_of_002.journal", false);
+        journal.append({e});
+    }
+
+    MergeStats stats = ShardMerger(dir, {"chr1"}).merge();
+    EXPECT_EQ(stats.regions, 2u);
+    EXPECT_EQ(stats.cluster_files, 2u);
+    EXPECT_EQ(stats.cluster_rows, 3u);
+    EXPECT_EQ(stats.failed, 1u);
+
+    auto rows = read_tsv(dir + "/merged.clusters.tsv");
+    ASSERT_EQ(rows.size(), 4u);
+    EXPECT_EQ(rows[0][0], "region_id");
+    EXPECT_EQ(rows[1][0], "0");
+    EXPECT_EQ(rows[1][2], "200");
+    EXPECT_EQ(rows[2][0], "1");
+    EXPECT_EQ(rows[2][2], "300");
+    EXPECT_EQ(rows[3][0], "-1");  // analyzed but never written
+    EXPECT_TRUE(std::filesystem::exists(dir + "/merged.summary.json"));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardMergerTest, KeepsOneFilesClusterRowsPerRegion) {
+    std::string dir = make_dir("cluster_dups");
+    {
+        BinaryRegionWriter w(dir + "/regions.shard_000.ismr");
+        write_region(w, 0, 300, 0, 2);
+    }
+    // A crash mid-append left one of the region's two rows (and a truncated one);
+    // the resumed run wrote both rows again
+    const std::string header = "region_id\tchr\tpos\tref\talt\tcluster_id";
+    std::ofstream(dir + "/clusters.tsv") << header << "\n0\tchr1\t300\tC\tT\t1\n0\tchr1\t300\tC\tT";
+    std::ofstream(dir + "/clusters.resume01.tsv") << header << "\n0\tchr1\t300\tC\tT\t1\n"
+                                                  << "0\tchr1\t300\tC\tT\t2\n";
+
+    MergeStats stats = ShardMerger(dir, {"chr1"}).merge();
+    EXPECT_EQ(stats.cluster_rows, 2u);
+    EXPECT_EQ(stats.cluster_duplicates, 2u);
+
+    auto rows = read_tsv(dir + "/merged.clusters.tsv");
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[1][5], "1");
+    EXPECT_EQ(rows[2][5], "2");
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "core/ShardPlan.hpp"
+
+using namespace InterSubMod;
+
+TEST(ShardPlanTest, ParsesAndMergesRegionLists) {
+    auto ranges = parse_region_list("chr2:1,000-2,000,chr1:1-50M,chr2:1500-3k,chrX");
+    ASSERT_EQ(ranges.size(), 3u);
+    // Chromosomes keep their first-appearance order; overlaps are merged
+    EXPECT_EQ(ranges[0].chr, "chr2");
+    EXPECT_EQ(ranges[0].start, 1000);
+    EXPECT_EQ(ranges[0].end, 3000);
+    EXPECT_EQ(ranges[1].to_string(), "chr1:1-50000000");
+    EXPECT_EQ(ranges[2].to_string(), "chrX");
+    EXPECT_TRUE(ranges[2].contains("chrX", 150000000));
+
+    // Contig names may contain ':'; only the last one separates coordinates
+    auto hla = parse_region_list("HLA-A*01:01:01:01:1-100");
+    ASSERT_EQ(hla.size(), 1u);
+    EXPECT_EQ(hla[0].chr, "HLA-A*01:01:01:01");
+    EXPECT_EQ(hla[0].end, 100);
+
+    EXPECT_THROW(parse_region_list(""), std::runtime_error);
+    EXPECT_THROW(parse_region_list("chr1:500-100"), std::runtime_error);
+}
+
+TEST(ShardPlanTest, ParsesShardSpecs) {
+    ShardSpec s = ShardSpec::parse("3/16");
+    EXPECT_EQ(s.index, 3);
+    EXPECT_EQ(s.count, 16);
+    EXPECT_EQ(s.tag(), "part_003_of_016");
+    EXPECT_THROW(ShardSpec::parse("0/4"), std::runtime_error);
+    EXPECT_THROW(ShardSpec::parse("5/4"), std::runtime_error);
+    EXPECT_THROW(ShardSpec::parse("2"), std::runtime_error);
+}
+
+TEST(ShardPlanTest, ShardsPartitionTheGenomeByWeight) {
+    // chr1 carries 3x the reads of chr2; chrM has none
+    std::vector<ContigWeight> contigs = {
+        {"chr1", 1000, 300.0}, {"chrM", 16, 0.0}, {"chr2", 500, 100.0}};
+
+    const int n = 4;
+    std::vector<std::vector<GenomicRange>> shards;
+    for (int i = 1; i <= n; i++) {
+        shards.push_back(ShardPlanner::plan(contigs, ShardSpec{i, n}));
+    }
+
+    // Three shards cut chr1 evenly, the read-less chrM rides along with the
+    // third and the last one takes chr2
+    ASSERT_EQ(shards[0].size(), 1u);
+    EXPECT_EQ(shards[0][0].to_string(), "chr1:1-333");
+    ASSERT_EQ(shards[2].size(), 2u);
+    EXPECT_EQ(shards[2][1].to_string(), "chrM:1-16");
+    ASSERT_EQ(shards[3].size(), 1u);
+    EXPECT_EQ(shards[3][0].to_string(), "chr2:1-500");
+
+    // Every base belongs to exactly one shard
+    for (const auto& c : contigs) {
+        for (int64_t pos = 1; pos <= c.length; pos++) {
+            int owners = 0;
+            for (const auto& shard : shards) {
+                for (const auto& r : shard) owners += r.contains(c.name, pos);
+            }
+            ASSERT_EQ(owners, 1) << c.name << ":" << pos;
+        }
+    }
+}
+
+TEST(ShardPlanTest, SelectionTagsAreFileNameSafe) {
+    EXPECT_EQ(region_selection_tag(parse_region_list("chr1:1-50M")), "chr1_1-50000000");
+    std::string many;
+    for (int i = 1; i <= 20; i++) many += "chr" + std::to_string(i) + ":1-1000,";
+    std::string tag = region_selection_tag(parse_region_list(many));
+    EXPECT_EQ(tag.rfind("regions_", 0), 0u);
+    EXPECT_EQ(tag, region_selection_tag(parse_region_list(many)));
+}
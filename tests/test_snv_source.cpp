@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "core/SnvSource.hpp"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+using namespace InterSubMod;
+
+TEST(SnvSourceTest, StreamsTsvAndAssignsChromosomeIds) {
+    std::string path = "/tmp/snv_source_test_" + std::to_string(getpid()) + ".tsv";
+    {
+        std::ofstream out(path);
+        out << "chr\tpos\tref\talt\tqual\n"
+            << "chr17\t7578000\tC\tT\t100.0\n"
+            << "# comment\n"
+            << "chr2\t5000\tG\tA\n"        // qual is optional
+            << "chr17\tnot_a_pos\tC\tT\n"  // malformed
+            << "\n"
+            << "chr17\t7579000\tA\tG\t30\n";
+    }
+
+    ChromIndex chroms;
+    SnvSource source(path, chroms);
+    EXPECT_EQ(source.format(), SnvSource::Format::TSV);
+
+    std::vector<SomaticSnv> snvs;
+    std::vector<std::string> names;
+    SomaticSnv snv;
+    std::string chr;
+    while (source.next(snv, chr)) {
+        snvs.push_back(snv);
+        names.push_back(chr);
+    }
+    std::remove(path.c_str());
+
+    ASSERT_EQ(snvs.size(), 3u);
+    EXPECT_EQ(names, (std::vector<std::string>{"chr17", "chr2", "chr17"}));
+    for (size_t i = 0; i < snvs.size(); i++) {
+        EXPECT_EQ(snvs[i].snv_id, static_cast<int>(i));
+        EXPECT_EQ(chroms.get_name(snvs[i].chr_id), names[i]);
+        EXPECT_TRUE(snvs[i].is_pass_filter);
+    }
+    EXPECT_EQ(snvs[0].chr_id, snvs[2].chr_id);
+    EXPECT_NE(snvs[0].chr_id, snvs[1].chr_id);
+    EXPECT_EQ(snvs[0].pos, 7578000);
+    EXPECT_FLOAT_EQ(snvs[0].qual, 100.0f);
+    EXPECT_FLOAT_EQ(snvs[1].qual, 0.0f);
+    EXPECT_EQ(snvs[2].ref_base, 'A');
+    EXPECT_EQ(snvs[2].alt_base, 'G');
+
+    EXPECT_EQ(source.stats().records, 4u);
+    EXPECT_EQ(source.stats().loaded, 3u);
+    EXPECT_EQ(source.stats().skipped, 1u);
+}
+
+TEST(SnvSourceTest, FirstLineWithoutHeaderIsData) {
+    std::string path = "/tmp/snv_source_test_nohdr_" + std::to_string(getpid()) + ".tsv";
+    {
+        std::ofstream out(path);
+        out << "chr1\t100\tC\tT\n";
+    }
+    ChromIndex chroms;
+    SnvSource source(path, chroms);
+    SomaticSnv snv;
+    std::string chr;
+    EXPECT_TRUE(source.next(snv, chr));
+    EXPECT_EQ(chr, "chr1");
+    EXPECT_EQ(snv.pos, 100);
+    EXPECT_FALSE(source.next(snv, chr));
+    std::remove(path.c_str());
+}
+
+TEST(SnvSourceTest, DetectsFormatAndRejectsMissingFiles) {
+    EXPECT_TRUE(SnvSource::is_vcf_path("somatic.vcf"));
+    EXPECT_TRUE(SnvSource::is_vcf_path("somatic.vcf.gz"));
+    EXPECT_TRUE(SnvSource::is_vcf_path("somatic.bcf"));
+    EXPECT_FALSE(SnvSource::is_vcf_path("snvs.tsv"));
+
+    ChromIndex chroms;
+    EXPECT_THROW(SnvSource("/nonexistent.tsv", chroms), std::runtime_error);
+    EXPECT_THROW(SnvSource("/nonexistent.vcf.gz", chroms), std::runtime_error);
+}
+
+TEST(SnvSourceTest, RegionSelectionFiltersTsv) {
+    std::string path = "/tmp/snv_source_test_regions_" + std::to_string(getpid()) + ".tsv";
+    {
+        std::ofstream out(path);
+        out << "chr1\t100\tC\tT\n"
+            << "chr1\t5000\tC\tT\n"
+            << "chr2\t100\tG\tA\n"
+            << "chr3\t42\tA\tG\n";
+    }
+    ChromIndex chroms;
+    SnvSource source(path, chroms);
+    source.set_regions(parse_region_list("chr1:1-1000,chr3"));
+
+    std::vector<int32_t> positions;
+    SomaticSnv snv;
+    std::string chr;
+    while (source.next(snv, chr)) {
+        positions.push_back(snv.pos);
+    }
+    std::remove(path.c_str());
+
+    EXPECT_EQ(positions, (std::vector<int32_t>{100, 42}));
+    EXPECT_EQ(source.stats().outside, 2u);
+    EXPECT_FALSE(source.stats().indexed);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "utils/StageTimer.hpp"
+#include "utils/ResourceMonitor.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace InterSubMod::Utils;
+
+TEST(StageTimerTest, ScopedTimerAccumulatesIntoStage) {
+    StageTimes times;
+    for (int i = 0; i < 2; i++) {
+        ScopedStageTimer timer(times[Stage::PARSE]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_GE(times[Stage::PARSE], 4.0);
+    EXPECT_EQ(times[Stage::BAM_FETCH], 0.0);
+    EXPECT_DOUBLE_EQ(times.total(), times[Stage::PARSE]);
+}
+
+TEST(StageTimerTest, PerThreadTimesMerge) {
+    std::vector<StageTimes> per_thread(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < per_thread.size(); t++) {
+        threads.emplace_back([&, t] {
+            per_thread[t][Stage::FINALIZE] += 1.5;
+            per_thread[t][Stage::WRITE] += static_cast<double>(t);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    StageTimes merged;
+    for (const auto& t : per_thread) merged += t;
+    EXPECT_DOUBLE_EQ(merged[Stage::FINALIZE], 6.0);
+    EXPECT_DOUBLE_EQ(merged[Stage::WRITE], 6.0);
+    EXPECT_STREQ(stage_name(Stage::BAM_FETCH), "bam_fetch");
+    EXPECT_STREQ(stage_name(Stage::WRITE), "write");
+}
+
+TEST(StageTimerTest, ThreadAllocationCounterIsMonotonic) {
+    uint64_t before = ResourceMonitor::thread_allocated_bytes();
+    std::vector<char> buffer(1 << 20, 'x');
+    uint64_t after = ResourceMonitor::thread_allocated_bytes();
+    EXPECT_GE(after, before);
+#ifdef USE_JEMALLOC
+    EXPECT_GE(after - before, buffer.size());
+#endif
+}